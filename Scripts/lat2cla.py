@@ -0,0 +1,307 @@
+#!/usr/bin/env python
+
+# This script converts legacy lattice archives (a TOC file with lines key=archive[offset] and the archives it refers to)
+# into a single compressed lattice archive, which the lattice deserializer memory-maps and decompresses per lattice on demand.
+# The compressed archive is listed in the latticeIndexFile of the reader in place of the TOC file(s), the format is detected automatically.
+#
+# Every lattice is compressed separately as an LZ4 block. If the 'lz4' Python package is installed it is used,
+# otherwise a (slow) built-in compressor. Before compression, the node times of V2 lattices are delta-coded.
+# Compression is lossless: the reader hands exactly the original bytes to the network.
+#
+# Format (little-endian), see also Source/Readers/HTKDeserializers/CompressedLatticeArchive.h:
+#   header: uint64 magic, uint32 version, uint32 reserved, uint64 number of lattices, uint64 TOC offset, uint64 keys offset, uint64 reserved
+#   blocks: compressed lattices
+#   TOC:    per lattice: uint64 block offset, uint64 key offset, uint32 compressed size, uint32 original size, uint32 flags, uint32 reserved
+#   keys:   zero-terminated keys
+#
+# Example usage:
+#   python lat2cla.py --input train.lats.toc --output train.lats.cla
+
+import sys
+import argparse
+import struct
+
+MAGIC_NUMBER = 0x636e746b5f636c61 # 'cntk_cla'
+VERSION = 1
+HEADER_FORMAT = '<QIIQQQQ'
+TOC_FORMAT = '<QQIIII'
+FLAG_LZ4 = 1
+FLAG_DELTA_NODE_TIMES = 2
+
+# Serialized V2 lattice: "LAT " version header_v1_v2 (32 bytes) "NODS" count times[count] ...
+NODES_TAG_OFFSET = 8 + 32
+NODE_TIMES_OFFSET = NODES_TAG_OFFSET + 8
+
+try:
+    import lz4.block
+    def lz4_compress(data):
+        return lz4.block.compress(bytes(data), store_size=False)
+except ImportError:
+    lz4_compress = None
+
+MIN_MATCH = 4
+MF_LIMIT = 12      # the last match must start at least 12 bytes before the end of the block
+LAST_LITERALS = 5  # the last 5 bytes are always literals
+
+def _write_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+def _write_sequence(out, literals, offset, match_length):
+    literal_length = len(literals)
+    token = min(literal_length, 15) << 4
+    if match_length:
+        token |= min(match_length - MIN_MATCH, 15)
+    out.append(token)
+    if literal_length >= 15:
+        _write_length(out, literal_length - 15)
+    out += literals
+    if match_length:
+        out += struct.pack('<H', offset)
+        if match_length - MIN_MATCH >= 15:
+            _write_length(out, match_length - MIN_MATCH - 15)
+
+# Greedy LZ4 block compressor, used when the lz4 package is not available.
+def lz4_compress_block(data):
+    data = bytes(data)
+    n = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    i = 0
+    while i < n - MF_LIMIT:
+        key = data[i:i + MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is not None and i - candidate <= 0xFFFF:
+            length = MIN_MATCH
+            max_length = n - LAST_LITERALS - i
+            while length < max_length and data[candidate + length] == data[i + length]:
+                length += 1
+            _write_sequence(out, data[anchor:i], i - candidate, length)
+            i += length
+            anchor = i
+            continue
+        i += 1
+    _write_sequence(out, data[anchor:], 0, 0)
+    return bytes(out)
+
+def lz4_decompress_block(data, size):
+    data = bytearray(data)
+    out = bytearray()
+    i = 0
+    def read_length(length, i):
+        if length == 15:
+            while True:
+                b = data[i]
+                i += 1
+                length += b
+                if b != 255:
+                    break
+        return length, i
+    while i < len(data):
+        token = data[i]
+        i += 1
+        literals, i = read_length(token >> 4, i)
+        out += data[i:i + literals]
+        i += literals
+        if i == len(data):
+            break
+        offset = data[i] | (data[i + 1] << 8)
+        i += 2
+        match, i = read_length(token & 15, i)
+        match += MIN_MATCH
+        for _ in range(match):
+            out.append(out[-offset])
+    if len(out) != size:
+        raise Exception("Decompressed {0} bytes, expected {1}".format(len(out), size))
+    return bytes(out)
+
+def _node_times(lattice):
+    if len(lattice) < NODE_TIMES_OFFSET or lattice[0:4] != b'LAT ' or lattice[NODES_TAG_OFFSET:NODES_TAG_OFFSET + 4] != b'NODS':
+        return None
+    count = struct.unpack_from('<i', lattice, NODES_TAG_OFFSET + 4)[0]
+    if count < 0 or NODE_TIMES_OFFSET + 2 * count > len(lattice):
+        return None
+    return count
+
+def delta_node_times(lattice, inverse=False):
+    count = _node_times(lattice)
+    if count is None:
+        return None
+    result = bytearray(lattice)
+    times = struct.unpack_from('<{0}H'.format(count), lattice, NODE_TIMES_OFFSET)
+    if inverse:
+        coded, t = [], 0
+        for d in times:
+            t = (t + d) & 0xFFFF
+            coded.append(t)
+    else:
+        coded = [(t - p) & 0xFFFF for t, p in zip(times, (0,) + times[:-1])]
+    struct.pack_into('<{0}H'.format(count), result, NODE_TIMES_OFFSET, *coded)
+    return bytes(result)
+
+def compress_lattice(lattice):
+    flags = 0
+    delta = delta_node_times(lattice)
+    if delta is not None:
+        lattice = delta
+        flags |= FLAG_DELTA_NODE_TIMES
+    compressed = (lz4_compress or lz4_compress_block)(lattice)
+    if len(compressed) < len(lattice):
+        return compressed, flags | FLAG_LZ4
+    return lattice, flags
+
+# Yields (key, archive path, start offset, end offset) for the lattices of a TOC file.
+# Same as the lattice deserializer: an empty path continues the previous archive; a lattice ends where the next one starts
+# in the same archive, or at the end of the archive.
+def read_toc(toc):
+    entries = []
+    archive = None
+    for line in toc:
+        line = line.rstrip('\r\n')
+        if not line:
+            continue
+        eq, open_bracket, close_bracket = line.find('='), line.find('['), line.find(']')
+        if eq < 0 or open_bracket < 0 or close_bracket < 0:
+            raise Exception("The lattice TOC line is malformed: " + line)
+        path = line[eq + 1:open_bracket]
+        if path:
+            archive = path
+        if archive is None:
+            raise Exception("The first lattice TOC line must name the archive: " + line)
+        entries.append((line[:eq], archive, int(line[open_bracket + 1:close_bracket].split(',')[0])))
+    for i, (key, archive, start) in enumerate(entries):
+        if i + 1 < len(entries) and entries[i + 1][1] == archive and entries[i + 1][2] > start:
+            end = entries[i + 1][2]
+        else:
+            end = None
+        yield key, archive, start, end
+
+def convert(tocs, output, open_archive=lambda path: open(path, 'rb')):
+    output.write(struct.pack(HEADER_FORMAT, 0, 0, 0, 0, 0, 0, 0)) # patched at the end
+    offset = struct.calcsize(HEADER_FORMAT)
+    toc_entries = []
+    keys = bytearray()
+    original_total = 0
+    archives = {}
+    for toc in tocs:
+        for key, archive, start, end in read_toc(toc):
+            if archive not in archives:
+                archives[archive] = open_archive(archive)
+            f = archives[archive]
+            f.seek(start)
+            lattice = f.read() if end is None else f.read(end - start)
+            block, flags = compress_lattice(lattice)
+            output.write(block)
+            toc_entries.append((offset, len(keys), len(block), len(lattice), flags, 0))
+            keys += key.encode('utf-8') + b'\0'
+            offset += len(block)
+            original_total += len(lattice)
+    for f in archives.values():
+        f.close()
+
+    toc_offset = offset
+    output.write(b''.join(struct.pack(TOC_FORMAT, *e) for e in toc_entries))
+    keys_offset = toc_offset + len(toc_entries) * struct.calcsize(TOC_FORMAT)
+    output.write(bytes(keys))
+    output.seek(0)
+    output.write(struct.pack(HEADER_FORMAT, MAGIC_NUMBER, VERSION, 0, len(toc_entries), toc_offset, keys_offset, 0))
+    return len(toc_entries), original_total, toc_offset
+
+# Reads a compressed lattice archive back into a list of (key, lattice).
+def read_archive(data):
+    magic, version, _, count, toc_offset, keys_offset, _ = struct.unpack_from(HEADER_FORMAT, data, 0)
+    if magic != MAGIC_NUMBER or version != VERSION:
+        raise Exception("Not a compressed lattice archive of version {0}".format(VERSION))
+    result = []
+    for i in range(count):
+        block_offset, key_offset, compressed_size, original_size, flags, _ = struct.unpack_from(TOC_FORMAT, data, toc_offset + i * struct.calcsize(TOC_FORMAT))
+        block = data[block_offset:block_offset + compressed_size]
+        lattice = lz4_decompress_block(block, original_size) if flags & FLAG_LZ4 else bytes(block)
+        if flags & FLAG_DELTA_NODE_TIMES:
+            lattice = delta_node_times(lattice, inverse=True)
+        key_start = keys_offset + key_offset
+        result.append((data[key_start:data.index(b'\0', key_start)].decode('utf-8'), lattice))
+    return result
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Converts legacy lattice archives into a compressed lattice archive.")
+    parser.add_argument('--input', help='Lattice TOC files to convert', nargs="+", required=True)
+    parser.add_argument('--output', help='Name of the output file', required=True)
+    args = parser.parse_args()
+
+    if lz4_compress is None:
+        sys.stderr.write("WARNING: the lz4 package is not installed, using the slow built-in compressor\n")
+
+    tocs = [open(t, 'r') for t in args.input]
+    with open(args.output, 'wb') as output:
+        count, original, compressed = convert(tocs, output)
+    for t in tocs:
+        t.close()
+    sys.stderr.write("Converted {0} lattices, {1} bytes into {2} bytes ({3:.1f}x)\n"
+        .format(count, original, compressed, original / float(max(compressed, 1))))
+
+#####################################################################################################
+# Tests
+#####################################################################################################
+from io import BytesIO
+try:
+    from StringIO import StringIO
+except ImportError:
+    from io import StringIO
+import random
+
+# A V2 lattice that lattice forward-backward accepts: a chain through all nodes plus edges that skip one or two nodes,
+# sorted by (end node, start node), each with an alignment of 3-state units of at least 3 frames that fills the edge.
+# Units are ids 0..num_units-1 of the .symlist; num_units is the implied /sp/, which GetSymList() appends.
+def _test_lattice(num_nodes, seed, num_units=44):
+    rng = random.Random(seed)
+    times = [0]
+    for _ in range(num_nodes - 1):
+        times.append(times[-1] + rng.randrange(3, 12))
+    edges = [(s, s + 1) for s in range(num_nodes - 1)]
+    edges += [(s, s + rng.randrange(2, 4)) for s in rng.sample(range(num_nodes - 3), num_nodes // 3)]
+    edges = sorted(set(edges), key=lambda e: (e[1], e[0]))
+    tokens, edge_records = [], []
+    for s, e in edges:
+        tokens += [struct.pack('<f', -10.0 * rng.random()), struct.pack('<f', rng.choice([-1.5, -2.25, 0.0]))] # ac, lm score
+        edge_records.append(struct.pack('<Q', s | (e << 20) | (len(tokens) << 40)))
+        frames = times[e] - times[s]
+        units = []
+        while frames >= 6 and rng.random() < 0.6:
+            units.append(rng.randrange(3, frames - 2))
+            frames -= units[-1]
+        units.append(frames)
+        for i, f in enumerate(units):
+            tokens.append(struct.pack('<I', rng.randrange(num_units) | (f << 19) | ((i == len(units) - 1) << 31)))
+    header = struct.pack('<IIffdQ', num_nodes, len(edges), 1.0, 0.0, 0.01, times[-1] | (num_units << 32) | (1 << 63))
+    return (b'LAT ' + struct.pack('<i', 2) + header + b'NODS' + struct.pack('<i', num_nodes) + struct.pack('<{0}H'.format(num_nodes), *times) +
+        b'EDGS' + struct.pack('<i', len(edges)) + b''.join(edge_records) + b'ALNS' + struct.pack('<i', len(tokens)) + b''.join(tokens) + b'END ')
+
+def test_lz4RoundTrip():
+    rng = random.Random(1)
+    for data in [b'', b'a', b'abcabcabcabcabcabcabcabcabcabc' * 20, bytes(rng.randrange(4) for _ in range(5000)), _test_lattice(300, 2)]:
+        assert lz4_decompress_block(lz4_compress_block(data), len(data)) == data
+
+def test_deltaNodeTimes():
+    lattice = _test_lattice(100, 3)
+    delta = delta_node_times(lattice)
+    assert delta != lattice
+    assert delta_node_times(delta, inverse=True) == lattice
+    assert delta_node_times(b'not a lattice') is None
+
+def test_archiveRoundTrip():
+    lattices = [_test_lattice(50 + 10 * i, i) for i in range(5)]
+    archive1 = b''.join(lattices[:3])
+    archive2 = b''.join(lattices[3:])
+    toc = ('a=arch1[0]\nb=[{0}]\nc=[{1}]\nd=arch2[0]\ne=[{2}]\n'
+        .format(len(lattices[0]), len(lattices[0]) + len(lattices[1]), len(lattices[3])))
+    files = {'arch1': archive1, 'arch2': archive2}
+    output = BytesIO()
+    count, original, compressed = convert([StringIO(toc)], output, lambda path: BytesIO(files[path]))
+    assert count == 5 and original == len(archive1) + len(archive2)
+    assert compressed < original
+    assert read_archive(output.getvalue()) == list(zip('abcde', lattices))
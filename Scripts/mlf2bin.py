@@ -0,0 +1,278 @@
+#!/usr/bin/env python
+
+# This script converts HTK state-aligned MLF files into a binary MLF label archive,
+# which the MLF deserializer memory-maps instead of parsing text on every chunk load.
+# The binary file is given to the reader in place of the text MLF (mlfFile = ...), the format is detected automatically.
+#
+# Labels are parsed the same way as the MLF deserializer does:
+#  - if a state list is given (it must be the labelMappingFile of the reader), the third column is looked up in it,
+#  - otherwise the MLF must have 4 columns, the fourth being the class id.
+# Utterances that the deserializer would reject (not consecutive, not starting at frame 0, empty) are skipped with a warning.
+#
+# Format (little-endian), see also Source/Readers/HTKDeserializers/MLFBinaryFile.h:
+#   header:     uint64 magic, uint32 version, uint32 number of classes, uint64 number of utterances,
+#               uint64 offsets of the utterances, hash index, keys and runs sections,
+#               uint64 hash of the state list (FNV-1a of the state names in index order, each followed by '\n'; 0 without a state list)
+#   utterances: per utterance: uint64 first run, uint64 key offset, uint32 number of runs, uint32 number of frames
+#   hash index: per utterance: uint64 FNV-1a hash of the key, uint64 utterance index; sorted
+#   keys:       zero-terminated keys (without quotes and extension), padded to 8 bytes
+#   runs:       per MLF frame range: uint32 number of frames, uint16 class id, uint16 reserved
+#
+# Example usage:
+#   python mlf2bin.py --input train.mlf --states state.list --output train.mlfbin
+
+import sys
+import argparse
+import struct
+import re
+
+MAGIC_NUMBER = 0x636e746b5f6d6c66 # 'cntk_mlf'
+VERSION = 2
+HEADER_FORMAT = '<QIIQQQQQQ'
+UTTERANCE_FORMAT = '<QQII'
+HASH_FORMAT = '<QQ'
+RUN_FORMAT = '<IHH'
+MAX_CLASS_ID = 0xFFFF
+HTK_TIME_TO_FRAME = 100000.0
+
+_double = re.compile(br'[+-]?(\d+\.?\d*|\.\d+)([eE][+-]?\d+)?')
+_int = re.compile(br'[+-]?\d+')
+
+def hash_key(key):
+    h = 0xcbf29ce484222325
+    for c in bytearray(key):
+        h ^= c
+        h = (h * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+# The reader refuses a binary MLF converted with a state list other than its labelMappingFile.
+def hash_state_list(states):
+    return hash_key(b''.join(name + b'\n' for name in sorted(states, key=states.get)))
+
+def read_state_list(stream):
+    lines = [l for l in re.split(br'[\r\n]', stream.read()) if l]
+    states = {}
+    for index, line in enumerate(lines):
+        if line in states:
+            raise Exception("Duplicate state '{0}' in the state list".format(line.decode('latin-1')))
+        states[line] = index
+    return states
+
+def _parse_number(pattern, token, what):
+    m = pattern.match(token)
+    if not m:
+        raise Exception("Cannot parse {0} from '{1}'".format(what, token.decode('latin-1')))
+    return m.group(0)
+
+# Same as MLFFrameRange::ParseFrameRange: values are either frames or HTK time (100ns units).
+def parse_frame_range(tokens):
+    if len(tokens) < 2:
+        raise Exception("Do not support frame range format with less than two columns")
+    start = float(_parse_number(_double, tokens[0], 'start frame'))
+    end = float(_parse_number(_double, tokens[1], 'end frame'))
+    if end - start >= HTK_TIME_TO_FRAME - 1:
+        return int(start / HTK_TIME_TO_FRAME + 0.5), int(end / HTK_TIME_TO_FRAME + 0.5)
+    return int(start), int(end)
+
+def parse_key(line):
+    key = line.rstrip()
+    if len(key) <= 2 or key[:1] != b'"' or key[-1:] != b'"':
+        return None
+    key = key[1:-1]
+    if len(key) > 2 and key[:2] == b'*/':
+        key = key[2:]
+    dot = key.rfind(b'.')
+    return key if dot < 0 else key[:dot]
+
+# Returns a list of (number of frames, class id) per MLF line, or None if the deserializer would skip the utterance.
+def parse_utterance(key, lines, states):
+    runs = []
+    expected_start = 0
+    for line in lines:
+        tokens = line.split(b' ')
+        start, end = parse_frame_range(tokens)
+        if states is not None:
+            if len(tokens) < 3 or tokens[2] not in states:
+                raise Exception("Utterance '{0}': state '{1}' is not found in the state list"
+                    .format(key.decode('latin-1'), tokens[2].decode('latin-1') if len(tokens) > 2 else ''))
+            class_id = states[tokens[2]]
+        else:
+            if len(tokens) != 4:
+                raise Exception("Utterance '{0}': 4-column format frame range or state list is required".format(key.decode('latin-1')))
+            class_id = int(_parse_number(_int, tokens[3], 'class id'))
+        if end < start:
+            raise Exception("Utterance '{0}': frame range end time is earlier than start time".format(key.decode('latin-1')))
+        if class_id < 0 or class_id > MAX_CLASS_ID:
+            raise Exception("Utterance '{0}': class id {1} does not fit into 16 bits".format(key.decode('latin-1'), class_id))
+        if start != expected_start:
+            return None
+        runs.append((end - start, class_id))
+        expected_start = end
+    if expected_start == 0:
+        return None
+    return runs
+
+# Yields (key, runs) for all utterances of a text MLF.
+def read_mlf(stream, states):
+    header = False
+    key = None
+    lines = []
+    for line in stream:
+        line = line.rstrip(b'\n')
+        if line.endswith(b'\r'):
+            line = line[:-1]
+        if not line:
+            continue
+        if not header:
+            if line != b'#!MLF!#':
+                raise Exception("Expected MLF header was not found")
+            header = True
+        elif key is None:
+            if line == b'#!MLF!#':
+                continue
+            key = parse_key(line)
+            if key is None:
+                key = b''
+                sys.stderr.write("WARNING: cannot parse the utterance key {0}\n".format(line.decode('latin-1')))
+            lines = []
+        elif line != b'.':
+            lines.append(line)
+        else:
+            runs = parse_utterance(key, lines, states) if key and lines else None
+            if runs is None:
+                sys.stderr.write("WARNING: skipping the utterance '{0}'\n".format(key.decode('latin-1')))
+            else:
+                yield key, runs
+            key = None
+
+def convert(inputs, output, states=None):
+    keys = bytearray()
+    runs = bytearray()
+    utterances = []  # (first run, key offset, number of runs, number of frames)
+    hashes = []
+    num_runs = 0
+    max_class_id = -1
+    for input in inputs:
+        for key, utterance_runs in read_mlf(input, states):
+            hashes.append((hash_key(key), len(utterances)))
+            utterances.append((num_runs, len(keys), len(utterance_runs), sum(r[0] for r in utterance_runs)))
+            keys += key + b'\0'
+            for frames, class_id in utterance_runs:
+                runs += struct.pack(RUN_FORMAT, frames, class_id, 0)
+                max_class_id = max(max_class_id, class_id)
+            num_runs += len(utterance_runs)
+    keys += b'\0' * (-len(keys) % 8)
+    hashes.sort()
+
+    num_classes = len(states) if states is not None else max_class_id + 1
+    state_list_hash = hash_state_list(states) if states is not None else 0
+    utterances_offset = struct.calcsize(HEADER_FORMAT)
+    hash_offset = utterances_offset + len(utterances) * struct.calcsize(UTTERANCE_FORMAT)
+    keys_offset = hash_offset + len(hashes) * struct.calcsize(HASH_FORMAT)
+    runs_offset = keys_offset + len(keys)
+
+    output.write(struct.pack(HEADER_FORMAT, MAGIC_NUMBER, VERSION, num_classes, len(utterances),
+        utterances_offset, hash_offset, keys_offset, runs_offset, state_list_hash))
+    output.write(b''.join(struct.pack(UTTERANCE_FORMAT, *u) for u in utterances))
+    output.write(b''.join(struct.pack(HASH_FORMAT, *h) for h in hashes))
+    output.write(bytes(keys))
+    output.write(bytes(runs))
+    return len(utterances)
+
+# Reads a binary MLF back into a list of (key, [(number of frames, class id)]) and the number of classes.
+def read_binary(data):
+    header = struct.unpack_from(HEADER_FORMAT, data, 0)
+    (magic, version, num_classes, num_utterances, utterances_offset, hash_offset, keys_offset, runs_offset, _) = header
+    if magic != MAGIC_NUMBER or version != VERSION:
+        raise Exception("Not a binary MLF of version {0}".format(VERSION))
+    result = []
+    for i in range(num_utterances):
+        first_run, key_offset, num_runs, _ = struct.unpack_from(UTTERANCE_FORMAT, data, utterances_offset + i * struct.calcsize(UTTERANCE_FORMAT))
+        key_start = keys_offset + key_offset
+        key = bytes(data[key_start:data.index(b'\0', key_start)])
+        runs = [struct.unpack_from(RUN_FORMAT, data, runs_offset + (first_run + r) * struct.calcsize(RUN_FORMAT))[:2] for r in range(num_runs)]
+        result.append((key, runs))
+    return result, num_classes
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Converts HTK state-aligned MLF files into a binary MLF label archive.")
+    parser.add_argument('--input', help='MLF files to convert', nargs="+", required=True)
+    parser.add_argument('--states', help='State list (labelMappingFile of the reader); if not given, the MLF must have class ids in the 4th column',
+        default=None, required=False)
+    parser.add_argument('--output', help='Name of the output file', required=True)
+    args = parser.parse_args()
+
+    states = None
+    if args.states:
+        with open(args.states, 'rb') as f:
+            states = read_state_list(f)
+
+    inputs = [open(i, 'rb') for i in args.input]
+    with open(args.output, 'wb') as output:
+        count = convert(inputs, output, states)
+    for i in inputs:
+        i.close()
+    sys.stderr.write("Converted {0} utterances\n".format(count))
+
+#####################################################################################################
+# Tests
+#####################################################################################################
+from io import BytesIO
+try:
+    import pytest
+except ImportError:
+    pass
+
+_test_mlf = (b'#!MLF!#\n'
+    b'"*/utt1.lab"\n'
+    b'0 200000 s2 2\n'
+    b'200000 500000 s0 0\n'
+    b'.\n'
+    b'"utt2.rec"\r\n'
+    b'0 3 s1 1\r\n'
+    b'3 4 s1 1\r\n'
+    b'.\r\n'
+    b'#!MLF!#\n'
+    b'"utt3.lab"\n'
+    b'1 3 s1 1\n'
+    b'.\n')
+
+def test_roundTripWithClassIds():
+    output = BytesIO()
+    assert convert([BytesIO(_test_mlf)], output) == 2
+    utterances, num_classes = read_binary(output.getvalue())
+    assert num_classes == 3
+    assert utterances == [(b'utt1', [(2, 2), (3, 0)]), (b'utt2', [(3, 1), (1, 1)])]
+
+def test_stateList():
+    output = BytesIO()
+    states = read_state_list(BytesIO(b's0\ns1\r\ns2\ns3\n'))
+    convert([BytesIO(_test_mlf)], output, states)
+    utterances, num_classes = read_binary(output.getvalue())
+    assert num_classes == 4
+    assert utterances[0] == (b'utt1', [(2, 2), (3, 0)])
+
+def test_stateListHash():
+    output = BytesIO()
+    convert([BytesIO(_test_mlf)], output)
+    assert struct.unpack_from(HEADER_FORMAT, output.getvalue(), 0)[8] == 0
+
+    output = BytesIO()
+    states = read_state_list(BytesIO(b's0\ns1\r\ns2\ns3\n'))
+    convert([BytesIO(_test_mlf)], output, states)
+    assert struct.unpack_from(HEADER_FORMAT, output.getvalue(), 0)[8] == hash_key(b's0\ns1\ns2\ns3\n')
+    assert hash_state_list(read_state_list(BytesIO(b's1\ns0\ns2\ns3\n'))) != hash_state_list(states)
+
+def test_hashIndex():
+    output = BytesIO()
+    convert([BytesIO(_test_mlf)], output)
+    data = output.getvalue()
+    header = struct.unpack_from(HEADER_FORMAT, data, 0)
+    hashes = [struct.unpack_from(HASH_FORMAT, data, header[5] + i * 16) for i in range(header[3])]
+    assert hashes == sorted([(hash_key(b'utt1'), 0), (hash_key(b'utt2'), 1)])
+    assert hash_key(b'') == 0xcbf29ce484222325
+
+def test_unknownState():
+    with pytest.raises(Exception) as info:
+        convert([BytesIO(_test_mlf)], BytesIO(), read_state_list(BytesIO(b's0\ns1\n')))
+    assert "state 's2' is not found" in str(info.value)
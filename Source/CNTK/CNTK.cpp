@@ -81,7 +81,8 @@ void SetupProfiling(ProfilerContext& profilerContext, const ConfigParamType& con
         profilerContext.Init(workDir + L"/profiler",
                              config(L"profilerBufferSize", static_cast<uint64_t>(32 * 1024 * 1024)),
                              std::to_wstring(nodeRank),
-                             config(L"profilerSyncGpu", true));
+                             config(L"profilerSyncGpu", true),
+                             config(L"profilerRingBuffer", false));
     }
 }
 
@@ -512,6 +513,8 @@ int wmainWithBS(int argc, wchar_t* argv[]) // called from wmain which is a wrapp
 
     Globals::SetShareNodeValueMatrices(config(L"shareNodeValueMatrices", true));
     Globals::SetGradientAccumulationOptimization(config(L"optimizeGradientAccumulation", true));
+    Globals::SetStackRecurrentTimes(config(L"stackRecurrentTimes", false));
+    Globals::SetConcurrentLoops(config(L"concurrentLoops", false));
 
     TracingGPUMemoryAllocator::SetTraceLevel(config(L"traceGPUMemoryAllocations", 0));
 
@@ -660,6 +663,8 @@ int wmainOldCNTKConfig(int argc, wchar_t* argv[])
 
     Globals::SetShareNodeValueMatrices(config(L"shareNodeValueMatrices", true));
     Globals::SetGradientAccumulationOptimization(config(L"optimizeGradientAccumulation", true));
+    Globals::SetStackRecurrentTimes(config(L"stackRecurrentTimes", false));
+    Globals::SetConcurrentLoops(config(L"concurrentLoops", false));
 
     TracingGPUMemoryAllocator::SetTraceLevel(config(L"traceGPUMemoryAllocations", 0));
 
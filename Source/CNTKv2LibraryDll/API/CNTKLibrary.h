@@ -4293,6 +4293,19 @@ namespace CNTK
         const std::wstring& phonePath, const std::wstring& stateListPath, const std::wstring& transitionProbabilityPath, float smoothingWeight, float frameDropThreshold, bool doReferenceAlign, bool gammarUsesMBR, 
         float gammarAMF, float gammarLMF, float gammarBMMIFactor, float gammarWordPenalty, const std::wstring& name = L"");
 
+    ///
+    /// Create an instance of the CNTK built-in sampled softmax criterion for large output vocabularies: the cross entropy of the softmax over the
+    /// true class and 'numSamples' classes, which are sampled once per minibatch and corrected by the log of their expected count in the sample.
+    /// 'weights' has the shape [input dimension x number of classes], 'bias' one element per class.
+    /// Classes are sampled proportionally to 'samplingWeights' (e.g. unigram counts); without them, log-uniformly, which assumes
+    /// that classes are sorted by decreasing frequency.
+    ///
+    CNTK_API FunctionPtr SampledSoftmax(const Variable& labels, const Variable& input, const Variable& weights, const Variable& bias, size_t numSamples,
+        unsigned long seed = SentinelValueForAutoSelectRandomSeed, const std::wstring& name = L"");
+
+    CNTK_API FunctionPtr SampledSoftmax(const Variable& labels, const Variable& input, const Variable& weights, const Variable& bias, const Variable& samplingWeights, size_t numSamples,
+        unsigned long seed = SentinelValueForAutoSelectRandomSeed, const std::wstring& name = L"");
+
     ///
     /// Create an instance of the CNTK built-in operation for computing the forwardbackward for specified operands.
     ///
@@ -5430,6 +5443,155 @@ namespace CNTK
     ///
     CNTK_API EvaluatorPtr CreateEvaluator(const FunctionPtr& evaluationFunction, const std::vector<ProgressWriterPtr>& progressWriters = {});
 
+    ///
+    /// A decoded sequence produced by the BeamSearchDecoder.
+    ///
+    struct BeamSearchHypothesis
+    {
+        std::vector<size_t> tokens; // without the start token, ends with the end token unless the maximum length was reached
+        double logProbability;      // sum of the log-probabilities of the tokens
+        double score;               // log-probability normalized by the length, used to rank the hypotheses
+    };
+
+    ///
+    /// BeamSearchDecoder decodes output sequences with a beam search, running a decoder step Function one step at a time.
+    /// The step Function computes one output step for a batch of samples (it has no sequence axis): given the previous token
+    /// as a one-hot input and the recurrent state inputs, it outputs the (unnormalized) log-probabilities of the next token
+    /// and the next recurrent states. Any other argument of the step Function is a context input (e.g. the encoded input
+    /// sequence of a sequence-to-sequence model), which stays constant during decoding.
+    /// All hypotheses of all input sequences are evaluated as one batch per step. State buffers are allocated once per
+    /// Decode call and reordered in place as hypotheses are selected.
+    ///
+    class BeamSearchDecoder : public std::enable_shared_from_this<BeamSearchDecoder>
+    {
+    public:
+        ///
+        /// Decodes a batch of input sequences. 'initialValues' holds a Value with one sample per input sequence for each
+        /// recurrent state input and context input of the step Function.
+        /// Returns the N best hypotheses of each input sequence, best first.
+        ///
+        CNTK_API std::vector<std::vector<BeamSearchHypothesis>> Decode(const std::unordered_map<Variable, ValuePtr>& initialValues, const DeviceDescriptor& computeDevice = DeviceDescriptor::UseDefaultDevice());
+
+        ///
+        /// The decoder step Function.
+        ///
+        FunctionPtr StepFunction() const { return m_stepFunction; }
+
+        CNTK_API virtual ~BeamSearchDecoder() {}
+
+    private:
+        template <typename T1, typename ...CtorArgTypes>
+        friend std::shared_ptr<T1> MakeSharedObject(CtorArgTypes&& ...ctorArgs);
+
+        BeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoresOutput,
+                          const std::vector<std::pair<Variable, Variable>>& stateInputOutputPairs,
+                          size_t startToken, size_t endToken, size_t beamWidth, size_t maxLength, size_t nBest, double lengthNormalizationExponent);
+
+        template <typename ElementType>
+        std::vector<std::vector<BeamSearchHypothesis>> DecodeTyped(const std::unordered_map<Variable, ValuePtr>& initialValues, const DeviceDescriptor& computeDevice);
+
+        double NormalizedScore(double logProbability, size_t length) const;
+
+        FunctionPtr m_stepFunction;
+        Variable m_tokenInput;
+        Variable m_scoresOutput;
+        // Recurrent state inputs and the outputs computing their next value, followed by the context inputs (without output).
+        std::vector<Variable> m_carriedInputs;
+        std::vector<Variable> m_stateOutputs;
+        size_t m_startToken;
+        size_t m_endToken;
+        size_t m_beamWidth;
+        size_t m_maxLength;
+        size_t m_nBest;
+        double m_lengthNormalizationExponent;
+    };
+
+    ///
+    /// Construct a BeamSearchDecoder for the specified decoder step Function.
+    /// 'stateInputOutputPairs' pairs each recurrent state input of the step Function with the output computing its next value.
+    /// Decoding stops at the end token or after 'maxLength' tokens; the search for an input sequence stops early once none of
+    /// its active hypotheses can outscore its N best finished ones. Scores are log-probabilities divided by
+    /// length^lengthNormalizationExponent (0 disables length normalization).
+    ///
+    CNTK_API BeamSearchDecoderPtr CreateBeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoresOutput,
+                                                          const std::vector<std::pair<Variable, Variable>>& stateInputOutputPairs,
+                                                          size_t startToken, size_t endToken, size_t beamWidth, size_t maxLength,
+                                                          size_t nBest = 1, double lengthNormalizationExponent = 0.0);
+
+    ///
+    /// StreamingEvaluator evaluates a recurrent model incrementally on many concurrent input streams, e.g. real-time audio.
+    /// Each call evaluates the next chunk of frames of some of the streams, multiplexed into one minibatch with a parallel
+    /// sequence per stream, and carries the recurrent (PastValue) state of each stream over to its next chunk, so that the
+    /// cost of a call is proportional to the number of new frames. Streams can be added and removed between calls.
+    /// The model must not contain FutureValue, and its PastValue operations must have an offset of 1.
+    ///
+    class StreamingEvaluator : public std::enable_shared_from_this<StreamingEvaluator>
+    {
+    public:
+        ///
+        /// Adds a stream that starts from the initial recurrent state, and returns its id.
+        ///
+        CNTK_API size_t AddStream();
+
+        ///
+        /// Removes a stream. Its parallel sequence is reused by the next added stream.
+        ///
+        CNTK_API void RemoveStream(size_t streamId);
+
+        ///
+        /// Restarts a stream from the initial recurrent state.
+        ///
+        CNTK_API void ResetStream(size_t streamId);
+
+        ///
+        /// Evaluates the next chunk of each stream in 'inputs', which maps a stream id to a Value with a single sequence (the chunk)
+        /// for each argument of the model. On return, 'outputs' maps each of these streams to a Value with the chunk's sequence for
+        /// each output of the evaluator. The streams that are not in 'inputs' keep their state.
+        ///
+        CNTK_API void Evaluate(const std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& inputs,
+                               std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& outputs);
+
+        ///
+        /// The number of streams.
+        ///
+        size_t NumStreams() const { return m_streamSlots.size(); }
+
+        ///
+        /// The model evaluated.
+        ///
+        FunctionPtr Model() const { return m_model; }
+
+        CNTK_API virtual ~StreamingEvaluator() {}
+
+    private:
+        template <typename T1, typename ...CtorArgTypes>
+        friend std::shared_ptr<T1> MakeSharedObject(CtorArgTypes&& ...ctorArgs);
+
+        StreamingEvaluator(const FunctionPtr& model, const std::vector<Variable>& outputs, const DeviceDescriptor& computeDevice);
+
+        template <typename ElementType>
+        void EvaluateTyped(const std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& inputs,
+                           std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& outputs);
+
+        size_t SlotOf(size_t streamId) const;
+
+        FunctionPtr m_model;
+        std::vector<Variable> m_arguments;
+        std::vector<Variable> m_outputs;
+        DeviceDescriptor m_device;
+        // Each stream has a parallel sequence (slot) of the minibatch, whose recurrent state it continues from once it has been evaluated.
+        std::unordered_map<size_t, size_t> m_streamSlots;
+        std::vector<size_t> m_slotStreams; // stream id of each slot, SIZE_MAX for a free slot
+        std::vector<bool> m_slotHasState;
+        size_t m_nextStreamId;
+    };
+
+    ///
+    /// Construct a StreamingEvaluator computing the specified outputs of the model, which must have the sequence axis of its arguments.
+    ///
+    CNTK_API StreamingEvaluatorPtr CreateStreamingEvaluator(const FunctionPtr& model, const std::vector<Variable>& outputs,
+                                                            const DeviceDescriptor& computeDevice = DeviceDescriptor::UseDefaultDevice());
+
     enum class DataUnit : unsigned int
     {
         ///Indiciate that the frequency of action is counted by sweep.
@@ -5533,6 +5695,9 @@ namespace CNTK
         friend std::shared_ptr<T1> MakeSharedObject(CtorArgTypes&& ...ctorArgs);
 
         friend class TrainingSession;
+        friend void Internal::SetAsyncCheckpointing(const TrainerPtr& trainer, bool enable, size_t maxPendingCheckpoints);
+        friend void Internal::WaitForPendingCheckpoints(const TrainerPtr& trainer);
+        friend double Internal::CheckpointStallSeconds(const TrainerPtr& trainer);
 
         Trainer(const FunctionPtr& model, const FunctionPtr& lossFunction, const std::vector<LearnerPtr>& parameterLearners,
                 const std::vector<ProgressWriterPtr>& progressWriters = {});
@@ -5573,6 +5738,9 @@ namespace CNTK
         AccumulatorPtr m_aggregatedTrainingEvalCriterionValue;
 
         size_t m_prevDistributedTotalNumSamples;
+
+        // writes SaveCheckpoint() in the background, see Internal::SetAsyncCheckpointing()
+        std::shared_ptr<Microsoft::MSR::CNTK::AsyncCheckpointWriter> m_checkpointWriter;
     };
 
     ///
@@ -5778,6 +5946,13 @@ namespace CNTK
         ///
         size_t randomizationSeed{ 0 };
 
+        ///
+        /// Number of buckets into which the sequences of each randomized chunk are grouped by length, so that
+        /// minibatches contain sequences of similar length and less padding (only applicable with randomization).
+        /// The buckets are visited in random order. 0 (default) disables the grouping.
+        ///
+        size_t numberOfLengthBuckets{ 0 };
+
         ///
         /// Output verbosity level.
         ///
@@ -43,6 +43,8 @@
 namespace Microsoft { namespace MSR { namespace CNTK {
     struct MatrixBase;
 
+    class AsyncCheckpointWriter;
+
     template <typename ElemType>
     class Matrix;
 
@@ -214,6 +216,12 @@ namespace CNTK
     class Evaluator;
     typedef std::shared_ptr<Evaluator> EvaluatorPtr;
 
+    class BeamSearchDecoder;
+    typedef std::shared_ptr<BeamSearchDecoder> BeamSearchDecoderPtr;
+
+    class StreamingEvaluator;
+    typedef std::shared_ptr<StreamingEvaluator> StreamingEvaluatorPtr;
+
     class Trainer;
     typedef std::shared_ptr<Trainer> TrainerPtr;
 
@@ -316,6 +324,15 @@ namespace CNTK
         CNTK_API void DisableProfiler();
         CNTK_API void StopProfiler();
 
+        // Let trainer->SaveCheckpoint() take a snapshot of the model and learner state and write it on a
+        // background thread, with at most maxPendingCheckpoints in flight. The files only exist once written,
+        // so call WaitForPendingCheckpoints() before reading them from outside the trainer. The thread belongs
+        // to the trainer, which finishes the pending writes when it is destroyed.
+        CNTK_API void SetAsyncCheckpointing(const TrainerPtr& trainer, bool enable, size_t maxPendingCheckpoints = 1);
+        CNTK_API void WaitForPendingCheckpoints(const TrainerPtr& trainer);
+        // total time trainer->SaveCheckpoint() was blocked waiting for earlier checkpoints to be written
+        CNTK_API double CheckpointStallSeconds(const TrainerPtr& trainer);
+
         CNTK_API bool AreEquivalent(const ::CNTK::FunctionPtr& f1, const ::CNTK::FunctionPtr& f2);
         CNTK_API bool AreEquivalent(const ::CNTK::Variable& v1, const ::CNTK::Variable& v2, bool allowParameterAndConstantsEquivalence = false);
 
@@ -233,6 +233,13 @@ namespace CNTK
 
                     opType = PrimitiveOpType::RandomSampleInclusionFrequency;
                 }
+                else if (node->OperationName() == OperationNameOf(SampledSoftmaxNode))
+                {
+                    auto sampledSoftmaxNode = node->As<SampledSoftmaxNode<ElementType>>();
+                    primitiveFunctionConfigParameters[PrimitiveFunction::AttributeNameNumSamples] = sampledSoftmaxNode->GetNumSamples();
+
+                    opType = PrimitiveOpType::SampledSoftmax;
+                }
                 else if (node->OperationName() == OperationNameOf(DropoutNode))
                 {
                     auto dropoutNode = node->As<DropoutNode<ElementType>>();
@@ -0,0 +1,348 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Utils.h"
+#include <cmath>
+#include <numeric>
+
+namespace CNTK
+{
+    BeamSearchDecoderPtr CreateBeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoresOutput,
+                                                 const std::vector<std::pair<Variable, Variable>>& stateInputOutputPairs,
+                                                 size_t startToken, size_t endToken, size_t beamWidth, size_t maxLength,
+                                                 size_t nBest, double lengthNormalizationExponent)
+    {
+        return MakeSharedObject<BeamSearchDecoder>(stepFunction, tokenInput, scoresOutput, stateInputOutputPairs,
+                                                   startToken, endToken, beamWidth, maxLength, nBest, lengthNormalizationExponent);
+    }
+
+    static bool HasOnlyBatchAxis(const Variable& var)
+    {
+        return (var.DynamicAxes().size() == 1) && (var.DynamicAxes()[0] == Axis::DefaultBatchAxis());
+    }
+
+    BeamSearchDecoder::BeamSearchDecoder(const FunctionPtr& stepFunction, const Variable& tokenInput, const Variable& scoresOutput,
+                                         const std::vector<std::pair<Variable, Variable>>& stateInputOutputPairs,
+                                         size_t startToken, size_t endToken, size_t beamWidth, size_t maxLength, size_t nBest, double lengthNormalizationExponent)
+        : m_stepFunction(stepFunction),
+          m_tokenInput(tokenInput),
+          m_scoresOutput(scoresOutput),
+          m_startToken(startToken),
+          m_endToken(endToken),
+          m_beamWidth(beamWidth),
+          m_maxLength(maxLength),
+          m_nBest(nBest),
+          m_lengthNormalizationExponent(lengthNormalizationExponent)
+    {
+        if (!m_stepFunction)
+            InvalidArgument("BeamSearchDecoder: The step Function must not be null.");
+
+        if ((m_beamWidth == 0) || (m_maxLength == 0) || (m_nBest == 0))
+            InvalidArgument("BeamSearchDecoder: The beam width, maximum length and number of best hypotheses must be positive.");
+
+        if (m_nBest > m_beamWidth)
+            InvalidArgument("BeamSearchDecoder: The number of best hypotheses (%zu) must not exceed the beam width (%zu).", m_nBest, m_beamWidth);
+
+        if (m_lengthNormalizationExponent < 0)
+            InvalidArgument("BeamSearchDecoder: The length normalization exponent (%f) must not be negative.", m_lengthNormalizationExponent);
+
+        auto arguments = m_stepFunction->Arguments();
+        auto outputs = m_stepFunction->Outputs();
+        auto isArgument = [&arguments](const Variable& var) { return std::find(arguments.begin(), arguments.end(), var) != arguments.end(); };
+        auto isOutput = [&outputs](const Variable& var) { return std::find(outputs.begin(), outputs.end(), var) != outputs.end(); };
+
+        if (!isArgument(m_tokenInput) || !HasOnlyBatchAxis(m_tokenInput) || m_tokenInput.Shape().HasUnboundDimension())
+            InvalidArgument("BeamSearchDecoder: The token input '%S' must be an argument of the step Function '%S' with a known shape and only a batch axis.",
+                            m_tokenInput.AsString().c_str(), m_stepFunction->AsString().c_str());
+
+        auto vocabularySize = m_tokenInput.Shape().TotalSize();
+        if ((m_startToken >= vocabularySize) || (m_endToken >= vocabularySize))
+            InvalidArgument("BeamSearchDecoder: The start token (%zu) and end token (%zu) must be less than the vocabulary size (%zu).", m_startToken, m_endToken, vocabularySize);
+
+        if (!isOutput(m_scoresOutput) || !HasOnlyBatchAxis(m_scoresOutput) || (m_scoresOutput.Shape() != m_tokenInput.Shape()))
+            InvalidArgument("BeamSearchDecoder: The scores output '%S' must be an output of the step Function '%S' with only a batch axis and the shape of the token input.",
+                            m_scoresOutput.AsString().c_str(), m_stepFunction->AsString().c_str());
+
+        if ((m_scoresOutput.GetDataType() != DataType::Float) && (m_scoresOutput.GetDataType() != DataType::Double))
+            InvalidArgument("BeamSearchDecoder: Unsupported DataType %s of the scores output '%S'.", DataTypeName(m_scoresOutput.GetDataType()), m_scoresOutput.AsString().c_str());
+
+        for (const auto& stateInputOutputPair : stateInputOutputPairs)
+        {
+            const auto& stateInput = stateInputOutputPair.first;
+            const auto& stateOutput = stateInputOutputPair.second;
+            if (!isArgument(stateInput) || !isOutput(stateOutput) || (stateInput == m_tokenInput))
+                InvalidArgument("BeamSearchDecoder: The state input '%S' must be an argument, and the state output '%S' an output of the step Function '%S'.",
+                                stateInput.AsString().c_str(), stateOutput.AsString().c_str(), m_stepFunction->AsString().c_str());
+
+            if ((stateInput.Shape() != stateOutput.Shape()) || (stateOutput.GetDataType() != m_scoresOutput.GetDataType()) || !HasOnlyBatchAxis(stateOutput))
+                InvalidArgument("BeamSearchDecoder: The state output '%S' does not match the state input '%S'.", stateOutput.AsString().c_str(), stateInput.AsString().c_str());
+
+            m_carriedInputs.push_back(stateInput);
+            m_stateOutputs.push_back(stateOutput);
+        }
+
+        // The remaining arguments are context inputs.
+        for (const auto& argument : arguments)
+        {
+            if ((argument != m_tokenInput) && (std::find(m_carriedInputs.begin(), m_carriedInputs.end(), argument) == m_carriedInputs.end()))
+                m_carriedInputs.push_back(argument);
+        }
+
+        if (m_carriedInputs.empty())
+            InvalidArgument("BeamSearchDecoder: The step Function '%S' must have at least one state or context input.", m_stepFunction->AsString().c_str());
+
+        for (const auto& input : m_carriedInputs)
+        {
+            if (!HasOnlyBatchAxis(input) || input.Shape().HasUnboundDimension() || (input.GetDataType() != m_scoresOutput.GetDataType()))
+                InvalidArgument("BeamSearchDecoder: The step Function input '%S' must have a known shape, only a batch axis and the DataType of the scores output.",
+                                input.AsString().c_str());
+        }
+    }
+
+    std::vector<std::vector<BeamSearchHypothesis>> BeamSearchDecoder::Decode(const std::unordered_map<Variable, ValuePtr>& initialValues, const DeviceDescriptor& computeDevice)
+    {
+        switch (m_scoresOutput.GetDataType())
+        {
+        case DataType::Float:
+            return DecodeTyped<float>(initialValues, computeDevice);
+        case DataType::Double:
+            return DecodeTyped<double>(initialValues, computeDevice);
+        default:
+            LogicError("BeamSearchDecoder: Unsupported DataType %s.", DataTypeName(m_scoresOutput.GetDataType()));
+        }
+    }
+
+    double BeamSearchDecoder::NormalizedScore(double logProbability, size_t length) const
+    {
+        if (m_lengthNormalizationExponent == 0)
+            return logProbability;
+
+        return logProbability / std::pow((double)length, m_lengthNormalizationExponent);
+    }
+
+    // Returns the data of a Value as a CPU NDArrayView, copying it only if it lives on another device.
+    static NDArrayViewPtr CPUDataOf(const ValuePtr& value)
+    {
+        auto data = value->Data();
+        if (data->Device() != DeviceDescriptor::CPUDevice())
+            data = data->DeepClone(DeviceDescriptor::CPUDevice(), /*readOnly =*/ true);
+
+        return data;
+    }
+
+    template <typename ElementType>
+    std::vector<std::vector<BeamSearchHypothesis>> BeamSearchDecoder::DecodeTyped(const std::unordered_map<Variable, ValuePtr>& initialValues, const DeviceDescriptor& computeDevice)
+    {
+        const auto cpuDevice = DeviceDescriptor::CPUDevice();
+        const size_t numInputs = m_carriedInputs.size();
+        const size_t numStates = m_stateOutputs.size();
+        const size_t vocabularySize = m_tokenInput.Shape().TotalSize();
+
+        // The carried inputs of all hypotheses are kept in CPU buffers sized for a full beam of every input sequence,
+        // which are allocated once and reused at every step. 'current' holds the inputs of the step, and 'next' receives
+        // the inputs of the selected hypotheses for the following one.
+        size_t numSequences = 0;
+        std::vector<size_t> sampleSizes(numInputs);
+        std::vector<std::vector<ElementType>> current(numInputs);
+        std::vector<std::vector<ElementType>> next(numInputs);
+        for (size_t i = 0; i < numInputs; i++)
+        {
+            const auto& input = m_carriedInputs[i];
+            auto initialValue = initialValues.find(input);
+            if ((initialValue == initialValues.end()) || !initialValue->second)
+                InvalidArgument("BeamSearchDecoder::Decode: No initial value is specified for the step Function input '%S'.", input.AsString().c_str());
+
+            std::vector<std::vector<ElementType>> samples;
+            initialValue->second->CopyVariableValueTo(input, samples);
+            if (i == 0)
+                numSequences = samples.size();
+            else if (samples.size() != numSequences)
+                InvalidArgument("BeamSearchDecoder::Decode: The initial value of '%S' has %zu samples, but %zu were specified for '%S'.",
+                                input.AsString().c_str(), samples.size(), numSequences, m_carriedInputs[0].AsString().c_str());
+
+            sampleSizes[i] = input.Shape().TotalSize();
+            current[i].resize(numSequences * m_beamWidth * sampleSizes[i]);
+            next[i].resize(current[i].size());
+            for (size_t s = 0; s < numSequences; s++)
+            {
+                if (samples[s].size() != sampleSizes[i])
+                    InvalidArgument("BeamSearchDecoder::Decode: The initial value of '%S' must have a single sample per input sequence.", input.AsString().c_str());
+
+                std::copy(samples[s].begin(), samples[s].end(), current[i].begin() + s * sampleSizes[i]);
+            }
+        }
+
+        struct Hypothesis
+        {
+            size_t sequence;
+            std::vector<size_t> tokens;
+            double logProbability;
+        };
+
+        struct Candidate
+        {
+            double logProbability;
+            size_t hypothesis;
+            size_t token;
+        };
+
+        std::vector<Hypothesis> active;
+        std::vector<Hypothesis> nextActive;
+        for (size_t s = 0; s < numSequences; s++)
+            active.push_back({ s, {}, 0.0 });
+
+        std::vector<std::vector<BeamSearchHypothesis>> finished(numSequences);
+        std::vector<std::vector<Candidate>> candidates(numSequences);
+        std::vector<size_t> parents;
+        std::vector<size_t> tokens;
+        std::vector<ElementType> oneHot;
+        std::vector<size_t> order(vocabularySize);
+        std::unordered_map<Variable, ValuePtr> arguments;
+        std::unordered_map<Variable, ValuePtr> outputs;
+
+        // Each hypothesis proposes twice the beam width of tokens, so that the beam can still be filled if some of them end the sequence.
+        const size_t numProposals = std::min(2 * m_beamWidth, vocabularySize);
+
+        for (size_t length = 1; !active.empty(); length++)
+        {
+            // Run the step Function on all active hypotheses as one batch.
+            const size_t numHypotheses = active.size();
+            tokens.resize(numHypotheses);
+            for (size_t h = 0; h < numHypotheses; h++)
+                tokens[h] = active[h].tokens.empty() ? m_startToken : active[h].tokens.back();
+
+            if (m_tokenInput.IsSparse())
+                arguments[m_tokenInput] = Value::CreateBatch<ElementType>(vocabularySize, tokens, computeDevice, /*readOnly =*/ true);
+            else
+            {
+                oneHot.assign(numHypotheses * vocabularySize, 0);
+                for (size_t h = 0; h < numHypotheses; h++)
+                    oneHot[h * vocabularySize + tokens[h]] = 1;
+                arguments[m_tokenInput] = Value::CreateBatch<ElementType>(m_tokenInput.Shape(), oneHot, computeDevice, /*readOnly =*/ true);
+            }
+            for (size_t i = 0; i < numInputs; i++)
+            {
+                const auto& input = m_carriedInputs[i];
+                auto data = MakeSharedObject<NDArrayView>(AsDataType<ElementType>(), input.Shape().AppendShape({ numHypotheses }),
+                                                          current[i].data(), numHypotheses * sampleSizes[i] * sizeof(ElementType), cpuDevice, /*readOnly =*/ true);
+                if (computeDevice != cpuDevice)
+                    data = data->DeepClone(computeDevice, /*readOnly =*/ true);
+
+                arguments[input] = MakeSharedObject<Value>(data);
+            }
+
+            outputs[m_scoresOutput] = nullptr;
+            for (const auto& stateOutput : m_stateOutputs)
+                outputs[stateOutput] = nullptr;
+
+            m_stepFunction->Evaluate(arguments, outputs, computeDevice);
+
+            auto scoresData = CPUDataOf(outputs[m_scoresOutput]);
+            std::vector<NDArrayViewPtr> stateData(numStates);
+            for (size_t i = 0; i < numStates; i++)
+                stateData[i] = CPUDataOf(outputs[m_stateOutputs[i]]);
+
+            // Propose the best tokens of each hypothesis. The scores are normalized with a log-softmax, which leaves
+            // log-probabilities unchanged, so that the step Function may output either.
+            for (auto& sequenceCandidates : candidates)
+                sequenceCandidates.clear();
+
+            const ElementType* allScores = scoresData->DataBuffer<ElementType>();
+            for (size_t h = 0; h < numHypotheses; h++)
+            {
+                const ElementType* scores = allScores + h * vocabularySize;
+                double maxScore = *std::max_element(scores, scores + vocabularySize);
+                double sum = 0;
+                for (size_t v = 0; v < vocabularySize; v++)
+                    sum += std::exp(scores[v] - maxScore);
+                double logNormalizer = maxScore + std::log(sum);
+
+                std::iota(order.begin(), order.end(), 0);
+                std::partial_sort(order.begin(), order.begin() + numProposals, order.end(), [scores](size_t a, size_t b)
+                {
+                    return (scores[a] > scores[b]) || ((scores[a] == scores[b]) && (a < b));
+                });
+
+                for (size_t k = 0; k < numProposals; k++)
+                    candidates[active[h].sequence].push_back({ active[h].logProbability + scores[order[k]] - logNormalizer, h, order[k] });
+            }
+
+            // Select the beam of each input sequence from the proposals, best first. Proposals ending the sequence (or
+            // reaching the maximum length) ahead of the last selected hypothesis are finished.
+            nextActive.clear();
+            parents.clear();
+            for (size_t s = 0; s < numSequences; s++)
+            {
+                auto& sequenceCandidates = candidates[s];
+                if (sequenceCandidates.empty())
+                    continue;
+
+                std::sort(sequenceCandidates.begin(), sequenceCandidates.end(), [](const Candidate& a, const Candidate& b)
+                {
+                    if (a.logProbability != b.logProbability)
+                        return a.logProbability > b.logProbability;
+                    return (a.hypothesis < b.hypothesis) || ((a.hypothesis == b.hypothesis) && (a.token < b.token));
+                });
+
+                auto& sequenceFinished = finished[s];
+                const size_t firstActive = nextActive.size();
+                size_t numSelected = 0;
+                for (const auto& candidate : sequenceCandidates)
+                {
+                    if (numSelected == m_beamWidth)
+                        break;
+
+                    const auto& parent = active[candidate.hypothesis];
+                    if ((candidate.token == m_endToken) || (length == m_maxLength))
+                    {
+                        sequenceFinished.push_back({ parent.tokens, candidate.logProbability, NormalizedScore(candidate.logProbability, length) });
+                        sequenceFinished.back().tokens.push_back(candidate.token);
+                        if (candidate.token != m_endToken)
+                            numSelected++;
+                    }
+                    else
+                    {
+                        nextActive.push_back({ s, parent.tokens, candidate.logProbability });
+                        nextActive.back().tokens.push_back(candidate.token);
+                        parents.push_back(candidate.hypothesis);
+                        numSelected++;
+                    }
+                }
+
+                // Keep the N best finished hypotheses. Log-probabilities only decrease as tokens are added, so the best
+                // score the active hypotheses can still reach is that of the best one at the maximum length.
+                std::stable_sort(sequenceFinished.begin(), sequenceFinished.end(), [](const BeamSearchHypothesis& a, const BeamSearchHypothesis& b)
+                {
+                    return a.score > b.score;
+                });
+                if (sequenceFinished.size() > m_nBest)
+                    sequenceFinished.resize(m_nBest);
+
+                if ((nextActive.size() > firstActive) && (sequenceFinished.size() == m_nBest) &&
+                    (sequenceFinished.back().score >= NormalizedScore(nextActive[firstActive].logProbability, m_maxLength)))
+                {
+                    nextActive.resize(firstActive);
+                    parents.resize(firstActive);
+                }
+            }
+
+            // Reorder the carried inputs for the selected hypotheses: states from the step outputs, context inputs from their current value.
+            for (size_t i = 0; i < numInputs; i++)
+            {
+                const ElementType* source = (i < numStates) ? stateData[i]->DataBuffer<ElementType>() : current[i].data();
+                for (size_t h = 0; h < parents.size(); h++)
+                    std::copy_n(source + parents[h] * sampleSizes[i], sampleSizes[i], next[i].begin() + h * sampleSizes[i]);
+
+                std::swap(current[i], next[i]);
+            }
+
+            std::swap(active, nextActive);
+        }
+
+        return finished;
+    }
+}
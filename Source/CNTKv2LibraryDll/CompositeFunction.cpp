@@ -893,6 +893,12 @@ namespace CNTK
                     ASSIGN_NEW_NODE(RandomSampleInclusionFrequencyNode, network->GetDeviceId(), internalNodeName, numSamples, allowDuplicates);
                     break;
                 }
+                case PrimitiveOpType::SampledSoftmax:
+                {
+                    auto numSamples = functionConfig[PrimitiveFunction::AttributeNameNumSamples].Value<size_t>();
+                    ASSIGN_NEW_NODE(SampledSoftmaxNode, network->GetDeviceId(), internalNodeName, numSamples);
+                    break;
+                }
                 case PrimitiveOpType::Dropout:
                 {
                     auto dropoutRate = functionConfig[PrimitiveFunction::AttributeNameDropoutRate].Value<double>();
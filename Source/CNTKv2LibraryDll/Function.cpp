@@ -2153,6 +2153,30 @@ namespace CNTK
         return AsComposite(MakeSharedObject<PrimitiveFunction>(PrimitiveOpType::LatticeSequenceWithSoftmax, operands, std::move(additionalProperties), name), name);
     }
 
+    static FunctionPtr SampledSoftmax(std::vector<Variable>&& operands, size_t numSamples, unsigned long seed, const std::wstring& name)
+    {
+        auto additionalProperties = Dictionary();
+        additionalProperties[PrimitiveFunction::AttributeNameNumSamples] = numSamples;
+
+        if (seed == SentinelValueForAutoSelectRandomSeed)
+            seed = Internal::GenerateRandomSeed(true);
+
+        additionalProperties[PrimitiveFunction::AttributeNameRngSeed] = size_t(seed);
+        additionalProperties[PrimitiveFunction::AttributeNameRngOffset] = size_t(0);
+
+        return AsComposite(MakeSharedObject<PrimitiveFunction>(PrimitiveOpType::SampledSoftmax, operands, std::move(additionalProperties), name), name);
+    }
+
+    FunctionPtr SampledSoftmax(const Variable& labels, const Variable& input, const Variable& weights, const Variable& bias, size_t numSamples, unsigned long seed, const std::wstring& name)
+    {
+        return SampledSoftmax(std::vector<Variable>{ labels, input, weights, bias }, numSamples, seed, name);
+    }
+
+    FunctionPtr SampledSoftmax(const Variable& labels, const Variable& input, const Variable& weights, const Variable& bias, const Variable& samplingWeights, size_t numSamples, unsigned long seed, const std::wstring& name)
+    {
+        return SampledSoftmax(std::vector<Variable>{ labels, input, weights, bias, samplingWeights }, numSamples, seed, name);
+    }
+
     FunctionPtr ForwardBackward(const Variable& graph, const Variable& features, size_t blankTokenId, int delayConstraint, const std::wstring& name)
     {
         auto additionalProperties = Dictionary();
@@ -565,6 +565,9 @@ namespace CNTK
                 augmentedConfiguration[L"randomize"] = false;
             }
 
+            if (configuration.numberOfLengthBuckets != 0)
+                augmentedConfiguration[L"lengthBuckets"] = configuration.numberOfLengthBuckets;
+
             if (configuration.truncationLength != 0)
             {
                 augmentedConfiguration[L"truncated"] = true;
@@ -128,6 +128,7 @@ namespace CNTK
             (op == PrimitiveOpType::SquaredError) ||
             (op == PrimitiveOpType::CrossEntropyWithSoftmax) ||
             (op == PrimitiveOpType::LatticeSequenceWithSoftmax) ||
+            (op == PrimitiveOpType::SampledSoftmax) ||
             (op == PrimitiveOpType::EditDistanceError) ||
             (op == PrimitiveOpType::ClassificationError) ||
             (op == PrimitiveOpType::ForwardBackward) ||
@@ -960,6 +961,16 @@ namespace CNTK
                             outputShape = SpliceOutputShape(m_inputs, spliceAxis.StaticAxisIndex());
                             break;
                         }
+                        case PrimitiveOpType::SampledSoftmax:
+                        {
+                            assert((m_inputs.size() == 4) || (m_inputs.size() == 5));
+                            auto numSamples = m_attributes[PrimitiveFunction::AttributeNameNumSamples].Value<size_t>();
+                            if (numSamples == 0)
+                                InvalidArgument("SampledSoftmax: Number of requested samples must be > 0.");
+
+                            outputShape = {};
+                            break;
+                        }
                         case PrimitiveOpType::RandomSample:
                         case PrimitiveOpType::RandomSampleInclusionFrequency:
                         {
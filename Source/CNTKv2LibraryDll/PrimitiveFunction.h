@@ -117,6 +117,7 @@ namespace CNTK
         {PrimitiveOpType::ConstantOp, L"ConstantOp"},
         {PrimitiveOpType::Squeeze, L"Squeeze"},
         {PrimitiveOpType::Cast, L"Cast" },
+        {PrimitiveOpType::SampledSoftmax, L"SampledSoftmax"},
     };
 
     inline const std::wstring& PrimitiveOpTypeName(PrimitiveOpType opType)
@@ -357,6 +358,7 @@ namespace CNTK
             return (OpType() == PrimitiveOpType::Dropout) ||
                    (OpType() == PrimitiveOpType::RandomSample) ||
                    (OpType() == PrimitiveOpType::RandomSampleInclusionFrequency) ||
+                   (OpType() == PrimitiveOpType::SampledSoftmax) ||
                    (OpType() == PrimitiveOpType::RandomDistribution);
         }
 
@@ -826,7 +828,8 @@ namespace CNTK
         // Version 18: Add Crop node.
         // Version 19: Add TopK
         // Version 20: Add squeeze, expand dims, zeros like, ones like
-        static const size_t s_serializationVersion = 20;
+        // Version 21: Add SampledSoftmax
+        static const size_t s_serializationVersion = 21;
     };
 
     std::vector<DictionaryValue> GetInputUids(const Function& f);
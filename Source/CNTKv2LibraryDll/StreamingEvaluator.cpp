@@ -0,0 +1,276 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "CompositeFunction.h"
+#include "RecurrentNodes.h"
+#include "Utils.h"
+#include "Value.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace CNTK
+{
+    StreamingEvaluatorPtr CreateStreamingEvaluator(const FunctionPtr& model, const std::vector<Variable>& outputs, const DeviceDescriptor& computeDevice)
+    {
+        return MakeSharedObject<StreamingEvaluator>(model, outputs, computeDevice);
+    }
+
+    StreamingEvaluator::StreamingEvaluator(const FunctionPtr& model, const std::vector<Variable>& outputs, const DeviceDescriptor& computeDevice)
+        : m_outputs(outputs), m_device(computeDevice), m_nextStreamId(0)
+    {
+        if (!model)
+            InvalidArgument("StreamingEvaluator: The model Function must not be null.");
+
+        if (m_outputs.empty())
+            InvalidArgument("StreamingEvaluator: At least one output must be specified.");
+
+        m_model = model->IsComposite() ? model : AsComposite(model);
+
+        m_model->PreorderTraverse([this](const FunctionPtr& function) {
+            if (function->OpName() == L"FutureValue")
+                InvalidArgument("StreamingEvaluator: The model Function '%S' contains FutureValue '%S', which cannot be evaluated incrementally.",
+                                m_model->AsString().c_str(), function->AsString().c_str());
+        }, /*traverseInsideBlockFunction =*/ true);
+
+        // All arguments and outputs share the sequence axis, so that a single minibatch layout holds all streams.
+        m_arguments = m_model->Arguments();
+        if (m_arguments.empty())
+            InvalidArgument("StreamingEvaluator: The model Function '%S' has no arguments.", m_model->AsString().c_str());
+
+        auto dynamicAxes = m_arguments.front().DynamicAxes();
+        if ((dynamicAxes.size() != 2) || !dynamicAxes[0].IsSequenceAxis() || (dynamicAxes[1] != Axis::DefaultBatchAxis()))
+            InvalidArgument("StreamingEvaluator: The argument '%S' must have a sequence axis and the batch axis.", m_arguments.front().AsString().c_str());
+
+        auto dataType = m_arguments.front().GetDataType();
+        if ((dataType != DataType::Float) && (dataType != DataType::Double))
+            InvalidArgument("StreamingEvaluator: Unsupported DataType %s of the model Function '%S'.", DataTypeName(dataType), m_model->AsString().c_str());
+
+        for (const auto& argument : m_arguments)
+        {
+            if ((argument.DynamicAxes() != dynamicAxes) || (argument.GetDataType() != dataType) || argument.IsSparse() || argument.Shape().HasUnboundDimension())
+                InvalidArgument("StreamingEvaluator: The argument '%S' must be dense, with a known shape and the dynamic axes and DataType of the argument '%S'.",
+                                argument.AsString().c_str(), m_arguments.front().AsString().c_str());
+        }
+
+        auto modelOutputs = m_model->Outputs();
+        for (const auto& output : m_outputs)
+        {
+            if (std::find(modelOutputs.begin(), modelOutputs.end(), output) == modelOutputs.end())
+                InvalidArgument("StreamingEvaluator: '%S' is not an output of the model Function '%S'.", output.AsString().c_str(), m_model->AsString().c_str());
+
+            if ((output.DynamicAxes() != dynamicAxes) || (output.GetDataType() != dataType) || output.Shape().HasUnboundDimension())
+                InvalidArgument("StreamingEvaluator: The output '%S' must have a known shape and the dynamic axes and DataType of the argument '%S'.",
+                                output.AsString().c_str(), m_arguments.front().AsString().c_str());
+        }
+    }
+
+    size_t StreamingEvaluator::AddStream()
+    {
+        auto freeSlot = std::find(m_slotStreams.begin(), m_slotStreams.end(), SIZE_MAX);
+        size_t slot = freeSlot - m_slotStreams.begin();
+        if (freeSlot == m_slotStreams.end())
+        {
+            m_slotStreams.push_back(SIZE_MAX);
+            m_slotHasState.push_back(false);
+        }
+
+        size_t streamId = m_nextStreamId++;
+        m_slotStreams[slot] = streamId;
+        m_slotHasState[slot] = false;
+        m_streamSlots[streamId] = slot;
+        return streamId;
+    }
+
+    void StreamingEvaluator::RemoveStream(size_t streamId)
+    {
+        size_t slot = SlotOf(streamId);
+        m_streamSlots.erase(streamId);
+        m_slotStreams[slot] = SIZE_MAX;
+        m_slotHasState[slot] = false;
+
+        // Free slots at the end are dropped so that they do not take space in the minibatch.
+        while (!m_slotStreams.empty() && (m_slotStreams.back() == SIZE_MAX))
+        {
+            m_slotStreams.pop_back();
+            m_slotHasState.pop_back();
+        }
+    }
+
+    void StreamingEvaluator::ResetStream(size_t streamId)
+    {
+        m_slotHasState[SlotOf(streamId)] = false;
+    }
+
+    size_t StreamingEvaluator::SlotOf(size_t streamId) const
+    {
+        auto streamSlot = m_streamSlots.find(streamId);
+        if (streamSlot == m_streamSlots.end())
+            InvalidArgument("StreamingEvaluator: Unknown stream id %zu.", streamId);
+
+        return streamSlot->second;
+    }
+
+    void StreamingEvaluator::Evaluate(const std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& inputs,
+                                      std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& outputs)
+    {
+        switch (m_arguments.front().GetDataType())
+        {
+        case DataType::Float:
+            EvaluateTyped<float>(inputs, outputs);
+            break;
+        case DataType::Double:
+            EvaluateTyped<double>(inputs, outputs);
+            break;
+        default:
+            LogicError("StreamingEvaluator: Unsupported DataType %s.", DataTypeName(m_arguments.front().GetDataType()));
+        }
+    }
+
+    template <typename ElementType>
+    void StreamingEvaluator::EvaluateTyped(const std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& inputs,
+                                           std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>>& outputs)
+    {
+        outputs.clear();
+        const size_t numSlots = m_slotStreams.size();
+        const size_t numArguments = m_arguments.size();
+
+        // Collect the chunk of each stream. The chunk of slot s is the sequence of parallel sequence s in the minibatch,
+        // followed by a gap up to the length of the longest chunk.
+        std::vector<std::vector<std::vector<ElementType>>> chunks(numSlots, std::vector<std::vector<ElementType>>(numArguments));
+        std::vector<size_t> chunkLengths(numSlots, 0);
+        size_t numTimeSteps = 0;
+        for (const auto& streamInputs : inputs)
+        {
+            size_t slot = SlotOf(streamInputs.first);
+            for (size_t i = 0; i < numArguments; i++)
+            {
+                const auto& argument = m_arguments[i];
+                auto input = streamInputs.second.find(argument);
+                if ((input == streamInputs.second.end()) || !input->second)
+                    InvalidArgument("StreamingEvaluator: No Value specified for the argument '%S' of stream %zu.", argument.AsString().c_str(), streamInputs.first);
+
+                std::vector<std::vector<ElementType>> sequences;
+                input->second->CopyVariableValueTo(argument, sequences);
+                if (sequences.size() != 1)
+                    InvalidArgument("StreamingEvaluator: The Value for the argument '%S' of stream %zu must hold a single sequence, not %zu.",
+                                    argument.AsString().c_str(), streamInputs.first, sequences.size());
+
+                size_t length = sequences[0].size() / argument.Shape().TotalSize();
+                if ((i > 0) && (length != chunkLengths[slot]))
+                    InvalidArgument("StreamingEvaluator: The Values for the arguments of stream %zu must have the same number of samples.", streamInputs.first);
+
+                chunkLengths[slot] = length;
+                chunks[slot][i] = std::move(sequences[0]);
+            }
+            numTimeSteps = std::max(numTimeSteps, chunkLengths[slot]);
+        }
+
+        if (numTimeSteps == 0)
+            return;
+
+        // Continuing streams begin before the minibatch; the PastValue nodes patch in their actual begin from the saved state.
+        auto layout = std::make_shared<MBLayout>();
+        layout->Init(numSlots, numTimeSteps);
+        for (size_t s = 0; s < numSlots; s++)
+        {
+            size_t length = chunkLengths[s];
+            if (length > 0)
+                layout->AddSequence(m_slotStreams[s], s, m_slotHasState[s] ? SentinelValueIndicatingUnspecifedSequenceBeginIdx : 0, length);
+            if (length < numTimeSteps)
+                layout->AddGap(s, length, numTimeSteps);
+        }
+
+        std::unordered_map<Variable, ValuePtr> arguments;
+        for (size_t i = 0; i < numArguments; i++)
+        {
+            const auto& argument = m_arguments[i];
+            const size_t sampleSize = argument.Shape().TotalSize();
+            std::vector<ElementType> packedData(sampleSize * numSlots * numTimeSteps, 0);
+            for (size_t s = 0; s < numSlots; s++)
+            {
+                for (size_t t = 0; t < chunkLengths[s]; t++)
+                    std::copy_n(chunks[s][i].begin() + t * sampleSize, sampleSize, packedData.begin() + (t * numSlots + s) * sampleSize);
+            }
+
+            auto matrix = std::make_shared<Matrix<ElementType>>(sampleSize, numSlots * numTimeSteps, packedData.data(), AsCNTKImplDeviceId(m_device));
+            arguments[argument] = MakeSharedObject<PackedValue>(argument.Shape(), argument.DynamicAxes(), matrix, layout, /*readOnly =*/ true);
+        }
+
+        // The PastValue nodes the outputs depend on carry the state of the streams from one minibatch to the next.
+        // The network is only built by the first evaluation, in which all streams are new.
+        auto compositeFunction = dynamic_cast<CompositeFunction*>(m_model.get());
+        auto pastValueNodes = [this, compositeFunction]() {
+            std::set<std::shared_ptr<DelayedValueNodeBase<ElementType, -1>>> nodes;
+            if (compositeFunction->m_computationNetwork)
+            {
+                for (const auto& output : m_outputs)
+                {
+                    auto outputNode = compositeFunction->m_variableToNodeMap.at(output);
+                    for (const auto& node : compositeFunction->m_computationNetwork->GetNodesWithType<PastValueNode<ElementType>>(outputNode))
+                        nodes.insert(std::dynamic_pointer_cast<DelayedValueNodeBase<ElementType, -1>>(node));
+                }
+            }
+            return nodes;
+        };
+
+        for (const auto& node : pastValueNodes())
+            node->BeginStreamingMinibatch(m_slotHasState);
+
+        std::unordered_map<Variable, ValuePtr> outputValues;
+        for (const auto& output : m_outputs)
+            outputValues[output] = nullptr;
+
+        m_model->Evaluate(arguments, outputValues, m_device);
+
+        std::vector<size_t> lastFrames(numSlots, SIZE_MAX);
+        for (size_t s = 0; s < numSlots; s++)
+        {
+            if (chunkLengths[s] > 0)
+                lastFrames[s] = chunkLengths[s] - 1;
+        }
+
+        for (const auto& node : pastValueNodes())
+            node->EndStreamingMinibatch(lastFrames);
+
+        // Unpack the outputs of each stream from its parallel sequence.
+        std::vector<ElementType> outputData;
+        for (const auto& output : m_outputs)
+        {
+            auto packedValue = std::dynamic_pointer_cast<PackedValue>(outputValues[output]);
+            if (!packedValue || !packedValue->IsPacked())
+                LogicError("StreamingEvaluator: The Value of the output '%S' is not packed.", output.AsString().c_str());
+
+            auto packedMatrixAndLayout = packedValue->PackedData<ElementType>();
+            const auto& outputLayout = packedMatrixAndLayout.second;
+            if (!outputLayout || (outputLayout->GetNumParallelSequences() != numSlots) || (outputLayout->GetNumTimeSteps() != numTimeSteps))
+                InvalidArgument("StreamingEvaluator: The output '%S' must have one sample per sample of the arguments.", output.AsString().c_str());
+
+            const size_t sampleSize = output.Shape().TotalSize();
+            outputData.resize(sampleSize * numSlots * numTimeSteps);
+            packedMatrixAndLayout.first->CopySection(sampleSize, numSlots * numTimeSteps, outputData.data(), sampleSize);
+
+            for (const auto& streamInputs : inputs)
+            {
+                size_t s = SlotOf(streamInputs.first);
+                if (chunkLengths[s] == 0)
+                    continue;
+
+                std::vector<ElementType> sequenceData(sampleSize * chunkLengths[s]);
+                for (size_t t = 0; t < chunkLengths[s]; t++)
+                    std::copy_n(outputData.begin() + (t * numSlots + s) * sampleSize, sampleSize, sequenceData.begin() + t * sampleSize);
+
+                outputs[streamInputs.first][output] = Value::CreateSequence<ElementType>(output.Shape(), sequenceData, /*sequenceStartFlag =*/ !m_slotHasState[s], m_device, /*readOnly =*/ true);
+            }
+        }
+
+        for (size_t s = 0; s < numSlots; s++)
+        {
+            if (chunkLengths[s] > 0)
+                m_slotHasState[s] = true;
+        }
+    }
+}
@@ -10,6 +10,7 @@
 #include "PerformanceProfiler.h"
 #include "CompositeFunction.h"
 #include "Serialization.h"
+#include "AsyncCheckpointWriter.h"
 
 namespace
 {
@@ -27,6 +28,27 @@ namespace
 
 namespace CNTK
 {
+    namespace Internal
+    {
+        void SetAsyncCheckpointing(const TrainerPtr& trainer, bool enable, size_t maxPendingCheckpoints)
+        {
+            if (trainer->m_checkpointWriter)
+                trainer->m_checkpointWriter->Wait();
+            trainer->m_checkpointWriter = enable ? std::make_shared<Microsoft::MSR::CNTK::AsyncCheckpointWriter>(maxPendingCheckpoints) : nullptr;
+        }
+
+        void WaitForPendingCheckpoints(const TrainerPtr& trainer)
+        {
+            if (trainer->m_checkpointWriter)
+                trainer->m_checkpointWriter->Wait();
+        }
+
+        double CheckpointStallSeconds(const TrainerPtr& trainer)
+        {
+            return trainer->m_checkpointWriter ? trainer->m_checkpointWriter->StallSeconds() : 0;
+        }
+    }
+
     Trainer::Trainer(const FunctionPtr& model, const FunctionPtr& lossFunction,
                      const std::vector<LearnerPtr>& parameterLearners,
                      const std::vector<ProgressWriterPtr>& progressWriters)
@@ -432,10 +454,30 @@ namespace CNTK
         state[externalStatePropertyName] = externalState;
         state[distributedStatePropertyName] = distributedState;
 
-        m_combinedTrainingFunction->Save(tempModelFile);
         std::wstring trainerStateCheckpointFilePath = GetTrainerStateCheckpointFilePath(modelFilePath);
         std::wstring tempCheckpointFile = trainerStateCheckpointFilePath + L".tmp";
 
+        if (m_checkpointWriter)
+        {
+            // Serialize() copies the parameter values into CPU memory, as does the learners' checkpoint,
+            // so training can go on while the snapshot is written.
+            auto model = std::make_shared<Dictionary>(m_combinedTrainingFunction->Serialize());
+            auto trainerState = std::make_shared<Dictionary>(state);
+            m_checkpointWriter->Enqueue([=]()
+            {
+                {
+                    auto stream = GetFstream(tempModelFile, false);
+                    *stream << *model;
+                    stream->flush();
+                }
+                trainerState->Save(tempCheckpointFile);
+                Microsoft::MSR::CNTK::AsyncCheckpointWriter::CommitFile(tempModelFile, modelFilePath);
+                Microsoft::MSR::CNTK::AsyncCheckpointWriter::CommitFile(tempCheckpointFile, trainerStateCheckpointFilePath);
+            });
+            return;
+        }
+
+        m_combinedTrainingFunction->Save(tempModelFile);
         state.Save(tempCheckpointFile);
 
         // The return value is ignored here.
@@ -448,6 +490,14 @@ namespace CNTK
 
     Dictionary Trainer::RestoreFromCheckpoint(const std::wstring& modelFilePath)
     {
+        // checkpoints written in the background (by the main worker) must be on disk before anybody reads them
+        if (m_checkpointWriter)
+        {
+            m_checkpointWriter->Wait();
+            if (m_distributed)
+                MPICommunicator()->Barrier();
+        }
+
         // Restore the model's parameters
         m_combinedTrainingFunction->Restore(modelFilePath);
 
@@ -259,6 +259,9 @@ namespace CNTK
             !fexists(m_checkpoint.m_fileName))
             SaveFinalCheckpoint();
 
+        // checkpoints written in the background are complete when training returns
+        Internal::WaitForPendingCheckpoints(m_trainer);
+
         // Perform testing according to the test config.
         Test(computeDevice);
     }
@@ -237,6 +237,17 @@ size_t DataReader::GetCurrentSamplePosition()
     return m_dataReaders[m_ioNames.back()]->GetCurrentSamplePosition();
 }
 
+// An input matrix may still refer to the buffer of a reader that hands over its data without a copy
+// ('zeroCopyInputs' of ReaderShim). Such a matrix cannot be resized, so it gets its own (empty) storage
+// before any reader fills it.
+template <class ElemType>
+static void ReleaseReaderBuffer(const MatrixBasePtr& matrix)
+{
+    auto m = dynamic_pointer_cast<Matrix<ElemType>>(matrix);
+    if (m && !m->OwnBuffer())
+        *m = Matrix<ElemType>(0, 0, m->GetDeviceId(), m->GetMatrixType(), m->GetFormat());
+}
+
 // GetMinibatch - Get the next minibatch (features and labels)
 // matrices - [in] a map with named matrix types (i.e. 'features', 'labels') mapped to the corresponding matrix,
 //             [out] each matrix resized if necessary containing data.
@@ -252,6 +263,13 @@ bool DataReader::GetMinibatch(StreamMinibatchInputs& matrices)
     Then this returned number is compared against the specified number. If these two numbers are not consistent, return with logic error.
     The logic error can be avoided usually with an exchange of reading orders.
     */
+    for (const auto& input : matrices)
+    {
+        ReleaseReaderBuffer<float>(input.second.matrix);
+        ReleaseReaderBuffer<double>(input.second.matrix);
+        ReleaseReaderBuffer<half>(input.second.matrix);
+    }
+
     bool bRet = true;
     //vector<size_t> vNbrSentences;
     size_t nbr = 0;
@@ -15,4 +15,6 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 
     std::atomic<bool> Globals::m_enableShareNodeValueMatrices(true);
     std::atomic<bool> Globals::m_optimizeGradientAccumulation(true);
+    std::atomic<bool> Globals::m_stackRecurrentTimes(false);
+    std::atomic<bool> Globals::m_concurrentLoops(false);
 }}}
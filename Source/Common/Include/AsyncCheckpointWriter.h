@@ -0,0 +1,158 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "fileutil.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// AsyncCheckpointWriter -- writes checkpoints on a background thread
+//
+// The trainer snapshots its state (e.g. into CPU memory or a temporary file) and hands the rest
+// of the work -- serialization, fsync, rename, removal of old checkpoints -- to Enqueue(). Jobs
+// run one at a time in the order they were queued. At most maxPending jobs are outstanding;
+// beyond that, Enqueue() blocks, which bounds the memory held by snapshots. The time the caller
+// spends blocked is reported as StallSeconds().
+// Errors of a job are rethrown by the next Enqueue() or Wait().
+// -----------------------------------------------------------------------
+
+class AsyncCheckpointWriter
+{
+public:
+    explicit AsyncCheckpointWriter(size_t maxPending = 1)
+        : m_maxPending(std::max(maxPending, (size_t)1)), m_numPending(0), m_stopping(false), m_stallSeconds(0)
+    {
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    // finishes pending writes; errors are swallowed here, call Wait() to see them
+    ~AsyncCheckpointWriter()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_jobQueued.notify_all();
+        m_thread.join();
+    }
+
+    void Enqueue(std::function<void()> job)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobDone.wait(lock, [this] { return m_numPending < m_maxPending || m_error; });
+        m_stallSeconds += SecondsSince(begin);
+        RethrowError();
+
+        m_jobs.push_back(std::move(job));
+        m_numPending++;
+        m_jobQueued.notify_one();
+    }
+
+    // blocks until all queued jobs are done, e.g. before reading a checkpoint back
+    void Wait()
+    {
+        auto begin = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobDone.wait(lock, [this] { return m_numPending == 0; });
+        m_stallSeconds += SecondsSince(begin);
+        RethrowError();
+    }
+
+    // total time callers were blocked by Enqueue() and Wait()
+    double StallSeconds() const
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_stallSeconds;
+    }
+
+    // Makes a file written to tmpFileName durable under fileName: sync its data, rename it,
+    // and sync the directory entry, so that neither a crash nor a power loss leaves a truncated checkpoint.
+    static void CommitFile(const std::wstring& tmpFileName, const std::wstring& fileName)
+    {
+        fsyncOrDie(tmpFileName);
+        renameOrDie(tmpFileName, fileName);
+#ifndef _WIN32
+        auto slash = fileName.find_last_of(L'/');
+        fsyncOrDie(slash == std::wstring::npos ? std::wstring(L".") : slash == 0 ? std::wstring(L"/") : fileName.substr(0, slash));
+#endif
+    }
+
+private:
+    void Run()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobQueued.wait(lock, [this] { return !m_jobs.empty() || m_stopping; });
+                if (m_jobs.empty())
+                    return;
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                job();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (error && !m_error)
+                    m_error = error;
+                m_numPending--;
+            }
+            m_jobDone.notify_all();
+        }
+    }
+
+    // call with m_mutex held
+    void RethrowError()
+    {
+        if (m_error)
+        {
+            auto error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    static double SecondsSince(std::chrono::steady_clock::time_point begin)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    const size_t m_maxPending;
+    size_t m_numPending; // queued or running
+    bool m_stopping;
+    double m_stallSeconds;
+    std::exception_ptr m_error;
+    std::deque<std::function<void()>> m_jobs;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobQueued;
+    std::condition_variable m_jobDone;
+    std::thread m_thread;
+};
+
+}}}
@@ -22,6 +22,12 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         static void SetGradientAccumulationOptimization(bool enable) { m_optimizeGradientAccumulation = enable; }
         static bool ShouldOptimizeGradientAccumulation() { return m_optimizeGradientAccumulation; }
 
+        static void SetStackRecurrentTimes(bool enable) { m_stackRecurrentTimes = enable; }
+        static bool ShouldStackRecurrentTimes() { return m_stackRecurrentTimes; }
+
+        static void SetConcurrentLoops(bool enable) { m_concurrentLoops = enable; }
+        static bool ShouldRunLoopsConcurrently() { return m_concurrentLoops; }
+
         // TODO: Currently the flag is set to false. Should be switched to true after more rigorous testing.
         static bool UseV2Aggregator() { return false; }
 
@@ -34,5 +40,9 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         static std::atomic<bool> m_enableShareNodeValueMatrices;
         static std::atomic<bool> m_forceConstantRandomSeed;
         static std::atomic<bool> m_optimizeGradientAccumulation;
+        // The global flag to compute the matrix products of a recurrent loop that share the right operand with one product per step
+        static std::atomic<bool> m_stackRecurrentTimes;
+        // The global flag to run independent recurrent loops (e.g. of a bidirectional layer) on the CPU concurrently
+        static std::atomic<bool> m_concurrentLoops;
     };
 }}}
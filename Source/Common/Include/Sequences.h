@@ -618,6 +618,10 @@ private:
     // and 0 indicates invalid (aka MinibatchPackingFlags::NoInput)
     mutable Matrix<char> m_columnsValidityMask;
 
+    // Guards the lazy creation of m_columnsValidityMask. Concurrently run loops (see ScheduleConcurrentLoops())
+    // share the layout of the network and may mask their columns at the same time.
+    mutable std::mutex m_columnsValidityMaskMutex;
+
     // A boolean flag indicating whether the MBLayout can be further modified
     // When it's value is false, no set operations are allowed on the MBLayout.
     // Meant to guard in lazy creation of m_columnsValidityMask.
@@ -921,12 +925,13 @@ inline bool MBLayout::IsBeyondStartOrEnd(const FrameRange &fr) const
 inline size_t MBLayout::GetActualNumSamples() const { return m_numFramesDeclared - m_numGapFrames; }
 
 // return m_columnsValidityMask(,), which is lazily created here upon first call
-// only called from MaskMissingColumnsTo()
+// only called from MaskMissingColumnsTo(), possibly from several threads at once
 // TODO: Can probably be faster by using the sequence array directly.
 // TODO: Or should we just blast m_distanceToStart to GPU, and maks based on that? It is small compared to features.
 inline const Matrix<char>& MBLayout::GetColumnsValidityMask(DEVICEID_TYPE deviceId) const
 {
     CheckIsValid();
+    std::lock_guard<std::mutex> lock(m_columnsValidityMaskMutex);
     // lazily compute the validity mask
     if (m_columnsValidityMask.IsEmpty())
     {
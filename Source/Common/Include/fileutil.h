@@ -174,6 +174,12 @@ void unlinkOrDie(const std::wstring& pathname);
 void renameOrDie(const std::string& from, const std::string& to);
 void renameOrDie(const std::wstring& from, const std::wstring& to);
 
+// ----------------------------------------------------------------------------
+// fsyncOrDie(): force a file's data to disk, with error handling
+// ----------------------------------------------------------------------------
+
+void fsyncOrDie(const std::wstring& pathname);
+
 // ----------------------------------------------------------------------------
 // copyOrDie(): copy file with error handling.
 // ----------------------------------------------------------------------------
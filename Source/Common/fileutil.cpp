@@ -27,6 +27,7 @@
 #include <glob.h>
 #include <dirent.h>
 #include <sys/sendfile.h>
+#include <fcntl.h>
 #endif
 #include <stdio.h>
 #include <string.h>
@@ -691,6 +692,33 @@ void renameOrDie(const std::wstring& from, const std::wstring& to)
 #endif
 }
 
+// ----------------------------------------------------------------------------
+// fsyncOrDie(): force a file's data to disk, with error handling
+// ----------------------------------------------------------------------------
+
+void fsyncOrDie(const std::wstring& pathname)
+{
+#ifdef _WIN32
+    // _commit() needs a handle with write access
+    int fd = _wopen(pathname.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0)
+        RuntimeError("error opening file '%ls' for syncing: %s", pathname.c_str(), strerror(errno));
+    int rc = _commit(fd);
+    int err = errno;
+    _close(fd);
+#else
+    // also works for directories, which is needed to make a rename() durable
+    int fd = open(wtocharpath(pathname.c_str()).c_str(), O_RDONLY);
+    if (fd < 0)
+        RuntimeError("error opening file '%ls' for syncing: %s", pathname.c_str(), strerror(errno));
+    int rc = fsync(fd);
+    int err = errno;
+    close(fd);
+#endif
+    if (rc != 0)
+        RuntimeError("error syncing file '%ls' to disk: %s", pathname.c_str(), strerror(err));
+}
+
 // ----------------------------------------------------------------------------
 // copyOrDie(): copy file with error handling.
 // ----------------------------------------------------------------------------
@@ -10,6 +10,8 @@
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+class NodeProfiler;
+
 // ===========================================================================
 // ComputationEnvironment -- global network properties of interest to nodes
 // ===========================================================================
@@ -56,6 +58,9 @@ struct ComputationEnvironment
 
     bool IsV2Library() const { return isV2Library; }
 
+    // per-node profiling of ForwardProp() and Backprop(); null unless enabled
+    std::shared_ptr<NodeProfiler> nodeProfiler;
+
     // more properties should be added here as needed
 };
 typedef std::shared_ptr<ComputationEnvironment> ComputationEnvironmentPtr;
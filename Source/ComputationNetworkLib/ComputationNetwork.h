@@ -13,6 +13,7 @@
 #include "ComputationNode.h"
 #include "ScriptableObjects.h"
 #include "ComputationEnvironment.h"
+#include "NodeProfiler.h"
 
 #include <map>
 #include <string>
@@ -126,11 +127,13 @@ public:
 
     void Save(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary) const;
     void SaveEdited(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary);
+    // writes directly to fileName; for callers that commit the file themselves (Save() writes a temporary file and renames it)
+    void SaveToFileImpl(const std::wstring& fileName, const FileOptions fileFormat) const;
+    // a copy of what SaveToFileImpl() writes, with the values in CPU memory, to be saved while training goes on
+    ComputationNetworkPtr CreateSnapshotForSave() const;
 
 private:
 
-    void SaveToFileImpl(const std::wstring& fileName, const FileOptions fileFormat) const;
-    
     static size_t GetModelVersion(File& fstream);
 
 public:
@@ -284,6 +287,8 @@ public:
 private:
     // The method below determines evaluation order, which is tricky in presence of recurrent loops.
     void FormRecurrentLoops();
+    // Reorders the evaluation order such that independent loops are consecutive, to be run concurrently.
+    void ScheduleConcurrentLoops(std::vector<ComputationNodeBasePtr>& sortedNodes);
 
 public:
     // -----------------------------------------------------------------------
@@ -844,6 +849,9 @@ public:
     template <class ElemType>
     void PerformSVDecomposition(const map<wstring, float>& SVDConfig, size_t AlignedSize);
 
+    template <class ElemType>
+    void OptimizeForInference(const std::vector<ComputationNodeBasePtr>& outputNodes);
+
     template <class ElemType>
     void SaveToDbnFile(ComputationNetworkPtr net, const std::wstring& fileName) const;
 
@@ -974,6 +982,21 @@ public:
     }
     int TraceLevel() const { return m_environment->traceLevel; }
 
+    // per-node profiling of ForwardProp() and Backprop(), see NodeProfiler.h
+    // Statistics accumulate until NodeProfilerPtr()->Reset().
+    void EnableNodeProfiling(bool enable)
+    {
+        if (!enable)
+            m_environment->nodeProfiler.reset();
+        else if (!m_environment->nodeProfiler)
+        {
+            m_environment->nodeProfiler = std::make_shared<NodeProfiler>();
+            if (m_areMatricesAllocated)
+                m_environment->nodeProfiler->SetMatrixPoolRequests(m_matrixPool.GetRequests());
+        }
+    }
+    const std::shared_ptr<NodeProfiler>& NodeProfilerPtr() const { return m_environment->nodeProfiler; }
+
     // call EnableNodeTracing() on the given nodes for real, category, and sparse printing
     void EnableNodeTracing(const std::vector<std::wstring>& traceNodeNamesReal,
                            const std::vector<std::wstring>& traceNodeNamesCategory,
@@ -1147,14 +1170,32 @@ protected:
         virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool);
         virtual bool IsOutOfDateWrtInputs() const override;
 
+    private:
+        // TimesNodes of the loop that multiply the same right operand with different weights,
+        // computed with one stacked matrix product per time step, see FormStackedTimes().
+        struct IStackedTimes;
+        template <class ElemType>
+        struct StackedTimes;
+
+        void FormStackedTimes();
+        template <class ElemType>
+        void FormStackedTimes();
+
+        bool m_stackedTimesFormed;
+        std::vector<std::shared_ptr<IStackedTimes>> m_stackedTimesGroups;
+        std::vector<std::shared_ptr<IStackedTimes>> m_stackedTimes; // [i] -> group of m_nestedNodes[i], or nullptr
+
     public:
         ComputationNodeBasePtr m_sourceNode; // one of the nodes of the loop   --TODO: What is the special meaning of this node? It seems to always be a delay node.
         int m_loopId;                        // unique loop id, index in m_allSEQNodes array
         int m_steppingDirection;             // +1 if left to right (t=0..T-1), -1 if rightt to left (t=T-1..0)
+        int m_concurrentGroupId;             // loops with the same id (>= 0) are independent, and run concurrently where they are consecutive in an evaluation order
 
         SEQTraversalFlowControlNode(int loopId, ComputationNodeBasePtr cur)
             : m_loopId(loopId),
-              m_sourceNode(cur)
+              m_sourceNode(cur),
+              m_concurrentGroupId(-1),
+              m_stackedTimesFormed(false)
         {
             SetNodeName(L"Loop_" + m_sourceNode->NodeName());
         }
@@ -1183,6 +1224,7 @@ protected:
         }
 
         static void ForwardProp(const ComputationNodeBasePtr& node, const FrameRange& fr);
+        static void Backprop(const ComputationNodeBasePtr& node, const FrameRange& fr);
         static void PostForwardAndBackProp(const ComputationNodeBasePtr& node);
 
         virtual void BeginForwardProp() override {}
@@ -1210,6 +1252,10 @@ protected:
         // There is currently no other constructor for inner nested PAR-traversed sub-networks, but there will be.
         PARTraversalFlowControlNode(const std::vector<shared_ptr<SEQTraversalFlowControlNode>>& recurrentInfo, const std::list<ComputationNodeBasePtr>& allNodes);
         // Base::m_nestedNodes contains all top-level nodes, in evaluation order
+
+    private:
+        // [i] -> range [begin, end) of m_nestedNodes that is run concurrently with m_nestedNodes[i]; [i, i+1) for most nodes
+        std::vector<std::pair<size_t, size_t>> m_concurrentRanges;
     };
 
 public:
@@ -11,6 +11,7 @@
 #include "RecurrentNodes.h"
 #include <string>
 #include <set>
+#include <list>
 
 using namespace std;
 
@@ -67,6 +68,9 @@ void ComputationNetwork::FormRecurrentLoops()
     // Peform global sort on all nodes honoring inner strong component sorting.
     auto sortedNodes = GlobalEvaluationSort(graph, strongComponents);
 
+    if (Globals::ShouldRunLoopsConcurrently())
+        ScheduleConcurrentLoops(sortedNodes);
+
     // Update global eval order in m_evalOrder.
     // TODO: Get rid of this after-the-fact patch.
     UpdateEvalOrder(nullptr, std::list<ComputationNodeBasePtr>(sortedNodes.begin(), sortedNodes.end()));
@@ -89,6 +93,113 @@ void ComputationNetwork::FormRecurrentLoops()
     }
 }
 
+// Loops that do not depend on each other, e.g. the two directions of a bidirectional recurrence,
+// are moved next to each other in the evaluation order and get the same m_concurrentGroupId, so that
+// PARTraversalFlowControlNode runs them concurrently. Nodes that the loops do not depend on, and that
+// do not depend on them, are moved in front of them.
+// Only loops on the CPU are grouped, and only if they have no common inputs, which they would
+// otherwise back-propagate into concurrently.
+void ComputationNetwork::ScheduleConcurrentLoops(std::vector<ComputationNodeBasePtr>& sortedNodes)
+{
+    // A unit of the evaluation order is either a single node or all nodes of a loop, which are consecutive.
+    struct Unit
+    {
+        std::vector<ComputationNodeBasePtr> m_nodes;
+        shared_ptr<SEQTraversalFlowControlNode> m_loop;
+        std::set<ComputationNodeBasePtr> m_inputs; // inputs of the loop from outside of it
+    };
+
+    std::list<Unit> units;
+    for (const auto& node : sortedNodes)
+    {
+        auto loop = node->IsPartOfLoop() ? FindInRecurrentLoops(m_allSEQNodes, node) : nullptr;
+        if (!loop || units.empty() || units.back().m_loop != loop)
+            units.push_back(Unit{ {}, loop, {} });
+        units.back().m_nodes.push_back(node);
+    }
+
+    for (auto& unit : units)
+    {
+        if (!unit.m_loop)
+            continue;
+        std::set<ComputationNodeBasePtr> loopNodes(unit.m_nodes.begin(), unit.m_nodes.end());
+        for (const auto& node : unit.m_nodes)
+            for (const auto& input : node->GetInputs())
+                if (loopNodes.find(input) == loopNodes.end())
+                    unit.m_inputs.insert(input);
+    }
+
+    auto canRunConcurrently = [](const Unit& unit)
+    {
+        return unit.m_loop && unit.m_loop->m_concurrentGroupId < 0 &&
+               std::all_of(unit.m_nodes.begin(), unit.m_nodes.end(), [](const ComputationNodeBasePtr& node) { return node->GetDeviceId() == CPUDEVICE; });
+    };
+
+    auto dependsOn = [](const Unit& unit, const std::set<ComputationNodeBasePtr>& nodes)
+    {
+        for (const auto& node : unit.m_nodes)
+            for (const auto& input : node->GetInputs())
+                if (nodes.find(input) != nodes.end())
+                    return true;
+        return false;
+    };
+
+    int groupId = 0;
+    for (auto first = units.begin(); first != units.end(); ++first)
+    {
+        if (!canRunConcurrently(*first))
+            continue;
+
+        // the group is [first, groupEnd); dependents are the nodes of the group and all nodes that depend on it
+        auto groupEnd = std::next(first);
+        std::set<ComputationNodeBasePtr> dependents(first->m_nodes.begin(), first->m_nodes.end());
+        std::set<ComputationNodeBasePtr> groupInputs = first->m_inputs;
+        for (auto iter = groupEnd; iter != units.end();)
+        {
+            auto next = std::next(iter);
+            if (dependsOn(*iter, dependents))
+                dependents.insert(iter->m_nodes.begin(), iter->m_nodes.end());
+            else if (canRunConcurrently(*iter) &&
+                     std::none_of(iter->m_inputs.begin(), iter->m_inputs.end(), [&groupInputs](const ComputationNodeBasePtr& input) { return groupInputs.find(input) != groupInputs.end(); }))
+            {
+                // Move the units in between that do not depend on the group in front of it.
+                // Their inputs are either in front of the group as well, or are moved with them.
+                for (auto other = groupEnd; other != iter;)
+                {
+                    auto nextOther = std::next(other);
+                    if (!dependsOn(*other, dependents))
+                        units.splice(first, units, other);
+                    other = nextOther;
+                }
+
+                // and append the loop to the group
+                units.splice(groupEnd, units, iter);
+                dependents.insert(iter->m_nodes.begin(), iter->m_nodes.end());
+                groupInputs.insert(iter->m_inputs.begin(), iter->m_inputs.end());
+                first->m_loop->m_concurrentGroupId = groupId;
+                iter->m_loop->m_concurrentGroupId = groupId;
+            }
+            iter = next;
+        }
+
+        if (first->m_loop->m_concurrentGroupId >= 0)
+        {
+            if (TraceLevel() > 0)
+            {
+                fprintf(stderr, "\nConcurrent loops:");
+                for (auto iter = first; iter != groupEnd; ++iter)
+                    fprintf(stderr, " %ls", iter->m_loop->NodeName().c_str());
+                fprintf(stderr, "\n");
+            }
+            groupId++;
+        }
+    }
+
+    sortedNodes.clear();
+    for (const auto& unit : units)
+        sortedNodes.insert(sortedNodes.end(), unit.m_nodes.begin(), unit.m_nodes.end());
+}
+
 // checks whether a node is recurrent, and which direction
 static int GetRecurrenceSteppingDirection(const ComputationNodeBasePtr& node)
 {
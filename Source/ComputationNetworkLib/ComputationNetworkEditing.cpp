@@ -10,6 +10,7 @@
 #include "ComputationNetwork.h"
 #include "InputAndParamNodes.h"
 #include "TrainingNodes.h"
+#include "SpecialPurposeNodes.h"
 #include <string>
 #include <vector>
 #include <list>
@@ -97,6 +98,56 @@ void ComputationNetwork::CopySubTree(const ComputationNetwork& fromNet,
     }
 }
 
+// keeps the value of a node that Save() may write, in CPU memory, and drops the matrices it does not write
+template <class ElemType>
+static bool MoveSnapshotValueToCPU(const ComputationNodeBasePtr& nodeBase)
+{
+    auto node = dynamic_pointer_cast<ComputationNode<ElemType>>(nodeBase);
+    if (!node)
+        return false;
+    node->GradientPtrRef() = nullptr;
+    if (node->IsValueSharable() || !node->ValuePtr()) // activations from the MatrixPool are not saved
+        node->ValuePtrRef() = nullptr;
+    else
+        node->Value().TransferToDeviceIfNotThere(CPUDEVICE, /*isBeingMoved=*/true);
+    return true;
+}
+
+// Copies the nodes, their inputs and the node groups that SaveToFileImpl() writes, so that a checkpoint
+// can be serialized on another thread while training updates the parameters. Nodes are duplicated one at
+// a time, so at most one node's value and gradient are copied on the GPU at any time.
+ComputationNetworkPtr ComputationNetwork::CreateSnapshotForSave() const
+{
+    auto snapshot = make_shared<ComputationNetwork>(CPUDEVICE);
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        auto node = iter.second->Duplicate(iter.first, CopyNodeFlags::copyNodeValue);
+        if (!MoveSnapshotValueToCPU<float>(node) && !MoveSnapshotValueToCPU<double>(node) && !MoveSnapshotValueToCPU<half>(node))
+            LogicError("CreateSnapshotForSave: Unexpected node type.");
+        snapshot->AddNodeToNet(node);
+    }
+
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        vector<ComputationNodeBasePtr> inputs;
+        for (const auto& input : iter.second->GetInputs())
+            inputs.push_back(input ? snapshot->GetNodeFromName(input->NodeName()) : nullptr);
+        snapshot->GetNodeFromName(iter.first)->AttachInputs(inputs);
+    }
+
+    auto copyGroup = [&](const vector<ComputationNodeBasePtr>& from, vector<ComputationNodeBasePtr>& to)
+    {
+        for (const auto& node : from)
+            to.push_back(snapshot->GetNodeFromName(node->NodeName()));
+    };
+    copyGroup(m_featureNodes, snapshot->m_featureNodes);
+    copyGroup(m_labelNodes, snapshot->m_labelNodes);
+    copyGroup(m_criterionNodes, snapshot->m_criterionNodes);
+    copyGroup(m_evaluationNodes, snapshot->m_evaluationNodes);
+    copyGroup(m_outputNodes, snapshot->m_outputNodes);
+    return snapshot;
+}
+
 // you can only copy inputs from nodes in the same network
 void ComputationNetwork::CopyInputs(const std::wstring fromName, std::wstring toName)
 {
@@ -367,4 +418,152 @@ void ComputationNetwork::SetLearnableNodesBelowLearningRateMultiplier(const floa
     }
 }
 
+// -----------------------------------------------------------------------
+// inference optimization
+// -----------------------------------------------------------------------
+
+// Simplifies a compiled network for pure inference of the given output nodes:
+//  - Dropout and StopGradient are identities at inference time, so their consumers are rewired to read their input directly.
+//  - Subexpressions that only depend on parameters and already-computed PreCompute nodes (e.g. a transposed weight,
+//    a Times of two parameters, or a normalization scale) are evaluated once and replaced by a constant LearnableParameter
+//    of the same name.
+//  - All nodes that the outputs do not depend on (criteria, evaluation nodes, labels, and the now-folded subexpressions) are removed.
+// This must be called before AllocateAllMatrices(), since it changes the set of nodes that share memory.
+// The outputs themselves are never replaced, so pointers to them remain valid. The network is recompiled at the end.
+template <class ElemType>
+void ComputationNetwork::OptimizeForInference(const std::vector<ComputationNodeBasePtr>& outputNodes)
+{
+    VerifyIsCompiled("OptimizeForInference");
+    if (AreMatricesAllocated())
+        LogicError("OptimizeForInference: Must be called before the matrices are allocated.");
+
+    set<ComputationNodeBasePtr> outputSet(outputNodes.begin(), outputNodes.end());
+
+    // STEP 1: bypass identity operations
+    size_t numBypassed = 0;
+    for (const auto& node : ComputationNodeBase::EnumerateNodes(outputNodes))
+    {
+        if (outputSet.find(node) != outputSet.end())
+            continue;
+        if (node->OperationName() != OperationNameOf(DropoutNode) && node->OperationName() != OperationNameOf(StopGradientNode))
+            continue;
+        ChangeNodeInputs(node, node->GetInputs()[0]);
+        numBypassed++;
+    }
+
+    // STEP 2: determine the constant nodes
+    // Nodes are enumerated in post-order, so inputs are classified before their consumers.
+    // Anything that has a dynamic axis, state, randomness, or multiple outputs is left alone.
+    set<ComputationNodeBasePtr> constantNodes;
+    list<ComputationNodeBasePtr> nodesToEvaluate;
+    for (const auto& node : ComputationNodeBase::EnumerateNodes(outputNodes))
+    {
+        if (!node->Is<ComputationNode<ElemType>>())
+            continue;
+        if (node->OperationName() == OperationNameOf(LearnableParameter))
+        {
+            constantNodes.insert(node);
+            continue;
+        }
+        if (node->Is<IPreComputeNode>())
+        {
+            if (node->As<IPreComputeNode>()->HasComputed())
+                constantNodes.insert(node);
+            continue;
+        }
+        if (node->GetNumInputs() == 0 || node->HasMBLayout() || node->IsPartOfLoop() ||
+            node->Is<IRngUser>() || node->Is<IStatefulNode>() || node->Is<MultiOutputNode<ElemType>>() ||
+            node->OperationName() == L"UserDefinedV2Function")
+            continue;
+
+        bool allInputsConstant = true;
+        for (const auto& input : node->GetInputs())
+            allInputsConstant &= constantNodes.find(input) != constantNodes.end();
+        if (!allInputsConstant)
+            continue;
+
+        constantNodes.insert(node);
+        nodesToEvaluate.push_back(node);
+    }
+
+    // the folded nodes are the constant non-parameters that are consumed by a non-constant node
+    // Outputs are not folded, so that callers can keep referring to them.
+    set<ComputationNodeBasePtr> foldedSet;
+    vector<ComputationNodeBasePtr> foldedNodes;
+    for (const auto& node : ComputationNodeBase::EnumerateNodes(outputNodes))
+    {
+        if (constantNodes.find(node) != constantNodes.end())
+            continue;
+        for (const auto& input : node->GetInputs())
+        {
+            if (constantNodes.find(input) != constantNodes.end() && input->OperationName() != OperationNameOf(LearnableParameter) &&
+                outputSet.find(input) == outputSet.end() && foldedSet.insert(input).second)
+                foldedNodes.push_back(input);
+        }
+    }
+
+    // STEP 3: evaluate the constant subexpressions once
+    // They get their own memory pool with non-shared values, since they are computed only once.
+    if (!foldedNodes.empty())
+    {
+        MatrixPool matrixPool;
+        for (const auto& node : nodesToEvaluate)
+        {
+            node->MarkValueNonSharable();
+            node->RequestMatricesBeforeForwardProp(matrixPool);
+        }
+        matrixPool.OptimizedMemoryAllocation();
+
+        ResetEvalTimeStamps();
+        for (const auto& node : nodesToEvaluate)
+            PARTraversalFlowControlNode::ForwardProp(node, FrameRange(nullptr));
+    }
+
+    // STEP 4: replace the folded nodes by constants
+    for (const auto& node : foldedNodes)
+    {
+        ComputationNodeBasePtr constant = New<LearnableParameter<ElemType>>(m_deviceId, node->NodeName(), node->GetSampleLayout());
+        InitLearnableParameters(constant, L"fixedValue", 0); // follow the protocol; otherwise deferred initialization will overwrite the value in validation
+        constant->As<ComputationNode<ElemType>>()->Value().SetValue(node->As<ComputationNode<ElemType>>()->Value());
+        constant->SetLearningRateMultiplier(0);
+
+        ChangeNodeInputs(node, constant);
+        for (auto groupIter : GetAllNodeGroups())
+            std::replace(groupIter->begin(), groupIter->end(), node, constant);
+        RemoveNodeFromNet(node);
+        AddNodeToNet(constant);
+        node->DetachInputs();
+    }
+
+    // STEP 5: remove all nodes that the outputs no longer depend on
+    auto neededNodes = ComputationNodeBase::EnumerateNodes(outputNodes);
+    set<ComputationNodeBasePtr> neededSet(neededNodes.begin(), neededNodes.end());
+    vector<ComputationNodeBasePtr> unneededNodes;
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        if (neededSet.find(iter.second) == neededSet.end())
+            unneededNodes.push_back(iter.second);
+    }
+    auto isUnneeded = [&](const ComputationNodeBasePtr& node) { return neededSet.find(node) == neededSet.end(); };
+    for (auto groupIter : GetAllNodeGroups())
+        groupIter->erase(std::remove_if(groupIter->begin(), groupIter->end(), isUnneeded), groupIter->end());
+    for (auto& iter : m_namedCriterionNodes)
+        iter.second.erase(std::remove_if(iter.second.begin(), iter.second.end(), isUnneeded), iter.second.end());
+    for (const auto& node : unneededNodes)
+    {
+        node->DetachInputs(); // deref all its inputs; if we don't do that, we might end up with a mem leak due to a circular reference
+        RemoveNodeFromNet(node);
+    }
+
+    if (TraceLevel() > 0)
+        fprintf(stderr, "OptimizeForInference: %d identity nodes bypassed, %d constant subexpressions folded, %d nodes removed.\n",
+                (int)numBypassed, (int)foldedNodes.size(), (int)unneededNodes.size());
+
+    CompileNetwork();
+}
+
+template void ComputationNetwork::OptimizeForInference<float>(const std::vector<ComputationNodeBasePtr>& outputNodes);
+template void ComputationNetwork::OptimizeForInference<double>(const std::vector<ComputationNodeBasePtr>& outputNodes);
+template void ComputationNetwork::OptimizeForInference<half>(const std::vector<ComputationNodeBasePtr>& outputNodes);
+
 }}}
@@ -11,6 +11,8 @@
 #include "RecurrentNodes.h"
 #include "InputAndParamNodes.h"
 #include "LinearAlgebraNodes.h"
+#include "CPUMatrix.h" // for SetNumThreadsOfCurrentThread()
+#include <future>
 #include <string>
 #include <vector>
 #include <list>
@@ -28,6 +30,11 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 // forward and backward propagation
 // -----------------------------------------------------------------------
 
+static NodeProfiler* GetNodeProfiler(const ComputationNodeBasePtr& node)
+{
+    return node->HasEnvironmentPtr() ? node->Environment().nodeProfiler.get() : nullptr;
+}
+
 // MAIN ENTRY POINT for evaluating one minibatch (forward prop)
 // This calls ForwardProp() on all nodes in order of data flow through the network.
 // By default, the network is applied concurrently on all frames in a minibatch in parallel (PAR mode, a "map" operation)
@@ -139,13 +146,54 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
             nodeIter++; // and consume this node
         }
     }
+
+    // consecutive loops of the same concurrent group are run concurrently, see ScheduleConcurrentLoops()
+    m_concurrentRanges.resize(m_nestedNodes.size());
+    for (size_t begin = 0; begin < m_nestedNodes.size();)
+    {
+        size_t end = begin + 1;
+        auto loop = dynamic_pointer_cast<SEQTraversalFlowControlNode>(m_nestedNodes[begin]);
+        if (loop && loop->m_concurrentGroupId >= 0)
+        {
+            for (; end < m_nestedNodes.size(); end++)
+            {
+                auto other = dynamic_pointer_cast<SEQTraversalFlowControlNode>(m_nestedNodes[end]);
+                if (!other || other->m_concurrentGroupId != loop->m_concurrentGroupId)
+                    break;
+            }
+        }
+        for (size_t i = begin; i < end; i++)
+            m_concurrentRanges[i] = make_pair(begin, end);
+        begin = end;
+    }
+}
+
+// runs the action for the nodes [begin, end) concurrently, each on its own thread with an equal share of the CPU threads
+static void RunConcurrently(const vector<ComputationNodeBasePtr>& nodes, size_t begin, size_t end, const function<void(const ComputationNodeBasePtr&)>& action)
+{
+    int numThreads = CPUMatrix<float /*any will do*/>::GetMaxNumThreads() / (int)(end - begin);
+    vector<future<void>> results;
+    for (size_t i = begin; i < end; i++)
+    {
+        const auto& node = nodes[i];
+        results.push_back(async(launch::async, [&node, &action, numThreads]()
+        {
+            CPUMatrix<float /*any will do*/>::SetNumThreadsOfCurrentThread(numThreads);
+            action(node);
+        }));
+    }
+    for (auto& result : results)
+        result.get();
 }
 /*static*/ void ComputationNetwork::PARTraversalFlowControlNode::ForwardProp(const ComputationNodeBasePtr& node, const FrameRange& fr)
 {
     if (node->IsOutOfDateWrtInputs())
     {
         node->BeginForwardProp();
-        node->ForwardProp(fr.WithLayout(node->GetMBLayout()));
+        {
+            NodeProfiler::Scope profile(GetNodeProfiler(node), node, fr, /*isBackprop=*/false);
+            node->ForwardProp(fr.WithLayout(node->GetMBLayout()));
+        }
         node->EndForwardProp();
 
         node->BumpEvalTimeStamp();
@@ -159,8 +207,18 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
 
 /*virtual*/ void ComputationNetwork::PARTraversalFlowControlNode::ForwardProp(const FrameRange& fr) /*override*/
 {
-    for (auto& node : m_nestedNodes)
-        ForwardProp(node, fr);
+    for (size_t begin = 0; begin < m_nestedNodes.size();)
+    {
+        size_t end = m_concurrentRanges[begin].second;
+        if (end - begin > 1 && !GetNodeProfiler(m_nestedNodes[begin]))
+            RunConcurrently(m_nestedNodes, begin, end, [&fr](const ComputationNodeBasePtr& node) { ForwardProp(node, fr); });
+        else
+        {
+            for (size_t i = begin; i < end; i++)
+                ForwardProp(m_nestedNodes[i], fr);
+        }
+        begin = end;
+    }
 }
 
 /*static*/ void ComputationNetwork::PARTraversalFlowControlNode::PostForwardAndBackProp(const ComputationNodeBasePtr& node)
@@ -174,21 +232,35 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
         PostForwardAndBackProp(node);
 }
 
+/*static*/ void ComputationNetwork::PARTraversalFlowControlNode::Backprop(const ComputationNodeBasePtr& node, const FrameRange& fr)
+{
+    node->BeginBackprop();
+    {
+        NodeProfiler::Scope profile(GetNodeProfiler(node), node, fr, /*isBackprop=*/true);
+        node->Backprop(fr.WithLayout(node->GetMBLayout()), true /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
+    }
+    node->EndBackprop();
+
+    // Extreme Tracing, part 2/4
+    if (node->HasEnvironmentPtr() && node->Environment().ShouldDumpNode() && node->NeedsGradient())
+        DumpNode(node, /*dumpGradient=*/true);
+}
+
 /*virtual*/ void ComputationNetwork::PARTraversalFlowControlNode::Backprop(const FrameRange& fr, bool childrenInThisLoop, bool childrenInOuterLoop) /*override*/
 {
     childrenInThisLoop, childrenInOuterLoop; // TODO: think through what these mean when coming from PAR mode
     // process nodes in pre-determined order
-    for (auto pnode = m_nestedNodes.rbegin(); pnode != m_nestedNodes.rend(); pnode++) // iterate backwards over evaluation order
+    for (size_t end = m_nestedNodes.size(); end > 0;) // iterate backwards over evaluation order
     {
-        auto& node = *pnode;
-
-        node->BeginBackprop();
-        node->Backprop(fr.WithLayout(node->GetMBLayout()), true /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
-        node->EndBackprop();
-
-        // Extreme Tracing, part 2/4
-        if (node->HasEnvironmentPtr() && node->Environment().ShouldDumpNode() && node->NeedsGradient())
-            DumpNode(node, /*dumpGradient=*/true);
+        size_t begin = m_concurrentRanges[end - 1].first;
+        if (end - begin > 1 && !GetNodeProfiler(m_nestedNodes[begin]))
+            RunConcurrently(m_nestedNodes, begin, end, [&fr](const ComputationNodeBasePtr& node) { Backprop(node, fr); });
+        else
+        {
+            for (size_t i = end; i > begin; i--)
+                Backprop(m_nestedNodes[i - 1], fr);
+        }
+        end = begin;
     }
 }
 /*virtual*/ void ComputationNetwork::PARTraversalFlowControlNode::RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) /*override*/
@@ -237,6 +309,109 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     return false;
 }
 
+// -----------------------------------------------------------------------
+// stacked TimesNodes of a SEQTraversalFlowControlNode
+//
+// A recurrence typically multiplies the same delayed value with several weight matrices,
+// e.g. one per gate of an LSTM. Evaluated node by node, this is one small matrix product
+// per gate and time step. Instead, the weights are stacked once per minibatch, and the
+// products of all gates are computed with a single matrix product per time step.
+// Backprop is not affected: the gradients w.r.t. the weights are already computed over
+// all time steps at once, outside the loop, in EndBackprop().
+// The NodeProfiler charges each node of a group its share of the stacked product.
+// -----------------------------------------------------------------------
+
+struct ComputationNetwork::SEQTraversalFlowControlNode::IStackedTimes
+{
+    virtual ~IStackedTimes() {}
+    virtual void StackWeights() = 0;
+    virtual void ForwardProp(const FrameRange& fr, NodeProfiler* profiler) = 0;
+
+    ComputationNodeBase* m_firstNode; // the group is computed when this node is reached in a time step
+};
+
+template <class ElemType>
+struct ComputationNetwork::SEQTraversalFlowControlNode::StackedTimes : public IStackedTimes
+{
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+    // Only plain matrix products W * x of dense data, with W not being minibatch data, are stacked.
+    static bool CanStack(const TimesNode<ElemType>& times)
+    {
+        const ComputationNodeBase& node = times;
+        if (times.OutputRank() != 1 || times.InferInputRankToMap() != TimesNode<ElemType>::NoInferredInputRank)
+            return false;
+
+        const auto& weights = node.GetInputs()[0];
+        const auto& right = node.GetInputs()[1];
+        if (weights->HasMBLayout() || !right->HasMBLayout())
+            return false;
+
+        const auto& weightsValue = weights->template As<ComputationNode<ElemType>>()->Value();
+        const auto& rightValue = right->template As<ComputationNode<ElemType>>()->Value();
+        if (weightsValue.GetMatrixType() != DENSE || rightValue.GetMatrixType() != DENSE)
+            return false;
+
+        size_t rows = node.GetSampleLayout().GetNumElements();
+        size_t cols = right->GetSampleLayout().GetNumElements();
+        return weights->GetSampleLayout().GetDim(0) == rows && weightsValue.GetNumElements() == rows * cols;
+    }
+
+    void StackWeights() override
+    {
+        size_t cols = m_right->GetSampleLayout().GetNumElements();
+        size_t rows = 0;
+        for (const auto& node : m_nodes)
+            rows += node->GetSampleLayout().GetNumElements();
+
+        if (!m_weights)
+        {
+            m_weights = make_shared<Matrix<ElemType>>(rows, cols, m_right->GetDeviceId());
+            m_product = make_shared<Matrix<ElemType>>(m_right->GetDeviceId());
+        }
+        m_weights->Resize(rows, cols);
+
+        size_t startRow = 0;
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            size_t numRows = m_nodes[i]->GetSampleLayout().GetNumElements();
+            m_weights->AssignToRowSliceValuesOf(m_leftOperands[i]->Value().Reshaped(numRows, cols), startRow, numRows);
+            startRow += numRows;
+        }
+    }
+
+    void ForwardProp(const FrameRange& fr, NodeProfiler* profiler) override
+    {
+        auto begin = chrono::steady_clock::now();
+        Matrix<ElemType>::Multiply(*m_weights, false, m_right->ValueFor(fr), false, *m_product);
+        double productSeconds = 0;
+        if (profiler)
+        {
+            profiler->SyncGpu();
+            productSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        }
+
+        // each node is charged the part of the product that computes its rows, plus copying them
+        size_t startRow = 0;
+        for (const auto& node : m_nodes)
+        {
+            size_t numRows = node->GetSampleLayout().GetNumElements();
+            NodeProfiler::Scope profile(profiler, node, fr, /*isBackprop=*/false);
+            profile.AddSharedSeconds(productSeconds * numRows / m_weights->GetNumRows());
+            Matrix<ElemType> value = node->ValueFor(fr);
+            value.AssignRowSliceValuesOf(*m_product, startRow, numRows);
+            startRow += numRows;
+        }
+    }
+
+    std::vector<ComputationNodePtr> m_nodes;
+    std::vector<ComputationNodePtr> m_leftOperands;
+    ComputationNodePtr m_right;
+
+    shared_ptr<Matrix<ElemType>> m_weights; // left operands of all nodes, stacked vertically
+    shared_ptr<Matrix<ElemType>> m_product; // stacked values of all nodes for one time step
+};
+
 // -----------------------------------------------------------------------
 // SEQTraversalFlowControlNode methods -- implements SEQ traversal (loop unrolling)
 //
@@ -260,6 +435,16 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     // tell all that loop is about to commence
     for (auto& node : m_nestedNodes)
         node->BeginForwardProp();
+
+    if (!m_stackedTimesFormed)
+    {
+        FormStackedTimes();
+        m_stackedTimesFormed = true;
+    }
+
+    // weights may have been updated since the last minibatch
+    for (auto& group : m_stackedTimesGroups)
+        group->StackWeights();
 }
 
 // evaluation of a SEQTraversalFlowControlNode FlowControlNode
@@ -276,11 +461,20 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     // Note: Currently, this is limited to linear-time loops. But nothing stops the iteration below to, e.g., be a 2D iteration over an image
     // if we implement an according FrameRangeIteration.
     FrameRangeIteration range(GetMBLayout(), m_steppingDirection);
+    auto nodeProfiler = GetNodeProfiler(m_nestedNodes[0]);
     for (auto t = range.begin(); t != range.end(); t++)
     {
-        for (auto& node : m_nestedNodes)
+        for (size_t i = 0; i < m_nestedNodes.size(); i++)
         {
-            node->ForwardProp(t);
+            auto& node = m_nestedNodes[i];
+            const auto& group = m_stackedTimes[i];
+            if (!group)
+            {
+                NodeProfiler::Scope profile(nodeProfiler, node, t, /*isBackprop=*/false);
+                node->ForwardProp(t);
+            }
+            else if (group->m_firstNode == node.get())
+                group->ForwardProp(t, nodeProfiler); // computes and profiles all nodes of the group
             node->BumpEvalTimeStamp();
         }
     }
@@ -315,11 +509,13 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     const auto& recurrentNodes = m_nestedNodes; // BUGBUG: -ForForward?? Does this mean we can remove non-ForForward?
     auto pMBLayout = recurrentNodes[0]->GetMBLayout();
     FrameRangeIteration range(pMBLayout, m_steppingDirection);
+    auto nodeProfiler = GetNodeProfiler(recurrentNodes[0]);
     for (auto t = range.rbegin(); t != range.rend(); t++) // note: reverse iteration
     {
         for (auto nodeIter2 = recurrentNodes.rbegin(); nodeIter2 != recurrentNodes.rend(); ++nodeIter2)
         {
             auto& node2 = *nodeIter2;
+            NodeProfiler::Scope profile(nodeProfiler, node2, t, /*isBackprop=*/true);
             node2->Backprop(t, true /*childrenInThisLoop*/, false /*childrenInOuterLoop*/);
             // The above flags tell Backprop() to skip back-propagation from inside a node into
             // a node that is outside the loop, which is done later in EndBackprop() in PAR mode.
@@ -344,7 +540,9 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     for (auto nodeIter2 = m_nestedNodes.rbegin(); nodeIter2 != m_nestedNodes.rend(); ++nodeIter2)
     {
         auto& node2 = *nodeIter2;
-        node2->Backprop(FrameRange(m_nestedNodes[0]->GetMBLayout()), false /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
+        FrameRange fr(m_nestedNodes[0]->GetMBLayout());
+        NodeProfiler::Scope profile(GetNodeProfiler(node2), node2, fr, /*isBackprop=*/true);
+        node2->Backprop(fr, false /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
     }
 
     // tell all nodes we are done for this iteraTion
@@ -380,6 +578,53 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     }
 }
 
+// Groups the TimesNodes of the loop by their right operand.
+void ComputationNetwork::SEQTraversalFlowControlNode::FormStackedTimes()
+{
+    m_stackedTimes.assign(m_nestedNodes.size(), nullptr);
+    if (!Globals::ShouldStackRecurrentTimes())
+        return;
+
+    FormStackedTimes<float>();
+    FormStackedTimes<double>();
+}
+
+template <class ElemType>
+void ComputationNetwork::SEQTraversalFlowControlNode::FormStackedTimes()
+{
+    map<ComputationNodeBase*, shared_ptr<StackedTimes<ElemType>>> groups; // right operand -> group
+    vector<shared_ptr<StackedTimes<ElemType>>> groupOfNode(m_nestedNodes.size());
+    for (size_t i = 0; i < m_nestedNodes.size(); i++)
+    {
+        auto node = dynamic_pointer_cast<TimesNode<ElemType>>(m_nestedNodes[i]);
+        if (!node || !StackedTimes<ElemType>::CanStack(*node))
+            continue;
+
+        auto& group = groups[node->GetInputs()[1].get()];
+        if (!group)
+        {
+            group = make_shared<StackedTimes<ElemType>>();
+            group->m_firstNode = node.get();
+            group->m_right = dynamic_pointer_cast<ComputationNode<ElemType>>(node->GetInputs()[1]);
+        }
+        group->m_nodes.push_back(node);
+        group->m_leftOperands.push_back(dynamic_pointer_cast<ComputationNode<ElemType>>(node->GetInputs()[0]));
+        groupOfNode[i] = group;
+    }
+
+    for (const auto& group : groups)
+    {
+        if (group.second->m_nodes.size() > 1)
+            m_stackedTimesGroups.push_back(group.second);
+    }
+
+    for (size_t i = 0; i < m_nestedNodes.size(); i++)
+    {
+        if (groupOfNode[i] && groupOfNode[i]->m_nodes.size() > 1)
+            m_stackedTimes[i] = groupOfNode[i];
+    }
+}
+
 // find if node is part of a recurrent loop; and return the loop id
 // If found then return a pointer to the list of nodes of this loop.
 /*static*/ shared_ptr<ComputationNetwork::SEQTraversalFlowControlNode> ComputationNetwork::FindInRecurrentLoops(const std::vector<std::shared_ptr<SEQTraversalFlowControlNode>>& recurrentInfo, const ComputationNodeBasePtr& node)
@@ -1146,20 +1391,40 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
 
     m_matrixPool.Reset();
 
-    TravserseInSortedGlobalEvalOrder(forwardPropRoots, [&outputValueNeededDuringBackProp, &parentsMap, this](const ComputationNodeBasePtr& node) {
-        if (node->Is<SEQTraversalFlowControlNode>())
+    // Loops that run concurrently (consecutive loops of the same concurrent group) must not share memory,
+    // so all of their matrices are requested before any is released.
+    std::vector<shared_ptr<SEQTraversalFlowControlNode>> concurrentLoops;
+    auto allocateLoops = [&concurrentLoops, &outputValueNeededDuringBackProp, &parentsMap, this]()
+    {
+        for (auto& loop : concurrentLoops)
         {
-            auto seqTraversalFlowControlNode = node->As<SEQTraversalFlowControlNode>();
-            for (auto& loopNode : seqTraversalFlowControlNode->m_nestedNodes)
+            for (auto& loopNode : loop->m_nestedNodes)
                 loopNode->SetOutputNeededDuringBackprop(outputValueNeededDuringBackProp[loopNode]);
 
-            seqTraversalFlowControlNode->RequestMatricesBeforeForwardProp(m_matrixPool);
+            loop->RequestMatricesBeforeForwardProp(m_matrixPool);
+        }
 
-            for (auto& loopNode : seqTraversalFlowControlNode->m_nestedNodes)
+        for (auto& loop : concurrentLoops)
+        {
+            for (auto& loopNode : loop->m_nestedNodes)
                 ReleaseMatricesAfterEvalForChildren(loopNode, parentsMap);
         }
+        concurrentLoops.clear();
+    };
+
+    TravserseInSortedGlobalEvalOrder(forwardPropRoots, [&concurrentLoops, &allocateLoops, &outputValueNeededDuringBackProp, &parentsMap, this](const ComputationNodeBasePtr& node) {
+        if (node->Is<SEQTraversalFlowControlNode>())
+        {
+            auto seqTraversalFlowControlNode = dynamic_pointer_cast<SEQTraversalFlowControlNode>(node);
+            if (!concurrentLoops.empty() &&
+                (seqTraversalFlowControlNode->m_concurrentGroupId < 0 || seqTraversalFlowControlNode->m_concurrentGroupId != concurrentLoops.back()->m_concurrentGroupId))
+                allocateLoops();
+
+            concurrentLoops.push_back(seqTraversalFlowControlNode);
+        }
         else
         {
+            allocateLoops();
             node->SetOutputNeededDuringBackprop(outputValueNeededDuringBackProp[node]);
             node->RequestMatricesBeforeForwardProp(m_matrixPool);
             // we only release matrices for the children since the root node's information will be used
@@ -1167,6 +1432,7 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
             ReleaseMatricesAfterEvalForChildren(node, parentsMap);
         }
     });
+    allocateLoops();
 
     if (trainRootNode != nullptr)
     {
@@ -1228,25 +1494,38 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
         // we need to call it here since we always compute gradients for children and root node is not children of other node
         trainRootNode->RequestMatricesBeforeBackprop(m_matrixPool);
 
+        // as in forward prop, concurrently running loops allocate all their matrices before releasing any
+        auto allocateGradientLoops = [&concurrentLoops, this]()
+        {
+            // SEQ mode: allocate all in loop first, then deallocate again
+            // TODO: next step: use PARTraversalFlowControlNode::AllocateGradientMatricesForInputs() and ReleaseMatricesAfterBackprop()...
+            // BUGBUG: naw, ^^ would not work! Wrong order! Need to rethink this. Need to make AllocateEvalMatrices() and AllocateGradientMatrices() the virtual functions.
+            for (auto& loop : concurrentLoops)
+                loop->AllocateGradientMatricesForInputs(m_matrixPool);
+            // Loops are computed sample by sample so we have to allocate them all
+            for (auto& loop : concurrentLoops)
+                loop->ReleaseMatricesAfterBackprop(m_matrixPool);
+            concurrentLoops.clear();
+        };
+
         for (auto iter = backPropNodes.rbegin(); iter != backPropNodes.rend(); iter++) // for gradient computation, traverse in reverse order
         {
             auto n = *iter;
             if (n->IsPartOfLoop())
             {
-                std::vector<ComputationNodeBasePtr> recurrentNodes;
                 shared_ptr<SEQTraversalFlowControlNode> recInfo = FindInRecurrentLoops(m_allSEQNodes, n);
                 if (completedGradient.insert(recInfo).second)
                 {
-                    // SEQ mode: allocate all in loop first, then deallocate again
-                    // TODO: next step: use PARTraversalFlowControlNode::AllocateGradientMatricesForInputs() and ReleaseMatricesAfterBackprop()...
-                    // BUGBUG: naw, ^^ would not work! Wrong order! Need to rethink this. Need to make AllocateEvalMatrices() and AllocateGradientMatrices() the virtual functions.
-                    recInfo->AllocateGradientMatricesForInputs(m_matrixPool);
-                    // Loops are computed sample by sample so we have to allocate them all
-                    recInfo->ReleaseMatricesAfterBackprop(m_matrixPool);
+                    if (!concurrentLoops.empty() &&
+                        (recInfo->m_concurrentGroupId < 0 || recInfo->m_concurrentGroupId != concurrentLoops.back()->m_concurrentGroupId))
+                        allocateGradientLoops();
+
+                    concurrentLoops.push_back(recInfo);
                 }
             }
             else
             {
+                allocateGradientLoops();
                 // PAR mode: we can allocate and immediately deallocate one by one
                 n->AllocateGradientMatricesForInputs(m_matrixPool);
                 // Root node's information will be used and should not be shared with others, also it's small (1x1)
@@ -1254,10 +1533,13 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
                     n->ReleaseMatricesAfterBackprop(m_matrixPool);
             }
         }
+        allocateGradientLoops();
     }
 
     m_matrixPool.OptimizedMemoryAllocation(); 
     m_areMatricesAllocated = true;
+    if (m_environment->nodeProfiler)
+        m_environment->nodeProfiler->SetMatrixPoolRequests(m_matrixPool.GetRequests());
 
     // TO DO: At the time of AllocateAllMatrices we don't know the minibatch size. In theory one may allocate memory again once we start to receive
     // data from the reader (and the minibatch size is known). For some problems, minibatch size can change constantly, and there needs to be a 
@@ -579,115 +579,42 @@ public:
     ElemType ComputeEditDistanceError(Matrix<ElemType>& firstSeq, const Matrix<ElemType> & secondSeq, MBLayoutPtr pMBLayout, 
         float subPen, float delPen, float insPen, bool squashInputs, const vector<size_t>& tokensToIgnore)
     {
-        std::vector<int> firstSeqVec, secondSeqVec;
-
-        // Edit distance between subsequences
-        Matrix<float> grid(CPUDEVICE);
-        
-        // Number of insertions between subsequences
-        Matrix<float> insMatrix(CPUDEVICE);
-        
-        //Number of deletions between subsequences
-        Matrix<float> delMatrix(CPUDEVICE);
-
-        // Number of substitutions between subsequences
-        Matrix<float> subMatrix(CPUDEVICE);
-
-        float del, ins, sub;
-        ElemType wrongSampleNum = 0.0;
-        size_t totalSampleNum = 0, totalframeNum = 0;
-        size_t sequenceStartFrame = 0;
+        // bring the sample indices to the CPU at once
+        size_t numCols = firstSeq.GetNumCols();
+        std::vector<ElemType> firstSeqData(numCols), secondSeqData(numCols);
+        if (numCols > 0)
+        {
+            firstSeq.CopySection(1, numCols, firstSeqData.data(), 1);
+            secondSeq.CopySection(1, numCols, secondSeqData.data(), 1);
+        }
 
+        std::vector<MBLayout::SequenceInfo> sequences;
         for (const auto& sequence : pMBLayout->GetAllSequences())
         {
-            if (sequence.seqId == GAP_SEQUENCE_ID)
-                continue;
-
-            auto numFrames = pMBLayout->GetNumSequenceFramesInCurrentMB(sequence);
+            if (sequence.seqId != GAP_SEQUENCE_ID && pMBLayout->GetNumSequenceFramesInCurrentMB(sequence) > 0)
+                sequences.push_back(sequence);
+        }
 
-            if (numFrames > 0)
-            {
-                totalframeNum += numFrames;
-
-                auto columnIndices = pMBLayout->GetColumnIndices(sequence);
-
-                ExtractSampleSequence(firstSeq, columnIndices, squashInputs, tokensToIgnore, firstSeqVec);
-                ExtractSampleSequence(secondSeq, columnIndices, squashInputs, tokensToIgnore, secondSeqVec);
-
-                //calculate edit distance
-                size_t firstSize = firstSeqVec.size();
-                size_t secondSize = secondSeqVec.size();
-                if (Base::HasEnvironmentPtr() && Base::Environment().IsV2Library())
-                    totalSampleNum += secondSize;
-                else 
-                    totalSampleNum += firstSize;
-
-                grid.Resize(firstSize + 1, secondSize + 1);
-                insMatrix.Resize(firstSize + 1, secondSize + 1);
-                delMatrix.Resize(firstSize + 1, secondSize + 1);
-                subMatrix.Resize(firstSize + 1, secondSize + 1);
-                insMatrix.SetValue(0.0f);
-                delMatrix.SetValue(0.0f);
-                subMatrix.SetValue(0.0f);
-
-                for (size_t i = 0; i < firstSize + 1; i++)
-                {
-                    grid(i, 0) = (float)(i * delPen);
-                    delMatrix(i, 0) = (float)i;
-                }
+        bool countSecondSeqSamples = Base::HasEnvironmentPtr() && Base::Environment().IsV2Library();
+        double numErrors = 0.0;
+        size_t totalSampleNum = 0, totalframeNum = 0;
 
-                for (size_t j = 0; j < secondSize + 1; j++)
-                {
-                    grid(0, j) = (float)(j * insPen);
-                    insMatrix(0, j) = (float)j;
-                }
-                for (size_t i = 1; i < firstSize + 1; i++)
-                {
-                    for (size_t j = 1; j < secondSize + 1; j++)
-                    {
-                        if (firstSeqVec[i - 1] == secondSeqVec[j - 1])
-                        {
-                            grid(i, j) = grid(i - 1, j - 1);
-                            insMatrix(i, j) = insMatrix(i - 1, j - 1);
-                            delMatrix(i, j) = delMatrix(i - 1, j - 1);
-                            subMatrix(i, j) = subMatrix(i - 1, j - 1);
-                        }
-                        else
-                        {
-                            del = grid(i - 1, j) + delPen; //deletion 
-                            ins = grid(i, j - 1) + insPen;  //insertion
-                            sub = grid(i - 1, j - 1) + subPen; //substitution 
-                            if (sub <= del && sub <= ins)
-                            {
-                                insMatrix(i, j) = insMatrix(i - 1, j - 1);
-                                delMatrix(i, j) = delMatrix(i - 1, j - 1);
-                                subMatrix(i, j) = subMatrix(i - 1, j - 1) + 1.0f;
-                                grid(i, j) = sub;
-                            }
-                            else if (del < ins)
-                            {
-                                insMatrix(i, j) = insMatrix(i - 1, j);
-                                subMatrix(i, j) = subMatrix(i - 1, j);
-                                delMatrix(i, j) = delMatrix(i - 1, j) + 1.0f;
-                                grid(i, j) = del;
-                            }
-                            else
-                            {
-                                delMatrix(i, j) = delMatrix(i, j - 1);
-                                subMatrix(i, j) = subMatrix(i, j - 1);
-                                insMatrix(i, j) = insMatrix(i, j - 1) + 1.0f;
-                                grid(i, j) = ins;
-                            }
-                        }
-                    }
-                }
+        // the sequences are independent; the sums are over integers, hence exact in any order
+#pragma omp parallel for schedule(dynamic) reduction(+ : numErrors, totalSampleNum, totalframeNum)
+        for (long i = 0; i < (long)sequences.size(); i++)
+        {
+            std::vector<int> firstSeqVec, secondSeqVec;
+            auto columnIndices = pMBLayout->GetColumnIndices(sequences[i]);
+            totalframeNum += pMBLayout->GetNumSequenceFramesInCurrentMB(sequences[i]);
 
-                wrongSampleNum += insMatrix(firstSize, secondSize) + delMatrix(firstSize, secondSize) + subMatrix(firstSize, secondSize);
-            }
+            ExtractSampleSequence(firstSeqData, columnIndices, squashInputs, tokensToIgnore, firstSeqVec);
+            ExtractSampleSequence(secondSeqData, columnIndices, squashInputs, tokensToIgnore, secondSeqVec);
 
-            sequenceStartFrame += numFrames;
+            totalSampleNum += countSecondSeqSamples ? secondSeqVec.size() : firstSeqVec.size();
+            numErrors += ComputeNumErrors(firstSeqVec, secondSeqVec, subPen, delPen, insPen);
         }
 
+        ElemType wrongSampleNum = (ElemType)numErrors;
         return (ElemType)(wrongSampleNum * totalframeNum / totalSampleNum);
     }
 
@@ -726,13 +653,13 @@ private:
     float m_insPen;
     std::vector<size_t> m_tokensToIgnore;
 
-    // Clear out_SampleSeqVec and extract a vector of samples from the matrix into out_SampleSeqVec.
-    static void ExtractSampleSequence(const Matrix<ElemType>& firstSeq, vector<size_t>& columnIndices, bool squashInputs, const vector<size_t>& tokensToIgnore, std::vector<int>& out_SampleSeqVec)
+    // Clear out_SampleSeqVec and extract a vector of samples from the sample indices into out_SampleSeqVec.
+    static void ExtractSampleSequence(const std::vector<ElemType>& firstSeq, const vector<size_t>& columnIndices, bool squashInputs, const vector<size_t>& tokensToIgnore, std::vector<int>& out_SampleSeqVec)
     {
         out_SampleSeqVec.clear();
 
         // Get the first element in the sequence
-        size_t lastId = (int)firstSeq(0, columnIndices[0]);
+        size_t lastId = (int)firstSeq[columnIndices[0]];
         if (std::find(tokensToIgnore.begin(), tokensToIgnore.end(), lastId) == tokensToIgnore.end())
             out_SampleSeqVec.push_back(lastId);
 
@@ -742,7 +669,7 @@ private:
             //squash sequences of identical samples
             for (size_t i = 1; i < columnIndices.size(); i++)
             {
-                size_t refId = (int)firstSeq(0, columnIndices[i]);
+                size_t refId = (int)firstSeq[columnIndices[i]];
                 if (lastId != refId)
                 {
                     lastId = refId;
@@ -755,12 +682,75 @@ private:
         {
             for (size_t i = 1; i < columnIndices.size(); i++)
             {
-                auto refId = (int)firstSeq(0, columnIndices[i]);
+                auto refId = (int)firstSeq[columnIndices[i]];
                 if (std::find(tokensToIgnore.begin(), tokensToIgnore.end(), refId) == tokensToIgnore.end())
                     out_SampleSeqVec.push_back(refId);
             }
         }
     }
+
+    // Returns the number of insertions, deletions and substitutions of the minimum-cost alignment of two sequences.
+    // The dynamic program runs along the anti-diagonals i + j = d of the grid, whose cells only depend on the two previous
+    // anti-diagonals, so that the loop over a diagonal is free of dependencies and branches and can be vectorized.
+    // Ties are broken as substitution, then deletion, then insertion.
+    static float ComputeNumErrors(const std::vector<int>& firstSeqVec, const std::vector<int>& secondSeqVec, float subPen, float delPen, float insPen)
+    {
+        const int firstSize = (int)firstSeqVec.size();
+        const int secondSize = (int)secondSeqVec.size();
+        if (firstSize == 0 || secondSize == 0)
+            return (float)(firstSize + secondSize);
+
+        // second sequence reversed, so that cells (i, d - i) of a diagonal compare with consecutive samples
+        std::vector<int> secondReversed(secondSeqVec.rbegin(), secondSeqVec.rend());
+
+        // [diagonal d % 3][i]: edit distance, and numbers of insertions, deletions and substitutions of cell (i, d - i)
+        std::vector<float> grid[3], ins[3], del[3], sub[3];
+        for (int k = 0; k < 3; k++)
+        {
+            grid[k].assign(firstSize + 1, 0.0f);
+            ins[k].assign(firstSize + 1, 0.0f);
+            del[k].assign(firstSize + 1, 0.0f);
+            sub[k].assign(firstSize + 1, 0.0f);
+        }
+
+        for (int d = 0; d <= firstSize + secondSize; d++)
+        {
+            float* curGrid = grid[d % 3].data(); float* curIns = ins[d % 3].data(); float* curDel = del[d % 3].data(); float* curSub = sub[d % 3].data();
+            const float* prevGrid = grid[(d + 2) % 3].data(); const float* prevIns = ins[(d + 2) % 3].data(); const float* prevDel = del[(d + 2) % 3].data(); const float* prevSub = sub[(d + 2) % 3].data();
+            const float* diagGrid = grid[(d + 1) % 3].data(); const float* diagIns = ins[(d + 1) % 3].data(); const float* diagDel = del[(d + 1) % 3].data(); const float* diagSub = sub[(d + 1) % 3].data();
+
+            // first and last row/column of the grid
+            if (d <= secondSize)
+            {
+                curGrid[0] = (float)(d * insPen); curIns[0] = (float)d; curDel[0] = 0.0f; curSub[0] = 0.0f;
+            }
+            if (d <= firstSize)
+            {
+                curGrid[d] = (float)(d * delPen); curIns[d] = 0.0f; curDel[d] = (float)d; curSub[d] = 0.0f;
+            }
+
+            const int iBegin = std::max(1, d - secondSize);
+            const int iEnd = std::min(firstSize, d - 1);
+            for (int i = iBegin; i <= iEnd; i++)
+            {
+                // up: (i - 1, j) on the previous diagonal at i - 1, left: (i, j - 1) on the previous diagonal at i, diagonal: (i - 1, j - 1)
+                // secondReversed[secondSize - d + i] = secondSeqVec[j - 1]
+                const bool same = firstSeqVec[i - 1] == secondReversed[secondSize - d + i];
+                const float delCost = prevGrid[i - 1] + delPen;
+                const float insCost = prevGrid[i] + insPen;
+                const float subCost = diagGrid[i - 1] + subPen;
+                const bool isSub = same || (subCost <= delCost && subCost <= insCost);
+                const bool isDel = !isSub && delCost < insCost;
+                curGrid[i] = same ? diagGrid[i - 1] : isSub ? subCost : isDel ? delCost : insCost;
+                curIns[i] = isSub ? diagIns[i - 1] : isDel ? prevIns[i - 1] : prevIns[i] + 1.0f;
+                curDel[i] = isSub ? diagDel[i - 1] : isDel ? prevDel[i - 1] + 1.0f : prevDel[i];
+                curSub[i] = isSub ? diagSub[i - 1] + (same ? 0.0f : 1.0f) : isDel ? prevSub[i - 1] : prevSub[i];
+            }
+        }
+
+        const int last = (firstSize + secondSize) % 3;
+        return ins[last][firstSize] + del[last][firstSize] + sub[last][firstSize];
+    }
 };
 
 template class EditDistanceErrorNode<float>;
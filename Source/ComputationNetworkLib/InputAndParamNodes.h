@@ -576,10 +576,45 @@ public:
     {
     }
 
+    virtual void AllocateGradientMatricesForInputs(MatrixPool& matrixPool) override
+    {
+        Base::AllocateGradientMatricesForInputs(matrixPool);
+
+        // If the input is known to be sparse from the graph, the gradient of the embedding matrix is made sparse block column
+        // right away, instead of on the first backprop. Thus it has the same type on all workers of a parallel training from
+        // the start, also on those whose first minibatch is empty, so that they aggregate it in the same way.
+        // A sparse matrix is not shared by the MatrixPool, so the temporary one it just assigned is kept.
+        if (Input(0)->NeedsGradient() && Input(1)->IsValueSparse() && InputRef(0).GetPreferredGradientMatrixType() == UNDETERMINED)
+        {
+            InputRef(0).Gradient().SwitchToMatrixType(SPARSE, MatrixFormat::matrixFormatSparseBlockCol, /*keepValues=*/false);
+            InputRef(0).SetPreferredGradientMatrixType(SPARSE);
+        }
+    }
+
     virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& t) override
     {
         if (inputIndex == 0) // left derivative (embedding matrix)
         {
+            // The input may only turn out to be sparse at runtime, e.g. if it is not an input_variable.
+            if (InputRef(1).Value().GetMatrixType() == SPARSE &&
+                InputRef(0).GetPreferredGradientMatrixType() == UNDETERMINED &&
+                Gradient().GetMatrixType() == DENSE)
+            {
+                // Same as in TimesNode: for a sparse input the gradient of the embedding matrix is only non-zero in the columns
+                // of the words seen in the minibatch, so we keep it in sparse block column format. This is carried through
+                // gradient aggregation and the learners, so that the cost is proportional to the vocabulary touched per minibatch.
+                // A new matrix is allocated instead of switching the type in place, since the current one may be shared with other nodes.
+                auto& currentInput0GradientMatrixRef = InputRef(0).Gradient();
+                InputRef(0).GradientPtrRef() =
+                    std::make_shared<Matrix<ElemType>>(
+                        currentInput0GradientMatrixRef.GetNumRows(),
+                        currentInput0GradientMatrixRef.GetNumCols(),
+                        currentInput0GradientMatrixRef.GetPreferredDeviceId(),
+                        SPARSE,
+                        MatrixFormat::matrixFormatSparseBlockCol);
+                InputRef(0).SetPreferredGradientMatrixType(SPARSE);
+            }
+
             // This is a reduction operation, hence we need to mask out gaps.
             Matrix<ElemType> sliceInput1Value = InputRef(1).MaskedValueFor(t);
             Matrix<ElemType> sliceOutputGrad = MaskedGradientFor(t);
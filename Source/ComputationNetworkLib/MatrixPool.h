@@ -11,6 +11,7 @@
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <tuple>
 #include <utility>
 #include <algorithm>
 #include <stdlib.h>
@@ -32,8 +33,9 @@ struct MemRequestInfo
     int allocStep;                              // at what step counter memory allocation is requested 
     int releaseStep;                            // at what step counter memory release is requested  
     int memoryId;                               // integer indexing the memory buffer ID 
-    MemRequestInfo(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace, int allocStep)
-        :deviceId(deviceId), matrixSize(matrixSize), mbScale(mbScale), isWorkSpace(isWorkSpace), allocStep(allocStep), releaseStep(INT_MAX), memoryId(-1)
+    const void* owner;                          // node that requested the memory, if known
+    MemRequestInfo(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace, int allocStep, const void* owner = nullptr)
+        :deviceId(deviceId), matrixSize(matrixSize), mbScale(mbScale), isWorkSpace(isWorkSpace), allocStep(allocStep), releaseStep(INT_MAX), memoryId(-1), owner(owner)
     {
         pMatrixPtrs.push_back(pMatrixPtr);
     }
@@ -69,6 +71,16 @@ class MatrixPool
 public:
     typedef const void* AliasNodePtr; // use as an identifier in place of ComputationNodeBasePtr to avoid include order issue
 
+    // a memory request as planned by OptimizedMemoryAllocation(); requests with the same buffer key share one matrix
+    struct RequestSummary
+    {
+        AliasNodePtr owner;     // node that requested the memory, if known
+        size_t matrixSize;      // elements, per sample if mbScale
+        size_t elementBytes;
+        bool mbScale;
+        std::tuple<size_t, DEVICEID_TYPE, bool, int> bufferKey; // element size, device, workspace, memory id
+    };
+
 protected:
     vector<MemRequestInfo<float>> m_memRequestInfoFloatVec; 
     vector<MemRequestInfo<double>> m_memRequestInfoDoubleVec;
@@ -134,11 +146,12 @@ public:
     // global memory allocation optimziation is run to improve memory efficiency 
     // mbScale is another flag indicating if the size of the memory will scale w.r.t. the minibatch size. Unfortunately, at the time of memory
     // request and pointer assignment, we don't known the minibatch size. Thus our memory sharing algorithm is sub-optimal. 
+    // owner identifies the requesting node for GetRequests().
     template <class ElemType>
-    void RequestAllocate(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace)
+    void RequestAllocate(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace, AliasNodePtr owner = nullptr)
     {
         vector<MemRequestInfo<ElemType>>& memInfoVec = GetMemRequestInfoVec<ElemType>(); 
-        MemRequestInfo<ElemType> memInfo(deviceId, pMatrixPtr, matrixSize, mbScale, isWorkSpace, m_stepCounter);
+        MemRequestInfo<ElemType> memInfo(deviceId, pMatrixPtr, matrixSize, mbScale, isWorkSpace, m_stepCounter, owner);
         memInfoVec.push_back(memInfo); 
         m_deviceIDSet.insert(deviceId); 
         m_stepCounter++; 
@@ -156,6 +169,17 @@ public:
         return; 
     }
 
+    // The requests that share memory after OptimizedMemoryAllocation(). Sparse matrices do not take part in the sharing and are not included.
+    // Aliased requests appear once, for the node that made the first request of the group.
+    vector<RequestSummary> GetRequests() const
+    {
+        vector<RequestSummary> requests;
+        AppendRequests(m_memRequestInfoFloatVec, requests);
+        AppendRequests(m_memRequestInfoDoubleVec, requests);
+        AppendRequests(m_memRequestInfoHalfVec, requests);
+        return requests;
+    }
+
     void SetAliasInfo(
         const unordered_map<AliasNodePtr, unordered_set<AliasNodePtr>>& groupMap,
         const unordered_map<AliasNodePtr, AliasNodePtr>& rootLookupMap)
@@ -217,7 +241,7 @@ public:
         {
             // first allocation for the group
             aliasInfo.pMatrixPtr = pMatrixPtr;
-            RequestAllocate(deviceId, pMatrixPtr, matrixSize, mbScale, false);
+            RequestAllocate(deviceId, pMatrixPtr, matrixSize, mbScale, false, node);
         }
         else
         {
@@ -228,6 +252,23 @@ public:
     }
 
 private: 
+    template <class ElemType>
+    static void AppendRequests(const vector<MemRequestInfo<ElemType>>& memInfoVec, vector<RequestSummary>& requests)
+    {
+        for (const auto& memInfo : memInfoVec)
+        {
+            if (memInfo.memoryId < 0) // not planned yet
+                continue;
+            RequestSummary request;
+            request.owner = memInfo.owner;
+            request.matrixSize = memInfo.matrixSize;
+            request.elementBytes = sizeof(ElemType);
+            request.mbScale = memInfo.mbScale;
+            request.bufferKey = std::make_tuple(sizeof(ElemType), memInfo.deviceId, memInfo.isWorkSpace, memInfo.memoryId);
+            requests.push_back(request);
+        }
+    }
+
     bool CheckOverlap(pair<int, int>occ, vector<pair<int, int>>&occVec)
     {
         bool bRet = false;
@@ -0,0 +1,394 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "ComputationNode.h"
+#include "MatrixPool.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// ===========================================================================
+// NodeProfiler -- opt-in per-node statistics of ForwardProp() and Backprop()
+//
+// Records wall time, an estimate of the floating-point operations, and the bytes of Value/Gradient
+// touched per call, plus the memory each node requested from the MatrixPool. The pool shares its
+// matrices between nodes, so the memory is taken from the requests (see SetMatrixPoolRequests())
+// rather than from the matrices, which would count a shared matrix for each node that uses it; the
+// matrices the pool actually allocates are reported separately. Statistics are aggregated until
+// Reset(), e.g. over an epoch, and printed per node and per operation, sorted by time.
+//
+// Enable with ComputationNetwork::EnableNodeProfiling(). Each call can additionally be forwarded
+// to the PerformanceProfiler through SetEventSink(); ComputationNetworkLib does not link against it.
+// Note that on the GPU, times only reflect execution if the sink synchronizes the device
+// (e.g. profilerSyncGpu); otherwise they are launch times.
+// ===========================================================================
+
+class NodeProfiler
+{
+public:
+    // hooks into an external profiler
+    struct EventSink
+    {
+        std::function<long long()> timeBegin;                    // returns a state id, e.g. ProfilerTimeBegin()
+        std::function<void(long long, const char*)> timeEnd;     // e.g. ProfilerTimeEnd()
+        std::function<void()> syncGpu;                           // e.g. ProfilerSyncGpu()
+    };
+
+    void SetEventSink(const EventSink& sink)
+    {
+        m_sink = sink;
+    }
+
+    // waits for the GPU if the sink asks for it, so that times measured outside a Scope reflect execution
+    void SyncGpu() const
+    {
+        if (m_sink.syncGpu)
+            m_sink.syncGpu();
+    }
+
+    // measures one ForwardProp() or Backprop() call of a node
+    class Scope
+    {
+        NodeProfiler* m_profiler;
+        const ComputationNodeBase* m_node;
+        bool m_isBackprop;
+        double m_frameFraction;
+        double m_sharedSeconds;
+        long long m_sinkStateId;
+        std::chrono::steady_clock::time_point m_begin;
+
+    public:
+        Scope(NodeProfiler* profiler, const ComputationNodeBasePtr& node, const FrameRange& fr, bool isBackprop)
+            : m_profiler(nullptr), m_node(node.get()), m_isBackprop(isBackprop), m_frameFraction(1.0), m_sharedSeconds(0), m_sinkStateId(0)
+        {
+            // loops are profiled through the nodes they contain
+            if (!profiler || dynamic_cast<const FlowControlNode*>(m_node))
+                return;
+
+            m_profiler = profiler;
+            // calls on a single time step (recurrent loops) only touch that part of the minibatch
+            if (!fr.IsAllFrames() && m_node->HasMBLayout() && m_node->GetMBLayout()->GetNumTimeSteps() > 0)
+                m_frameFraction = 1.0 / m_node->GetMBLayout()->GetNumTimeSteps();
+            if (m_profiler->m_sink.timeBegin)
+                m_sinkStateId = m_profiler->m_sink.timeBegin();
+            m_begin = std::chrono::steady_clock::now();
+        }
+
+        ~Scope()
+        {
+            if (!m_profiler)
+                return;
+
+            m_profiler->SyncGpu();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_begin).count() + m_sharedSeconds;
+            m_profiler->Record(*m_node, m_isBackprop, seconds, m_frameFraction, m_sinkStateId);
+        }
+
+        // charges this node its share of work done outside the scope for several nodes at once,
+        // e.g. of the stacked matrix product of a recurrent loop
+        void AddSharedSeconds(double seconds)
+        {
+            m_sharedSeconds += seconds;
+        }
+    };
+
+    // the requests of the MatrixPool, as planned by ComputationNetwork::AllocateAllMatrices(); kept across Reset()
+    void SetMatrixPoolRequests(const std::vector<MatrixPool::RequestSummary>& requests)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_poolRequests = requests;
+    }
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nodes.clear();
+    }
+
+    // statistics aggregated for a node or an operation
+    struct NodeStats
+    {
+        std::wstring nodeName;
+        std::wstring operationName;
+        std::string forwardEventName;  // for the event sink
+        std::string backwardEventName;
+        size_t forwardCalls = 0;
+        size_t backwardCalls = 0;
+        double forwardSeconds = 0;
+        double backwardSeconds = 0;
+        double flops = 0;
+        double bytesTouched = 0;
+        size_t numColumns = 0;  // columns of the Value as of the last call, to size the requests that scale with the minibatch
+        double memoryBytes = 0; // MatrixPool requests, filled in by Print()
+
+        double TotalSeconds() const { return forwardSeconds + backwardSeconds; }
+
+        void Accumulate(const NodeStats& other)
+        {
+            operationName = other.operationName;
+            forwardCalls += other.forwardCalls;
+            backwardCalls += other.backwardCalls;
+            forwardSeconds += other.forwardSeconds;
+            backwardSeconds += other.backwardSeconds;
+            flops += other.flops;
+            bytesTouched += other.bytesTouched;
+            memoryBytes += other.memoryBytes;
+        }
+    };
+
+    // statistics of a node, or nullptr if it was not called since Reset(); valid until Reset()
+    const NodeStats* GetStats(const ComputationNodeBase* node) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto iter = m_nodes.find(node);
+        return iter == m_nodes.end() ? nullptr : &iter->second;
+    }
+
+    // bytes of the MatrixPool requests of a node, at the minibatch size of its last call
+    double GetRequestedBytes(const ComputationNodeBase* node) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return RequestedBytes(CollectRequests(), node);
+    }
+
+    // bytes of the matrices the MatrixPool allocates for the requests of the nodes called since Reset(), and their number
+    double GetPoolBytes(size_t* numBuffers = nullptr) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return PoolBytes(numBuffers);
+    }
+
+    // print per-node and per-operation tables, sorted by total time
+    void Print(FILE* f) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto requests = CollectRequests();
+        std::vector<NodeStats> allStats;
+        for (const auto& entry : m_nodes)
+        {
+            allStats.push_back(entry.second);
+            allStats.back().memoryBytes = RequestedBytes(requests, entry.first);
+        }
+
+        std::vector<const NodeStats*> nodes;
+        std::map<std::wstring, NodeStats> operations;
+        std::map<std::wstring, size_t> operationNodeCounts;
+        double totalSeconds = 0;
+        for (const auto& stats : allStats)
+        {
+            nodes.push_back(&stats);
+            operations[stats.operationName].Accumulate(stats);
+            operationNodeCounts[stats.operationName]++;
+            totalSeconds += stats.forwardSeconds + stats.backwardSeconds;
+        }
+        auto byTime = [](const NodeStats* a, const NodeStats* b) { return a->TotalSeconds() > b->TotalSeconds(); };
+        std::sort(nodes.begin(), nodes.end(), byTime);
+
+        fprintf(f, "\nPer-node profile (%d nodes, %.3f s total):\n", (int)nodes.size(), totalSeconds);
+        PrintHeader(f, "Node");
+        for (const auto* stats : nodes)
+            PrintStats(f, *stats, totalSeconds, stats->nodeName + L" : " + stats->operationName);
+
+        std::vector<const NodeStats*> ops;
+        for (const auto& entry : operations)
+            ops.push_back(&entry.second);
+        std::sort(ops.begin(), ops.end(), byTime);
+
+        fprintf(f, "\nPer-operation profile (%d operations):\n", (int)ops.size());
+        PrintHeader(f, "Operation");
+        for (const auto* stats : ops)
+            PrintStats(f, *stats, totalSeconds, stats->operationName + L" (" + std::to_wstring(operationNodeCounts.at(stats->operationName)) + L" nodes)");
+
+        size_t numBuffers = 0;
+        double poolBytes = PoolBytes(&numBuffers);
+        fprintf(f, "\nMatrixPool: %d matrices, %.1f MB, shared by the requests of these nodes (Memory column).\n\n", (int)numBuffers, poolBytes / (1024.0 * 1024.0));
+    }
+
+private:
+    // sizes of a node's Value and Gradient matrices
+    struct MatrixSizes
+    {
+        size_t valueElements = 0;
+        size_t valueColumns = 0;
+        size_t gradientElements = 0;
+        size_t elementBytes = 0;
+    };
+
+    // bytes of a pool request, at the minibatch size of the last call of its node
+    static double RequestBytes(const MatrixPool::RequestSummary& request, const NodeStats& stats)
+    {
+        return (double)request.matrixSize * request.elementBytes * (request.mbScale ? stats.numColumns : 1);
+    }
+
+    // pool requests of the nodes called since Reset(), by node
+    std::unordered_map<const void*, std::vector<const MatrixPool::RequestSummary*>> CollectRequests() const
+    {
+        std::unordered_map<const void*, std::vector<const MatrixPool::RequestSummary*>> requests;
+        for (const auto& request : m_poolRequests)
+        {
+            if (m_nodes.find((const ComputationNodeBase*)request.owner) != m_nodes.end())
+                requests[request.owner].push_back(&request);
+        }
+        return requests;
+    }
+
+    double RequestedBytes(const std::unordered_map<const void*, std::vector<const MatrixPool::RequestSummary*>>& requests, const ComputationNodeBase* node) const
+    {
+        auto iter = requests.find(node);
+        if (iter == requests.end())
+            return 0;
+        const auto& stats = m_nodes.at(node);
+        double bytes = 0;
+        for (const auto* request : iter->second)
+            bytes += RequestBytes(*request, stats);
+        return bytes;
+    }
+
+    // each shared matrix is as large as the largest request it serves
+    double PoolBytes(size_t* numBuffers) const
+    {
+        std::map<std::tuple<size_t, DEVICEID_TYPE, bool, int>, double> buffers;
+        for (const auto& entry : CollectRequests())
+        {
+            const auto& stats = m_nodes.at((const ComputationNodeBase*)entry.first);
+            for (const auto* request : entry.second)
+            {
+                auto& bytes = buffers[request->bufferKey];
+                bytes = std::max(bytes, RequestBytes(*request, stats));
+            }
+        }
+        double bytes = 0;
+        for (const auto& buffer : buffers)
+            bytes += buffer.second;
+        if (numBuffers)
+            *numBuffers = buffers.size();
+        return bytes;
+    }
+
+    template <class ElemType>
+    static bool GetTypedMatrixSizes(const ComputationNodeBase* node, MatrixSizes& sizes)
+    {
+        auto typedNode = dynamic_cast<const ComputationNode<ElemType>*>(node);
+        if (!typedNode)
+            return false;
+        sizes.elementBytes = sizeof(ElemType);
+        auto value = static_cast<const Matrix<ElemType>*>(typedNode->ValuePtr().get());
+        auto gradient = static_cast<const Matrix<ElemType>*>(typedNode->GradientPtr().get());
+        if (value)
+        {
+            sizes.valueElements = value->GetNumElements();
+            sizes.valueColumns = value->GetNumCols();
+        }
+        if (gradient)
+            sizes.gradientElements = gradient->GetNumElements();
+        return true;
+    }
+
+    static MatrixSizes GetMatrixSizes(const ComputationNodeBase* node)
+    {
+        MatrixSizes sizes;
+        GetTypedMatrixSizes<float>(node, sizes) || GetTypedMatrixSizes<double>(node, sizes) || GetTypedMatrixSizes<half>(node, sizes);
+        return sizes;
+    }
+
+    // Rough number of floating-point operations of one forward pass over numOutputElements outputs.
+    // Products count a multiply-add per inner dimension element; everything else is treated as element-wise.
+    static double EstimateForwardFlops(const ComputationNodeBase& node, size_t numOutputElements)
+    {
+        const auto& op = node.OperationName();
+        const auto& sampleLayout = node.GetSampleLayout();
+        if ((op == L"Times" || op == L"TransposeTimes") && node.GetNumInputs() == 2 && sampleLayout.GetNumElements() > 0)
+        {
+            double innerDim = (double)node.GetInputs()[0]->GetSampleLayout().GetNumElements() / sampleLayout.GetNumElements();
+            return 2.0 * numOutputElements * innerDim;
+        }
+        if (op == L"Convolution" && node.GetNumInputs() >= 2 && sampleLayout.GetRank() > 0)
+        {
+            // kernel: [outputChannels x kernelSize*inputChannels], output channels are the last dimension
+            double kernelSize = (double)node.GetInputs()[0]->GetSampleLayout().GetNumElements() / sampleLayout.GetDims().back();
+            return 2.0 * numOutputElements * kernelSize;
+        }
+        return (double)numOutputElements;
+    }
+
+    void Record(const ComputationNodeBase& node, bool isBackprop, double seconds, double frameFraction, long long sinkStateId)
+    {
+        // sizes of what this call reads and writes
+        auto sizes = GetMatrixSizes(&node);
+        size_t numInputElements = 0;
+        for (const auto& input : node.GetInputs())
+            numInputElements += GetMatrixSizes(input.get()).valueElements;
+
+        double flops = EstimateForwardFlops(node, sizes.valueElements) * frameFraction;
+        double elementsTouched = (double)(sizes.valueElements + numInputElements) * frameFraction;
+        if (isBackprop)
+        {
+            flops *= 2; // gradients w.r.t. inputs and parameters
+            elementsTouched += (double)(sizes.gradientElements + numInputElements) * frameFraction;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto& stats = m_nodes[&node];
+        if (stats.nodeName.empty())
+        {
+            stats.nodeName = node.NodeName();
+            stats.operationName = node.OperationName();
+            stats.forwardEventName = "Forward " + msra::strfun::utf8(stats.nodeName);
+            stats.backwardEventName = "Backprop " + msra::strfun::utf8(stats.nodeName);
+        }
+        if (isBackprop)
+        {
+            stats.backwardCalls++;
+            stats.backwardSeconds += seconds;
+        }
+        else
+        {
+            stats.forwardCalls++;
+            stats.forwardSeconds += seconds;
+        }
+        stats.flops += flops;
+        stats.bytesTouched += elementsTouched * sizes.elementBytes;
+        stats.numColumns = sizes.valueColumns;
+
+        if (m_sink.timeEnd)
+            m_sink.timeEnd(sinkStateId, (isBackprop ? stats.backwardEventName : stats.forwardEventName).c_str());
+    }
+
+    static void PrintHeader(FILE* f, const char* what)
+    {
+        fprintf(f, "%12s %12s %12s %6s %10s %10s %12s %12s %12s  %s\n",
+                "Forward(ms)", "Backprop(ms)", "Total(ms)", "%", "FwdCalls", "BwdCalls", "GFLOP", "Touched(MB)", "Memory(MB)", what);
+    }
+
+    static void PrintStats(FILE* f, const NodeStats& stats, double totalSeconds, const std::wstring& what)
+    {
+        fprintf(f, "%12.3f %12.3f %12.3f %6.2f %10d %10d %12.3f %12.1f %12.1f  %ls\n",
+                stats.forwardSeconds * 1000, stats.backwardSeconds * 1000, stats.TotalSeconds() * 1000,
+                totalSeconds > 0 ? 100.0 * stats.TotalSeconds() / totalSeconds : 0.0,
+                (int)stats.forwardCalls, (int)stats.backwardCalls,
+                stats.flops / 1e9, stats.bytesTouched / (1024.0 * 1024.0), stats.memoryBytes / (1024.0 * 1024.0),
+                what.c_str());
+    }
+
+    EventSink m_sink;
+    mutable std::mutex m_mutex; // nodes may be evaluated from several threads
+    std::unordered_map<const ComputationNodeBase*, NodeStats> m_nodes;
+    std::vector<MatrixPool::RequestSummary> m_poolRequests;
+};
+
+}}}
@@ -124,46 +124,40 @@ template<class ElemType, int direction>
     // So the V2 library just sets the sequence tBegin to be SentinelValueIndicatingUnspecifedSequenceBeginIdx if the sequence
     // does not begin in the current MB and we patch the actual tBegin in by obtaining the info from the saved m_delayedActivationMBLayout.
 
-    // Collect the trailing sequences in each parallel stream in the previous MB
-    // TODO: Switch to a vector instead of an unordered_map
-    std::unordered_map<size_t, MBLayout::SequenceInfo> trailingSequencesOfLastMB;
-    if (m_delayedActivationMBLayout)
+    // This is only needed if the current MB has any such truncated sequence, which is not the case for most MBs
+    // even in truncated BPTT, since the readers pass the actual begin time-index.
+    const auto& currentMBSequences = m_pMBLayout->GetAllSequences();
+    bool anySequencesToPatch = std::any_of(currentMBSequences.begin(), currentMBSequences.end(), [](const MBLayout::SequenceInfo& sequenceInfo)
     {
-        const auto& prevMBSequences = m_delayedActivationMBLayout->GetAllSequences();
-        for (const auto& sequenceInfo : prevMBSequences)
+        return sequenceInfo.seqId != GAP_SEQUENCE_ID && sequenceInfo.tBegin == SentinelValueIndicatingUnspecifedSequenceBeginIdx;
+    });
+    if (anySequencesToPatch)
+    {
+        // Collect the trailing sequence in each parallel stream in the previous MB
+        std::vector<const MBLayout::SequenceInfo*> trailingSequencesOfLastMB(m_delayedActivationMBLayout ? m_delayedActivationMBLayout->GetNumParallelSequences() : 0, nullptr);
+        if (m_delayedActivationMBLayout)
         {
-            if (sequenceInfo.seqId != GAP_SEQUENCE_ID)
+            for (const auto& sequenceInfo : m_delayedActivationMBLayout->GetAllSequences())
             {
-                auto insertPos = trailingSequencesOfLastMB.insert({ sequenceInfo.s, sequenceInfo });
-                if (!insertPos.second)
-                {
-                    if (trailingSequencesOfLastMB[sequenceInfo.s].tBegin < sequenceInfo.tBegin)
-                        trailingSequencesOfLastMB[sequenceInfo.s] = sequenceInfo;
-                }
+                auto& trailingSequence = trailingSequencesOfLastMB[sequenceInfo.s];
+                if (sequenceInfo.seqId != GAP_SEQUENCE_ID && (!trailingSequence || trailingSequence->tBegin < sequenceInfo.tBegin))
+                    trailingSequence = &sequenceInfo;
             }
         }
-    }
 
-    bool anySequencesPatched = false;
-    std::vector<MBLayout::SequenceInfo> patchedMBSequences = m_pMBLayout->GetAllSequences();
-    for (auto& patchedSequenceInfo : patchedMBSequences)
-    {
-        if (patchedSequenceInfo.seqId != GAP_SEQUENCE_ID)
+        std::vector<MBLayout::SequenceInfo> patchedMBSequences = currentMBSequences;
+        for (auto& patchedSequenceInfo : patchedMBSequences)
         {
-            if (patchedSequenceInfo.tBegin == SentinelValueIndicatingUnspecifedSequenceBeginIdx)
+            if (patchedSequenceInfo.seqId != GAP_SEQUENCE_ID && patchedSequenceInfo.tBegin == SentinelValueIndicatingUnspecifedSequenceBeginIdx)
             {
-                if (trailingSequencesOfLastMB.find(patchedSequenceInfo.s) == trailingSequencesOfLastMB.end())
+                if (patchedSequenceInfo.s >= trailingSequencesOfLastMB.size() || !trailingSequencesOfLastMB[patchedSequenceInfo.s])
                     LogicError("No matching sequence found in the saved previous MBLayout to determine the real tBegin from for a truncated sequence in the current MBLayout");
 
-                anySequencesPatched = true;
-                patchedSequenceInfo.tBegin = trailingSequencesOfLastMB[patchedSequenceInfo.s].tBegin - m_delayedActivationMBLayout->GetNumTimeSteps();
+                patchedSequenceInfo.tBegin = trailingSequencesOfLastMB[patchedSequenceInfo.s]->tBegin - m_delayedActivationMBLayout->GetNumTimeSteps();
             }
         }
-    }
 
-    // Now reconstruct the MBLayout with patched sequences if needed
-    if (anySequencesPatched)
-    {
+        // Now reconstruct the MBLayout with patched sequences
         auto newMBLayout = make_shared<MBLayout>();
         newMBLayout->Init(m_pMBLayout->GetNumParallelSequences(), m_pMBLayout->GetNumTimeSteps());
         for (auto sequence : patchedMBSequences)
@@ -398,17 +392,37 @@ template<class ElemType, int direction>
 {
     // In truncated BPTT, we carry over left-to-right state across minibatches.
     // It is kept in m_delayedValue, m_delayedActivationMBLayout.
-    // This could be optimized as follows:
-    //  - only keep the required number of frames (m_timeStep)
+    // If a sequence spans across the end of the MB, only the last m_timeStep frames can be accessed by the next MB,
+    // so we only keep those, as a shortened copy of the MB with the layout shifted accordingly. Since the number of
+    // kept frames does not depend on the MB size, m_delayedValue keeps its size from one MB to the next.
+    // Otherwise we keep the entire MB, since ExportState() and EndStreamingMinibatch() may refer to any frame.
+    // This could be further optimized as follows:
     //  - we don't need to keep anything in full-sequence mode
     //  - we don't need to keep anything if all sequences are closed (sentence end)
     //    This condition includes full-sequence mode.
-    // TODO: Can we optimize this and only copy if there is a sequence spanning across the end of the MB? And add a check to BeginForwardProp() to make sure we got one if there is a boundary at the start?
-    m_delayedValue->SetValue(InputRef(0).Value());
     if (!m_delayedActivationMBLayout)
         m_delayedActivationMBLayout = make_shared<MBLayout>();
-    m_delayedActivationMBLayout->CopyFrom(m_pMBLayout);
-    // Perf BUGBUG: ^^ This copies a matrix from CPU to GPU at each MB; we should short-circuit it
+    int dir = direction; // (this avoids a 'conditional expression is constant' warning)
+    let T = GetNumTimeSteps();
+    if (dir < 0 && m_timeStep < T && m_pMBLayout->HasSequenceBeyondEnd())
+    {
+        let S = GetNumParallelSequences();
+        let firstKeptFrame = T - m_timeStep;
+        m_delayedValue->SetValue(InputRef(0).Value().ColumnSlice(firstKeptFrame * S, m_timeStep * S));
+        m_delayedActivationMBLayout->Init(S, m_timeStep);
+        m_delayedActivationMBLayout->SetAxisName(m_pMBLayout->GetAxisName());
+        for (const auto& sequenceInfo : m_pMBLayout->GetAllSequences())
+        {
+            if (sequenceInfo.tEnd > firstKeptFrame)
+                m_delayedActivationMBLayout->AddSequence(sequenceInfo.seqId, sequenceInfo.s, sequenceInfo.tBegin - (ptrdiff_t)firstKeptFrame, sequenceInfo.tEnd - firstKeptFrame);
+        }
+    }
+    else
+    {
+        m_delayedValue->SetValue(InputRef(0).Value());
+        m_delayedActivationMBLayout->CopyFrom(m_pMBLayout);
+        // Perf BUGBUG: ^^ This copies a matrix from CPU to GPU at each MB; we should short-circuit it
+    }
 
     Base::EndForwardProp();
 }
@@ -528,8 +542,10 @@ template<class ElemType, int direction>
         }
         else
         {
+            // (EndForwardProp() may have kept only the last frames of the MB)
+            size_t nTDelayed = m_delayedActivationMBLayout->GetNumTimeSteps();
             auto pState = make_shared<DelayedValueNodeState<ElemType>>(m_deviceId);
-            pState->CacheState(m_delayedValue->ColumnSlice((nT - 1) * nU, nU));
+            pState->CacheState(m_delayedValue->ColumnSlice((nTDelayed - 1) * nU, nU));
             pState->CacheDelayedMBLayout(m_delayedActivationMBLayout);
             pExportedState = pState;
         }
@@ -584,6 +600,69 @@ template<class ElemType, int direction>
         LogicError("Unrecognized direction in DelayedValueNodeBase");
 }
 
+// resizes m_streamValues to the given number of parallel sequences, keeping the values of the existing streams
+// Returns the number of streams that have a saved value.
+template<class ElemType, int direction>
+/*private*/ size_t DelayedValueNodeBase<ElemType, direction>::ResizeStreamValues(size_t numStreams)
+{
+    size_t numSavedStreams = m_streamValues ? m_streamValues->GetNumCols() : 0;
+    if (numSavedStreams != numStreams)
+    {
+        auto streamValues = make_shared<Matrix<ElemType>>(GetSampleMatrixNumRows(), numStreams, m_deviceId);
+        streamValues->SetValue(0);
+        size_t numKept = min(numSavedStreams, numStreams);
+        if (numKept > 0)
+            streamValues->SetColumnSlice(m_streamValues->ColumnSlice(0, numKept), 0, numKept);
+        m_streamValues = streamValues;
+        numSavedStreams = numKept;
+    }
+    return numSavedStreams;
+}
+
+template<class ElemType, int direction>
+void DelayedValueNodeBase<ElemType, direction>::BeginStreamingMinibatch(const std::vector<bool>& continuesStream)
+{
+    int dir = direction;
+    if (dir != -1 || m_timeStep != 1)
+        RuntimeError("%ls %ls operation: Streaming inference is only supported for PastValue with a time step of 1.", NodeName().c_str(), OperationName().c_str());
+
+    size_t numStreams = continuesStream.size();
+    size_t numSavedStreams = ResizeStreamValues(numStreams);
+
+    // The saved values look like a previous minibatch of one frame, in which the sequences of the continuing streams end.
+    // BeginForwardProp() then patches their sequences in the next minibatch to begin at frame -1.
+    m_delayedValue->SetValue(*m_streamValues);
+    if (!m_delayedActivationMBLayout)
+        m_delayedActivationMBLayout = make_shared<MBLayout>();
+    m_delayedActivationMBLayout->Init(numStreams, 1);
+    for (size_t s = 0; s < numStreams; s++)
+    {
+        if (!continuesStream[s])
+            m_delayedActivationMBLayout->AddGap(s, 0, 1);
+        else if (s < numSavedStreams)
+            m_delayedActivationMBLayout->AddSequence(s, s, 0, 1);
+        else
+            LogicError("%ls %ls operation: No saved value to continue the stream in parallel sequence %d from.", NodeName().c_str(), OperationName().c_str(), (int)s);
+    }
+}
+
+template<class ElemType, int direction>
+void DelayedValueNodeBase<ElemType, direction>::EndStreamingMinibatch(const std::vector<size_t>& lastFrames)
+{
+    // m_delayedValue and m_delayedActivationMBLayout now hold the input of the minibatch (see EndForwardProp()).
+    // The first minibatch may have been run without BeginStreamingMinibatch() since all its streams are new.
+    size_t numStreams = lastFrames.size();
+    if (!m_delayedActivationMBLayout || m_delayedActivationMBLayout->GetNumParallelSequences() != numStreams)
+        LogicError("%ls %ls operation: The minibatch does not have one parallel sequence per stream.", NodeName().c_str(), OperationName().c_str());
+
+    ResizeStreamValues(numStreams);
+    for (size_t s = 0; s < numStreams; s++)
+    {
+        if (lastFrames[s] != SIZE_MAX)
+            m_streamValues->SetColumnSlice(m_delayedValue->ColumnSlice(lastFrames[s] * numStreams + s, 1), s, 1);
+    }
+}
+
 // instantiate the classes that derive from the above
 template class PastValueNode<float>;
 template class PastValueNode<double>;
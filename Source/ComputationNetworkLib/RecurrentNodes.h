@@ -31,6 +31,7 @@ class DelayedValueNodeBase : public ComputationNode<ElemType>, public IRecurrent
 
 private:
     TensorView<ElemType> GetMaskTensor(size_t rank, const FrameRange& fr) const;
+    size_t ResizeStreamValues(size_t numStreams);
 
 protected:
     DelayedValueNodeBase(DEVICEID_TYPE deviceId, const wstring& name, ElemType fixedInitialStateScalarValue, const TensorShape& sampleLayout, size_t timeStep);
@@ -76,6 +77,14 @@ public:
     int TimeStep() const { return m_timeStep; }
     ElemType InitialActivationValue() const { return m_initialStateValue; }
 
+    // Streaming inference (see CNTK::StreamingEvaluator): each parallel sequence of the minibatch holds the next chunk of an input stream,
+    // which continues from the value of the last frame of the previous chunk of that stream, whatever the lengths of both chunks.
+    // BeginStreamingMinibatch() makes the saved stream values the delayed values of the next minibatch, where parallel sequence s
+    // continues its stream if continuesStream[s]. EndStreamingMinibatch() saves the value of frame lastFrames[s] of each parallel
+    // sequence s as its stream value, or keeps the saved one for SIZE_MAX (no input in this minibatch).
+    void BeginStreamingMinibatch(const std::vector<bool>& continuesStream);
+    void EndStreamingMinibatch(const std::vector<size_t>& lastFrames);
+
 protected:
     ElemType m_initialStateValue;                           // starting value for hidden activation vector at boundary
     int m_timeStep;                                         // delay in frames (typ. 1)
@@ -92,6 +101,7 @@ protected:
 
     shared_ptr<Matrix<ElemType>> m_delayedValue;            // saves the activation of the previous step that this node points to
     MBLayoutPtr m_delayedActivationMBLayout;                // layout for m_delayedValue
+    shared_ptr<Matrix<ElemType>> m_streamValues;            // [j] value of the last frame of the stream in parallel sequence j, for streaming inference
 };
 
 #define UsingDelayedValueNodeMembers        \
@@ -5,6 +5,7 @@
 
 #include "TrainingNodes.h"
 #include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -307,6 +308,332 @@ template class RandomSampleInclusionFrequencyNode<float>;
 template class RandomSampleInclusionFrequencyNode<double>;
 template class RandomSampleInclusionFrequencyNode<half>;
 
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const
+{
+    Base::CopyTo(nodeP, newName, flags);
+    if (flags & CopyNodeFlags::copyNodeValue)
+    {
+        auto node = dynamic_pointer_cast<SampledSoftmaxNode<ElemType>>(nodeP);
+        node->m_sizeOfSampledSet = m_sizeOfSampledSet;
+        node->SetRngState(GetRngSeed(), GetRngOffset());
+    }
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::Save(File& fstream) const
+{
+    Base::Save(fstream);
+    fstream << m_sizeOfSampledSet;
+    RngUser::Save(fstream);
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::Load(File& fstream, size_t modelVersion)
+{
+    Base::Load(fstream, modelVersion);
+    fstream >> m_sizeOfSampledSet;
+    RngUser::Load(fstream, modelVersion);
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::UpdateAliasTable()
+{
+    const size_t numClasses = Input(0)->GetSampleMatrixNumRows();
+    const bool hasSamplingWeights = GetNumInputs() > 4;
+    if (hasSamplingWeights ? Input(4)->GetEvalTimeStamp() == m_samplingWeightsTimeStamp : m_aliasProbability.size() == numClasses)
+        return;
+
+    // sampling probabilities
+    std::vector<double> probabilities(numClasses);
+    if (hasSamplingWeights)
+    {
+        const Matrix<ElemType>& samplingWeights = Input(4)->ValueAsMatrix();
+        std::vector<ElemType> weights(numClasses);
+        ElemType* weightsData = weights.data();
+        samplingWeights.CopySection(samplingWeights.GetNumRows(), samplingWeights.GetNumCols(), weightsData, samplingWeights.GetNumRows());
+        double sumOfWeights = 0;
+        for (size_t k = 0; k < numClasses; k++)
+        {
+            probabilities[k] = (double)weights[k];
+            if (probabilities[k] < 0)
+                InvalidArgument("%ls %ls operation: Sampling weights contain negative number %f.", NodeName().c_str(), OperationName().c_str(), probabilities[k]);
+            sumOfWeights += probabilities[k];
+        }
+        if (sumOfWeights <= 0)
+            InvalidArgument("%ls %ls operation: Sampling weights must not all be zero.", NodeName().c_str(), OperationName().c_str());
+        for (auto& p : probabilities)
+            p /= sumOfWeights;
+        m_samplingWeightsTimeStamp = Input(4)->GetEvalTimeStamp();
+    }
+    else
+    {
+        const double logNumClasses = log((double)numClasses + 1);
+        for (size_t k = 0; k < numClasses; k++)
+            probabilities[k] = (log((double)k + 2) - log((double)k + 1)) / logNumClasses;
+    }
+
+    // Vose's alias method: split the classes into those with less and more than the average probability,
+    // and fill up each bucket of a small class with the excess of a large one.
+    m_aliasProbability.resize(numClasses);
+    m_aliasIndex.resize(numClasses);
+    std::vector<size_t> small, large;
+    for (size_t k = 0; k < numClasses; k++)
+    {
+        m_aliasProbability[k] = probabilities[k] * numClasses;
+        m_aliasIndex[k] = k;
+        (m_aliasProbability[k] < 1 ? small : large).push_back(k);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        size_t s = small.back(); small.pop_back();
+        size_t l = large.back();
+        m_aliasIndex[s] = l;
+        m_aliasProbability[l] -= 1 - m_aliasProbability[s];
+        if (m_aliasProbability[l] < 1)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // what remains is (up to rounding) exactly 1
+    for (auto k : small)
+        m_aliasProbability[k] = 1;
+    for (auto k : large)
+        m_aliasProbability[k] = 1;
+
+    // log of the expected number of occurrences in the sampled set; classes that are never sampled get the smallest
+    // representable probability, to keep the correction of their logits finite
+    std::vector<ElemType> logQ(numClasses);
+    std::vector<ElemType> classIds(numClasses);
+    for (size_t k = 0; k < numClasses; k++)
+    {
+        logQ[k] = (ElemType)log(std::max(probabilities[k], (double)std::numeric_limits<ElemType>::min()) * m_sizeOfSampledSet);
+        classIds[k] = (ElemType)k;
+    }
+    m_logQ.SetValue(1, numClasses, m_logQ.GetDeviceId(), logQ.data());
+    m_classIds.SetValue(1, numClasses, m_classIds.GetDeviceId(), classIds.data());
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::DrawSamples()
+{
+    const size_t numClasses = m_aliasProbability.size();
+    boost::random::uniform_int_distribution<size_t> drawClass(0, numClasses - 1);
+    boost::random::uniform_real_distribution<double> drawProbability(0, 1);
+    CPURNGHandle* cpuRNGHandle = dynamic_cast<CPURNGHandle*>(&GetRNGHandle(CPUDEVICE));
+
+    std::vector<ElemType> samples(m_sizeOfSampledSet);
+    m_sampledIdsOnHost.resize(m_sizeOfSampledSet);
+    for (size_t i = 0; i < m_sizeOfSampledSet; i++)
+    {
+        size_t k = drawClass(cpuRNGHandle->Generator());
+        k = drawProbability(cpuRNGHandle->Generator()) < m_aliasProbability[k] ? k : m_aliasIndex[k];
+        samples[i] = (ElemType)k;
+        m_sampledIdsOnHost[i] = (CPUSPARSE_INDEX_TYPE)k;
+    }
+    UpdateRngOffset(GetRngOffset() + 2 * m_sizeOfSampledSet);
+
+    m_sampledIds.SetValue(1, m_sizeOfSampledSet, m_sampledIds.GetDeviceId(), samples.data());
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::ForwardPropNonLooping()
+{
+    FrameRange fr(InputRef(0).GetMBLayout());
+    const size_t numClasses = Input(0)->GetSampleMatrixNumRows();
+    const size_t numSamples = m_sizeOfSampledSet;
+
+    UpdateAliasTable();
+    DrawSamples();
+
+    auto labels = InputRef(0).MaskedValueFor(fr);
+    auto input = InputRef(1).MaskedValueFor(fr);
+    const auto& weights = InputRef(2).ValueAsMatrix();
+    const auto bias = InputRef(3).ValueAsMatrix().Reshaped(1, numClasses);
+    const size_t numCols = input.GetNumCols();
+
+    // class index of each label (0 for gaps)
+    Matrix<ElemType>::Multiply(m_classIds, false, labels, false, *m_trueIds);
+
+    // logits of the sampled classes [numSamples x T], corrected by log Q
+    m_sampledWeights->DoGatherColumnsOf(0, m_sampledIds, weights, 1);
+    Matrix<ElemType>::Multiply(*m_sampledWeights, true, input, false, *m_sampledLogits);
+    m_temp->DoGatherColumnsOf(0, m_sampledIds, bias, 1);
+    m_temp->DoGatherColumnsOf(1, m_sampledIds, m_logQ, -1);
+    Matrix<ElemType>::ScaleAndAdd(1, m_temp->Reshaped(numSamples, 1), *m_sampledLogits);
+
+    // logits of the true classes [1 x T], corrected by log Q
+    m_trueWeights->DoGatherColumnsOf(0, *m_trueIds, weights, 1);
+    m_trueLogits->AssignInnerProductOf(*m_trueWeights, input, /*isColWise=*/true);
+    m_temp->DoGatherColumnsOf(0, *m_trueIds, bias, 1);
+    m_temp->DoGatherColumnsOf(1, *m_trueIds, m_logQ, -1);
+    *m_trueLogits += *m_temp;
+
+    // cross entropy of the softmax over [true class, sampled classes]
+    m_logits->Resize(1 + numSamples, numCols);
+    m_logits->AssignToRowSliceValuesOf(*m_trueLogits, 0, 1);
+    m_logits->AssignToRowSliceValuesOf(*m_sampledLogits, 1, numSamples);
+    m_logits->InplaceLogSoftmax(/*isColWise=*/true);
+    MaskMissingColumnsToZero(*m_logits, InputRef(1).GetMBLayout(), fr);
+    m_trueLogits->AssignRowSliceValuesOf(*m_logits, 0, 1);
+    Value().AssignSumOfElements(*m_trueLogits);
+    Value() *= -1;
+#if NANCHECK
+    Value().HasNan("SampledSoftmax");
+#endif
+    m_needRecomputeGradientOfLogits = true;
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::BackpropToNonLooping(size_t inputIndex)
+{
+    if (inputIndex == 0 || inputIndex == 4) // no gradient for the labels and the sampling weights
+        return;
+
+    FrameRange fr(InputRef(0).GetMBLayout());
+    const size_t numClasses = Input(0)->GetSampleMatrixNumRows();
+    const size_t numSamples = m_sizeOfSampledSet;
+
+    if (m_needRecomputeGradientOfLogits)
+    {
+        // gradient of the logits: softmax minus the one-hot vector of the true class (row 0)
+        m_logits->InplaceExp();
+        m_trueLogits->AssignRowSliceValuesOf(*m_logits, 0, 1);
+        *m_trueLogits -= 1;
+        m_logits->AssignToRowSliceValuesOf(*m_trueLogits, 0, 1);
+        MaskMissingColumnsToZero(*m_logits, InputRef(1).GetMBLayout(), fr);
+        Matrix<ElemType>::Multiply1x1AndWeightedAdd(+1.0f, Gradient() /*1x1*/, *m_logits, 0.0f, *m_logits);
+        m_trueLogits->AssignRowSliceValuesOf(*m_logits, 0, 1);
+        m_sampledLogits->AssignRowSliceValuesOf(*m_logits, 1, numSamples);
+        m_needRecomputeGradientOfLogits = false;
+    }
+
+    auto input = InputRef(1).MaskedValueFor(fr);
+    if (inputIndex == 1)
+    {
+        auto inputGradient = InputRef(1).GradientFor(fr);
+        Matrix<ElemType>::MultiplyAndAdd(*m_sampledWeights, false, *m_sampledLogits, false, inputGradient);
+        m_temp->AssignValuesOf(*m_trueWeights);
+        m_temp->RowElementMultiplyWith(*m_trueLogits);
+        inputGradient += *m_temp;
+    }
+    else if (inputIndex == 2)
+    {
+        // Only the columns of the true and sampled classes are non-zero. As for Times with a sparse input, the product with the
+        // sparse gradient of the logits is a sparse block column matrix, unless the gradient of the weights was made dense.
+        AssignSparseGradientOfLogits(numClasses);
+        Matrix<ElemType>::MultiplyAndAdd(input, false, m_logitsGradient, true, InputRef(2).GradientAsMatrix());
+    }
+    else if (inputIndex == 3)
+    {
+        auto biasGradient = InputRef(3).GradientAsMatrix().Reshaped(1, numClasses);
+        Matrix<ElemType>::VectorSum(*m_sampledLogits, *m_temp, /*isColWise=*/false);
+        biasGradient.DoScatterColumnsOf(1, m_sampledIds, m_temp->Reshaped(1, numSamples), 1);
+        biasGradient.DoScatterColumnsOf(1, *m_trueIds, *m_trueLogits, 1);
+    }
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::AssignSparseGradientOfLogits(size_t numClasses)
+{
+    // The gradient of the logits [1 + numSamples x T] is column-major, hence it is the value array of the CSC matrix as it is,
+    // with the true class followed by the sampled classes in each column. Gaps have a zero gradient.
+    const size_t numRows = 1 + m_sizeOfSampledSet;
+    const size_t numCols = m_logits->GetNumCols();
+    std::vector<ElemType> values(numRows * numCols);
+    std::vector<ElemType> trueIds(numCols);
+    m_logits->CopySection(numRows, numCols, values.data(), numRows);
+    m_trueIds->CopySection(1, numCols, trueIds.data(), 1);
+
+    std::vector<CPUSPARSE_INDEX_TYPE> colStarts(numCols + 1);
+    std::vector<CPUSPARSE_INDEX_TYPE> rowIds(numRows * numCols);
+    for (size_t t = 0; t < numCols; t++)
+    {
+        colStarts[t] = (CPUSPARSE_INDEX_TYPE)(t * numRows);
+        rowIds[t * numRows] = (CPUSPARSE_INDEX_TYPE)trueIds[t];
+        std::copy(m_sampledIdsOnHost.begin(), m_sampledIdsOnHost.end(), rowIds.begin() + t * numRows + 1);
+    }
+    colStarts[numCols] = (CPUSPARSE_INDEX_TYPE)(numRows * numCols);
+    m_logitsGradient.SetMatrixFromCSCFormat(colStarts.data(), rowIds.data(), values.data(), values.size(), numClasses, numCols);
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::Validate(bool isFinalValidationPass)
+{
+    Base::Validate(isFinalValidationPass);
+    m_pMBLayout = nullptr; // this node does not hold mini-batch data
+
+    if (GetNumInputs() != 4 && GetNumInputs() != 5)
+        InvalidArgument("%ls %ls operation expects 4 or 5 inputs (labels, input, weights, bias[, samplingWeights]).", NodeName().c_str(), OperationName().c_str());
+    if (m_sizeOfSampledSet == 0)
+        InvalidArgument("%ls %ls operation: Number of requested samples is zero.", NodeName().c_str(), OperationName().c_str());
+    if (std::is_same<ElemType, half>::value)
+        InvalidArgument("%ls %ls operation is not supported for half precision.", NodeName().c_str(), OperationName().c_str());
+
+    if (isFinalValidationPass)
+    {
+        const size_t numClasses = Input(0)->GetSampleMatrixNumRows();
+        if (!Input(0)->HasMBLayout() || Input(0)->GetMBLayout() != Input(1)->GetMBLayout())
+            LogicError("%ls %ls operation requires the labels and the input to be minibatches with the same layout.", NodeName().c_str(), OperationName().c_str());
+        if (Input(2)->HasMBLayout() || Input(3)->HasMBLayout() || (GetNumInputs() > 4 && Input(4)->HasMBLayout()))
+            LogicError("%ls %ls operation requires the weights, bias and sampling weights not to be minibatches.", NodeName().c_str(), OperationName().c_str());
+        if (Input(2)->GetAsMatrixNumRows() != Input(1)->GetSampleMatrixNumRows() || Input(2)->GetAsMatrixNumCols() != numClasses)
+            InvalidArgument("%ls %ls operation: The weights must be of shape [%d x %d] (input dimension x number of classes).",
+                            NodeName().c_str(), OperationName().c_str(), (int)Input(1)->GetSampleMatrixNumRows(), (int)numClasses);
+        if (Input(3)->GetSampleLayout().GetNumElements() != numClasses)
+            InvalidArgument("%ls %ls operation: The bias must have one element per class (%d).", NodeName().c_str(), OperationName().c_str(), (int)numClasses);
+        if (GetNumInputs() > 4 && Input(4)->GetSampleLayout().GetNumElements() != numClasses)
+            InvalidArgument("%ls %ls operation: The sampling weights must have one element per class (%d).", NodeName().c_str(), OperationName().c_str(), (int)numClasses);
+    }
+
+    SetDims(TensorShape(1), false);
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::RequestMatricesBeforeForwardProp(MatrixPool& matrixPool)
+{
+    Base::RequestMatricesBeforeForwardProp(matrixPool);
+    RequestMatrixFromPool(m_trueIds, matrixPool);
+    RequestMatrixFromPool(m_trueWeights, matrixPool);
+    RequestMatrixFromPool(m_sampledWeights, matrixPool);
+    RequestMatrixFromPool(m_trueLogits, matrixPool);
+    RequestMatrixFromPool(m_sampledLogits, matrixPool);
+    RequestMatrixFromPool(m_logits, matrixPool);
+    RequestMatrixFromPool(m_temp, matrixPool);
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::ReleaseMatricesAfterBackprop(MatrixPool& matrixPool)
+{
+    Base::ReleaseMatricesAfterBackprop(matrixPool);
+    ReleaseMatrixToPool(m_trueIds, matrixPool);
+    ReleaseMatrixToPool(m_trueWeights, matrixPool);
+    ReleaseMatrixToPool(m_sampledWeights, matrixPool);
+    ReleaseMatrixToPool(m_trueLogits, matrixPool);
+    ReleaseMatrixToPool(m_sampledLogits, matrixPool);
+    ReleaseMatrixToPool(m_logits, matrixPool);
+    ReleaseMatrixToPool(m_temp, matrixPool);
+}
+
+template<class ElemType>
+void SampledSoftmaxNode<ElemType>::AllocateGradientMatricesForInputs(MatrixPool& matrixPool)
+{
+    Base::AllocateGradientMatricesForInputs(matrixPool);
+
+    // Same as in LookupTableNode: the gradient of the weights is sparse block column, unless another node already made it dense.
+    // A sparse matrix is not shared by the MatrixPool, so the temporary one it just assigned is kept.
+    if (Input(2)->NeedsGradient() && InputRef(2).GetPreferredGradientMatrixType() == UNDETERMINED)
+    {
+        InputRef(2).Gradient().SwitchToMatrixType(SPARSE, MatrixFormat::matrixFormatSparseBlockCol, /*keepValues=*/false);
+        InputRef(2).SetPreferredGradientMatrixType(SPARSE);
+    }
+}
+
+template class SampledSoftmaxNode<float>;
+template class SampledSoftmaxNode<double>;
+template class SampledSoftmaxNode<half>;
+
 template<class ElemType>
 void DropoutNode<ElemType>::Save(File& fstream) const
 {
@@ -1456,6 +1456,101 @@ private:
     double EstimateNumberOfTries();
 };
 
+// ------------------------------------------------------------------------------------------------------------------------------------------------
+// SampledSoftmaxNode(labels, input, weights, bias[, samplingWeights]; sizeOfSampledSet):
+// Sampled softmax criterion for large output vocabularies. Per minibatch, sizeOfSampledSet negative classes are drawn (with replacement)
+// and shared by all frames. Logits are only computed for the true class and the sampled classes, by gathering the corresponding columns
+// of the weights, and are corrected by the log of the expected number of occurrences of the class in the sampled set (log Q).
+// The value is the sum over all frames of the cross entropy of the softmax over [true class, sampled classes].
+// Accidental hits, i.e. sampled classes that are equal to the true class, are not removed.
+// The gradient of the weights is a sparse block column matrix of the true and sampled classes, unless another node needs it dense.
+//
+// Samples are drawn in O(1) from an alias table, which is built from the sampling weights whenever they change. If there are no sampling
+// weights, classes are drawn from a log-uniform (Zipfian) distribution, p(k) = log((k+2)/(k+1)) / log(numClasses+1), which assumes that
+// the classes are sorted by decreasing frequency.
+//
+// Parameters:
+// * Input(0): labels, one-hot vectors (typically sparse) of shape [numClasses x T].
+// * Input(1): input of the output layer, of shape [hiddenDim x T].
+// * Input(2): weights of the output layer, matrix of shape [hiddenDim x numClasses].
+// * Input(3): bias of the output layer, vector of shape [numClasses].
+// * Input(4): optional sampling weight vector of shape [numClasses] providing sampling weights >= 0, e.g. unigram counts.
+// * sizeOfSampledSet: number of sampled classes per minibatch.
+// Class indices are passed through the element type, hence float supports up to 2^24 classes.
+// --------------------------------------------------------------------------------------------------------------------------------------------------
+template <class ElemType>
+class SampledSoftmaxNode : public ComputationNodeNonLooping<ElemType>, public RngUser
+{
+    typedef ComputationNodeNonLooping<ElemType> Base; UsingComputationNodeMembersBoilerplate;
+    static const std::wstring TypeName() { return L"SampledSoftmax"; }
+
+public:
+    SampledSoftmaxNode(DEVICEID_TYPE deviceId, const wstring& name, size_t sizeOfSampledSet = 0)
+        : Base(deviceId, name), m_sizeOfSampledSet(sizeOfSampledSet),
+          m_classIds(deviceId), m_logQ(deviceId), m_sampledIds(deviceId),
+          m_samplingWeightsTimeStamp(0), m_logitsGradient(0, 0, deviceId, SPARSE, MatrixFormat::matrixFormatSparseCSC),
+          m_needRecomputeGradientOfLogits(false)
+    {
+        SetRngState(CreateUniqId());
+    }
+
+    SampledSoftmaxNode(const ScriptableObjects::IConfigRecordPtr configp)
+        : SampledSoftmaxNode(configp->Get(L"deviceId"), L"<placeholder>", configp->Get(L"sizeOfSampledSet"))
+    {
+        AttachInputsFromConfig(configp);
+    }
+
+    virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override;
+
+    virtual void Save(File& fstream) const override;
+    virtual void Load(File& fstream, size_t modelVersion) override;
+
+    virtual void /*ComputationNodeNonLooping::*/ ForwardPropNonLooping() override;
+    virtual void /*ComputationNodeNonLooping::*/ BackpropToNonLooping(size_t inputIndex) override;
+    virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override;
+
+    virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
+    virtual void UpdateFunctionMBSize() override {}
+
+    virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override;
+    virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool) override;
+    virtual void AllocateGradientMatricesForInputs(MatrixPool& matrixPool) override;
+
+    size_t GetNumSamples() const { return m_sizeOfSampledSet; }
+
+private:
+    // Builds the alias table and m_logQ from the sampling weights if they changed, or from the log-uniform distribution.
+    void UpdateAliasTable();
+
+    // Draws m_sizeOfSampledSet classes into m_sampledIds.
+    void DrawSamples();
+
+    // Builds m_logitsGradient from the gradient of the logits in m_logits.
+    void AssignSparseGradientOfLogits(size_t numClasses);
+
+    size_t m_sizeOfSampledSet;
+
+    // Alias table (Vose): draw a class k uniformly, keep it with probability m_aliasProbability[k], otherwise take m_aliasIndex[k].
+    std::vector<double> m_aliasProbability;
+    std::vector<size_t> m_aliasIndex;
+
+    Matrix<ElemType> m_classIds;   // [1 x numClasses] row vector 0, 1, ..., numClasses-1, to get the class indices of the labels
+    Matrix<ElemType> m_logQ;       // [1 x numClasses] log of the expected number of occurrences of each class in the sampled set
+    Matrix<ElemType> m_sampledIds; // [1 x sizeOfSampledSet] indices of the sampled classes
+    std::vector<CPUSPARSE_INDEX_TYPE> m_sampledIdsOnHost;
+    uint64_t m_samplingWeightsTimeStamp;
+    Matrix<ElemType> m_logitsGradient; // sparse CSC [numClasses x T] gradient of the logits, non-zero for the true and sampled classes
+
+    shared_ptr<Matrix<ElemType>> m_trueIds;        // [1 x T] class indices of the labels
+    shared_ptr<Matrix<ElemType>> m_trueWeights;    // [hiddenDim x T] gathered weights of the true classes
+    shared_ptr<Matrix<ElemType>> m_sampledWeights; // [hiddenDim x sizeOfSampledSet] gathered weights of the sampled classes
+    shared_ptr<Matrix<ElemType>> m_trueLogits;     // [1 x T] logits of the true classes, in backprop their gradient
+    shared_ptr<Matrix<ElemType>> m_sampledLogits;  // [sizeOfSampledSet x T] logits of the sampled classes, in backprop their gradient
+    shared_ptr<Matrix<ElemType>> m_logits;         // [1 + sizeOfSampledSet x T] log softmax of the true and sampled logits
+    shared_ptr<Matrix<ElemType>> m_temp;           // gathered biases, and gradients of the gathered weights and biases
+    bool m_needRecomputeGradientOfLogits;
+};
+
 // -----------------------------------------------------------------------
 // ClassBasedCrossEntropyWithSoftmaxNode (labeldata(.,t), inputdata(.,t), embeddingMatrix, clsProbBeforeSoftmaxData(.,t))
 //  - Input(0) [4 x T] label in dense matrix in
@@ -254,6 +254,9 @@ void CNTKEvalExtended<ElemType>::StartForwardEvaluation(const std::vector<wstrin
 {
     m_scopedNetworkOperationMode = make_shared<ScopedNetworkOperationMode>(this->m_net, NetworkOperationMode::inferring);
     m_outputNodes  = this->m_net->OutputNodesByName(outputNodeNames);
+    // optionally fold constant subexpressions and drop everything the outputs don't need; must happen before allocation
+    if (this->m_config(L"optimizeForInference", false))
+        this->m_net->template OptimizeForInference<ElemType>(m_outputNodes);
     m_inputNodes = this->m_net->InputNodesForOutputs(outputNodeNames);
     // allocate memory for forward computation
     this->m_net->AllocateAllMatrices({}, m_outputNodes, nullptr);
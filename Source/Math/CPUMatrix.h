@@ -432,6 +432,8 @@ public:
     // This functions do not depend on <ElemType>, i.e. you can call them on any <ElemType>
     static int SetNumThreads(int numThreads);
     static int GetMaxNumThreads();
+    // Same as SetNumThreads(), but only for the calling thread, e.g. for work that runs on several threads concurrently.
+    static int SetNumThreadsOfCurrentThread(int numThreads);
 
     static void SetCompatibleMode();
 
@@ -684,7 +684,9 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::DoScatterColumnsOf(ElemType beta, cons
 
     // pre-scale with beta upfront
     // Scatter may add more than one source column to the same target, so we must pre-scale with beta, and then just keep adding.
-    Scale(beta, us); // if beta is 0, then this will be a memset()
+    // If beta is 1, the target is left alone, so that a sparse update of a large matrix only touches the scattered columns.
+    if (beta != 1)
+        Scale(beta, us); // if beta is 0, then this will be a memset()
 
     ScatterValues(idx.Data(), a.Data(), us.Data(), alpha, idx.GetNumCols(), a.GetNumRows(), GetNumCols(), idx.GetNumRows());
 
@@ -878,7 +880,8 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
         // free previous array allocation if any before overwriting
-        delete[] Buffer();
+        if (!HasExternalBuffer())
+            delete[] Buffer();
 
         m_numRows = numRows;
         m_numCols = numCols;
@@ -3802,6 +3805,64 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AddSignOf(const CPUMatrix<ElemType>& a
 
     return us;
 }
+// helpers for the top-K path of VectorMax
+// Ordering of (value, row) candidates: the larger value wins, ties go to the lower row. This makes the result
+// independent of how a column is split into row ranges.
+template <class ElemType>
+static bool VectorMaxTopKIsBetter(const std::pair<ElemType, int>& a, const std::pair<ElemType, int>& b)
+{
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+// Selects the topK best candidates of rows [begin, end) of a column into 'heap', a heap whose front is the worst
+// candidate kept so far. Its value is the threshold a row has to exceed to enter; it is tested a block at a time
+// with a branch-free max that the compiler can vectorize, so that blocks without any candidate are skipped quickly.
+// Rows are visited in increasing order, so a row that only ties the threshold loses to the one already kept.
+template <class ElemType>
+static void VectorMaxTopKSelect(const ElemType* val, int begin, int end, int topK, std::vector<std::pair<ElemType, int>>& heap)
+{
+    heap.clear();
+    int i = begin;
+    for (; i < end && (int) heap.size() < topK; i++)
+        heap.emplace_back(val[i], i);
+    std::make_heap(heap.begin(), heap.end(), VectorMaxTopKIsBetter<ElemType>);
+
+    const int blockSize = 16;
+    auto offer = [&heap, val](int row)
+    {
+        if (val[row] > heap.front().first)
+        {
+            std::pop_heap(heap.begin(), heap.end(), VectorMaxTopKIsBetter<ElemType>);
+            heap.back() = std::make_pair(val[row], row);
+            std::push_heap(heap.begin(), heap.end(), VectorMaxTopKIsBetter<ElemType>);
+        }
+    };
+    for (; i + blockSize <= end; i += blockSize)
+    {
+        ElemType blockMax = val[i];
+        for (int k = 1; k < blockSize; k++)
+            blockMax = val[i + k] > blockMax ? val[i + k] : blockMax;
+        if (blockMax > heap.front().first)
+        {
+            for (int k = 0; k < blockSize; k++)
+                offer(i + k);
+        }
+    }
+    for (; i < end; i++)
+        offer(i);
+}
+
+// Writes the first topK of the candidates, sorted best first, as a column of row indices and values.
+template <class ElemType>
+static void VectorMaxTopKStore(const std::vector<std::pair<ElemType, int>>& sorted, int topK, ElemType* curIdx, ElemType* curMax)
+{
+    for (int i = 0; i < topK; i++)
+    {
+        curIdx[i] = static_cast<ElemType>(sorted[i].second);
+        curMax[i] = sorted[i].first;
+    }
+}
+
 //I decided to use CPUMatrix<ElemType>& maxIndexes instead of integer vector because the result may be used to do additional calculation
 template <class ElemType>
 void CPUMatrix<ElemType>::VectorMax(CPUMatrix<ElemType>& maxIndexes, CPUMatrix<ElemType>& maxValues, const bool isColWise, int topK) const
@@ -3843,26 +3904,52 @@ void CPUMatrix<ElemType>::VectorMax(CPUMatrix<ElemType>& maxIndexes, CPUMatrix<E
         }
         else
         {
-            std::vector<int> indices(m);
-
-            const ElemType* curVal =            Data();
-            ElemType* curIdx       = maxIndexes.Data();
-            ElemType* curMax       =  maxValues.Data();
-            for (int icol = 0; icol < n; icol++, curVal += m, curIdx += topK, curMax += topK)
+            // Top-K selection instead of sorting the column, which matters for 100k+ row outputs (e.g. decoding over a
+            // large vocabulary). Columns are processed in parallel; if there are fewer columns than threads and the
+            // columns are tall, each column is also split into row ranges whose top K candidates are merged afterwards.
+            const int minRowsPerSplit = 16384;
+            int numSplits = 1;
+            if (n < GetMaxNumThreads())
+                numSplits = std::max(1, std::min({ GetMaxNumThreads() / n, m / minRowsPerSplit, m / topK }));
+            const int numTasks = n * numSplits;
+
+            std::vector<std::vector<std::pair<ElemType, int>>> candidates(numSplits > 1 ? numTasks : 0);
+            const ElemType* val = Data();
+            ElemType* idx       = maxIndexes.Data();
+            ElemType* maxVal    =  maxValues.Data();
+#pragma omp parallel
             {
-                std::iota(indices.begin(), indices.end(), 0);
-                // Partial sort, descending order.
-                std::partial_sort(indices.begin(), indices.begin() + topK, indices.end(),
-                                    [curVal](const int& a, const int& b)
-                                    {
-                                        return curVal[a] > curVal[b];
-                                    });
-                // REVIEW alexeyk: the following produces warning (see SCL_SECURE_NO_WARNINGS) so use loop instead.
-                // std::transform(indices.begin(), indices.begin() + topK, curIdx, [](const int& a) { return static_cast<ElemType>(a); });
-                for (int i2 = 0; i2 < topK; i2++)
+                std::vector<std::pair<ElemType, int>> heap;
+#pragma omp for
+                for (int task = 0; task < numTasks; task++)
+                {
+                    const int icol  = task / numSplits;
+                    const int split = task % numSplits;
+                    const ElemType* curVal = val + (size_t) icol * m;
+                    VectorMaxTopKSelect(curVal, (int) ((int64_t) m * split / numSplits), (int) ((int64_t) m * (split + 1) / numSplits), topK, heap);
+                    if (numSplits > 1)
+                        candidates[task] = heap;
+                    else
+                    {
+                        std::sort_heap(heap.begin(), heap.end(), VectorMaxTopKIsBetter<ElemType>);
+                        VectorMaxTopKStore(heap, topK, idx + (size_t) icol * topK, maxVal + (size_t) icol * topK);
+                    }
+                }
+
+                if (numSplits > 1)
                 {
-                    curIdx[i2] = static_cast<ElemType>(indices[i2]);
-                    curMax[i2] = curVal[indices[i2]];
+#pragma omp for
+                    for (int icol = 0; icol < n; icol++)
+                    {
+                        heap.clear();
+                        for (int split = 0; split < numSplits; split++)
+                        {
+                            const auto& c = candidates[icol * numSplits + split];
+                            heap.insert(heap.end(), c.begin(), c.end());
+                        }
+                        std::partial_sort(heap.begin(), heap.begin() + topK, heap.end(), VectorMaxTopKIsBetter<ElemType>);
+                        VectorMaxTopKStore(heap, topK, idx + (size_t) icol * topK, maxVal + (size_t) icol * topK);
+                    }
                 }
             }
         }
@@ -6444,22 +6531,66 @@ void CPUMatrix<ElemType>::RCRFBackwardCompute(const CPUMatrix<ElemType>& alpha,
     }
 };
 
+// Per-utterance quantities of the forward-backward calculation that do not depend on the frame
+// skip[s]: whether the path may go from label s-2 to s (or from s+2 to s in beta), skipping the blank in between
+// alphaLastFrame[s], betaLastFrame[s]: last frame at which alpha_t(s), beta_t(s) may be non-zero under the delay constraint
+struct CTCUtteranceLabels
+{
+    std::vector<size_t> phoneIds;
+    std::vector<char> alphaSkip, betaSkip;
+    std::vector<size_t> alphaLastFrame, betaLastFrame;
+};
+
+template<class ElemType>
+void _prepareCTCUtteranceLabels(
+    const ElemType *phoneSeq,
+    const ElemType *phoneBound,
+    const size_t uttId,
+    const size_t phoneNum,
+    const size_t maxPhoneNum,
+    const size_t blankTokenId,
+    const int delayConstraint,
+    CTCUtteranceLabels& labels)
+{
+    const ElemType* uttPhoneSeq = phoneSeq + uttId * maxPhoneNum;
+    labels.phoneIds.assign(phoneNum, SIZE_MAX);
+    labels.alphaSkip.assign(phoneNum, 0);
+    labels.betaSkip.assign(phoneNum, 0);
+    labels.alphaLastFrame.assign(phoneNum, SIZE_MAX);
+    labels.betaLastFrame.assign(phoneNum, SIZE_MAX);
+    for (size_t s = 1; s + 1 < phoneNum; s++)
+        labels.phoneIds[s] = (size_t)(uttPhoneSeq[s]);
+
+    for (size_t s = 1; s + 1 < phoneNum; s++)
+    {
+        size_t phoneId = labels.phoneIds[s];
+        // if current label is not blank and not equal prev (next) non-blank label
+        labels.alphaSkip[s] = s > 2 && phoneId != blankTokenId && phoneId != labels.phoneIds[s - 2];
+        labels.betaSkip[s] = s + 3 < phoneNum && phoneId != blankTokenId && phoneId != labels.phoneIds[s + 2];
+        if (delayConstraint != -1)
+        {
+            // both look at the right boundary, blanks are only constrained on the right side
+            size_t phoneBoundId_r = (size_t)(phoneBound[uttId * maxPhoneNum + s + 2]);
+            size_t lastFrame = phoneId == blankTokenId ? phoneBoundId_r + delayConstraint - 1 : phoneBoundId_r + delayConstraint;
+            labels.alphaLastFrame[s] = lastFrame;
+            labels.betaLastFrame[s] = lastFrame;
+        }
+    }
+}
+
 // Calculate alpha in forward-backward calculation. equation (6), (7) in ftp://ftp.idsia.ch/pub/juergen/icml2006.pdf
-// GPU x dimension corresponds to utterances, y dimension corresponds to phone sequence in each utterance
+// The recursion runs over all frames of one utterance; utterances are processed in parallel by the caller.
 // prob (input): the posterior output from the network
 // alpha (output): alpha for forward-backward calculation.
-// phoneSeq (input): phone ID sequence for each utterance in this minibatch, each col is one utterance
-// phoneBound (input): phone boundary (frame index) of each phone for each utterance in this minibatch, each col is one utterance
+// labels (input): labels of the utterance, see CTCUtteranceLabels
 // uttToChanInd (input):  map from utterance ID to minibatch channel ID. We need this because each channel may contain more than one utterance.
 // uttFrameNum (input): the frame number of each utterance. The size of this vector =  the number of all utterances in this minibatch
 // uttBeginFrame(input): the position of the first frame of each utterance in the minibatch channel. We need this because each channel may contain more than one utterance.
 // uttPhoneNum (input): the phone number of each utterance. The size of this vector =  the number of all utterances in this minibatch
 // numChannels (input): channel number in this minibatch
-// uttNum (input): number of utterances
-// t (input): time stamp to process
+// uttId (input): utterance to process
 // maxPhoneNum (input): the max number of phones between utterances
 // totalPhoneNum (input): the total number of phones of all utterances
-// blankTokenId (input): id of the CTC blank token
 // delayConstraint -- label output delay constraint introduced during training that allows to have shorter delay during inference.
 //      Alpha and Beta scores outside of the delay boundary are set to zero.
 //      Setting this parameter smaller will result in shorted delay between label output during decoding.
@@ -6468,106 +6599,52 @@ template<class ElemType>
 void _assignAlphaScore(
     const ElemType *prob,
     ElemType *alphaScore,
-    ElemType *phoneSeq,
-    ElemType *phoneBound,
+    const CTCUtteranceLabels& labels,
     const std::vector<size_t>& uttToChanInd,
     const std::vector<size_t>& uttFrameNum,
     const std::vector<size_t>& uttBeginFrame,
     const std::vector<size_t>& uttPhoneNum,
     size_t numChannels,
-    const size_t uttNum,
-    const size_t  t,
+    const size_t uttId,
     const size_t maxPhoneNum, // Maximum length of utterance in this MB
     const size_t totalPhoneNum, // Total number of phones
-    const size_t blankTokenId,
     const int delayConstraint)
 {
-    for (size_t uttId = 0;uttId < uttNum;uttId++) {
-
-        // Number of phones and frames in this utterance
-        size_t frameNum = uttFrameNum[uttId];
-        if (t >= frameNum) continue;
-
-        size_t phoneNum = uttPhoneNum[uttId];
-
-#pragma omp parallel for
-        for (int phoneSeqId = 1;phoneSeqId < phoneNum - 1;phoneSeqId++) {
-            // Index of the label in the sequence
-
-            // Current and previous phone indices in phoneSeq matrix
-            size_t labelid = uttId*maxPhoneNum + phoneSeqId;
-
-            // Actual current phone label
-            size_t phoneId = (size_t)(phoneSeq[labelid]);
-
-            // Index of the current frame in minibatch
-            size_t timeId = (t + uttBeginFrame[uttId])*numChannels + uttToChanInd[uttId];
+    // Number of phones and frames in this utterance
+    const size_t frameNum = uttFrameNum[uttId];
+    const size_t phoneNum = uttPhoneNum[uttId];
 
-            // Index of probability of observing phoneId at frame timeId
-            size_t probId = timeId*totalPhoneNum + phoneId;
-
-            size_t alphaId = maxPhoneNum* timeId + phoneSeqId; // alpha_t(s)
+    for (size_t t = 0; t < frameNum; t++)
+    {
+        // Index of the current frame in minibatch, and alpha_t(.), alpha_{t-1}(.) and the probabilities of frame t
+        size_t timeId = (t + uttBeginFrame[uttId])*numChannels + uttToChanInd[uttId];
+        ElemType* alpha = alphaScore + maxPhoneNum * timeId;
+        const ElemType* alpha_1 = alpha - maxPhoneNum * numChannels;
+        const ElemType* probT = prob + totalPhoneNum * timeId;
 
-            if (t == 0)
-            {
-                // Initialize recursion
-                if (phoneSeqId == 1 || phoneSeqId == 2)
-                {
-                    alphaScore[alphaId] = prob[probId];
-                }
-            }
-            else
-            {
-                if (phoneSeqId >= 1)
-                {
-                    size_t timeId_1 = timeId - numChannels; // Index corresponding to (t-1)
-                    size_t alphaId_0 = maxPhoneNum* timeId_1 + phoneSeqId; // alpha_{t-1}(s)
-                    size_t alphaId_1 = alphaId_0 - 1; // alpha_{t-1}(s-1)
-                    size_t alphaId_2 = alphaId_0 - 2; // alpha_{t-1}(s-2)
-                    ElemType x = LZERO;
-
-                    ElemType ascore;
-                    if (phoneSeqId > 2)
-                    {
-                        size_t labelid_2 = labelid - 2;
-                        // if current label is not blank and not equal prev non-blank label
-                        if ((size_t)(phoneSeq[labelid]) != blankTokenId && phoneId != (size_t)(phoneSeq[labelid_2]))
-                        {
-                            x = LogAdd(x, alphaScore[alphaId_2]);
-                        }
-                    }
+        if (t == 0)
+        {
+            // Initialize recursion
+            for (size_t phoneSeqId = 1; phoneSeqId + 1 < phoneNum && phoneSeqId <= 2; phoneSeqId++)
+                alpha[phoneSeqId] = probT[labels.phoneIds[phoneSeqId]];
+            continue;
+        }
 
-                    if (phoneSeqId > 1)
-                    {
-                        x = LogAdd(x, alphaScore[alphaId_1]);
-                    }
+        for (size_t phoneSeqId = 1; phoneSeqId + 1 < phoneNum; phoneSeqId++)
+        {
+            ElemType x = LZERO;
+            if (labels.alphaSkip[phoneSeqId])
+                x = LogAdd(x, alpha_1[phoneSeqId - 2]);
 
-                    x = LogAdd(x, alphaScore[alphaId_0]);
+            if (phoneSeqId > 1)
+                x = LogAdd(x, alpha_1[phoneSeqId - 1]);
 
-                    if (phoneId != SIZE_MAX)
-                        ascore = prob[probId]; // Probability of observing given label at given time
-                    else
-                        ascore = 0;
-                    alphaScore[alphaId] = (ElemType)x + ascore;
-                    if (delayConstraint != -1)
-                    {
-                        size_t labelid_r = labelid + 2;
-                        size_t phoneBoundId_r = (size_t)(phoneBound[labelid_r]);
-                        if (phoneId == blankTokenId)
-                        {
-                            // only constraint right side
-                            if (t > phoneBoundId_r + delayConstraint - 1)
-                                alphaScore[alphaId] = LZERO;
-                        }
-                        else if (phoneId != blankTokenId)
-                        {
-                            if (t > phoneBoundId_r + delayConstraint)
-                                alphaScore[alphaId] = LZERO;
-                        }
-                    }
-                }
+            x = LogAdd(x, alpha_1[phoneSeqId]);
 
-            }
+            // Probability of observing given label at given time
+            alpha[phoneSeqId] = (ElemType)x + probT[labels.phoneIds[phoneSeqId]];
+            if (delayConstraint != -1 && t > labels.alphaLastFrame[phoneSeqId])
+                alpha[phoneSeqId] = LZERO;
         }
     }
 }
@@ -6578,91 +6655,52 @@ template<class ElemType>
 void _assignBetaScore(
     const ElemType *prob,
     ElemType *betaScore,
-    ElemType *phoneSeq,
-    ElemType *phoneBound,
+    const CTCUtteranceLabels& labels,
     const std::vector<size_t>& uttToChanInd,
     const std::vector<size_t>& uttFrameNum,
     const std::vector<size_t>& uttBeginFrame,
     const std::vector<size_t>& uttPhoneNum,
     const size_t numChannels,
-    const size_t uttNum,
-    const long  t,
+    const size_t uttId,
     const size_t maxPhoneNum,
     const size_t totalPhoneNum,
-    const size_t blankTokenId,
     const int delayConstraint)
 {
-    for (size_t uttId = 0;uttId < uttNum;uttId++) {
-
-        // Number of phones and frames in this utterance
-        size_t frameNum = uttFrameNum[uttId];
-        if (t >= frameNum) continue;
-
-        size_t phoneNum = uttPhoneNum[uttId];
-
-#pragma omp parallel for
-        for (int phoneSeqId = 1;phoneSeqId < phoneNum - 1;phoneSeqId++) {
+    // Number of phones and frames in this utterance
+    const size_t frameNum = uttFrameNum[uttId];
+    const size_t phoneNum = uttPhoneNum[uttId];
 
-            size_t labelid = uttId*maxPhoneNum + phoneSeqId;
-            size_t labelid_2 = labelid + 2;
-            size_t phoneId = (LONG64)(phoneSeq[labelid]);
-            size_t timeId = (t + uttBeginFrame[uttId])*numChannels + uttToChanInd[uttId];
-            size_t probId = timeId*totalPhoneNum + phoneId;
-            size_t betaid = maxPhoneNum* timeId + phoneSeqId;
-            size_t timeId_1 = timeId + numChannels;
-            size_t betaid_0 = maxPhoneNum* timeId_1 + phoneSeqId;
-            size_t betaid_1 = betaid_0 + 1;
-            size_t betaid_2 = betaid_0 + 2;
+    for (size_t t = frameNum; t-- > 0;)
+    {
+        size_t timeId = (t + uttBeginFrame[uttId])*numChannels + uttToChanInd[uttId];
+        ElemType* beta = betaScore + maxPhoneNum * timeId;
+        const ElemType* beta_1 = beta + maxPhoneNum * numChannels;
+        const ElemType* probT = prob + totalPhoneNum * timeId;
 
-            if (t == frameNum - 1)
+        if (t == frameNum - 1)
+        {
+            for (size_t phoneSeqId = 1; phoneSeqId + 1 < phoneNum; phoneSeqId++)
             {
                 if (phoneSeqId == phoneNum - 3 || phoneSeqId == phoneNum - 2)
-                {
-                    betaScore[betaid] = prob[probId];
-                }
+                    beta[phoneSeqId] = probT[labels.phoneIds[phoneSeqId]];
             }
-            else
-            {
-                if (phoneSeqId >= 1)
-                {
-                    ElemType x = LZERO;
-                    ElemType ascore;
-                    if (phoneSeqId < phoneNum - 3)
-                    {
-                        if (phoneSeq[labelid] != blankTokenId && phoneId != phoneSeq[labelid_2])
-                        {
-                            x = LogAdd(x, betaScore[betaid_2]);
-                        }
-                    }
+            continue;
+        }
 
-                    if (phoneSeqId < phoneNum - 2)
-                    {
-                        x = LogAdd(x, betaScore[betaid_1]);
-                    }
+        for (size_t phoneSeqId = 1; phoneSeqId + 1 < phoneNum; phoneSeqId++)
+        {
+            ElemType x = LZERO;
+            if (labels.betaSkip[phoneSeqId])
+                x = LogAdd(x, beta_1[phoneSeqId + 2]);
 
-                    x = LogAdd(x, betaScore[betaid_0]);
+            if (phoneSeqId < phoneNum - 2)
+                x = LogAdd(x, beta_1[phoneSeqId + 1]);
 
-                    if (phoneId != SIZE_MAX)
-                        ascore = prob[probId];
-                    else
-                        ascore = 0;
-                    betaScore[betaid] = (ElemType)x + ascore;
-                    if (delayConstraint != -1)
-                    {
-                        size_t phoneBoundId_r = (size_t)(phoneBound[labelid_2]);
-                        if (phoneId == blankTokenId)
-                        {
-                            if (t > phoneBoundId_r + delayConstraint - 1)
-                                betaScore[betaid] = LZERO;
-                        }
-                        else if (phoneId != blankTokenId)
-                        {
-                            if (t > phoneBoundId_r + delayConstraint)
-                                betaScore[betaid] = LZERO;
-                        }
-                    }
-                }
-            }
+            x = LogAdd(x, beta_1[phoneSeqId]);
+
+            beta[phoneSeqId] = (ElemType)x + probT[labels.phoneIds[phoneSeqId]];
+            if (delayConstraint != -1 && t > labels.betaLastFrame[phoneSeqId])
+                beta[phoneSeqId] = LZERO;
         }
     }
 }
@@ -6689,55 +6727,47 @@ void _assignTotalScore(ElemType *betaScore,
     }
 }
 
-// Calculate derivative, equation (15) in ftp://ftp.idsia.ch/pub/juergen/icml2006.pdf
+// Calculate derivative, equation (15) in ftp://ftp.idsia.ch/pub/juergen/icml2006.pdf, of frame t of an utterance
 // See _assignAlphaScore for the explanation of parameters
 template<class ElemType>
 void _assignCTCScore(
     ElemType *CTCscore,
-    ElemType *prob,
-    ElemType *alphaScore,
-    ElemType *betaScore,
-    ElemType *phoneSeq,
-    const size_t uttNum,
+    const ElemType *prob,
+    const ElemType *alphaScore,
+    const ElemType *betaScore,
+    const CTCUtteranceLabels& labels,
+    const size_t uttId,
+    const size_t t,
     const std::vector<size_t>& uttToChanInd,
     const std::vector<size_t>& uttBeginFrame,
     const std::vector<size_t>& uttPhoneNum,
-    const std::vector<size_t>& uttFrameNum,
     const size_t numChannels,
     const size_t maxPhoneNum,
     const size_t totalPhoneNum)
 {
-    for (size_t uttId = 0;uttId < uttNum;uttId++) {
-#pragma omp parallel for
-        for (int t = 0; t < uttFrameNum[uttId]; t++) {
-            size_t phoneNum = uttPhoneNum[uttId];
-            size_t alphaId_0 = (uttBeginFrame[uttId] * numChannels + uttToChanInd[uttId]) * maxPhoneNum;
-            size_t timeId = (t + uttBeginFrame[uttId])*numChannels + uttToChanInd[uttId];
-            ElemType P_lx = betaScore[alphaId_0];
+    size_t phoneNum = uttPhoneNum[uttId];
+    size_t alphaId_0 = (uttBeginFrame[uttId] * numChannels + uttToChanInd[uttId]) * maxPhoneNum;
+    size_t timeId = (t + uttBeginFrame[uttId])*numChannels + uttToChanInd[uttId];
+    ElemType P_lx = betaScore[alphaId_0];
+    ElemType* CTCscoreT = CTCscore + timeId * totalPhoneNum;
+    const ElemType* probT = prob + timeId * totalPhoneNum;
+    const ElemType* alpha = alphaScore + timeId * maxPhoneNum;
+    const ElemType* beta = betaScore + timeId * maxPhoneNum;
 
-            for (int s = 1; s < phoneNum - 1; s++)
-            {
-                long phoneId = phoneSeq[uttId*maxPhoneNum + s];
-                size_t alphaId = maxPhoneNum* timeId + s;
-                size_t probId = timeId*totalPhoneNum + phoneId;
-
-                if (phoneId != SIZE_MAX)
-                {
-                    ElemType logoccu = alphaScore[alphaId] + betaScore[alphaId] - prob[probId] - (ElemType)P_lx;
-                    CTCscore[probId] = LogAdd(CTCscore[probId], logoccu);
-                }
-            }
+    for (size_t s = 1; s + 1 < phoneNum; s++)
+    {
+        size_t phoneId = labels.phoneIds[s];
+        ElemType logoccu = alpha[s] + beta[s] - probT[phoneId] - (ElemType)P_lx;
+        CTCscoreT[phoneId] = LogAdd(CTCscoreT[phoneId], logoccu);
+    }
 
-            for (int s = 0; s < totalPhoneNum; s++)
-            {
-                size_t probId = timeId*totalPhoneNum + s;
-                ElemType logoccu = CTCscore[probId];
-                if (logoccu < LZERO)
-                    CTCscore[probId] = 0.0f;
-                else
-                    CTCscore[probId] = exp(logoccu);
-            }
-        }
+    for (size_t s = 0; s < totalPhoneNum; s++)
+    {
+        ElemType logoccu = CTCscoreT[s];
+        if (logoccu < LZERO)
+            CTCscoreT[s] = 0.0f;
+        else
+            CTCscoreT[s] = exp(logoccu);
     }
 }
 
@@ -6756,24 +6786,36 @@ CPUMatrix<ElemType>& CPUMatrix<ElemType>::AssignCTCScore(
 
         // Max number of phones in utterances in this minibatch
         size_t maxPhoneNum = phoneSeq.GetNumRows();
+        UNUSED(maxFrameNum);
 
-        for (size_t t = 0; t < maxFrameNum; t++)
+        // The recursions are sequential in time, so they run in parallel over the utterances, each one going through all its frames.
+        // This is the same computation, in the same order for each alpha_t(s) and beta_t(s), as a time step at a time.
+        std::vector<CTCUtteranceLabels> labels(uttNum);
+#pragma omp parallel for schedule(dynamic)
+        for (long uttId = 0; uttId < (long)uttNum; uttId++)
         {
-            _assignAlphaScore(prob.Data(), alpha.Data(), phoneSeq.Data(), phoneBoundary.Data(), uttToChanInd,
-                uttFrameNum, uttBeginFrame, uttPhoneNum, numParallelSequences, uttNum, t, maxPhoneNum, totalPhoneNum, blankTokenId, delayConstraint);
-        }
-
-        for (LONG64 t = maxFrameNum - 1; t >= 0; t--)
-        {
-            _assignBetaScore(prob.Data(), beta.Data(), phoneSeq.Data(), phoneBoundary.Data(), uttToChanInd,
-                uttFrameNum, uttBeginFrame, uttPhoneNum, numParallelSequences, uttNum, t, maxPhoneNum, totalPhoneNum, blankTokenId, delayConstraint);
+            _prepareCTCUtteranceLabels(phoneSeq.Data(), phoneBoundary.Data(), uttId, uttPhoneNum[uttId], maxPhoneNum, blankTokenId, delayConstraint, labels[uttId]);
+            _assignAlphaScore(prob.Data(), alpha.Data(), labels[uttId], uttToChanInd,
+                uttFrameNum, uttBeginFrame, uttPhoneNum, numParallelSequences, uttId, maxPhoneNum, totalPhoneNum, delayConstraint);
+            _assignBetaScore(prob.Data(), beta.Data(), labels[uttId], uttToChanInd,
+                uttFrameNum, uttBeginFrame, uttPhoneNum, numParallelSequences, uttId, maxPhoneNum, totalPhoneNum, delayConstraint);
         }
 
         std::vector<ElemType> scores(uttNum);
         _assignTotalScore(beta.Data(), scores, uttNum, uttToChanInd, uttBeginFrame, numParallelSequences, maxPhoneNum);
 
-        _assignCTCScore(Data(), prob.Data(), alpha.Data(), beta.Data(), phoneSeq.Data(), uttNum, uttToChanInd,
-            uttBeginFrame, uttPhoneNum, uttFrameNum, numParallelSequences, maxPhoneNum, totalPhoneNum);
+        // the derivatives of all frames of all utterances are independent
+        std::vector<size_t> uttFirstFrame(uttNum + 1, 0);
+        for (size_t uttId = 0; uttId < uttNum; uttId++)
+            uttFirstFrame[uttId + 1] = uttFirstFrame[uttId] + uttFrameNum[uttId];
+
+#pragma omp parallel for
+        for (long frame = 0; frame < (long)uttFirstFrame[uttNum]; frame++)
+        {
+            size_t uttId = std::upper_bound(uttFirstFrame.begin(), uttFirstFrame.end(), (size_t)frame) - uttFirstFrame.begin() - 1;
+            _assignCTCScore(Data(), prob.Data(), alpha.Data(), beta.Data(), labels[uttId], uttId, frame - uttFirstFrame[uttId], uttToChanInd,
+                uttBeginFrame, uttPhoneNum, numParallelSequences, maxPhoneNum, totalPhoneNum);
+        }
 
         totalScore(0, 0) = 0.0;
         for (size_t utt = 0; utt < uttNum; utt++)
@@ -7031,6 +7073,22 @@ int CPUMatrix<ElemType>::SetNumThreads(int numThreads)
     return numThreads;
 }
 
+// note: this function does not depend on the <ElemType> parameter
+template <class ElemType>
+int CPUMatrix<ElemType>::SetNumThreadsOfCurrentThread(int numThreads)
+{
+    numThreads = std::max(1, numThreads);
+#ifdef _OPENMP
+    omp_set_num_threads(numThreads); // affects parallel regions started by the calling thread only
+    numThreads = omp_get_max_threads();
+
+    #ifdef USE_MKL
+        mkl_set_num_threads_local(numThreads);
+    #endif
+#endif
+    return numThreads;
+}
+
 template <class ElemType>
 int CPUMatrix<ElemType>::GetMaxNumThreads()
 {
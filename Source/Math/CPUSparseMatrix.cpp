@@ -719,6 +719,62 @@ void CPUSparseMatrix<ElemType>::SetMatrixFromSBCFormat(const size_t* blockIds, c
     memcpy(Data(), val, sizeof(ElemType)*numBlocks*numRows);
 }
 
+// Returns the columns of a sparse block column matrix that own a block, in block order.
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::GetBlockColumnIds(std::vector<size_t>& columnIds) const
+{
+    if (GetFormat() != matrixFormatSparseBlockCol)
+        LogicError("GetBlockColumnIds: Only the sparse block column format is supported.");
+
+    columnIds.resize(GetBlockSize());
+    for (size_t blockId = 0; blockId < columnIds.size(); blockId++)
+        columnIds[blockId] = GetBlockIds()[blockId] - GetBlockIdShift();
+}
+
+// Re-lays out a sparse block column matrix so that block j holds column newBlockIds[j].
+// Columns that currently have no block are filled with zeros. Every column that currently has a block must be
+// contained in newBlockIds, so that no value is lost. This is used to align the sparse gradients of all workers
+// before aggregating their values.
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::AdjustBlockColumnIds(const size_t* newBlockIds, const size_t numBlocks)
+{
+    if (!OwnBuffer())
+        LogicError("Cannot modify since the buffer is managed externally.");
+
+    if (GetFormat() != matrixFormatSparseBlockCol)
+        LogicError("AdjustBlockColumnIds: Only the sparse block column format is supported.");
+
+    const size_t numRows = GetNumRows();
+    const size_t numCols = GetNumCols();
+
+    unordered_map<size_t, size_t> col2BlockId;
+    for (size_t blockId = 0; blockId < GetBlockSize(); blockId++)
+        col2BlockId[GetBlockIds()[blockId] - GetBlockIdShift()] = blockId;
+
+    vector<ElemType> values(numBlocks * numRows, 0);
+    size_t numBlocksKept = 0;
+    for (size_t blockId = 0; blockId < numBlocks; blockId++)
+    {
+        auto iter = col2BlockId.find(newBlockIds[blockId]);
+        if (iter == col2BlockId.end())
+            continue;
+        memcpy(values.data() + blockId * numRows, Data() + iter->second * numRows, sizeof(ElemType) * numRows);
+        numBlocksKept++;
+    }
+
+    if (numBlocksKept != col2BlockId.size())
+        LogicError("AdjustBlockColumnIds: The new block ids must contain all columns of the matrix that have a block.");
+
+    RequireSizeAndAllocate(numRows, numCols, numBlocks * numRows, true, false);
+    SetBlockSize(numBlocks);
+    SetBlockIdShift(0);
+    if (numBlocks > 0)
+    {
+        memcpy(GetBlockIds(), newBlockIds, sizeof(size_t) * numBlocks);
+        memcpy(Data(), values.data(), sizeof(ElemType) * numBlocks * numRows);
+    }
+}
+
 template <class ElemType>
 ElemType* CPUSparseMatrix<ElemType>::Data()  const
 {
@@ -931,47 +987,76 @@ public:
         // * Initialized the output matrix c
 
         // Now do the actual multiplication.
-        ElemType* valueBuffer = sparse.Buffer() + *sparse.SecondaryIndexLocation(); // Points to the value buffer of the current view (i.e. buffer containing values of non-zero elements).
-        int* rowIndexBuffer = sparse.MajorIndexLocation();                          // Points to the index buffer of the current view (i.e. buffer containing indices of non-zero elements).
-        size_t iNonzero = 0;                                                           // Number of nonzero elements handled so far for current slice view.
-        int numPreviosNonzero = sparse.SecondaryIndexLocation()[0];                 // Total number of nonzero values handled in previous slices.
+        const ElemType* valueBuffer = sparse.Buffer() + *sparse.SecondaryIndexLocation(); // Points to the value buffer of the current view (i.e. buffer containing values of non-zero elements).
+        const CPUSPARSE_INDEX_TYPE* rowIndexBuffer = sparse.MajorIndexLocation();         // Points to the index buffer of the current view (i.e. buffer containing indices of non-zero elements).
+        const CPUSPARSE_INDEX_TYPE* colStart = sparse.SecondaryIndexLocation();           // colStart[j] - colStart[0] is the offset of column j into the two buffers above.
+        const long numColsSparse = (long)sparse.GetNumCols();
+
+        // Both the dense input and the output are column major. Express the element accessed by the inner loop (which runs
+        // over the outer index of the dense matrix) as a base pointer plus a stride, so that the loop becomes a strided AXPY.
+        // The strides are fixed by the template parameters; in the common case of dense * sparse without transposition
+        // both strides are 1 and the compiler vectorizes the inner loop.
+        const size_t ldDense = dense.GetNumRows();
+        const size_t ldC = c.GetNumRows();
+        const bool   denseOuterIsCol  = denseTimesSparse ? transposeA : !transposeB;
+        const size_t denseOuterStride = denseOuterIsCol ? ldDense : 1;                   // step in 'dense' for one step of outerIndexDense
+        const size_t denseInnerStride = denseOuterIsCol ? 1 : ldDense;                   // step in 'dense' for one step of innerIndex
+        const size_t cDenseStride     = denseTimesSparse ? 1 : ldC;                      // step in 'c' for one step of outerIndexDense
+        const size_t cSparseStride    = denseTimesSparse ? ldC : 1;                      // step in 'c' for one step of outerIndexSparse
+        const ElemType* denseData = dense.Data();
+        ElemType* cData = c.Data();
+
+        // Adds alpha * sparseVal * dense(inner, [begin, end)) to c(outerSparse, [begin, end)), both taken along the outer index of the dense matrix.
+        auto axpy = [&](size_t innerIndex, size_t outerIndexSparse, ElemType sparseVal, size_t begin, size_t end)
+        {
+            const ElemType* x = denseData + innerIndex * denseInnerStride;
+            ElemType* y = cData + outerIndexSparse * cSparseStride;
+            const ElemType scale = alpha * sparseVal;
+            if (denseOuterStride == 1 && cDenseStride == 1)
+            {
+                for (size_t i = begin; i < end; i++)
+                    y[i] += scale * x[i];
+            }
+            else
+            {
+                for (size_t i = begin; i < end; i++)
+                    y[i * cDenseStride] += scale * x[i * denseOuterStride];
+            }
+        };
 
-        // Loop over columns of the sparse matrix
-        for (size_t colSparse = 0; colSparse < sparse.GetNumCols(); colSparse++)
+        // Below if-statements are evaluated at compile time.
+        // If the outer index of the sparse matrix is its column index, the non-zero elements of different sparse columns are written into
+        // disjoint slices of c. We can then hand out whole sparse columns to the threads without any write conflicts.
+        if ((denseTimesSparse && !transposeB) || (!denseTimesSparse && transposeA))
         {
-            size_t numNonzeroInSparseCol = sparse.SecondaryIndexLocation()[colSparse + 1] - numPreviosNonzero;
-            // Loop over the nonzero rows of the current column of the sparse matrix
-            for (; iNonzero < numNonzeroInSparseCol; iNonzero++)
+#pragma omp parallel for schedule(dynamic, 16) if (sparse.NzCount() * outerDimensionDense > 4096)
+            for (long colSparse = 0; colSparse < numColsSparse; colSparse++)
             {
-                size_t rowSparse = rowIndexBuffer[iNonzero]; // RowLocation
-                ElemType sparseVal = valueBuffer[iNonzero];
-
-                // Determine the index of the 'outer' dimension of the sparse matrix and the common inner index.
-                size_t outerIndexSparse;
-                size_t innerIndex;
-                // Below if-statements are evaluated at compile time.
-                if      ( denseTimesSparse && !transposeB) { outerIndexSparse = colSparse; innerIndex = rowSparse; }
-                else if ( denseTimesSparse &&  transposeB) { outerIndexSparse = rowSparse; innerIndex = colSparse; }
-                else if (!denseTimesSparse && !transposeA) { outerIndexSparse = rowSparse; innerIndex = colSparse; }
-                else if (!denseTimesSparse &&  transposeA) { outerIndexSparse = colSparse; innerIndex = rowSparse; }
-
-                // Loop over the outer index of the dense matrix
-                for (size_t outerIndexDense = 0; outerIndexDense < outerDimensionDense; outerIndexDense++)
+                for (size_t iNonzero = colStart[colSparse] - colStart[0]; iNonzero < colStart[colSparse + 1] - colStart[0]; iNonzero++)
                 {
-                    // Determine the row index of the dense input matrix.
-                    // Below if-statements are evaluated at compile time.
-                    ElemType denseVal;
-                    if      ( denseTimesSparse && !transposeA) denseVal = dense(outerIndexDense,      innerIndex);
-                    else if ( denseTimesSparse &&  transposeA) denseVal = dense(     innerIndex, outerIndexDense);
-                    else if (!denseTimesSparse && !transposeB) denseVal = dense(     innerIndex, outerIndexDense);
-                    else if (!denseTimesSparse &&  transposeB) denseVal = dense(outerIndexDense,      innerIndex);
-
-
-                    // Update matrix c.
-                    if (denseTimesSparse)
-                        c(outerIndexDense, outerIndexSparse) += alpha * denseVal * sparseVal;
-                    else /*Sparse times dense */
-                        c(outerIndexSparse, outerIndexDense) += alpha * denseVal * sparseVal;
+                    size_t rowSparse = rowIndexBuffer[iNonzero]; // RowLocation
+                    axpy(/*innerIndex=*/rowSparse, /*outerIndexSparse=*/colSparse, valueBuffer[iNonzero], 0, outerDimensionDense);
+                }
+            }
+        }
+        // Otherwise different sparse columns may update the same slice of c. Instead we partition the outer index of the dense matrix into
+        // blocks, and each thread applies all non-zero elements to its own block of c.
+        else
+        {
+            const size_t blockSize = 256;
+            const long numBlocks = (long)((outerDimensionDense + blockSize - 1) / blockSize);
+#pragma omp parallel for if (sparse.NzCount() * outerDimensionDense > 4096)
+            for (long block = 0; block < numBlocks; block++)
+            {
+                size_t begin = block * blockSize;
+                size_t end = min(begin + blockSize, outerDimensionDense);
+                for (long colSparse = 0; colSparse < numColsSparse; colSparse++)
+                {
+                    for (size_t iNonzero = colStart[colSparse] - colStart[0]; iNonzero < colStart[colSparse + 1] - colStart[0]; iNonzero++)
+                    {
+                        size_t rowSparse = rowIndexBuffer[iNonzero]; // RowLocation
+                        axpy(/*innerIndex=*/colSparse, /*outerIndexSparse=*/rowSparse, valueBuffer[iNonzero], begin, end);
+                    }
                 }
             }
         }
@@ -1056,22 +1141,32 @@ void CPUSparseMatrix<ElemType>::MultiplyAndAdd(ElemType alpha, const CPUMatrix<E
             c.RequireSizeAndAllocate(m, n, 0, true); // allocate for blockIds
         }
 
-        map<size_t, size_t> col2BlockId;
+        // Each non-zero rhs(rhsRow, rhsCol) contributes alpha * lhs(:, rhsCol) * val to column rhsRow of the result, which is stored
+        // as a dense block of m values. Only the columns (e.g. embedding rows) touched by the minibatch get a block.
+        unordered_map<size_t, size_t> col2BlockId;
         for (size_t blockId = 0; blockId < blockSizePrev; blockId++)
         {
             col2BlockId[c.GetBlockIds()[blockId]] = blockId;
         }
 
+        const CPUSPARSE_INDEX_TYPE* rhsRows = rhs.MajorIndexLocation();
+        const CPUSPARSE_INDEX_TYPE* rhsColStart = rhs.SecondaryIndexLocation();
+        const ElemType* rhsValues = rhs.Buffer() + rhsColStart[0];
+        const size_t rhsNzCount = rhs.NzCount();
+
         size_t blockSizeCurr = blockSizePrev;
-        for (size_t rhsNz = 0; rhsNz < rhs.NzCount(); rhsNz++)
+        vector<size_t> nz2BlockId(rhsNzCount);
+        for (size_t rhsNz = 0; rhsNz < rhsNzCount; rhsNz++)
         {
-            size_t resultCol = rhs.MajorIndexLocation()[rhsNz];
-            if (col2BlockId.find(resultCol) == col2BlockId.end())
+            size_t resultCol = rhsRows[rhsNz];
+            auto iter = col2BlockId.find(resultCol);
+            if (iter == col2BlockId.end())
             {
-                col2BlockId[resultCol] = blockSizeCurr;
+                iter = col2BlockId.insert(make_pair(resultCol, blockSizeCurr)).first;
                 c.GetBlockIds()[blockSizeCurr] = resultCol;
                 blockSizeCurr ++;
             }
+            nz2BlockId[rhsNz] = iter->second;
         }
 
         if (blockSizeCurr > blockSizePrev)
@@ -1081,21 +1176,27 @@ void CPUSparseMatrix<ElemType>::MultiplyAndAdd(ElemType alpha, const CPUMatrix<E
             memset(c.Data() + m * blockSizePrev, 0, sizeof(ElemType) * m * (blockSizeCurr - blockSizePrev));
         }
 
-        for (size_t rhsCol = 0; rhsCol < rhs.GetNumCols(); rhsCol++)
+        // Several non-zeros may map to the same block, so we partition the rows of the result instead: each thread
+        // applies all non-zeros to its own range of rows of every block, which is free of write conflicts.
+        ElemType* results = c.Buffer();
+        const ElemType* lhsData = lhs.Data();
+        const size_t ldLhs = lhs.GetNumRows();
+        const size_t rowBlockSize = 256;
+        const long numRowBlocks = (long)((m + rowBlockSize - 1) / rowBlockSize);
+#pragma omp parallel for if (rhsNzCount * m > 4096)
+        for (long rowBlock = 0; rowBlock < numRowBlocks; rowBlock++)
         {
-            size_t start = rhs.SecondaryIndexLocation()[rhsCol];
-            size_t end = rhs.SecondaryIndexLocation()[rhsCol + 1];
-
-            for (size_t p = start; p < end; p++)
+            size_t rowBegin = rowBlock * rowBlockSize;
+            size_t rowEnd = min(rowBegin + rowBlockSize, m);
+            for (size_t rhsCol = 0; rhsCol < rhs.GetNumCols(); rhsCol++)
             {
-                size_t rhsRow = rhs.MajorIndexLocation()[p];
-                ElemType val = rhs.Buffer()[p];
-
-                ElemType* results = c.Buffer() + col2BlockId[rhsRow] * m;
-                #pragma omp parallel for
-                for (int lhsRow = 0; lhsRow < (int)m; lhsRow++)
+                const ElemType* x = lhsData + rhsCol * ldLhs;
+                for (size_t p = rhsColStart[rhsCol] - rhsColStart[0]; p < rhsColStart[rhsCol + 1] - rhsColStart[0]; p++)
                 {
-                    results[lhsRow] += alpha * lhs((size_t)lhsRow, rhsCol) * val;
+                    ElemType* y = results + nz2BlockId[p] * m;
+                    const ElemType scale = alpha * rhsValues[p];
+                    for (size_t lhsRow = rowBegin; lhsRow < rowEnd; lhsRow++)
+                        y[lhsRow] += scale * x[lhsRow];
                 }
             }
         }
@@ -1333,7 +1434,9 @@ void CPUSparseMatrix<ElemType>::NormalGrad(CPUMatrix<ElemType>& c, const ElemTyp
     if (GetFormat() == MatrixFormat::matrixFormatSparseBlockCol || GetFormat() == MatrixFormat::matrixFormatSparseBlockRow)
     {
         const auto isSparseBlockCol = (GetFormat() == MatrixFormat::matrixFormatSparseBlockCol);
-        for (size_t j = 0; j < GetBlockSize(); j++)
+        // each block covers a different column (row), so blocks can be updated in parallel
+#pragma omp parallel for
+        for (long j = 0; j < (long)GetBlockSize(); j++)
         {
             size_t i = GetBlockIds()[j] - GetBlockIdShift();
             size_t len = (isSparseBlockCol) ? GetNumRows() : GetNumCols();
@@ -1471,6 +1574,67 @@ void CPUSparseMatrix<ElemType>::AdaDelta(CPUMatrix<AccumType>& c, CPUMatrix<Accu
     }
 }
 
+// FSAdaGrad update for a sparse block column gradient (this); only the columns present in the gradient are updated.
+// c holds the smoothed squared gradients and the momentum in dense layout, see CPUMatrix::FSAdagrad().
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::FSAdagrad(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum,
+                                          ElemType adaWeight, ElemType adaMul, ElemType unitGainFactor)
+{
+    size_t numColsNeeded = 2 * GetNumCols();
+
+    if (c.IsEmpty() || (c.GetNumCols() < numColsNeeded))
+    {
+        c.RequireSize(GetNumRows(), numColsNeeded);
+        c.SetValue(0.0);
+    }
+
+    if (c.GetNumRows() != GetNumRows() || c.GetNumCols() != numColsNeeded)
+        LogicError("The matrix gradients does not have expected dimensions.");
+
+    if (GetFormat() != MatrixFormat::matrixFormatSparseBlockCol)
+        LogicError("Unsupported sparse format.");
+
+    size_t n = GetNumElements();
+    const ElemType* grad = Data();
+    ElemType* smoothAda = c.Data();
+    ElemType* smoothMom = c.Data() + n;
+    ElemType* val = functionValues.Data();
+    size_t rows = GetNumRows();
+
+    // Each block belongs to a different column, so the blocks can be processed in parallel.
+#pragma omp parallel for
+    for (long blockId = 0; blockId < (long)GetBlockSize(); blockId++)
+    {
+        size_t columnOffset = (GetBlockIds()[blockId] - GetBlockIdShift()) * rows;
+        size_t blockOffset = blockId * rows;
+        for (size_t row = 0; row < rows; row++)
+        {
+            size_t denseIndex = columnOffset + row;
+            ElemType g = grad[blockOffset + row];
+            ElemType adaSqr = adaWeight * smoothAda[denseIndex] + (1.0f - adaWeight) * g * g;
+            smoothAda[denseIndex] = adaSqr;
+            if (adaSqr != 0.0f)
+            {
+                ElemType ada = sqrt(adaSqr);
+                ElemType w = adaMul * ((ElemType) 1.0 / ada);
+
+                if (w > 10.0f)
+                    w = 10.0f;
+                g *= w;
+            }
+
+            if (momentum > 0.0f)
+            {
+                g = momentum * smoothMom[denseIndex] + unitGainFactor * g;
+                smoothMom[denseIndex] = g;
+            }
+
+            g *= learnRatePerSample;
+            val[denseIndex] -= g;
+        }
+    }
+}
+
 template <class ElemType>
 CPUSparseMatrix<ElemType>& CPUSparseMatrix<ElemType>::InplaceTruncateTop(const ElemType threshold)
 {
@@ -1097,7 +1097,9 @@ GPUMatrix<ElemType>& GPUMatrix<ElemType>::DoScatterColumnsOf(ElemType beta, cons
 
     // pre-scale with beta upfront
     // Scatter may add more than one source column to the same target, so we must pre-scale with beta, and then just keep adding.
-    Scale(beta, us); // if beta is 0, then this will be a memset()
+    // If beta is 1, the target is left alone, so that a sparse update of a large matrix only touches the scattered columns.
+    if (beta != 1)
+        Scale(beta, us); // if beta is 0, then this will be a memset()
 
     // launch the kernel
     CUDA_LONG NN = (CUDA_LONG)(a.GetNumElements()); // linear space identifying each individual input element
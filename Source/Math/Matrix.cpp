@@ -1467,6 +1467,35 @@ void Matrix<ElemType>::AdjustSparseBlockColumn(const GPUSPARSE_INDEX_TYPE* cpuCo
         m_GPUSparseMatrix->AdjustCol2BlockId(cpuCol2BlockId, numBlocks, useBlockId2Col));
 }
 
+///
+/// returns the columns of a sparse block column matrix that own a block, in block order
+///
+template <class ElemType>
+void Matrix<ElemType>::GetSparseBlockColumnIds(std::vector<size_t>& columnIds) const
+{
+    DISPATCH_MATRIX_ON_FLAG(this,
+        nullptr,
+        NOT_IMPLEMENTED,
+        NOT_IMPLEMENTED,
+        m_CPUSparseMatrix->GetBlockColumnIds(columnIds),
+        NOT_IMPLEMENTED);
+}
+
+///
+/// adjusts the sparse block column matrix so that block i holds column columnIds[i]
+/// columnIds must contain all columns that currently own a block; the other blocks are filled with zeros
+///
+template <class ElemType>
+void Matrix<ElemType>::AdjustSparseBlockColumnIds(const std::vector<size_t>& columnIds)
+{
+    DISPATCH_MATRIX_ON_FLAG(this,
+        this,
+        NOT_IMPLEMENTED,
+        NOT_IMPLEMENTED,
+        m_CPUSparseMatrix->AdjustBlockColumnIds(columnIds.data(), columnIds.size()),
+        NOT_IMPLEMENTED);
+}
+
 template <class ElemType>
 void Matrix<ElemType>::SetDiagonalValue(const ElemType v)
 {
@@ -1817,7 +1846,12 @@ void Matrix<ElemType>::FSAdagradUpdate(Matrix<ElemType>& gradients, Matrix<ElemT
                                    (ElemType)targetAdagradAvDenom_x_sqrtAdagradSqrFrames, unitGainFactor);
             SetDataLocation(GPU);
         },
-        { NOT_IMPLEMENTED; },
+        {
+            gradients.m_CPUSparseMatrix->FSAdagrad(*m_CPUMatrix, *functionValues.m_CPUMatrix,
+                                                   (ElemType)learnRatePerSample, (ElemType)meanMomentum, (ElemType)varMomentum,
+                                                   (ElemType)targetAdagradAvDenom_x_sqrtAdagradSqrFrames, unitGainFactor);
+            SetDataLocation(CPU);
+        },
         {
             gradients.m_GPUSparseMatrix->FSAdagrad(*m_GPUMatrix, *functionValues.m_GPUMatrix,
                                                    (ElemType)learnRatePerSample, (ElemType)meanMomentum, (ElemType)varMomentum,
@@ -300,6 +300,9 @@ public:
     void SetColumn(const Matrix<ElemType>& valMat, size_t colInd);
 
     void AdjustSparseBlockColumn(const GPUSPARSE_INDEX_TYPE* cpuCol2BlockId, size_t numBlocks, bool useBlockId2Col);
+    // CPU counterpart of the above, based on the list of columns that own a block instead of a col2BlockId map over all columns
+    void GetSparseBlockColumnIds(std::vector<size_t>& columnIds) const;
+    void AdjustSparseBlockColumnIds(const std::vector<size_t>& columnIds);
 
     void SetDiagonalValue(const ElemType v);
     void SetDiagonalValue(const Matrix<ElemType>& vector);
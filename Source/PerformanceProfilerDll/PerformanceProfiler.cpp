@@ -17,8 +17,11 @@
 #include "fileutil.h"
 #include "TimerUtility.h"
 #include <algorithm>
+#include <atomic>
+#include <climits>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include <stdio.h>
 #ifndef CPUONLY
 #include <cuda_runtime_api.h>
@@ -28,6 +31,7 @@
 #include <Windows.h>
 #else
 #include <sys/syscall.h>
+#include <unistd.h>
 #endif 
 
 
@@ -80,17 +84,37 @@ struct FixedEventRecord
     long long       totalBytes;   // used only for throughput events
 };
 
+//
+// Custom event types. Only time events appear in the detail log, all of them appear in the trace.
+//
+enum CustomEventType
+{
+    customEvtTime = 0,
+    customEvtFlowBegin,
+    customEvtFlowEnd,
+    customEvtCounter
+};
+
 //
 // The custom event record is a variable size datastructure in memory:
-// NULL terminated description string, followed by CustomEventRecord struct
+// CustomEventRecord struct, followed by NULL terminated description string, padded to the record alignment.
 //
 struct CustomEventRecord
 {
-    long long       beginClock;
-    long long       endClock;
+    unsigned int    recordBytes;  // size of the record including description and padding
     unsigned int    threadId;
+    int             eventType;    // CustomEventType
+    long long       beginClock;
+    long long       endClock;     // same as beginClock for flow and counter events
+    union
+    {
+        unsigned long long  flowId;       // customEvtFlowBegin/customEvtFlowEnd
+        double              counterValue; // customEvtCounter
+    };
 };
 
+static const size_t c_customEventAlignment = sizeof(long long);
+
 
 //
 // Global state of the profiler
@@ -104,8 +128,11 @@ struct ProfilerState
     std::wstring            logSuffix;                   // Suffix to append to report/log file names
     FixedEventRecord        fixedEvents[profilerEvtMax]; // Profiling data for each fixed event
     bool                    customEventBufferFull;       // Is custom event buffer full?
+    bool                    ringBuffer;                  // Overwrite oldest custom events when the buffer is full
     unsigned long long      customEventBufferBytes;      // Number of bytes allocated for the custom event buffer
+    unsigned long long      customEventBegin;            // Offset to the oldest record in buffer
     unsigned long long      customEventOffset;           // Offset to current place in buffer
+    unsigned long long      customEventWrapOffset;       // If the ring buffer has wrapped: end of the records before the wrap, else 0
     unique_ptr<char[]>      customEventBuffer;           // Pointer to custom event buffer
 };
 
@@ -116,14 +143,20 @@ static unique_ptr<ProfilerState> g_profilerState;
 // Mutex controlling access to g_profilerState
 static std::mutex g_mutex;
 
+// Source of flow ids, unique within the process
+static std::atomic<unsigned long long> g_nextFlowId(1);
+
 // Forward declarations
 unsigned int GetThreadId();
+unsigned int GetProcessId();
 
 void ProfilerGenerateReport(const std::wstring& fileName, struct tm* timeInfo);
 void FormatTimeStr(char* str, size_t strLen, double value);
 void FormatThroughputStr(char* str, size_t strLen, double value);
 void FormatBytesStr(char* str, size_t strLen, long long bytes);
 void ProfilerGenerateDetailFile(const std::wstring& fileName);
+void ProfilerGenerateTraceFile(const std::wstring& fileName, const std::vector<char>& records, const std::wstring& logSuffix);
+void ProfilerCopyCustomEvents(std::vector<char>& records, const long long sinceClock);
 
 
 double TicksToSeconds(long long ticks)
@@ -145,9 +178,10 @@ double TicksSqToSecondsSq(double ticksSq)
 // customEventBufferBytes: Size of the custom event buffer.
 // logSuffix: Suffix string to append to log file names.
 // syncGpu: Wait for GPU to complete processing for each profiling event with syncGpu flag set.
+// ringBuffer: Overwrite the oldest events when the custom event buffer is full, instead of dropping new ones.
 //
 void PERF_PROFILER_API ProfilerInit(const std::wstring& profilerDir, const unsigned long long customEventBufferBytes,
-    const std::wstring& logSuffix, const bool syncGpu)
+    const std::wstring& logSuffix, const bool syncGpu, const bool ringBuffer)
 {
     if (g_profilerState != nullptr)
     {
@@ -159,8 +193,11 @@ void PERF_PROFILER_API ProfilerInit(const std::wstring& profilerDir, const unsig
     g_profilerState->logSuffix = logSuffix;
 
     g_profilerState->customEventBufferFull = false;
+    g_profilerState->ringBuffer = ringBuffer;
     g_profilerState->customEventBufferBytes = customEventBufferBytes;
+    g_profilerState->customEventBegin = 0ull;
     g_profilerState->customEventOffset = 0ull;
+    g_profilerState->customEventWrapOffset = 0ull;
     g_profilerState->customEventBuffer.reset(new char[customEventBufferBytes]);
 
     g_profilerState->syncGpu = syncGpu;
@@ -210,35 +247,99 @@ void ProfilerTimeRecordFixedEvent(const int eventId, const long long beginClock,
     g_profilerState->fixedEvents[eventId].cnt++;
 }
 
-void ProfilerTimeRecordToBuffer(const char* eventDescription, const long long beginClock, const long long endClock)
+//
+// Reserve space for a custom event record of the given size, evicting the oldest records in ring buffer mode.
+// Returns nullptr if the record cannot be stored. Must be called with g_mutex held.
+//
+char* ProfilerReserveCustomEvent(const unsigned long long requiredBufferBytes)
 {
-    std::lock_guard<std::mutex> lock(g_mutex);
-
-    if (!g_profilerState->enabled)
-        return;
-
-    auto eventDescriptionBytes = strlen(eventDescription) + 1;
-    auto requiredBufferBytes = eventDescriptionBytes + sizeof(CustomEventRecord);
-    if ((g_profilerState->customEventOffset + requiredBufferBytes) > g_profilerState->customEventBufferBytes)
+    auto& state = *g_profilerState;
+    if (!state.ringBuffer || requiredBufferBytes > state.customEventBufferBytes)
     {
-        if (!g_profilerState->customEventBufferFull)
+        if ((state.customEventOffset + requiredBufferBytes) > state.customEventBufferBytes)
         {
-            fprintf(stderr, "Warning: Performance Profiler: Buffer is full, no more events will be recorded.\n");
-            g_profilerState->customEventBufferFull = true;
+            if (!state.customEventBufferFull)
+            {
+                fprintf(stderr, "Warning: Performance Profiler: Buffer is full, no more events will be recorded.\n");
+                state.customEventBufferFull = true;
+            }
+            return nullptr;
+        }
+    }
+    else
+    {
+        // Records never straddle the end of the buffer. Valid records are [begin, offset) if the buffer has not wrapped,
+        // otherwise [begin, wrapOffset) followed by [0, offset).
+        for (;;)
+        {
+            if (state.customEventWrapOffset == 0)
+            {
+                if ((state.customEventOffset + requiredBufferBytes) <= state.customEventBufferBytes)
+                    break;
+                state.customEventWrapOffset = state.customEventOffset;
+                state.customEventOffset = 0;
+            }
+            if (state.customEventBegin == state.customEventWrapOffset) // records before the wrap all evicted
+            {
+                state.customEventBegin = 0;
+                state.customEventWrapOffset = 0;
+                continue;
+            }
+            if ((state.customEventOffset + requiredBufferBytes) <= state.customEventBegin)
+                break;
+            // evict oldest record
+            state.customEventBegin += ((CustomEventRecord*)(state.customEventBuffer.get() + state.customEventBegin))->recordBytes;
         }
-        return;
     }
 
-    strcpy(g_profilerState->customEventBuffer.get() + g_profilerState->customEventOffset, eventDescription);
-    g_profilerState->customEventOffset += eventDescriptionBytes;
+    char* recordPtr = state.customEventBuffer.get() + state.customEventOffset;
+    state.customEventOffset += requiredBufferBytes;
+    return recordPtr;
+}
+
+//
+// Write a custom event record. Must be called with g_mutex held.
+//
+void ProfilerWriteCustomEvent(const char* eventDescription, const CustomEventType eventType, const long long beginClock, const long long endClock,
+                              const unsigned long long flowId, const double counterValue)
+{
+    auto eventDescriptionBytes = strlen(eventDescription) + 1;
+    auto requiredBufferBytes = sizeof(CustomEventRecord) + eventDescriptionBytes;
+    requiredBufferBytes = (requiredBufferBytes + c_customEventAlignment - 1) / c_customEventAlignment * c_customEventAlignment;
+
+    char* recordPtr = ProfilerReserveCustomEvent(requiredBufferBytes);
+    if (recordPtr == nullptr)
+        return;
 
     CustomEventRecord eventRecord;
+    eventRecord.recordBytes = (unsigned int)requiredBufferBytes;
+    eventRecord.threadId = GetThreadId();
+    eventRecord.eventType = eventType;
     eventRecord.beginClock = beginClock;
     eventRecord.endClock = endClock;
-    eventRecord.threadId = GetThreadId();
+    if (eventType == customEvtCounter)
+        eventRecord.counterValue = counterValue;
+    else
+        eventRecord.flowId = flowId;
+
+    memcpy(recordPtr, &eventRecord, sizeof(CustomEventRecord));
+    strcpy(recordPtr + sizeof(CustomEventRecord), eventDescription);
+}
+
+void ProfilerRecordToBuffer(const char* eventDescription, const CustomEventType eventType, const long long beginClock, const long long endClock,
+                            const unsigned long long flowId, const double counterValue)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    if (!g_profilerState->enabled)
+        return;
+
+    ProfilerWriteCustomEvent(eventDescription, eventType, beginClock, endClock, flowId, counterValue);
+}
 
-    memcpy(g_profilerState->customEventBuffer.get() + g_profilerState->customEventOffset, &eventRecord, sizeof(CustomEventRecord));
-    g_profilerState->customEventOffset += sizeof(CustomEventRecord);
+void ProfilerTimeRecordToBuffer(const char* eventDescription, const long long beginClock, const long long endClock)
+{
+    ProfilerRecordToBuffer(eventDescription, customEvtTime, beginClock, endClock, 0, 0.0);
 }
 
 
@@ -339,6 +440,86 @@ void PERF_PROFILER_API ProfilerThroughputEnd(const long long stateId, const int
     g_profilerState->fixedEvents[eventId].sumsq += (double)kBytesPerSec * (double)kBytesPerSec;
     g_profilerState->fixedEvents[eventId].totalBytes += bytes;
     g_profilerState->fixedEvents[eventId].cnt++;
+
+    // Total bytes so far as counter track in the trace
+    ProfilerWriteCustomEvent(c_fixedEvtDesc[eventId].eventDescription, customEvtCounter, endClock, endClock, 0,
+        (double)g_profilerState->fixedEvents[eventId].totalBytes);
+}
+
+
+//
+// Link events across threads in the trace.
+//
+unsigned long long PERF_PROFILER_API ProfilerFlowBegin(const char* flowName)
+{
+    auto flowId = g_nextFlowId++;
+
+    // A nullptr state indicates that the profiler is globally disabled, and not initialized
+    if (g_profilerState == nullptr)
+        return flowId;
+
+    auto clock = Clock::GetTimeStamp();
+    ProfilerRecordToBuffer(flowName, customEvtFlowBegin, clock, clock, flowId, 0.0);
+    return flowId;
+}
+
+
+void PERF_PROFILER_API ProfilerFlowEnd(const unsigned long long flowId, const char* flowName)
+{
+    // A nullptr state indicates that the profiler is globally disabled, and not initialized
+    if (g_profilerState == nullptr)
+        return;
+
+    auto clock = Clock::GetTimeStamp();
+    ProfilerRecordToBuffer(flowName, customEvtFlowEnd, clock, clock, flowId, 0.0);
+}
+
+
+//
+// Record the current value of a counter.
+//
+void PERF_PROFILER_API ProfilerCounter(const char* counterName, const double value)
+{
+    // A nullptr state indicates that the profiler is globally disabled, and not initialized
+    if (g_profilerState == nullptr)
+        return;
+
+    auto clock = Clock::GetTimeStamp();
+    ProfilerRecordToBuffer(counterName, customEvtCounter, clock, clock, 0, value);
+}
+
+
+void PERF_PROFILER_API ProfilerCounterRate(const long long stateId, const char* counterName, const double amount)
+{
+    // A nullptr state indicates that the profiler is globally disabled, and not initialized
+    if (g_profilerState == nullptr)
+        return;
+
+    auto clock = Clock::GetTimeStamp();
+    if (clock == stateId)
+        return;
+
+    ProfilerRecordToBuffer(counterName, customEvtCounter, clock, clock, 0, amount / TicksToSeconds(clock - stateId));
+}
+
+
+//
+// Write a Chrome Trace Event file with the events of the last lastSeconds seconds (all events if 0).
+//
+void PERF_PROFILER_API ProfilerDumpTrace(const std::wstring& fileName, const double lastSeconds)
+{
+    // A nullptr state indicates that the profiler is globally disabled, and not initialized
+    if (g_profilerState == nullptr)
+        return;
+
+    long long sinceClock = LLONG_MIN;
+    if (lastSeconds > 0.0)
+        sinceClock = Clock::GetTimeStamp() - (long long)(lastSeconds * Clock::GetTicksPerSecond());
+
+    // Take a snapshot so that recording is only blocked for the copy, not for writing the file
+    std::vector<char> records;
+    ProfilerCopyCustomEvents(records, sinceClock);
+    ProfilerGenerateTraceFile(fileName, records, g_profilerState->logSuffix);
 }
 
 
@@ -366,6 +547,10 @@ void PERF_PROFILER_API ProfilerClose()
     fileName = g_profilerState->profilerDir + L"/" + std::wstring(timeStr) + L"_detail_" + g_profilerState->logSuffix + L".csv";
     ProfilerGenerateDetailFile(fileName);
 
+    // Generate trace file
+    fileName = g_profilerState->profilerDir + L"/" + std::wstring(timeStr) + L"_trace_" + g_profilerState->logSuffix + L".json";
+    ProfilerDumpTrace(fileName);
+
     g_profilerState.reset();
 }
 
@@ -387,6 +572,19 @@ unsigned int GetThreadId()
 }
 
 
+//
+// Get current process id
+//
+unsigned int GetProcessId()
+{
+#ifdef _WIN32
+    return (unsigned int)GetCurrentProcessId();
+#else
+    return (unsigned int)getpid();
+#endif
+}
+
+
 //
 // Generate summary report.
 //
@@ -536,15 +734,17 @@ void ProfilerGenerateDetailFile(const std::wstring& fileName)
 
     fprintfOrDie(f, "EventDescription,ThreadId,BeginTimeStamp(ms),EndTimeStamp(ms)\n");
 
-    char* eventPtr = g_profilerState->customEventBuffer.get();
+    std::vector<char> records;
+    ProfilerCopyCustomEvents(records, LLONG_MIN);
 
-    while (eventPtr < (g_profilerState->customEventBuffer.get() + g_profilerState->customEventOffset))
+    for (size_t offset = 0; offset < records.size();)
     {
-        char* descriptionStr = eventPtr;
-        eventPtr += strlen(descriptionStr) + 1;
+        const CustomEventRecord* eventRecord = (const CustomEventRecord*)&records[offset];
+        const char* descriptionStr = &records[offset] + sizeof(CustomEventRecord);
+        offset += eventRecord->recordBytes;
 
-        CustomEventRecord* eventRecord = (CustomEventRecord*)eventPtr;
-        eventPtr += sizeof(CustomEventRecord);
+        if (eventRecord->eventType != customEvtTime)
+            continue;
 
         fprintfOrDie(f, "\"%s\",%u,%.8f,%.8f\n", descriptionStr, eventRecord->threadId, 
             1000.0 * TicksToSeconds(eventRecord->beginClock),
@@ -555,13 +755,115 @@ void ProfilerGenerateDetailFile(const std::wstring& fileName)
 }
 
 
+//
+// Copy the custom event records that end at or after sinceClock, oldest first, into a contiguous buffer.
+//
+void ProfilerCopyCustomEvents(std::vector<char>& records, const long long sinceClock)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    const auto& state = *g_profilerState;
+    auto copySegment = [&](unsigned long long begin, unsigned long long end)
+    {
+        while (begin < end)
+        {
+            const CustomEventRecord* eventRecord = (const CustomEventRecord*)(state.customEventBuffer.get() + begin);
+            if (eventRecord->endClock >= sinceClock)
+                records.insert(records.end(), (const char*)eventRecord, (const char*)eventRecord + eventRecord->recordBytes);
+            begin += eventRecord->recordBytes;
+        }
+    };
+
+    records.clear();
+    if (state.customEventWrapOffset == 0)
+    {
+        copySegment(state.customEventBegin, state.customEventOffset);
+    }
+    else
+    {
+        copySegment(state.customEventBegin, state.customEventWrapOffset);
+        copySegment(0, state.customEventOffset);
+    }
+}
+
+
+//
+// Write a string as JSON string literal.
+//
+void FprintfJsonString(FILE* f, const char* str)
+{
+    fputc('"', f);
+    for (; *str; str++)
+    {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\')
+            fprintfOrDie(f, "\\%c", c);
+        else if (c < 0x20)
+            fprintfOrDie(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+
+//
+// Generate Chrome Trace Event file (JSON array format), see
+// https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+// Time events become complete events on per-thread tracks, flow events link the enclosing time events,
+// and counters become counter tracks. All time stamps are in microseconds.
+//
+void ProfilerGenerateTraceFile(const std::wstring& fileName, const std::vector<char>& records, const std::wstring& logSuffix)
+{
+    FILE* f = _wfopen(fileName.c_str(), L"wt");
+    if (f == NULL)
+    {
+        RuntimeError("Error: ProfilerGenerateTraceFile: Cannot create file <%ls>.\n", fileName.c_str());
+    }
+
+    const unsigned int pid = GetProcessId();
+    fprintfOrDie(f, "{\"traceEvents\":[\n");
+    fprintfOrDie(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"CNTK %ls\"}}", pid, logSuffix.c_str());
+
+    for (size_t offset = 0; offset < records.size();)
+    {
+        const CustomEventRecord* eventRecord = (const CustomEventRecord*)&records[offset];
+        const char* descriptionStr = &records[offset] + sizeof(CustomEventRecord);
+        offset += eventRecord->recordBytes;
+
+        const double beginUs = 1000000.0 * TicksToSeconds(eventRecord->beginClock);
+        fprintfOrDie(f, ",\n{\"name\":");
+        FprintfJsonString(f, descriptionStr);
+        switch (eventRecord->eventType)
+        {
+        case customEvtTime:
+            fprintfOrDie(f, ",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", pid, eventRecord->threadId, beginUs,
+                1000000.0 * TicksToSeconds(eventRecord->endClock - eventRecord->beginClock));
+            break;
+        case customEvtFlowBegin:
+            fprintfOrDie(f, ",\"cat\":\"flow\",\"ph\":\"s\",\"id\":%llu,\"pid\":%u,\"tid\":%u,\"ts\":%.3f}", eventRecord->flowId, pid, eventRecord->threadId, beginUs);
+            break;
+        case customEvtFlowEnd:
+            fprintfOrDie(f, ",\"cat\":\"flow\",\"ph\":\"f\",\"bp\":\"e\",\"id\":%llu,\"pid\":%u,\"tid\":%u,\"ts\":%.3f}", eventRecord->flowId, pid, eventRecord->threadId, beginUs);
+            break;
+        case customEvtCounter:
+            fprintfOrDie(f, ",\"ph\":\"C\",\"pid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.6g}}", pid, beginUs, eventRecord->counterValue);
+            break;
+        }
+    }
+
+    fprintfOrDie(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Scoped helpers.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void ProfilerContext::Init(const std::wstring& profilerDir, const unsigned long long customEventBufferBytes, const std::wstring& logSuffix, const bool syncGpu)
+void ProfilerContext::Init(const std::wstring& profilerDir, const unsigned long long customEventBufferBytes, const std::wstring& logSuffix, const bool syncGpu, const bool ringBuffer)
 {
-    ProfilerInit(profilerDir, customEventBufferBytes, logSuffix, syncGpu);
+    ProfilerInit(profilerDir, customEventBufferBytes, logSuffix, syncGpu, ringBuffer);
 }
 
 ProfilerContext::~ProfilerContext()
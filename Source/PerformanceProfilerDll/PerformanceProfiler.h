@@ -11,7 +11,10 @@
 // To initialize and tear down the profiler, call ProfilerInit() and ProfilerClose(). The scoped
 // object, ProfilerContext can also be used for managing the lifetime of the profiler. The profiler
 // works by accumulating events in a pre-allocated buffer, up until the buffer is full. At the
-// time when the profiler is torn down, a summary report and a detailed log file is written to disk.
+// time when the profiler is torn down, a summary report, a detailed log file and a Chrome Trace Event
+// file (viewable in chrome://tracing or Perfetto) are written to disk. In ring buffer mode, the oldest
+// events are overwritten once the buffer is full instead, so that ProfilerDumpTrace() can write the
+// most recent events of a long running job at any time.
 //
 // When profiling code, two types of events can be used - fixed or custom. A fixed event is
 // predefined in the ProfilerEvents enum and by the FixedEventDesc struct. A custom event is
@@ -26,6 +29,10 @@
 // and ProfilerThroughputEnd() calls should be used. The throughput APIs can only be used
 // with fixed events.
 //
+// For the trace, ProfilerFlowBegin() and ProfilerFlowEnd() link an event on one thread to an event on
+// another thread (e.g. a prefetched minibatch to the place where it is consumed), and ProfilerCounter()
+// records values such as samples/sec that are shown as separate counter tracks.
+//
 // CNTK specifics
 //
 // The profiler is turned off during the very first epoch to avoid polluting profile data with
@@ -90,9 +97,10 @@ enum ProfilerEvents
 // customEventBufferBytes: Bytes to allocate for the custom event buffer.
 // logSuffix: Suffix string to append to log files.
 // syncGpu: Wait for GPU to complete processing for each profiling event.
+// ringBuffer: Overwrite the oldest events when the custom event buffer is full, instead of dropping new ones.
 //
 void PERF_PROFILER_API ProfilerInit(const std::wstring& profilerDir, const unsigned long long customEventBufferBytes,
-    const std::wstring& logSuffix, const bool syncGpu);
+    const std::wstring& logSuffix, const bool syncGpu, const bool ringBuffer = false);
 
 
 //
@@ -128,6 +136,30 @@ long long PERF_PROFILER_API ProfilerThroughputBegin();
 void PERF_PROFILER_API ProfilerThroughputEnd(const long long stateId, const int eventId, const long long bytes);
 
 
+//
+// Link events across threads in the trace. ProfilerFlowBegin() returns a flowId that is passed to
+// ProfilerFlowEnd(). The flow starts in the event that encloses the ProfilerFlowBegin() call and ends
+// in the event that encloses the ProfilerFlowEnd() call, which may be on a different thread.
+//
+unsigned long long PERF_PROFILER_API ProfilerFlowBegin(const char* flowName);
+void PERF_PROFILER_API ProfilerFlowEnd(const unsigned long long flowId, const char* flowName);
+
+
+//
+// Record the current value of a counter, e.g. bytes read.
+// ProfilerCounterRate() records amount per second elapsed since stateId, as returned by ProfilerTimeBegin().
+//
+void PERF_PROFILER_API ProfilerCounter(const char* counterName, const double value);
+void PERF_PROFILER_API ProfilerCounterRate(const long long stateId, const char* counterName, const double amount);
+
+
+//
+// Write a Chrome Trace Event file with the events of the last lastSeconds seconds (all events if 0).
+// Can be called at any time, e.g. to inspect a long running job that uses the ring buffer mode.
+//
+void PERF_PROFILER_API ProfilerDumpTrace(const std::wstring& fileName, const double lastSeconds = 0.0);
+
+
 //
 // Generate reports and release all resources.
 //
@@ -139,7 +171,7 @@ void PERF_PROFILER_API ProfilerClose();
 //
 struct PERF_PROFILER_API ProfilerContext
 {
-    void Init(const std::wstring& profilerDir = L"", const unsigned long long customEventBufferBytes = (32 * 1024 * 1024), const std::wstring& logSuffix = L"", const bool syncGpu = false);
+    void Init(const std::wstring& profilerDir = L"", const unsigned long long customEventBufferBytes = (32 * 1024 * 1024), const std::wstring& logSuffix = L"", const bool syncGpu = false, const bool ringBuffer = false);
     ~ProfilerContext();
 };
 
@@ -128,6 +128,13 @@ TextConfigHelper::TextConfigHelper(const ConfigParameters& config)
     m_keepDataInMemory = config(L"keepDataInMemory", false);
     m_frameMode = config(L"frameMode", false);
     m_cacheIndex = config(L"cacheIndex", false);
+    m_indexCacheWaitTimeout = config(L"indexCacheWaitTimeout", (size_t)0);
+    if (m_indexCacheWaitTimeout > 0 && !m_cacheIndex)
+        InvalidArgument("'indexCacheWaitTimeout' requires 'cacheIndex' to be enabled.");
+    m_streaming = config(L"streaming", false);
+    m_followInput = config(L"followInput", false);
+    if (m_followInput && !m_streaming)
+        InvalidArgument("'followInput' requires 'streaming' to be enabled.");
 
     m_randomizationWindow = GetRandomizationWindowFromConfig(config);
     m_sampleBasedRandomizationWindow = config(L"sampleBasedRandomizationWindow", false);
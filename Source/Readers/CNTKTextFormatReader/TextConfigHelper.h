@@ -33,6 +33,8 @@ public:
 
     bool ShouldCacheIndex() const { return m_cacheIndex; }
 
+    size_t GetIndexCacheWaitTimeout() const { return m_indexCacheWaitTimeout; }
+
     unsigned int GetMaxAllowedErrors() const { return m_maxErrors; }
 
     unsigned int GetTraceLevel() const { return m_traceLevel; }
@@ -45,6 +47,10 @@ public:
 
     DataType GetDataType() const { return m_elementType; }
 
+    bool IsStreaming() const { return m_streaming; }
+
+    bool ShouldFollowInput() const { return m_followInput; }
+
     DISABLE_COPY_AND_MOVE(TextConfigHelper);
 
 private:
@@ -63,6 +69,9 @@ private:
     bool m_frameMode; // if true, the maximum expected sequence length in the dataset is one sample.
     bool m_cacheIndex; // When true, the index will be loaded from a cache file it if exists.
                        // If cache does not exist, the index, once created, will be written out to a file.
+    size_t m_indexCacheWaitTimeout; // seconds other workers on the node wait for the main one to write the index cache.
+    bool m_streaming; // if true, the input is read sequentially without building an index upfront.
+    bool m_followInput; // if true (in streaming mode), the input is expected to grow, reaching its end means waiting for new data.
 };
 
 }
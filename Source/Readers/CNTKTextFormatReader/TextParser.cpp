@@ -70,7 +70,11 @@ TextParser(corpus, helper.GetFilePath(), helper.GetStreams(), primary)
     SetChunkSize(helper.GetChunkSize());
     SetSkipSequenceIds(helper.ShouldSkipSequenceIds());
 
-    SetCacheIndex(helper.ShouldCacheIndex());
+    SetCacheIndex(helper.ShouldCacheIndex(), helper.GetIndexCacheWaitTimeout());
+    SetStreaming(helper.IsStreaming(), helper.ShouldFollowInput());
+
+    if (m_streaming && !primary)
+        InvalidArgument("A streaming text deserializer must be the primary deserializer.");
 
     Initialize();
 }
@@ -93,7 +97,11 @@ TextParser<ElemType>::TextParser(CorpusDescriptorPtr corpus, const std::wstring&
     m_numRetries(5),
     m_corpus(corpus),
     m_useMaximumAsSequenceLength(true),
-    m_cacheIndex(false)
+    m_cacheIndex(false),
+    m_indexCacheWaitTimeout(0),
+    m_streaming(false),
+    m_followInput(false),
+    m_streamOneSequencePerLine(-1)
 {
     assert(streams.size() > 0);
 
@@ -161,7 +169,7 @@ void TextParser<ElemType>::PrintWarningNotification()
 template <class ElemType>
 void TextParser<ElemType>::Initialize()
 {
-    if (m_index != nullptr)
+    if (m_index != nullptr || m_streamFile != nullptr)
     {
         return;
     }
@@ -180,6 +188,15 @@ void TextParser<ElemType>::Initialize()
                 "UTF-16 encoding is currently not supported.", m_filename.c_str());
         }
 
+        if (m_streaming)
+        {
+            // No index, the chunks are indexed one by one while the input is read, see TryReadChunk.
+            m_streamFile = std::make_shared<FileWrapper>(m_filename, L"rbS");
+            m_streamFile->CheckIsOpenOrDie();
+            m_fileReader = std::make_shared<BufferedFileReader>(BUFFER_SIZE, *m_file);
+            return;
+        }
+
         TextInputIndexBuilder builder(*m_file);
 
         builder.SetSkipSequenceIds(m_skipSequenceIds)
@@ -187,7 +204,8 @@ void TextParser<ElemType>::Initialize()
             .SetCorpus(m_corpus)
             .SetPrimary(m_primary)
             .SetChunkSize(m_chunkSizeBytes)
-            .SetCachingEnabled(m_cacheIndex);
+            .SetCachingEnabled(m_cacheIndex)
+            .SetCacheWaitTimeout(m_indexCacheWaitTimeout);
 
         if (!m_useMaximumAsSequenceLength)
         {
@@ -201,12 +219,16 @@ void TextParser<ElemType>::Initialize()
         m_fileReader = std::make_shared<BufferedFileReader>(BUFFER_SIZE, *m_file);
     });
 
-    assert(m_index != nullptr);
+    assert(m_index != nullptr || m_streaming);
 }
 
 template <class ElemType>
 std::vector<ChunkInfo> TextParser<ElemType>::ChunkInfos()
 {
+    // In streaming mode the chunks are not known upfront.
+    if (m_streaming)
+        return {};
+
     assert(m_index != nullptr);
 
     std::vector<ChunkInfo> result;
@@ -226,6 +248,9 @@ std::vector<ChunkInfo> TextParser<ElemType>::ChunkInfos()
 template <class ElemType>
 void TextParser<ElemType>::SequenceInfosForChunk(ChunkIdType chunkId, std::vector<SequenceInfo>& result)
 {
+    if (m_streaming)
+        LogicError("Chunks of a streamed input can only be read sequentially.");
+
     const auto& chunk = m_index->Chunks()[chunkId];
     result.reserve(chunk.NumberOfSequences());
 
@@ -261,6 +286,9 @@ void TextParser<ElemType>::TextDataChunk::GetSequence(size_t sequenceId, std::ve
 template <class ElemType>
 ChunkPtr TextParser<ElemType>::GetChunk(ChunkIdType chunkId)
 {
+    if (m_streaming)
+        LogicError("Chunks of a streamed input can only be read sequentially.");
+
     const auto& chunkDescriptor = m_index->Chunks()[chunkId];
     auto textChunk = make_shared<TextDataChunk>(this);
 
@@ -278,6 +306,242 @@ ChunkPtr TextParser<ElemType>::GetChunk(ChunkIdType chunkId)
     return textChunk;
 }
 
+template <class ElemType>
+bool TextParser<ElemType>::TryReadChunk(size_t position, ChunkIdType chunkId, bool loadData, StreamingChunk& result)
+{
+    if (!m_streaming)
+        LogicError("The text deserializer is not in streaming mode.");
+
+    std::shared_ptr<Index> index;
+    attempt(m_numRetries, [this, &index, &result, position]()
+    {
+        index = IndexStreamingChunk(position, result.m_endPosition);
+    });
+
+    if (!index)
+        return false;
+
+    const auto& descriptor = index->Chunks().front();
+    result.m_sequences.clear();
+    result.m_sequences.reserve(descriptor.NumberOfSequences());
+    for (size_t sequenceIndex = 0; sequenceIndex < descriptor.NumberOfSequences(); ++sequenceIndex)
+    {
+        auto const& s = descriptor.Sequences()[sequenceIndex];
+        result.m_sequences.push_back({ sequenceIndex, s.m_numberOfSamples, chunkId, SequenceKey{ s.m_key, 0 } });
+    }
+
+    result.m_data = nullptr;
+    if (!loadData)
+        return true;
+
+    auto textChunk = make_shared<TextDataChunk>(this);
+    attempt(m_numRetries, [this, &textChunk, &descriptor]()
+    {
+        // The input may have grown after the reader reached its end, so start over with a fresh buffer.
+        if (m_file->CheckError())
+        {
+            m_file.reset(new FileWrapper(m_filename, L"rbS"));
+            m_file->CheckIsOpenOrDie();
+        }
+
+        m_file->SeekOrDie(descriptor.StartOffset(), SEEK_SET);
+        m_fileReader = std::make_shared<BufferedFileReader>(BUFFER_SIZE, *m_file);
+        LoadChunk(textChunk, descriptor);
+    });
+
+    result.m_data = textChunk;
+    return true;
+}
+
+// A chunk of a streamed input holds the sequences that are known to be complete within the next chunkSizeInBytes
+// of the input (the region is doubled until there is at least one), so that its boundaries only depend on the position
+// and not on how much of the input is available. Hence, while following a growing input, the chunk is only indexed once chunkSizeInBytes
+// of input is available after the position. A sequence is complete when the next line starts a different sequence
+// (or, without sequence ids, at the end of its line).
+template <class ElemType>
+std::shared_ptr<Index> TextParser<ElemType>::IndexStreamingChunk(size_t position, size_t& endPosition)
+{
+    static const char s_BOM[3] = { '\xEF', '\xBB', '\xBF' };
+
+    size_t fileSize = m_streamFile->Filesize();
+    vector<char> buffer;
+    auto read = [this, &buffer](size_t begin, size_t end)
+    {
+        buffer.resize(end - begin);
+        m_streamFile->SeekOrDie(begin, SEEK_SET);
+        if (!buffer.empty())
+            m_streamFile->ReadOrDie(buffer.data(), 1, buffer.size());
+    };
+
+    size_t start = position;
+    if (position == 0 || m_streamOneSequencePerLine < 0)
+    {
+        // Skip the BOM prefix and leading spaces at the beginning of the input,
+        // as the first character tells whether it has sequence ids.
+        read(0, min(fileSize, (size_t)BUFFER_SIZE));
+        size_t i = 0;
+        for (; i < sizeof(s_BOM) && i < buffer.size() && buffer[i] == s_BOM[i]; ++i);
+        for (; i < buffer.size() && isspace((unsigned char)buffer[i]); ++i);
+        if (i == buffer.size())
+            return nullptr;
+
+        bool oneSequencePerLine = m_skipSequenceIds || buffer[i] == NAME_PREFIX;
+        if (oneSequencePerLine && m_corpus && !m_corpus->IsNumericSequenceKeys())
+            RuntimeError("Corpus expects non-numeric sequence keys present but the input file does not have them."
+                "Please use the configuration to enable numeric keys instead.");
+
+        m_streamOneSequencePerLine = oneSequencePerLine ? 1 : 0;
+        if (position == 0)
+            start = i;
+    }
+
+    bool numericKeys = !m_corpus || m_corpus->IsNumericSequenceKeys();
+    auto tryGetSequenceId = [this, numericKeys](const char* begin, const char* end, size_t& id)
+    {
+        const char* p = begin;
+        if (numericKeys)
+        {
+            id = 0;
+            for (; p != end && IsDigit(*p); ++p)
+            {
+                size_t temp = id;
+                id = id * 10 + (*p - '0');
+                if (temp > id)
+                    RuntimeError("Overflow while reading a numeric sequence id (%zu-bit value).", sizeof(id));
+            }
+        }
+        else
+        {
+            for (; p != end && !isspace((unsigned char)*p); ++p);
+            if (p != begin && p != end)
+                id = m_corpus->KeyToId(string(begin, p));
+        }
+        // The id has to be followed by another character, as in the indexer.
+        return p != begin && p != end;
+    };
+
+    vector<IndexedSequence> sequences;
+    size_t chunkEnd = 0;
+    for (size_t limit = m_chunkSizeBytes; start < fileSize; limit *= 2)
+    {
+        size_t regionEnd = start + limit < start ? fileSize : min(fileSize, start + limit);
+        bool isRegionFull = regionEnd - start == limit;
+        bool atEndOfInput = regionEnd == fileSize && !m_followInput;
+        read(start, regionEnd);
+
+        sequences.clear();
+        chunkEnd = 0;
+        const char* data = buffer.data();
+        size_t lineBegin = 0;
+        bool isSequenceOpen = false, foundMainStream = false;
+        size_t sequenceId = 0, sequenceBegin = 0;
+        uint32_t numberOfSamples = 0;
+        while (lineBegin < buffer.size())
+        {
+            auto eol = (const char*)memchr(data + lineBegin, ROW_DELIMITER, buffer.size() - lineBegin);
+            if (!eol && !atEndOfInput)
+                break; // incomplete line
+
+            size_t lineEnd = eol ? eol - data + 1 : buffer.size();
+            bool hasMainStream = HasMainStream(data + lineBegin, data + lineEnd);
+            if (m_streamOneSequencePerLine)
+            {
+                // Sequences do not have ids, they are identified by their offset in the input.
+                if (hasMainStream)
+                    sequences.push_back(IndexedSequence().SetKey(start + lineBegin).SetNumberOfSamples(1)
+                        .SetOffset(start + lineBegin).SetSize(lineEnd - lineBegin));
+                chunkEnd = lineEnd;
+            }
+            else
+            {
+                size_t id = 0;
+                bool hasId = tryGetSequenceId(data + lineBegin, data + lineEnd, id);
+                if (!isSequenceOpen)
+                {
+                    if (!hasId)
+                        RuntimeError("Expected a sequence id at the offset %zu, none was found.", start + lineBegin);
+                    isSequenceOpen = true;
+                    sequenceId = id;
+                }
+                else if (hasId && id != sequenceId)
+                {
+                    // The line starts a new sequence, the previous one is complete.
+                    if (foundMainStream)
+                        sequences.push_back(IndexedSequence().SetKey(sequenceId).SetNumberOfSamples(numberOfSamples)
+                            .SetOffset(start + sequenceBegin).SetSize(lineBegin - sequenceBegin));
+                    chunkEnd = lineBegin;
+                    sequenceId = id;
+                    sequenceBegin = lineBegin;
+                    numberOfSamples = 0;
+                    foundMainStream = false;
+                }
+
+                if (hasMainStream)
+                {
+                    numberOfSamples++;
+                    foundMainStream = true;
+                }
+            }
+
+            lineBegin = lineEnd;
+        }
+
+        if (!m_streamOneSequencePerLine && isSequenceOpen && atEndOfInput && lineBegin == buffer.size())
+        {
+            // The last sequence of the input.
+            if (foundMainStream)
+                sequences.push_back(IndexedSequence().SetKey(sequenceId).SetNumberOfSamples(numberOfSamples)
+                    .SetOffset(start + sequenceBegin).SetSize(lineBegin - sequenceBegin));
+            chunkEnd = lineBegin;
+        }
+
+        if (!sequences.empty())
+        {
+            // While following the input, wait until the whole chunk is available.
+            if (!isRegionFull && !atEndOfInput)
+                return nullptr;
+            break;
+        }
+
+        // No complete sequence in the region: either there is no more data (yet),
+        // or the first sequence is longer than the chunk size.
+        if (!isRegionFull)
+            return nullptr;
+    }
+
+    if (sequences.empty())
+        return nullptr;
+
+    auto index = make_shared<Index>(chunkEnd);
+    for (const auto& sequence : sequences)
+        index->AddSequence(sequence);
+
+    endPosition = start + chunkEnd;
+    return index;
+}
+
+template <class ElemType>
+bool TextParser<ElemType>::HasMainStream(const char* begin, const char* end) const
+{
+    if (m_useMaximumAsSequenceLength)
+        return true;
+
+    const auto& alias = std::find_if(m_streamDescriptors.begin(), m_streamDescriptors.end(),
+        [](const StreamDescriptor& s) { return s.m_definesMbSize; })->m_alias;
+
+    for (const char* p = begin; p + alias.size() < end; ++p)
+    {
+        if (*p != NAME_PREFIX || memcmp(p + 1, alias.data(), alias.size()) != 0)
+            continue;
+
+        // The name has to be followed by a space, a stream prefix or a non-printable character (or the end of the line).
+        const char* next = p + 1 + alias.size();
+        if (next == end || isspace((unsigned char)*next) || *next == NAME_PREFIX || isNonPrintable(*next))
+            return true;
+    }
+    return false;
+}
+
 template <class ElemType>
 void TextParser<ElemType>::LoadChunk(TextChunkPtr& chunk, const ChunkDescriptor& descriptor)
 {
@@ -1227,9 +1491,17 @@ void TextParser<ElemType>::SetNumRetries(unsigned int numRetries)
 }
 
 template <class ElemType>
-void TextParser<ElemType>::SetCacheIndex(bool value)
+void TextParser<ElemType>::SetCacheIndex(bool value, size_t waitTimeoutInSeconds)
 {
     m_cacheIndex = value;
+    m_indexCacheWaitTimeout = waitTimeoutInSeconds;
+}
+
+template <class ElemType>
+void TextParser<ElemType>::SetStreaming(bool streaming, bool followInput)
+{
+    m_streaming = streaming;
+    m_followInput = followInput;
 }
 
 template<class ElemType>
@@ -1255,6 +1527,9 @@ std::wstring TextParser<ElemType>::GetFileInfo()
 template <class ElemType>
 bool TextParser<ElemType>::GetSequenceInfoByKey(const SequenceKey& key, SequenceInfo& r)
 {
+    if (m_streaming)
+        LogicError("Sequences of a streamed input cannot be looked up by key.");
+
     return DataDeserializerBase::GetSequenceInfoByKey(*m_index, key, r);
 }
 
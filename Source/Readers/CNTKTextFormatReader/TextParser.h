@@ -6,6 +6,7 @@
 #pragma once
 
 #include "DataDeserializerBase.h"
+#include "StreamingDeserializer.h"
 #include "Descriptors.h"
 #include "TextConfigHelper.h"
 #include "Index.h"
@@ -22,7 +23,7 @@ class BufferedFileReader;
 // TODO: more details when tracing warnings
 // (e.g., buffer content around the char that triggered the warning)
 template <class ElemType>
-class TextParser : public DataDeserializerBase {
+class TextParser : public DataDeserializerBase, public StreamingDeserializer {
 public:
     TextParser(CorpusDescriptorPtr corpus, const TextConfigHelper& helper, bool pimary);
     ~TextParser();
@@ -38,6 +39,13 @@ public:
 
     bool GetSequenceInfoByKey(const SequenceKey&, SequenceInfo&) override;
 
+    // Streaming mode, the input is indexed chunk by chunk while it is read.
+    bool IsStreaming() const override { return m_streaming; }
+
+    bool IsFollowingInput() const override { return m_followInput; }
+
+    bool TryReadChunk(size_t position, ChunkIdType chunkId, bool loadData, StreamingChunk& result) override;
+
 private:
     TextParser(CorpusDescriptorPtr corpus, const std::wstring& filename, const vector<StreamDescriptor>& streams, bool primary = true);
 
@@ -133,6 +141,12 @@ private:
     unsigned int m_numAllowedErrors;
     bool m_skipSequenceIds;
     bool m_cacheIndex;
+    size_t m_indexCacheWaitTimeout;
+    bool m_streaming;
+    bool m_followInput;
+    // In streaming mode, file used to index the chunks, and whether the input has one sequence per line (-1 if not known yet).
+    std::shared_ptr<FileWrapper> m_streamFile;
+    int m_streamOneSequencePerLine;
     unsigned int m_numRetries; // specifies the number of times an unsuccessful
                                // file operation should be repeated (default value is 5).
 
@@ -201,7 +215,16 @@ private:
 
     void SetNumRetries(unsigned int numRetries);
 
-    void SetCacheIndex(bool value);
+    void SetCacheIndex(bool value, size_t waitTimeoutInSeconds = 0);
+
+    void SetStreaming(bool streaming, bool followInput);
+
+    // Indexes the chunk of complete sequences that starts at the given position of a streamed input.
+    // Returns nullptr if there is no such chunk (yet), see TryReadChunk.
+    std::shared_ptr<Index> IndexStreamingChunk(size_t position, size_t& endPosition);
+
+    // Returns true if the line [begin, end) has a sample of the stream that defines the sequence length.
+    bool HasMainStream(const char* begin, const char* end) const;
 
     friend class CNTKTextFormatReaderTestRunner<ElemType>;
 
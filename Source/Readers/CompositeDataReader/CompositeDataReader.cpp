@@ -25,6 +25,7 @@
 #include "V2Dependencies.h"
 #include "LTNoRandomizer.h"
 #include "LTTumblingWindowRandomizer.h"
+#include "LTStreamingRandomizer.h"
 
 namespace CNTK {
 
@@ -116,8 +117,36 @@ CompositeDataReader::CompositeDataReader(const ConfigParameters& config) :
     // i.e. decompression of images.
     bool multiThreadedDeserialization = config(L"multiThreadedDeserialization", ContainsDeserializer(config, L"ImageDeserializer"));
 
-    if (!composable) // Pick up simple interface.
+    // Number of buckets into which the sequences of each randomized chunk are grouped by length,
+    // to reduce padding in sequence mode. 0 (default) keeps the randomized order.
+    size_t lengthBuckets = config(L"lengthBuckets", (size_t)0);
+
+    // A streaming deserializer reads its input sequentially without an index, so it cannot be bundled with others.
+    auto streamingDeserializer = std::dynamic_pointer_cast<StreamingDeserializer>(m_deserializers.front());
+    bool streaming = streamingDeserializer && streamingDeserializer->IsStreaming();
+    if (streaming && m_deserializers.size() > 1)
+        InvalidArgument("A streaming deserializer cannot be composed with other deserializers. Please specify a single deserializer.");
+
+    if (streaming)
+    {
+        if (lengthBuckets > 1)
+            fprintf(stderr, "WARNING: 'lengthBuckets' is not supported with a streaming deserializer and will be ignored.\n");
+
+        // The whole input is never known, so the window has to be given explicitly when randomizing.
+        bool sampleBasedRandomizationWindow = config(L"sampleBasedRandomizationWindow", false);
+        if (randomize && !config.ExistsCurrent(L"randomizationWindow"))
+            LogicError("A streaming deserializer requires that the 'randomizationWindow' is explicitly specified.");
+
+        m_sequenceEnumerator = std::make_shared<LTStreamingRandomizer>(deserializer, randomize,
+            sampleBasedRandomizationWindow, config(L"randomizationWindow", (size_t)1),
+            GetRandomSeed(config), config(L"pollingIntervalInMs", (size_t)1000),
+            multiThreadedDeserialization, maxErrors);
+    }
+    else if (!composable) // Pick up simple interface.
     {
+        if (lengthBuckets > 1)
+            fprintf(stderr, "WARNING: 'lengthBuckets' is only supported with composable deserializers and will be ignored.\n");
+
         if (randomize)
         {
             bool sampleBasedRandomizationWindow = config(L"sampleBasedRandomizationWindow", false);
@@ -163,9 +192,14 @@ CompositeDataReader::CompositeDataReader(const ConfigParameters& config) :
                 }
             }
 
+            // With many workers on shared storage, let each worker read chunks from nearby parts of the input
+            // instead of chunks spread over all of it, still balanced within each randomization window.
+            bool contiguousChunkPlacement = config(L"contiguousChunkPlacement", false);
+
             bool shouldPrefetch = true;
             m_sequenceEnumerator = std::make_shared<BlockRandomizer>(verbosity, randomizationWindow, deserializer, shouldPrefetch,
-                multiThreadedDeserialization, maxErrors, sampleBasedRandomizationWindow, GetRandomSeed(config));
+                multiThreadedDeserialization, maxErrors, sampleBasedRandomizationWindow, GetRandomSeed(config), lengthBuckets,
+                contiguousChunkPlacement);
         }
         else
             m_sequenceEnumerator = std::make_shared<NoRandomizer>(deserializer, multiThreadedDeserialization, maxErrors);
@@ -202,7 +236,8 @@ CompositeDataReader::CompositeDataReader(const ConfigParameters& config) :
             outputStreams,
             numAlternatingBuffers,
             localTimeline,
-            m_corpus);
+            m_corpus,
+            verbosity);
         break;
     case PackingMode::truncated:
     {
@@ -0,0 +1,175 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#define _CRT_SECURE_NO_WARNINGS
+#include <algorithm>
+#include <cstring>
+#include "CompressedLatticeArchive.h"
+#include "Basics.h"
+#include "fileutil.h"
+
+namespace CNTK {
+
+    using namespace std;
+    namespace bip = boost::interprocess;
+
+    static_assert(sizeof(CompressedLatticeArchive::Header) == 48, "Unexpected size of the compressed lattice archive header.");
+    static_assert(sizeof(CompressedLatticeArchive::TocEntry) == 32, "Unexpected size of a compressed lattice archive TOC entry.");
+
+    // Layout of a serialized V2 lattice: "LAT " version header_v1_v2 "NODS" count times[count] ...
+    static const size_t s_nodesTagOffset = 8 + 32;
+    static const size_t s_nodeTimesOffset = s_nodesTagOffset + 8;
+
+    CompressedLatticeArchive::CompressedLatticeArchive(const wstring& path)
+        : m_path(path),
+          m_file(msra::strfun::utf8(path).c_str(), bip::read_only),
+          m_region(m_file, bip::read_only)
+    {
+        m_base = static_cast<const char*>(m_region.get_address());
+        m_size = m_region.get_size();
+
+        if (m_size < sizeof(Header))
+            RuntimeError("Compressed lattice archive '%ls' is too small to hold a header.", path.c_str());
+
+        m_header = reinterpret_cast<const Header*>(m_base);
+        if (m_header->magic != s_magic)
+            RuntimeError("'%ls' is not a compressed lattice archive.", path.c_str());
+        if (m_header->version != s_version)
+            RuntimeError("Compressed lattice archive '%ls' has unsupported version %u, expected %u.", path.c_str(), m_header->version, s_version);
+
+        uint64_t numLattices = m_header->numberOfLattices;
+        if (m_header->tocOffset > m_size || numLattices > (m_size - m_header->tocOffset) / sizeof(TocEntry) ||
+            m_header->keysOffset < m_header->tocOffset + numLattices * sizeof(TocEntry) || m_header->keysOffset > m_size)
+            RuntimeError("Compressed lattice archive '%ls' is corrupt: TOC is out of bounds.", path.c_str());
+        if (numLattices > 0 && (m_header->keysOffset == m_size || m_base[m_size - 1] != 0))
+            RuntimeError("Compressed lattice archive '%ls' is corrupt: keys are not terminated.", path.c_str());
+
+        m_toc = reinterpret_cast<const TocEntry*>(m_base + m_header->tocOffset);
+        m_keys = m_base + m_header->keysOffset;
+
+        uint64_t keysSize = m_size - m_header->keysOffset;
+        for (size_t i = 0; i < numLattices; ++i)
+        {
+            const auto& e = m_toc[i];
+            uint64_t minOffset = i == 0 ? sizeof(Header) : m_toc[i - 1].blockOffset + m_toc[i - 1].compressedSize;
+            if (e.blockOffset < minOffset || e.blockOffset + e.compressedSize > m_header->tocOffset ||
+                e.compressedSize == 0 || e.originalSize == 0 || e.keyOffset >= keysSize)
+                RuntimeError("Compressed lattice archive '%ls' is corrupt: lattice %zu is out of bounds.", path.c_str(), i);
+        }
+    }
+
+    /*static*/ bool CompressedLatticeArchive::IsCompressedLatticeArchive(const wstring& path)
+    {
+        // a missing file is left to the caller, which reports it as a missing TOC file
+        if (!fexists(path))
+            return false;
+        auto_file_ptr f(fopenOrDie(path, L"rb"));
+        uint64_t magic = 0;
+        return fread(&magic, sizeof(magic), 1, f) == 1 && magic == s_magic;
+    }
+
+    const CompressedLatticeArchive::TocEntry& CompressedLatticeArchive::EntryByBlockOffset(size_t blockOffset) const
+    {
+        auto end = m_toc + m_header->numberOfLattices;
+        auto found = lower_bound(m_toc, end, blockOffset, [](const TocEntry& e, size_t offset) { return e.blockOffset < offset; });
+        if (found == end || found->blockOffset != blockOffset)
+            RuntimeError("Compressed lattice archive '%ls' has no lattice at offset %zu.", m_path.c_str(), blockOffset);
+        return *found;
+    }
+
+    void CompressedLatticeArchive::Decompress(size_t blockOffset, size_t compressedSize, uint32_t flags, char* result, size_t originalSize) const
+    {
+        const char* block = m_base + blockOffset;
+        if (flags & Lz4)
+            Lz4Decompress(block, compressedSize, result, originalSize);
+        else if (compressedSize == originalSize)
+            memcpy(result, block, originalSize);
+        else
+            RuntimeError("Compressed lattice archive '%ls': stored lattice at offset %zu has unexpected size.", m_path.c_str(), blockOffset);
+
+        if (flags & DeltaNodeTimes)
+            RestoreNodeTimes(result, originalSize);
+    }
+
+    // See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+    /*static*/ void CompressedLatticeArchive::Lz4Decompress(const char* src, size_t srcSize, char* dst, size_t dstSize)
+    {
+        auto ip = reinterpret_cast<const unsigned char*>(src);
+        auto iend = ip + srcSize;
+        char* op = dst;
+        char* oend = dst + dstSize;
+
+        auto readLength = [&](size_t length)
+        {
+            if (length == 15)
+            {
+                unsigned char b;
+                do
+                {
+                    if (ip >= iend)
+                        RuntimeError("Lz4Decompress: truncated length.");
+                    b = *ip++;
+                    length += b;
+                } while (b == 255);
+            }
+            return length;
+        };
+
+        while (ip < iend)
+        {
+            unsigned char token = *ip++;
+
+            size_t literals = readLength(token >> 4);
+            if (literals > (size_t)(iend - ip) || literals > (size_t)(oend - op))
+                RuntimeError("Lz4Decompress: literals out of bounds.");
+            memcpy(op, ip, literals);
+            ip += literals;
+            op += literals;
+
+            if (ip == iend) // the last sequence has no match
+                break;
+
+            if (iend - ip < 2)
+                RuntimeError("Lz4Decompress: truncated match offset.");
+            size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+            if (offset == 0 || offset > (size_t)(op - dst))
+                RuntimeError("Lz4Decompress: match offset out of bounds.");
+
+            size_t match = readLength(token & 15) + 4;
+            if (match > (size_t)(oend - op))
+                RuntimeError("Lz4Decompress: match out of bounds.");
+            const char* from = op - offset;
+            for (size_t i = 0; i < match; ++i) // may overlap
+                op[i] = from[i];
+            op += match;
+        }
+
+        if (op != oend)
+            RuntimeError("Lz4Decompress: decompressed %zu bytes, expected %zu.", (size_t)(op - dst), dstSize);
+    }
+
+    /*static*/ void CompressedLatticeArchive::RestoreNodeTimes(char* lattice, size_t size)
+    {
+        if (size < s_nodeTimesOffset || memcmp(lattice, "LAT ", 4) != 0 || memcmp(lattice + s_nodesTagOffset, "NODS", 4) != 0)
+            RuntimeError("RestoreNodeTimes: not a V2 lattice.");
+
+        int32_t numNodes;
+        memcpy(&numNodes, lattice + s_nodesTagOffset + 4, sizeof(numNodes));
+        if (numNodes < 0 || s_nodeTimesOffset + numNodes * sizeof(uint16_t) > size)
+            RuntimeError("RestoreNodeTimes: node times out of bounds.");
+
+        uint16_t t = 0;
+        char* times = lattice + s_nodeTimesOffset;
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            uint16_t delta;
+            memcpy(&delta, times + i * sizeof(uint16_t), sizeof(delta));
+            t = (uint16_t)(t + delta);
+            memcpy(times + i * sizeof(uint16_t), &t, sizeof(t));
+        }
+    }
+}
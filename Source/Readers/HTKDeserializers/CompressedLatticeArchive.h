@@ -0,0 +1,100 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace CNTK {
+
+    // Read-only, memory-mapped view of a compressed lattice archive, as written by Scripts/lat2cla.py.
+    // It holds the serialized lattices of one or more legacy lattice archives (see latticearchive.h), each compressed separately,
+    // so that any lattice can be read without touching its neighbors. All values are little-endian:
+    //     Header  -- magic "cntk_cla", version, number of lattices and section offsets
+    //     Blocks  -- one per lattice, in the order of the TOC
+    //     TOC     -- per lattice: block offset, key offset, compressed and original size, flags
+    //     Keys    -- zero-terminated lattice keys, as in the legacy TOC files
+    // A block is an LZ4 block (flag Lz4) or stored as is. Before compression, the node times of the lattice may have been
+    // delta-coded (flag DeltaNodeTimes), which makes them compress much better; decompression restores the original bytes.
+    class CompressedLatticeArchive : boost::noncopyable
+    {
+    public:
+        static const uint64_t s_magic = 0x636e746b5f636c61; // 'cntk_cla'
+        static const uint32_t s_version = 1;
+
+        enum Flags : uint32_t
+        {
+            Lz4 = 1,
+            DeltaNodeTimes = 2,
+        };
+
+#pragma pack(push, 1)
+        struct Header
+        {
+            uint64_t magic;
+            uint32_t version;
+            uint32_t reserved;
+            uint64_t numberOfLattices;
+            uint64_t tocOffset;
+            uint64_t keysOffset;
+            uint64_t reserved2;
+        };
+
+        struct TocEntry
+        {
+            uint64_t blockOffset;
+            uint64_t keyOffset;
+            uint32_t compressedSize;
+            uint32_t originalSize;
+            uint32_t flags;
+            uint32_t reserved;
+        };
+#pragma pack(pop)
+
+        explicit CompressedLatticeArchive(const std::wstring& path);
+
+        // Checks the magic number, so that compressed archives can be listed in place of TOC files. False if 'path' does not exist.
+        static bool IsCompressedLatticeArchive(const std::wstring& path);
+
+        const std::wstring& Path() const { return m_path; }
+
+        size_t NumberOfLattices() const { return m_header->numberOfLattices; }
+
+        const TocEntry& Entry(size_t index) const { return m_toc[index]; }
+
+        const char* Key(const TocEntry& entry) const { return m_keys + entry.keyOffset; }
+
+        // Finds the TOC entry of the lattice stored at the given block offset; blocks are in the order of the TOC.
+        const TocEntry& EntryByBlockOffset(size_t blockOffset) const;
+
+        // Decompresses the lattice stored in [blockOffset, blockOffset + compressedSize) into result[0, originalSize).
+        // The caller provides a buffer of at least originalSize bytes. Thread-safe.
+        void Decompress(size_t blockOffset, size_t compressedSize, uint32_t flags, char* result, size_t originalSize) const;
+
+        // Decodes an LZ4 block; throws if it is malformed or does not decode to exactly dstSize bytes.
+        static void Lz4Decompress(const char* src, size_t srcSize, char* dst, size_t dstSize);
+
+        // Undoes the delta coding of the node times ("NODS" section) of a serialized lattice in place.
+        static void RestoreNodeTimes(char* lattice, size_t size);
+
+    private:
+        std::wstring m_path;
+        boost::interprocess::file_mapping m_file;
+        boost::interprocess::mapped_region m_region;
+
+        const char* m_base;
+        size_t m_size;
+        const Header* m_header;
+        const TocEntry* m_toc;
+        const char* m_keys;
+    };
+
+    typedef std::shared_ptr<CompressedLatticeArchive> CompressedLatticeArchivePtr;
+}
@@ -7,7 +7,9 @@
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <chrono>
 #include "DataDeserializer.h"
+#include "ExceptionCapture.h"
 #include "HTKFeaturesIO.h"
 #include "UtteranceDescription.h"
 #include "ssematrix.h"
@@ -117,10 +119,37 @@ public:
         return msra::dbn::matrixstripe(m_frames, ts, n);
     }
 
+    // Splits the utterances of the chunk into ranges of consecutive utterances that are read by one thread each.
+    // A range never spans two archives, and holds about 1/numThreads of the frames of the chunk, so that a chunk
+    // that lives in a single archive is still read on several threads.
+    // Returns the first utterance of each range, followed by the number of utterances.
+    std::vector<size_t> GetReadRanges(size_t numThreads) const
+    {
+        size_t framesPerRange = std::max<size_t>(1, (m_totalFrames + numThreads - 1) / std::max<size_t>(1, numThreads));
+        std::vector<size_t> rangeStarts;
+        size_t framesInRange = 0;
+        for (size_t i = 0; i < m_utterances.size(); ++i)
+        {
+            if (i == 0 ||
+                m_utterances[i].GetPath().archivePathIdx != m_utterances[i - 1].GetPath().archivePathIdx ||
+                framesInRange >= framesPerRange)
+            {
+                rangeStarts.push_back(i);
+                framesInRange = 0;
+            }
+            framesInRange += m_utterances[i].GetNumberOfFrames();
+        }
+        rangeStarts.push_back(m_utterances.size());
+        return rangeStarts;
+    }
+
     // Pages-in the data for this chunk.
     // this function supports retrying since we read from the unreliable network, i.e. do not return in a broken state
     // We pass in the feature info variables to check that data being read has expected properties.
-    void RequireData(const string& featureKind, size_t featureDimension, unsigned int samplePeriod, int verbosity = 0) const
+    // Utterances are read on up to numThreads threads, see GetReadRanges(); each range of utterances is read
+    // by one thread through its own file handle, so that the reads within a range stay sequential.
+    void RequireData(const string& featureKind, size_t featureDimension, unsigned int samplePeriod, int verbosity = 0,
+                     size_t numThreads = 1, bool readAhead = false) const
     {
         if (GetNumberOfUtterances() == 0)
         {
@@ -134,26 +163,43 @@ public:
 
         try
         {
-            // feature reader (we reinstantiate it for each block, i.e. we reopen the file actually)
-            // if this is the first feature read ever, we explicitly open the first file to get the information such as feature dimension
-            htkfeatreader reader;
+            auto start = std::chrono::steady_clock::now();
+
+            auto rangeStarts = GetReadRanges(numThreads);
 
-            // read all utterances; if they are in the same archive, htkfeatreader will be efficient in not closing the file
+            // read all utterances; within a range, htkfeatreader will be efficient in not closing the file
             m_frames.resize(featureDimension, m_totalFrames);
-            foreach_index(i, m_utterances)
+            ExceptionCapture capture;
+            int numRanges = (int)rangeStarts.size() - 1;
+#pragma omp parallel for schedule(dynamic) num_threads((int)std::max<size_t>(1, std::min<size_t>(numThreads, numRanges)))
+            for (int range = 0; range < numRanges; ++range)
             {
-                // read features for this file
-                auto framesWrapper = GetUtteranceFrames(i);
-                reader.read(m_utterances[i].GetPath(), featureKind, samplePeriod, framesWrapper);
+                capture.SafeRun([&](int r)
+                {
+                    // feature reader (we reinstantiate it for each range, i.e. we reopen the file actually)
+                    htkfeatreader reader;
+                    reader.SetReadAhead(readAhead);
+                    for (size_t i = rangeStarts[r]; i < rangeStarts[r + 1]; ++i)
+                    {
+                        // read features for this file
+                        auto framesWrapper = GetUtteranceFrames(i);
+                        reader.read(m_utterances[i].GetPath(), featureKind, samplePeriod, framesWrapper);
+                    }
+                }, range);
             }
+            capture.RethrowIfHappened();
 
             if (verbosity)
             {
-                fprintf(stderr, "HTKChunkInfo::RequireData: read physical chunk %u (%" PRIu64 " utterances, %" PRIu64 " frames, %" PRIu64 " bytes)\n",
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                fprintf(stderr, "HTKChunkInfo::RequireData: read physical chunk %u (%" PRIu64 " utterances, %" PRIu64 " frames, %" PRIu64 " bytes, %d ranges) in %.3f seconds, %.0f frames/sec\n",
                         m_chunkId,
                         m_utterances.size(),
                         m_totalFrames,
-                        sizeof(float) * m_frames.rows() * m_frames.cols());
+                        sizeof(float) * m_frames.rows() * m_frames.cols(),
+                        numRanges,
+                        seconds,
+                        seconds > 0 ? m_totalFrames / seconds : 0.0);
             }
         }
         catch (...)
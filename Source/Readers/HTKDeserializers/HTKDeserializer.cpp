@@ -25,7 +25,9 @@ HTKDeserializer::HTKDeserializer(
     bool primary)
     : DataDeserializerBase(primary),
       m_verbosity(0),
-      m_corpus(corpus)
+      m_corpus(corpus),
+      m_chunkLoadThreads(1),
+      m_readAhead(false)
 {
     // TODO: This should be read in one place, potentially given by SGD.
     m_frameMode = (ConfigValue)cfg("frameMode", "true");
@@ -52,6 +54,8 @@ HTKDeserializer::HTKDeserializer(
     m_dimension = m_dimension * (1 + context.first + context.second);
 
     m_maxSequenceSize = input(L"maxSequenceSize", SIZE_MAX);
+    m_chunkLoadThreads = streamConfig(L"chunkLoadThreads", (size_t)1);
+    m_readAhead = streamConfig(L"readAhead", false);
 
     InitializeChunkInfos(config);
     InitializeStreams(inputName, input(L"definesMBSize", false));
@@ -89,6 +93,8 @@ HTKDeserializer::HTKDeserializer(
         InvalidArgument("Cannot expand utterances of the primary stream %ls, please change your configuration.", featureName.c_str());
     }
     m_maxSequenceSize = feature(L"maxSequenceSize", SIZE_MAX);
+    m_chunkLoadThreads = feature(L"chunkLoadThreads", (size_t)1);
+    m_readAhead = feature(L"readAhead", false);
     InitializeChunkInfos(config);
     InitializeStreams(featureName, feature(L"definesMBSize", false));
     InitializeFeatureInformation();
@@ -379,7 +385,8 @@ public:
         // making several attempts
         msra::util::attempt(5, [&]()
         {
-            chunkInfo.RequireData(m_parent->m_featureKind, m_parent->m_ioFeatureDimension, m_parent->m_samplePeriod, m_parent->m_verbosity);
+            chunkInfo.RequireData(m_parent->m_featureKind, m_parent->m_ioFeatureDimension, m_parent->m_samplePeriod, m_parent->m_verbosity,
+                                  m_parent->m_chunkLoadThreads, m_parent->m_readAhead);
         });
     }
 
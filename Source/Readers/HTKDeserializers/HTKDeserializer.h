@@ -85,6 +85,12 @@ private:
 
     // Upper limit of utterance lengths. Longer utterances are skipped.
     size_t m_maxSequenceSize;
+
+    // Number of threads reading the utterances of a chunk.
+    size_t m_chunkLoadThreads;
+
+    // Whether to ask the OS to read ahead the feature files.
+    bool m_readAhead;
 };
 
 typedef std::shared_ptr<HTKDeserializer> HTKDeserializerPtr;
@@ -23,6 +23,9 @@
 #include "simplesenonehmm.h"
 #include <array>
 #include <ReaderUtil.h>
+#ifdef __unix__
+#include <fcntl.h>
+#endif
 
 namespace CNTK {
 
@@ -179,6 +182,8 @@ class htkfeatreader : protected htkfeatio
     size_t curframe;                     // current # samples read so far
     size_t numframes;                    // number of samples for current logical file
     size_t energyElements;               // how many energy elements to add if addEnergy is true
+    bool readAhead;                      // hint the OS to read ahead the ranges we are about to read
+    vector<float> coalesced;             // frames of a whole range, read with a single fread()
 
 public:
     // parser for complex a=b[s,e] syntax
@@ -307,7 +312,12 @@ private:
     void openphysical(const parsedpath& ppath)
     {
         wstring physpath = ppath.physicallocation();
-        auto_file_ptr f2(fopenOrDie(physpath, L"rb")); // removed 'S' for now, as we mostly run local anyway, and this will speed up debugging
+        // 'S' (large buffer) only if read-ahead is requested, as we mostly run local anyway, and this will speed up debugging
+        auto_file_ptr f2(fopenOrDie(physpath, readAhead ? L"rbS" : L"rb"));
+#ifdef __unix__
+        if (readAhead) // advisory only, errors are ignored
+            posix_fadvise(fileno(f2), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
 
         // read the header (12 bytes for htk feature files)
         fileheader H;
@@ -421,6 +431,14 @@ public:
     {
         addEnergy = false;
         energyElements = 0;
+        readAhead = false;
+    }
+
+    // If set, files are opened with a large buffer and the OS is asked to prefetch the frames of each
+    // range as it is opened (posix_fadvise() on Linux). Useful on network storage.
+    void SetReadAhead(bool enable)
+    {
+        readAhead = enable;
     }
 
     // read a feature file
@@ -443,6 +461,10 @@ public:
             fsetpos(f, dataoffset); // we assume fsetpos(), which is our own, is smart to not flush the read buffer
             curframe = 0;
             numframes = ppath.e + 1 - ppath.s;
+#ifdef __unix__
+            if (readAhead)
+                posix_fadvise(fileno(f), (off_t)dataoffset, (off_t)(numframes * vecbytesize), POSIX_FADV_WILLNEED);
+#endif
         }
         else // reading a full file
         {
@@ -512,6 +534,24 @@ public:
     template <class MATRIX>
     void read(MATRIX& feat, size_t ts, size_t te)
     {
+        // plain float frames: read the whole range at once instead of frame by frame
+        if (!compressed && !isidxformat && !addEnergy)
+        {
+            if (curframe + (te - ts) > numframes)
+                RuntimeError("htkfeatreader:attempted to read beyond end");
+            freadOrDie(coalesced, featdim * (te - ts), f);
+            if (needbyteswapping)
+                msra::util::byteswap(coalesced);
+            for (size_t t = ts; t < te; t++)
+            {
+                const float* v = &coalesced[(t - ts) * featdim];
+                for (size_t k = 0; k < featdim; k++)
+                    feat(k, t) = v[k];
+            }
+            curframe += te - ts;
+            return;
+        }
+
         // read vectors from file and push to our target structure
         vector<float> v(featdim + energyElements);
         for (size_t t = ts; t < te; t++)
@@ -117,6 +117,37 @@ private:
     const NDShape m_ndShape; 
 };
 
+// Chunk of a compressed lattice archive. Nothing is read upfront: the archive is memory-mapped,
+// and each lattice is decompressed on its own when the sequence is requested (by the prefetch/packer threads).
+class LatticeDeserializer::CompressedSequenceChunk : public Chunk
+{
+public:
+    CompressedSequenceChunk(const ChunkDescriptor& descriptor, CompressedLatticeArchivePtr archive)
+        : m_descriptor(descriptor), m_archive(archive), m_ndShape({ 1 })
+    {
+        if (descriptor.NumberOfSequences() == 0 || descriptor.SizeInBytes() == 0)
+            LogicError("Empty chunks are not supported.");
+    }
+
+    void GetSequence(size_t sequenceIndex, vector<SequenceDataPtr>& result) override
+    {
+        const auto& sequence = m_descriptor.Sequences()[sequenceIndex];
+        size_t blockOffset = m_descriptor.StartOffset() + sequence.OffsetInChunk();
+        const auto& entry = m_archive->EntryByBlockOffset(blockOffset);
+
+        // Same padding as for the legacy archives, lattices are exposed as an array of floats.
+        auto buffer = make_shared<vector<char>>(entry.originalSize + sizeof(float) - 1, (char)0);
+        m_archive->Decompress(blockOffset, entry.compressedSize, entry.flags, buffer->data(), entry.originalSize);
+
+        result.push_back(make_shared<LatticeFloatSequenceData>(buffer->data(), sequence.NumberOfSamples(), m_ndShape, buffer));
+    }
+
+private:
+    const ChunkDescriptor& m_descriptor;
+    CompressedLatticeArchivePtr m_archive;
+    const NDShape m_ndShape;
+};
+
 LatticeDeserializer::LatticeDeserializer(
     CorpusDescriptorPtr corpus,
     const ConfigParameters& cfg,
@@ -144,7 +175,6 @@ LatticeDeserializer::LatticeDeserializer(
 
 size_t LatticeDeserializer::RecordChunk(const string& latticePath, const vector<string>& tocLines, CorpusDescriptorPtr corpus, bool enableCaching, bool lastChunkInTOC)
 {
-    size_t totalNumSequences = 0;
     wstring latticePathW;
     latticePathW.assign(latticePath.begin(), latticePath.end());
     attempt(5, [this, latticePathW, tocLines, enableCaching, corpus, lastChunkInTOC]()
@@ -155,10 +185,51 @@ size_t LatticeDeserializer::RecordChunk(const string& latticePath, const vector<
     });
 
     m_latticeFiles.push_back(latticePathW);
+    m_compressedArchives.push_back(nullptr);
+
+    return RecordChunks(*m_indices.back());
+}
+
+size_t LatticeDeserializer::RecordCompressedArchive(const wstring& archivePath, CorpusDescriptorPtr corpus)
+{
+    CompressedLatticeArchivePtr archive;
+    attempt(5, [&archive, &archivePath]()
+    {
+        archive = make_shared<CompressedLatticeArchive>(archivePath);
+    });
+
+    auto index = make_shared<Index>(m_chunkSizeBytes);
+    size_t originalBytes = 0, compressedBytes = 0;
+    for (size_t i = 0; i < archive->NumberOfLattices(); ++i)
+    {
+        const auto& entry = archive->Entry(i);
+        // Number of samples is expressed in floats, as for the legacy archives.
+        auto sequence = IndexedSequence()
+            .SetKey(corpus->KeyToId(archive->Key(entry)))
+            .SetNumberOfSamples(static_cast<uint32_t>((entry.originalSize + sizeof(float) - 1) / sizeof(float)))
+            .SetOffset(entry.blockOffset)
+            .SetSize(entry.compressedSize);
+        index->AddSequence(sequence);
+        originalBytes += entry.originalSize;
+        compressedBytes += entry.compressedSize;
+    }
+
+    if (m_verbosity > 0)
+        fprintf(stderr, "LatticeDeserializer: compressed lattice archive '%ls': %zu lattices, %zu bytes (%.1fx compressed)\n",
+            archivePath.c_str(), archive->NumberOfLattices(), compressedBytes, (double)originalBytes / max<size_t>(compressedBytes, 1));
+
+    m_indices.push_back(index);
+    m_latticeFiles.push_back(archivePath);
+    m_compressedArchives.push_back(archive);
 
-    auto& index = m_indices.back();
+    return RecordChunks(*index);
+}
+
+size_t LatticeDeserializer::RecordChunks(const Index& index)
+{
+    size_t totalNumSequences = 0;
     // Build auxiliary for GetSequenceByKey.
-    for (const auto& chunk : index->Chunks())
+    for (const auto& chunk : index.Chunks())
     {
         // Preparing chunk info that will be exposed to the outside.
         auto chunkId = static_cast<ChunkIdType>(m_chunks.size());
@@ -201,6 +272,15 @@ void LatticeDeserializer::InitializeChunkInfos(CorpusDescriptorPtr corpus, Confi
     while (getline(latticeIndexStream, tocPath))
     {
         tocPath.erase(tocPath.find_last_not_of(" \n\r\t") + 1);
+
+        // Compressed lattice archives (see Scripts/lat2cla.py) are listed in place of TOC files.
+        wstring tocPathW(tocPath.begin(), tocPath.end());
+        if (!tocPath.empty() && CompressedLatticeArchive::IsCompressedLatticeArchive(tocPathW))
+        {
+            totalNumSequences += RecordCompressedArchive(tocPathW, corpus);
+            continue;
+        }
+
         std::ifstream tocFileStream(tocPath);
         if (!(tocFileStream && tocFileStream.good())) 
             fprintf(stderr, "Failed to open input file: %s", tocPath.c_str());
@@ -285,9 +365,11 @@ ChunkPtr LatticeDeserializer::GetChunk(ChunkIdType chunkId)
     attempt(5, [this, &result, chunkId]()
     {
         auto chunk = m_chunks[chunkId];
-        auto& fileName = m_latticeFiles[m_chunkToFileIndex[chunk]];
-
-        result = make_shared<SequenceChunk>(*this, *chunk, fileName);
+        auto fileIndex = m_chunkToFileIndex[chunk];
+        if (m_compressedArchives[fileIndex])
+            result = make_shared<CompressedSequenceChunk>(*chunk, m_compressedArchives[fileIndex]);
+        else
+            result = make_shared<SequenceChunk>(*this, *chunk, m_latticeFiles[fileIndex]);
     });
 
     return result;
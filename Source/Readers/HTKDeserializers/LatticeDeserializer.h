@@ -10,6 +10,7 @@
 #include "CorpusDescriptor.h"
 #include "ConfigHelper.h"
 #include "Index.h"
+#include "CompressedLatticeArchive.h"
 #include <boost/noncopyable.hpp>
 
 namespace CNTK {
@@ -38,11 +39,14 @@ private:
     class LatticeChunk;
     class ChunkBase;
     class SequenceChunk;
+    class CompressedSequenceChunk;
 
     // Initialization functions.
     void InitializeChunkInfos(CorpusDescriptorPtr corpus, ConfigHelper& config);
     void InitializeStreams(const std::wstring& featureName);
     size_t RecordChunk(const string& latticePath, const vector<string>& tocLines, CorpusDescriptorPtr corpus, bool enableCaching, bool lastChunkInTOC);
+    size_t RecordCompressedArchive(const std::wstring& archivePath, CorpusDescriptorPtr corpus);
+    size_t RecordChunks(const Index& index);
 
     CorpusDescriptorPtr m_corpus;
 
@@ -58,6 +62,9 @@ private:
     size_t m_chunkSizeBytes;
     std::vector<std::shared_ptr<Index>> m_indices;
     std::vector<std::wstring> m_latticeFiles;
+
+    // Per lattice file, the compressed lattice archive it is, or null for legacy archives.
+    std::vector<CompressedLatticeArchivePtr> m_compressedArchives;
 };
 
 }
@@ -0,0 +1,129 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#define _CRT_SECURE_NO_WARNINGS
+#include <algorithm>
+#include "MLFBinaryFile.h"
+#include "Basics.h"
+#include "fileutil.h"
+
+namespace CNTK {
+
+    using namespace std;
+    namespace bip = boost::interprocess;
+
+    static_assert(sizeof(MLFBinaryFile::Header) == 64, "Unexpected size of the binary MLF header.");
+    static_assert(sizeof(MLFBinaryFile::Utterance) == 24, "Unexpected size of a binary MLF utterance.");
+    static_assert(sizeof(MLFBinaryFile::HashIndexEntry) == 16, "Unexpected size of a binary MLF hash index entry.");
+    static_assert(sizeof(MLFBinaryFile::Run) == 8, "Unexpected size of a binary MLF run.");
+
+    MLFBinaryFile::MLFBinaryFile(const wstring& path)
+        : m_path(path),
+          m_file(msra::strfun::utf8(path).c_str(), bip::read_only),
+          m_region(m_file, bip::read_only)
+    {
+        m_base = static_cast<const char*>(m_region.get_address());
+        m_size = m_region.get_size();
+
+        if (m_size < sizeof(Header))
+            RuntimeError("Binary MLF '%ls' is too small to hold a header.", path.c_str());
+
+        m_header = reinterpret_cast<const Header*>(m_base);
+        if (m_header->magic != s_magic)
+            RuntimeError("'%ls' is not a binary MLF.", path.c_str());
+        if (m_header->version != s_version)
+            RuntimeError("Binary MLF '%ls' has unsupported version %u, expected %u.", path.c_str(), m_header->version, s_version);
+
+        uint64_t numUtterances = m_header->numberOfUtterances;
+        Verify(m_header->utterancesOffset, numUtterances * sizeof(Utterance), "utterances");
+        Verify(m_header->hashIndexOffset, numUtterances * sizeof(HashIndexEntry), "hash index");
+        Verify(m_header->keysOffset, m_header->runsOffset - m_header->keysOffset, "keys");
+        Verify(m_header->runsOffset, m_size - m_header->runsOffset, "runs");
+        if (numUtterances > 0 && (m_header->runsOffset == m_header->keysOffset || m_base[m_header->runsOffset - 1] != 0))
+            RuntimeError("Binary MLF '%ls' is corrupt: keys are not terminated.", path.c_str());
+
+        m_utterances = reinterpret_cast<const Utterance*>(m_base + m_header->utterancesOffset);
+        m_hashIndex = reinterpret_cast<const HashIndexEntry*>(m_base + m_header->hashIndexOffset);
+        m_keys = m_base + m_header->keysOffset;
+
+        uint64_t numRuns = (m_size - m_header->runsOffset) / sizeof(Run);
+        uint64_t keysSize = m_header->runsOffset - m_header->keysOffset;
+        for (size_t i = 0; i < numUtterances; ++i)
+        {
+            const auto& u = m_utterances[i];
+            if (u.firstRun + u.numberOfRuns > numRuns || u.keyOffset >= keysSize || u.numberOfRuns == 0)
+                RuntimeError("Binary MLF '%ls' is corrupt: utterance %zu is out of bounds.", path.c_str(), i);
+        }
+    }
+
+    void MLFBinaryFile::Verify(uint64_t offset, uint64_t size, const char* section) const
+    {
+        if (offset < sizeof(Header) || offset > m_size || size > m_size - offset)
+            RuntimeError("Binary MLF '%ls' is corrupt: %s section is out of bounds.", m_path.c_str(), section);
+    }
+
+    /*static*/ bool MLFBinaryFile::IsBinaryMLF(const wstring& path)
+    {
+        auto_file_ptr f(fopenOrDie(path, L"rb"));
+        uint64_t magic = 0;
+        return fread(&magic, sizeof(magic), 1, f) == 1 && magic == s_magic;
+    }
+
+    // FNV-1a, 64 bit.
+    /*static*/ uint64_t MLFBinaryFile::HashKey(const char* key, size_t length)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<unsigned char>(key[i]);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    /*static*/ uint64_t MLFBinaryFile::HashStateList(const unordered_map<string, size_t>& states)
+    {
+        vector<const string*> names(states.size());
+        for (const auto& s : states)
+        {
+            if (s.second >= names.size())
+                LogicError("State index %zu is out of range of the state list of size %zu.", s.second, names.size());
+            names[s.second] = &s.first;
+        }
+
+        string text;
+        for (const auto& name : names)
+            text.append(*name).push_back('\n');
+        return HashKey(text.data(), text.size());
+    }
+
+    /*static*/ void MLFBinaryFile::ToFrameRanges(const Run* begin, size_t numberOfRuns, vector<MLFFrameRange>& result)
+    {
+        result.resize(numberOfRuns);
+        uint32_t firstFrame = 0;
+        for (size_t i = 0; i < numberOfRuns; ++i)
+        {
+            result[i].Build(firstFrame, begin[i].numberOfFrames, begin[i].classId);
+            firstFrame += begin[i].numberOfFrames;
+        }
+    }
+
+    bool MLFBinaryFile::TryFind(const string& key, size_t& index) const
+    {
+        auto hash = HashKey(key.data(), key.size());
+        auto end = m_hashIndex + m_header->numberOfUtterances;
+        auto found = lower_bound(m_hashIndex, end, hash, [](const HashIndexEntry& e, uint64_t h) { return e.keyHash < h; });
+        for (; found != end && found->keyHash == hash; ++found)
+        {
+            if (found->utterance < m_header->numberOfUtterances && key == Key(m_utterances[found->utterance]))
+            {
+                index = static_cast<size_t>(found->utterance);
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,119 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <boost/noncopyable.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "MLFUtils.h"
+
+namespace CNTK {
+
+    // Read-only, memory-mapped view of a binary MLF label archive, as written by Scripts/mlf2bin.py.
+    // All values are little-endian:
+    //     Header      -- magic "cntk_mlf", version, number of classes, number of utterances, section offsets
+    //                    and the hash of the state list the labels were converted with (0 if none, class ids came from the MLF)
+    //     Utterances  -- per utterance (in the order of the source MLF): first run, key offset, number of runs, number of frames
+    //     Hash index  -- (FNV-1a hash of the key, utterance index), sorted, for lookups by key
+    //     Keys        -- zero-terminated utterance keys, as the text MLF deserializer would see them (no quotes, no extension)
+    //     Runs        -- run-length encoded labels: per MLF frame range its number of frames and class id
+    // Ranges are stored one per line of the source MLF, so that phone boundaries are preserved.
+    class MLFBinaryFile : boost::noncopyable
+    {
+    public:
+        static const uint64_t s_magic = 0x636e746b5f6d6c66; // 'cntk_mlf'
+        static const uint32_t s_version = 2;
+
+#pragma pack(push, 1)
+        struct Header
+        {
+            uint64_t magic;
+            uint32_t version;
+            uint32_t numberOfClasses;
+            uint64_t numberOfUtterances;
+            uint64_t utterancesOffset;
+            uint64_t hashIndexOffset;
+            uint64_t keysOffset;
+            uint64_t runsOffset;
+            uint64_t stateListHash;
+        };
+
+        struct Utterance
+        {
+            uint64_t firstRun;
+            uint64_t keyOffset;
+            uint32_t numberOfRuns;
+            uint32_t numberOfFrames;
+        };
+
+        struct HashIndexEntry
+        {
+            uint64_t keyHash;
+            uint64_t utterance;
+        };
+
+        struct Run
+        {
+            uint32_t numberOfFrames;
+            ClassIdType classId;
+            uint16_t reserved;
+        };
+#pragma pack(pop)
+
+        explicit MLFBinaryFile(const std::wstring& path);
+
+        // Checks the magic number, so that text and binary MLFs can be given through the same option.
+        static bool IsBinaryMLF(const std::wstring& path);
+
+        static uint64_t HashKey(const char* key, size_t length);
+
+        // Hash of a state list: HashKey of the state names in the order of their indices, each followed by '\n'.
+        static uint64_t HashStateList(const std::unordered_map<std::string, size_t>& states);
+
+        const std::wstring& Path() const { return m_path; }
+
+        size_t NumberOfClasses() const { return m_header->numberOfClasses; }
+
+        uint64_t StateListHash() const { return m_header->stateListHash; }
+
+        size_t NumberOfUtterances() const { return m_header->numberOfUtterances; }
+
+        const Utterance& GetUtterance(size_t index) const { return m_utterances[index]; }
+
+        const char* Key(const Utterance& utterance) const { return m_keys + utterance.keyOffset; }
+
+        // Byte offset of the runs of the utterance in the file, the binary counterpart of a sequence offset in a text MLF.
+        size_t RunsOffset(const Utterance& utterance) const { return m_header->runsOffset + utterance.firstRun * sizeof(Run); }
+
+        // Runs of an utterance, given its byte offset and size as returned by RunsOffset().
+        const Run* Runs(size_t offset) const { return reinterpret_cast<const Run*>(m_base + offset); }
+
+        // Decodes the runs [begin, begin + numberOfRuns) into frame ranges.
+        static void ToFrameRanges(const Run* begin, size_t numberOfRuns, std::vector<MLFFrameRange>& result);
+
+        // Finds an utterance by its key, returns false if it does not exist.
+        bool TryFind(const std::string& key, size_t& index) const;
+
+    private:
+        void Verify(uint64_t offset, uint64_t size, const char* section) const;
+
+        std::wstring m_path;
+        boost::interprocess::file_mapping m_file;
+        boost::interprocess::mapped_region m_region;
+
+        const char* m_base;
+        size_t m_size;
+        const Header* m_header;
+        const Utterance* m_utterances;
+        const HashIndexEntry* m_hashIndex;
+        const char* m_keys;
+    };
+
+    typedef std::shared_ptr<MLFBinaryFile> MLFBinaryFilePtr;
+}
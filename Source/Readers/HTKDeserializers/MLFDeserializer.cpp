@@ -77,18 +77,26 @@ protected:
     vector<char> m_buffer;   // Buffer for the whole chunk
     vector<bool> m_valid;    // Bit mask whether the parsed sequence is valid.
     MLFUtteranceParser m_parser;
+    const MLFBinaryFile* m_binary; // Set for a binary MLF, which is accessed through its mapping instead of m_buffer.
 
     const MLFDeserializer& m_deserializer;
     const ChunkDescriptor& m_descriptor;     // Current chunk descriptor.
 
-    ChunkBase(const MLFDeserializer& deserializer, const ChunkDescriptor& descriptor, const wstring& fileName, const StateTablePtr& states)
+    ChunkBase(const MLFDeserializer& deserializer, const ChunkDescriptor& descriptor, const wstring& fileName, const StateTablePtr& states, const MLFBinaryFile* binary)
         : m_parser(states),
+          m_binary(binary),
           m_descriptor(descriptor),
           m_deserializer(deserializer)
     {
         if (descriptor.NumberOfSequences() == 0 || descriptor.SizeInBytes() == 0)
             LogicError("Empty chunks are not supported.");
 
+        // all sequences are valid by default.
+        m_valid.resize(m_descriptor.NumberOfSequences(), true);
+
+        if (m_binary)
+            return;
+
         auto f = FileWrapper::OpenOrDie(fileName, L"rbS");
         size_t sizeInBytes = descriptor.SizeInBytes();
 
@@ -100,9 +108,6 @@ protected:
         f.SeekOrDie(descriptor.StartOffset(), SEEK_SET);
 
         f.ReadOrDie(m_buffer.data(), sizeInBytes, 1);
-
-        // all sequences are valid by default.
-        m_valid.resize(m_descriptor.NumberOfSequences(), true);
     }
 
     string KeyOf(const SequenceDescriptor& s)
@@ -110,6 +115,22 @@ protected:
         return m_deserializer.m_corpus->IdToKey(s.m_key);
     }
 
+    // Gets the frame ranges of a sequence, by parsing its text or decoding its runs in the binary MLF.
+    bool ParseSequence(const SequenceDescriptor& sequence, vector<MLFFrameRange>& utterance)
+    {
+        if (m_binary)
+        {
+            auto runs = m_binary->Runs(m_descriptor.StartOffset() + sequence.OffsetInChunk());
+            MLFBinaryFile::ToFrameRanges(runs, sequence.SizeInBytes() / sizeof(MLFBinaryFile::Run), utterance);
+            return true;
+        }
+
+        auto start = m_buffer.data() + sequence.OffsetInChunk();
+        auto end = start + sequence.SizeInBytes();
+        auto absoluteOffset = m_descriptor.StartOffset() + sequence.OffsetInChunk();
+        return m_parser.Parse(boost::make_iterator_range(start, end), utterance, absoluteOffset);
+    }
+
     void CleanBuffer()
     {
         // Make sure we do not keep unnecessary memory after sequences have been parsed.
@@ -124,9 +145,13 @@ class MLFDeserializer::SequenceChunk : public MLFDeserializer::ChunkBase
     vector<vector<MLFFrameRange>> m_sequences; // Each sequence is a vector of sequential frame ranges.
 
 public:
-    SequenceChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, StateTablePtr states)
-        : ChunkBase(parent, descriptor, fileName, states)
+    SequenceChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, StateTablePtr states, const MLFBinaryFile* binary)
+        : ChunkBase(parent, descriptor, fileName, states, binary)
     {
+        // Runs of a binary MLF are decoded on demand in GetSequence.
+        if (m_binary)
+            return;
+
         m_sequences.resize(m_descriptor.Sequences().size());
 
 #pragma omp parallel for schedule(dynamic)
@@ -138,12 +163,8 @@ public:
 
     void CacheSequence(const SequenceDescriptor& sequence, size_t index)
     {
-        auto start = m_buffer.data() + sequence.OffsetInChunk();
-        auto end = start + sequence.SizeInBytes();
-
         vector<MLFFrameRange> utterance;
-        auto absoluteOffset = m_descriptor.StartOffset() + sequence.OffsetInChunk();
-        bool parsed = m_parser.Parse(boost::make_iterator_range(start, end), utterance, absoluteOffset);
+        bool parsed = ParseSequence(sequence, utterance);
         if (!parsed) // cannot parse
         {
             fprintf(stderr, "WARNING: Cannot parse the utterance '%s'\n", KeyOf(sequence).c_str());
@@ -176,8 +197,11 @@ public:
             return;
         }
 
-        const auto& utterance = m_sequences[sequenceIndex];
         const auto& sequence = m_descriptor.Sequences()[sequenceIndex];
+        vector<MLFFrameRange> decoded;
+        if (m_binary)
+            ParseSequence(sequence, decoded);
+        const auto& utterance = m_binary ? decoded : m_sequences[sequenceIndex];
 
         // Packing labels for the utterance into sparse sequence.
         vector<size_t> sequencePhoneBoundaries(m_deserializer.m_withPhoneBoundaries ? utterance.size() : 0);
@@ -217,8 +241,8 @@ class MLFDeserializer::FrameChunk : public MLFDeserializer::ChunkBase
     std::vector<uint32_t> m_sequenceOffsetInChunkInSamples;
 
 public:
-    FrameChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, StateTablePtr states)
-        : ChunkBase(parent, descriptor, fileName, states)
+    FrameChunk(const MLFDeserializer& parent, const ChunkDescriptor& descriptor, const wstring& fileName, StateTablePtr states, const MLFBinaryFile* binary)
+        : ChunkBase(parent, descriptor, fileName, states, binary)
     {
         uint32_t numSamples = static_cast<uint32_t>(m_descriptor.NumberOfSamples());
 
@@ -282,12 +306,8 @@ public:
     // Parses and caches sequence in the buffer for GetSequence fast retrieval.
     void CacheSequence(const SequenceDescriptor& sequence, size_t index)
     {
-        auto start = m_buffer.data() + sequence.OffsetInChunk();
-        auto end = start + sequence.SizeInBytes();
-
         vector<MLFFrameRange> utterance;
-        auto absoluteOffset = m_descriptor.StartOffset() + sequence.OffsetInChunk();
-        bool parsed = m_parser.Parse(boost::make_iterator_range(start, end), utterance, absoluteOffset);
+        bool parsed = ParseSequence(sequence, utterance);
         if (!parsed)
         {
             m_valid[index] = false;
@@ -379,6 +399,29 @@ MLFDeserializer::MLFDeserializer(CorpusDescriptorPtr corpus, const ConfigParamet
     InitializeChunkInfos(corpus, config, labelMappingFile);
 }
 
+// Builds the index of a binary MLF; sequences are located by the byte offsets of their runs.
+static shared_ptr<Index> BuildBinaryMLFIndex(const MLFBinaryFile& file, CorpusDescriptorPtr corpus, size_t chunkSizeBytes)
+{
+    auto index = make_shared<Index>(chunkSizeBytes);
+    if (file.NumberOfUtterances() == 0)
+        return index;
+
+    const auto& last = file.GetUtterance(file.NumberOfUtterances() - 1);
+    index->Reserve(file.RunsOffset(last) + last.numberOfRuns * sizeof(MLFBinaryFile::Run) - file.RunsOffset(file.GetUtterance(0)));
+
+    IndexedSequence sequence;
+    for (size_t i = 0; i < file.NumberOfUtterances(); ++i)
+    {
+        const auto& utterance = file.GetUtterance(i);
+        sequence.SetKey(corpus->KeyToId(file.Key(utterance)))
+            .SetNumberOfSamples(utterance.numberOfFrames)
+            .SetOffset(file.RunsOffset(utterance))
+            .SetSize(utterance.numberOfRuns * sizeof(MLFBinaryFile::Run));
+        index->AddSequence(sequence);
+    }
+    return index;
+}
+
 static inline bool LessByFirstItem(const std::tuple<size_t, size_t, size_t>& a, const std::tuple<size_t, size_t, size_t>& b)
 {
     return std::get<0>(a) < std::get<0>(b);
@@ -402,14 +445,39 @@ void MLFDeserializer::InitializeChunkInfos(CorpusDescriptorPtr corpus, const Con
     bool enableCaching = corpus->IsHashingEnabled() && config.GetCacheIndex();
     for (const auto& path : mlfPaths)
     {
-        attempt(5, [this, path, enableCaching, corpus]()
+        MLFBinaryFilePtr binary;
+        attempt(5, [this, path, enableCaching, corpus, &binary]()
         {
+            // Binary MLFs (see Scripts/mlf2bin.py) are memory-mapped, their labels are already parsed.
+            if (MLFBinaryFile::IsBinaryMLF(path))
+            {
+                binary = make_shared<MLFBinaryFile>(path);
+                m_indices.emplace_back(BuildBinaryMLFIndex(*binary, corpus, m_chunkSizeBytes));
+                return;
+            }
+
             MLFIndexBuilder builder(FileWrapper(path, L"rbS"), corpus);
             builder.SetChunkSize(m_chunkSizeBytes).SetCachingEnabled(enableCaching);
             m_indices.emplace_back(builder.Build());
         });
 
+        // Class ids of a binary MLF were resolved at conversion time, so it must have been converted with the same state list.
+        if (binary)
+        {
+            uint64_t stateListHash = m_stateTable ? MLFBinaryFile::HashStateList(m_stateTable->States()) : 0;
+            if (binary->StateListHash() != stateListHash)
+            {
+                if (!m_stateTable)
+                    RuntimeError("Binary MLF '%ls' was converted with a state list, the same labelMappingFile must be given.", path.c_str());
+                if (binary->StateListHash() == 0)
+                    RuntimeError("Binary MLF '%ls' was converted without a state list, but labelMappingFile '%ls' is given.",
+                        path.c_str(), stateListPath.c_str());
+                RuntimeError("Binary MLF '%ls' was converted with a different state list than '%ls'.", path.c_str(), stateListPath.c_str());
+            }
+        }
+
         m_mlfFiles.push_back(path);
+        m_binaryFiles.push_back(binary);
         
         auto& index = m_indices.back();
         // Build auxiliary for GetSequenceByKey.
@@ -509,12 +577,14 @@ ChunkPtr MLFDeserializer::GetChunk(ChunkIdType chunkId)
     attempt(5, [this, &result, chunkId]()
     {
         auto chunk = m_chunks[chunkId];
-        auto& fileName = m_mlfFiles[m_chunkToFileIndex[chunk]];
+        auto fileIndex = m_chunkToFileIndex[chunk];
+        auto& fileName = m_mlfFiles[fileIndex];
+        auto binary = m_binaryFiles[fileIndex].get();
 
         if (m_frameMode)
-            result = make_shared<FrameChunk>(*this, *chunk, fileName, m_stateTable);
+            result = make_shared<FrameChunk>(*this, *chunk, fileName, m_stateTable, binary);
         else
-            result = make_shared<SequenceChunk>(*this, *chunk, fileName, m_stateTable);
+            result = make_shared<SequenceChunk>(*this, *chunk, fileName, m_stateTable, binary);
     });
 
     return result;
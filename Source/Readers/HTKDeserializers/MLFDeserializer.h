@@ -9,6 +9,7 @@
 #include "HTKDeserializer.h"
 #include "CorpusDescriptor.h"
 #include "MLFUtils.h"
+#include "MLFBinaryFile.h"
 #include "Index.h"
 
 namespace CNTK {
@@ -83,6 +84,9 @@ private:
 
     std::vector<std::shared_ptr<Index>> m_indices;
     std::vector<std::wstring> m_mlfFiles;
+
+    // Per MLF file, the mapped binary MLF, or null for a text MLF.
+    std::vector<MLFBinaryFilePtr> m_binaryFiles;
 };
 
 }
@@ -61,7 +61,8 @@ namespace CNTK {
 
         vector<boost::iterator_range<char*>> lines;
         const static std::vector<bool> delim = DelimiterHash({ '\r', '\n' });
-        Split(buffer.data(), buffer.data() + buffer.size(), delim, lines);
+        // The terminating zero is not part of the last line.
+        Split(buffer.data(), buffer.data() + len, delim, lines);
 
         EraseEmptyLines(lines);
         return lines;
@@ -61,6 +61,14 @@ namespace CNTK {
         // Parses format with original HTK state align MLF format and state list and builds an MLFFrameRange.
         void Build(const std::vector<boost::iterator_range<char*>>& tokens, const std::unordered_map<std::string, size_t>& stateTable, size_t byteOffset);
 
+        // Builds a range from already parsed values, e.g. from a binary MLF.
+        void Build(uint32_t firstFrame, uint32_t numFrames, ClassIdType classId)
+        {
+            m_firstFrame = firstFrame;
+            m_numFrames = numFrames;
+            m_classId = classId;
+        }
+
         ClassIdType ClassId() const { return m_classId;    }
         uint32_t FirstFrame() const { return m_firstFrame; }
         uint32_t NumFrames()  const { return m_numFrames;  }
@@ -12,6 +12,7 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <memory>
 #include <algorithm> // for various sort() calls
 #include <math.h>
 
@@ -1964,4 +1965,231 @@ public:
     }
 };
 
+// ===========================================================================
+// CHashedMGramLM -- a read-only copy of a back-off M-gram LM for fast lookup,
+// with a state-based query interface for scoring word sequences incrementally.
+//
+// Each history (an m-gram of order 0..M-1, order 0 = root) is a 'state.' All
+// m-grams are stored in a single open-addressing hash table keyed by
+// (state of their history, predicted word), so a lookup is one hash probe per
+// back-off step instead of a binary search per history token. Each entry also
+// carries the state to continue from after that word, so the history never
+// needs to be looked up again when scoring a word sequence left to right:
+//
+//   int s = lm.initialstate (context, m);
+//   for (...) logP += lm.score (s, w, s);
+//
+// Scores are identical to CMGramLM::score(). The tables are flat arrays of
+// PODs without pointers.
+// ===========================================================================
+
+class CHashedMGramLM
+{
+    struct entry // one m-gram, keyed by (history state, predicted word)
+    {
+        uint64_t key;  // makekey (state, w), or emptykey
+        float logP;    // probability of w given the history
+        int nextstate; // longest suffix of (history, w) that is a history itself
+    };
+    static const uint64_t emptykey = ~(uint64_t) 0;
+    static inline uint64_t makekey(int s, int w)
+    {
+        return ((uint64_t)(unsigned int) s << 32) | (unsigned int) w;
+    }
+
+    int M;                         // e.g. M=3 for trigram
+    std::vector<entry> table;      // open-addressing hash table, size is a power of 2
+    uint64_t tablemask;            // table.size() - 1
+    std::vector<float> statelogB;  // [s] back-off weight of history s
+    std::vector<int> backoffstate; // [s] longest proper suffix of history s that is a history itself
+    float zerogramlogP;            // fallback score of words not found at all (OOV)
+    std::vector<bool> knownwords;  // [w] true if w is predicted by at least one m-gram
+
+    static void fail(const char *msg)
+    {
+        RuntimeError("CHashedMGramLM::%s", msg);
+    }
+
+    static inline size_t hash(uint64_t key)
+    {
+        key *= 0x9e3779b97f4a7c15ull; // Fibonacci hashing; the high bits are best mixed
+        return (size_t)(key ^ (key >> 29));
+    }
+
+    inline const entry *find(int s, int w) const
+    {
+        const uint64_t key = makekey(s, w);
+        for (uint64_t i = hash(key) & tablemask;; i = (i + 1) & tablemask)
+        {
+            const entry &e = table[i];
+            if (e.key == key)
+                return &e;
+            if (e.key == emptykey)
+                return NULL;
+        }
+    }
+
+    entry &insert(int s, int w)
+    {
+        const uint64_t key = makekey(s, w);
+        for (uint64_t i = hash(key) & tablemask;; i = (i + 1) & tablemask)
+        {
+            entry &e = table[i];
+            if (e.key == emptykey)
+            {
+                e.key = key;
+                return e;
+            }
+            if (e.key == key)
+                fail("insert: duplicate m-gram");
+        }
+    }
+
+    // state of the history given by the words [mgram, mgram+m), or -1 if not a history
+    int historystate(const int *mgram, int m) const
+    {
+        int s = 0; // root
+        for (int k = 0; k < m; k++)
+        {
+            const entry *e = find(s, mgram[k]);
+            if (!e)
+                return -1;
+            s = e->nextstate; // (for m-grams shorter than M this is the m-gram's own state)
+        }
+        return s;
+    }
+
+    // state of the longest suffix of [mgram, mgram+m) that is a history (always succeeds, at worst the root)
+    int longestsuffixstate(const int *mgram, int m) const
+    {
+        if (m > M - 1)
+            mgram += m - (M - 1), m = M - 1;
+        for (;; mgram++, m--)
+        {
+            int s = historystate(mgram, m);
+            if (s >= 0)
+                return s;
+        }
+    }
+
+public:
+    CHashedMGramLM()
+        : M(-1), tablemask(0), zerogramlogP((float) logzero)
+    {
+    } // needs explicit initialization through build()
+
+    // build from any LM that supports iteration, typically a CMGramLM loaded with read()
+    void build(const ILM &lm)
+    {
+        M = lm.order();
+        if (M < 1)
+            fail("build: LM has no m-grams");
+
+        // collect all m-grams grouped by order, such that histories get created before they are used
+        std::vector<std::vector<int>> mgrams(M + 1);                      // [m] concatenated words of all m-grams of order m
+        std::vector<std::vector<std::pair<float, float>>> values(M + 1); // [m][j] (logP, logB)
+        std::unique_ptr<ILM::IIter> iter(lm.iter(0, M));
+        for (; *iter; ++*iter)
+        {
+            std::pair<const int *, int> mgram = **iter;
+            const int m = mgram.second;
+            if (std::find_if(mgram.first, mgram.first + m, [](int w) { return w < 0; }) != mgram.first + m)
+                continue; // contains a word not in the user's symbol space: cannot be queried
+            mgrams[m].insert(mgrams[m].end(), mgram.first, mgram.first + m);
+            std::pair<double, double> value = iter->value();
+            values[m].push_back(std::make_pair((float) value.first, (float) value.second));
+        }
+        if (values[0].size() != 1)
+            fail("build: LM has no zerogram entry");
+
+        // dimension the hash table for a load factor of at most 1/2
+        size_t numentries = 0;
+        for (int m = 1; m <= M; m++)
+            numentries += values[m].size();
+        size_t tablesize = 16;
+        while (tablesize < 2 * numentries)
+            tablesize *= 2;
+        entry empty = {emptykey, 0.0f, -1};
+        table.assign(tablesize, empty);
+        tablemask = tablesize - 1;
+
+        // root
+        zerogramlogP = values[0][0].first;
+        statelogB.assign(1, values[0][0].second);
+        backoffstate.assign(1, -1);
+        knownwords.clear();
+
+        for (int m = 1; m <= M; m++)
+        {
+            foreach_index (j, values[m])
+            {
+                const int *mgram = &mgrams[m][j * m];
+                const int w = mgram[m - 1];
+                const int h = historystate(mgram, m - 1); // must exist since the LM is a prefix tree
+                if (h < 0)
+                    fail("build: malformed LM: m-gram without history");
+                entry &e = insert(h, w);
+                e.logP = values[m][j].first;
+                if (m < M) // m-gram is a history itself
+                {
+                    e.nextstate = (int) statelogB.size();
+                    statelogB.push_back(values[m][j].second);
+                    backoffstate.push_back(longestsuffixstate(mgram + 1, m - 1));
+                }
+                else
+                    e.nextstate = longestsuffixstate(mgram + 1, m - 1);
+                if ((size_t) w >= knownwords.size())
+                    knownwords.resize(w + 1, false);
+                knownwords[w] = true;
+            }
+        }
+    }
+
+    int order() const
+    {
+        return M;
+    }
+
+    // test for OOV word (OOV w.r.t. LM)
+    bool oov(int w) const
+    {
+        return w < 0 || (size_t) w >= knownwords.size() || !knownwords[w];
+    }
+
+    // state to start scoring from, given the preceding words [context, context+m) (m=0 for no context)
+    int initialstate(const int *context, int m) const
+    {
+        if (M < 0)
+            fail("initialstate: LM not built");
+        return longestsuffixstate(context, m);
+    }
+
+    // score word w following the history represented by state s.
+    // Returns the state that represents the history after w. 's' and 'nextstate' may be the same variable.
+    inline double score(int s, int w, int &nextstate) const
+    {
+        double totalLogB = 0.0; // accumulated back-off
+        for (; s >= 0; s = backoffstate[s])
+        {
+            const entry *e = find(s, w);
+            if (e) // m-gram found -> done
+            {
+                nextstate = e->nextstate;
+                return totalLogB + e->logP;
+            }
+            totalLogB += statelogB[s]; // history found but predicted word not -> back-off
+        }
+        // not even found as a unigram: OOV (root back-off weight was applied above, as in CMGramLM)
+        nextstate = 0;
+        return totalLogB + zerogramlogP;
+    }
+
+    // same interface as ILM::score(): mgram[m-1] = word to predict, tokens before that are history
+    double score(const int *mgram, int m) const
+    {
+        int s = initialstate(mgram, m - 1);
+        return score(s, mgram[m - 1], s);
+    }
+};
+
 }; }; // namespace
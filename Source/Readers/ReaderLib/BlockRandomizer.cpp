@@ -24,7 +24,9 @@ BlockRandomizer::BlockRandomizer(
     bool multithreadedGetNextSequence,
     size_t maxNumberOfInvalidSequences,
     bool sampleBasedRandomizationWindow,
-    size_t seedOffset)
+    size_t seedOffset,
+    size_t numberOfLengthBuckets,
+    bool contiguousChunkPlacement)
     : m_verbosity(verbosity),
       m_deserializer(deserializer),
       m_sweep(SIZE_MAX),
@@ -32,6 +34,8 @@ BlockRandomizer::BlockRandomizer(
       m_globalSamplePosition(0),
       m_epochStartPosition(0),
       m_sweepSizeInSamples(0),
+      m_contiguousChunkPlacement(contiguousChunkPlacement),
+      m_chunkOwnersNumberOfWorkers(0),
       m_chunkRandomizer(std::make_shared<ChunkRandomizer>(deserializer, randomizationRange, sampleBasedRandomizationWindow)),
       m_multithreadedGetNextSequences(multithreadedGetNextSequence),
       m_prefetchedChunk(ChunkIdMax),
@@ -43,12 +47,15 @@ BlockRandomizer::BlockRandomizer(
     m_launchType = shouldPrefetch ? launch::async : launch::deferred;
 
     m_streams = m_deserializer->StreamInfos();
-    m_sequenceRandomizer = std::make_shared<SequenceRandomizer>(verbosity, m_deserializer, m_chunkRandomizer);
+    m_sequenceRandomizer = std::make_shared<SequenceRandomizer>(verbosity, m_deserializer, m_chunkRandomizer, numberOfLengthBuckets);
 
     // Calculate total number of samples.
+    auto chunks = m_deserializer->ChunkInfos();
+    m_originalChunkSampleStart.resize(chunks.size());
     m_sweepSizeInSamples = 0;
-    for (auto const & chunk : m_deserializer->ChunkInfos())
+    for (auto const & chunk : chunks)
     {
+        m_originalChunkSampleStart.at(chunk.m_id) = m_sweepSizeInSamples;
         m_sweepSizeInSamples += chunk.m_numberOfSamples;
     }
 }
@@ -117,6 +124,50 @@ void BlockRandomizer::PrepareNewSweepIfNeeded(size_t samplePosition)
         // Resetting sequence randomizer.
         m_sequenceRandomizer->Reset(m_seedOffset + m_sweep);
         m_currentWindowRange = {};
+        m_chunkOwners.clear();
+    }
+
+    if (m_contiguousChunkPlacement && (m_chunkOwners.empty() || m_chunkOwnersNumberOfWorkers != m_config.m_numberOfWorkers))
+        PlaceChunks();
+}
+
+// Assigns the randomized chunks of the current sweep to the workers, for the contiguous chunk placement.
+// The randomized chunks are cut into groups of a few chunks per worker, smaller than the randomization window.
+// Each group is split by position in the input into one range per worker, so that every window, and thus every
+// minibatch, has about the same number of samples of each worker, while a worker reads nearby parts of the input
+// (the same part of every group). The ranges rotate by one worker every sweep, so that a worker sees all the data.
+void BlockRandomizer::PlaceChunks()
+{
+    const auto& chunks = m_chunkRandomizer->GetRandomizedChunks();
+    size_t numberOfWorkers = std::max<size_t>(m_config.m_numberOfWorkers, 1);
+    m_chunkOwners.resize(chunks.size());
+    m_chunkOwnersNumberOfWorkers = m_config.m_numberOfWorkers;
+    if (chunks.empty())
+        return;
+
+    size_t windowSize = 0;
+    for (const auto& chunk : chunks)
+        windowSize += chunk.m_randomizationWindow.m_end - chunk.m_randomizationWindow.m_begin;
+    windowSize /= chunks.size();
+    size_t groupSize = numberOfWorkers * std::max<size_t>(windowSize / (2 * numberOfWorkers), 1);
+
+    std::vector<ChunkIdType> group;
+    for (size_t begin = 0; begin < chunks.size(); begin += groupSize)
+    {
+        size_t end = std::min(begin + groupSize, chunks.size());
+        group.clear();
+        for (size_t i = begin; i < end; ++i)
+            group.push_back((ChunkIdType)i);
+        std::sort(group.begin(), group.end(), [&](ChunkIdType a, ChunkIdType b)
+        {
+            return m_originalChunkSampleStart[chunks[a].m_original->m_id] < m_originalChunkSampleStart[chunks[b].m_original->m_id];
+        });
+
+        for (size_t rank = 0; rank < group.size(); ++rank)
+        {
+            size_t range = rank * numberOfWorkers / group.size();
+            m_chunkOwners[group[rank]] = (range + m_sweep) % numberOfWorkers;
+        }
     }
 }
 
@@ -282,7 +333,7 @@ std::tuple<bool, bool, size_t, size_t> BlockRandomizer::GetNextSequenceDescripti
         [&, this](const RandomizedSequenceDescription& s)
     {
         auto sequenceLength = s.m_numberOfSamples;
-        bool isLocal = s.m_chunk->m_chunkId % m_config.m_numberOfWorkers == m_config.m_workerRank; 
+        bool isLocal = IsLocalChunk(*s.m_chunk);
 
         // TODO: should we just drop this flag and return false if we cannot fulfil this request?
         if (!atLeastOneSequenceNeeded) 
@@ -366,7 +417,7 @@ void BlockRandomizer::LoadDataChunks(const ClosedOpenChunkInterval& windowRange)
     for (size_t i = windowRange.m_begin; i < windowRange.m_end; ++i)
     {
         auto const& chunk = m_chunkRandomizer->GetRandomizedChunks()[i];
-        if (chunk.m_chunkId % m_config.m_numberOfWorkers != m_config.m_workerRank)
+        if (!IsLocalChunk(chunk))
         {
             continue;
         }
@@ -437,8 +488,7 @@ ChunkIdType BlockRandomizer::GetChunkToPrefetch(const ClosedOpenChunkInterval& w
     while (current < m_chunkRandomizer->GetRandomizedChunks().size())
     {
         const auto& chunk = m_chunkRandomizer->GetRandomizedChunks()[current];
-        if (chunk.m_chunkId % m_config.m_numberOfWorkers == m_config.m_workerRank &&
-            m_chunks.find(chunk.m_original->m_id) == m_chunks.end())
+        if (IsLocalChunk(chunk) && m_chunks.find(chunk.m_original->m_id) == m_chunks.end())
         {
             toBePrefetched = chunk.m_original->m_id;
             break;
@@ -448,6 +498,16 @@ ChunkIdType BlockRandomizer::GetChunkToPrefetch(const ClosedOpenChunkInterval& w
     return toBePrefetched;
 }
 
+// Decides whether the randomized chunk is read by this worker.
+bool BlockRandomizer::IsLocalChunk(const RandomizedChunk& chunk) const
+{
+    if (!m_contiguousChunkPlacement)
+        return chunk.m_chunkId % m_config.m_numberOfWorkers == m_config.m_workerRank;
+
+    assert(chunk.m_chunkId < m_chunkOwners.size());
+    return m_chunkOwners[chunk.m_chunkId] == m_config.m_workerRank;
+}
+
 // Performs io prefetch of the specified chunk if needed.
 void BlockRandomizer::Prefetch(ChunkIdType chunkId)
 {
@@ -27,7 +27,9 @@ namespace CNTK {
 //         2) if a new chunk is entered, using SequenceRandomizer identify a window of chunks and requested their sequence descriptions from deserializer.
 //         3) randomize sequence descriptions inside the window
 //         4) return sequence descriptions not exceeding sampleCount/minibatch limit
-//         5) decimate sequence descriptions based on the worker rank
+//         5) decimate sequence descriptions based on the worker rank: by default randomized chunks are dealt round robin,
+//            with contiguous chunk placement each worker reads the same range of the original chunks within each group
+//            of randomized chunks, rotated every sweep
 //         6) request chunks of data based on decimated sequences and return sequence data
 //
 // This class is responsible for decimation and loading the data chunks in to memory.
@@ -44,7 +46,9 @@ public:
         bool multithreadedGetNextSequences = false,
         size_t maxNumberOfInvalidSequences = 0, // per worker
         bool sampleBasedRandomizationWindow = true,
-        size_t seedOffset = 0);
+        size_t seedOffset = 0,
+        size_t numberOfLengthBuckets = 0, // group sequences of similar length inside each chunk, see SequenceRandomizer
+        bool contiguousChunkPlacement = false);
 
     // Starts a new epoch.
     virtual void StartEpoch(const EpochConfiguration& config) override;
@@ -103,6 +107,12 @@ private:
     // Returns next candidate for the prefetch in the given range.
     ChunkIdType GetChunkToPrefetch(const ClosedOpenChunkInterval& windowRange);
 
+    // Assigns the randomized chunks of the current sweep to the workers, for the contiguous chunk placement.
+    void PlaceChunks();
+
+    // Returns true if the randomized chunk belongs to this worker in the current sweep.
+    bool IsLocalChunk(const RandomizedChunk& chunk) const;
+
     // Global sample position on the timeline.
     size_t m_globalSamplePosition;
 
@@ -124,6 +134,18 @@ private:
     // Total number of samples in a sweep.
     size_t m_sweepSizeInSamples;
 
+    // Whether workers read nearby ranges of the original chunks instead of every n-th randomized chunk.
+    // The global timeline is the same, only the assignment of chunks to workers differs.
+    bool m_contiguousChunkPlacement;
+
+    // Position of the first sample of each original chunk in the input, used for the contiguous chunk placement.
+    std::vector<size_t> m_originalChunkSampleStart;
+
+    // Worker of each randomized chunk in the current sweep, and the number of workers it was computed for
+    // (contiguous chunk placement only).
+    std::vector<size_t> m_chunkOwners;
+    size_t m_chunkOwnersNumberOfWorkers;
+
     DataDeserializerPtr m_deserializer;
 
     // Chunk randomizer.
@@ -7,6 +7,8 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include <inttypes.h>
 #include <future>
+#include <thread>
+#include <chrono>
 #include "IndexBuilder.h"
 #include "ReaderConstants.h"
 #include "FileWrapper.h"
@@ -21,6 +23,7 @@ IndexBuilder::IndexBuilder(const FileWrapper& input)
     : m_input(input),
     m_corpus(nullptr),
     m_isCacheEnabled(false),
+    m_cacheWaitTimeoutInSeconds(0),
     m_chunkSize(g_32MB),
     m_bufferSize(g_2MB),
     m_primary(true)
@@ -30,18 +33,29 @@ shared_ptr<Index> IndexBuilder::Build()
 {
     if (m_isCacheEnabled) 
     {
-        auto cacheFilename = GetCacheFilename();
-        if (msra::files::fuptodate(cacheFilename, m_input.Filename(), true))
-        {
-            // cache file is up-to-date, try to reconstruct the index from cache.
-            auto index = TryLoadFromCache(cacheFilename, m_chunkSize);
+        auto index = TryLoadUpToDateCache();
 
-            if (index != nullptr) 
+        // Only the main worker of the node writes the cache, the others can wait for it to appear
+        // rather than read the whole input as well.
+        if (index == nullptr && m_cacheWaitTimeoutInSeconds > 0 && IsCacheable() &&
+            Microsoft::MSR::CNTK::EnvironmentUtil::GetLocalMPINodeRank() != 0)
+        {
+            for (size_t waited = 0; index == nullptr && waited < m_cacheWaitTimeoutInSeconds; ++waited)
             {
-                if (!m_primary) 
-                    index->MapSequenceKeyToLocation();
-                return index;
+                this_thread::sleep_for(chrono::seconds(1));
+                index = TryLoadUpToDateCache();
             }
+
+            if (index == nullptr)
+                fprintf(stderr, "WARNING: the index cache of '%ls' was not written within %zu seconds, building the index.\n",
+                    m_input.Filename().c_str(), m_cacheWaitTimeoutInSeconds);
+        }
+
+        if (index != nullptr) 
+        {
+            if (!m_primary) 
+                index->MapSequenceKeyToLocation();
+            return index;
         }
     }
     
@@ -49,19 +63,32 @@ shared_ptr<Index> IndexBuilder::Build()
     
     Populate(index);
 
-    if (!m_corpus || m_corpus->IsNumericSequenceKeys() || m_corpus->IsHashingEnabled())
-    {
-        // For now, we do not cache index if input contains non-numeric sequence ids 
-        // and the corpus does not use a (deterministic and stateless) hashing procedure
-        // to transform sequence ids into numeric keys.
+    if (IsCacheable())
         WriteIndexCacheAsync(index);
-    }
 
     if (!m_primary)
         index->MapSequenceKeyToLocation();
     return index;
 }
 
+bool IndexBuilder::IsCacheable() const
+{
+    // For now, we do not cache index if input contains non-numeric sequence ids 
+    // and the corpus does not use a (deterministic and stateless) hashing procedure
+    // to transform sequence ids into numeric keys.
+    return !m_corpus || m_corpus->IsNumericSequenceKeys() || m_corpus->IsHashingEnabled();
+}
+
+shared_ptr<Index> IndexBuilder::TryLoadUpToDateCache()
+{
+    auto cacheFilename = GetCacheFilename();
+    if (!msra::files::fuptodate(cacheFilename, m_input.Filename(), true))
+        return nullptr;
+
+    // cache file is up-to-date, try to reconstruct the index from cache.
+    return TryLoadFromCache(cacheFilename, m_chunkSize);
+}
+
 
 void IndexBuilder::WriteIndexCacheAsync(shared_ptr<Index>& index) 
 {
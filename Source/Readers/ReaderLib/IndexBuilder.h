@@ -76,6 +76,10 @@ public:
 
     IndexBuilder& SetCachingEnabled(bool value) { m_isCacheEnabled = value; return *this; }
 
+    // When caching is enabled, workers other than the main one on the node wait up to the given time
+    // for the main worker to write the cache, instead of all of them reading the whole input.
+    IndexBuilder& SetCacheWaitTimeout(size_t seconds) { m_cacheWaitTimeoutInSeconds = seconds; return *this; }
+
     virtual std::wstring GetCacheFilename() = 0;
 
 protected:
@@ -92,10 +96,14 @@ protected:
     size_t m_chunkSize;
 
     bool m_isCacheEnabled;
+    size_t m_cacheWaitTimeoutInSeconds;
 
     static const uint64_t s_version = 1;
 
 private:
+    // Returns true if the index of the input can be written to the cache.
+    bool IsCacheable() const;
+    std::shared_ptr<Index> TryLoadUpToDateCache();
     static std::shared_ptr<Index> TryLoadFromCache(const std::wstring& cacheFilename, size_t chunkSize);
     void WriteIndexCacheAsync(std::shared_ptr<Index>& index);
     std::shared_ptr<Index> m_index;
@@ -0,0 +1,161 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <random>
+#include <thread>
+#include <chrono>
+
+#include "LTStreamingRandomizer.h"
+#include "RandomOrdering.h"
+
+namespace CNTK {
+
+using Microsoft::MSR::CNTK::RandomShuffleMT;
+
+// Properties used in the checkpoint.
+const static std::wstring s_streamPositionProperty = L"streamPosition";
+const static std::wstring s_streamChunkCountProperty = L"streamChunkCount";
+const static std::wstring s_streamSweepIndexProperty = L"streamSweepIndex";
+
+LTStreamingRandomizer::LTStreamingRandomizer(
+    DataDeserializerPtr deserializer,
+    bool randomize,
+    bool sampleBasedRandomizationWindow,
+    size_t randomizationRange,
+    size_t seedOffset,
+    size_t pollingIntervalInMs,
+    bool multithreadedGetNextSequences,
+    size_t maxNumberOfInvalidSequences)
+    : Base(deserializer, { { s_streamPositionProperty, 0 }, { s_streamChunkCountProperty, 0 }, { s_streamSweepIndexProperty, 0 } },
+        multithreadedGetNextSequences, maxNumberOfInvalidSequences, /*streaming =*/ true),
+      m_streamingDeserializer(dynamic_cast<StreamingDeserializer*>(deserializer.get())),
+      m_randomize(randomize),
+      m_sampleBasedRandomizationWindow(sampleBasedRandomizationWindow),
+      m_randomizationRange(randomize ? randomizationRange : 1),
+      m_seedOffset(seedOffset),
+      m_pollingIntervalInMs(pollingIntervalInMs),
+      m_position(0),
+      m_chunkCount(0),
+      m_sweepCount(0),
+      m_stopRequested(false),
+      m_prefetchedEndPosition(0),
+      m_prefetchedChunkCount(0),
+      m_prefetchedEndOfSweep(false)
+{
+    if (!m_streamingDeserializer || !m_streamingDeserializer->IsStreaming())
+        InvalidArgument("LTStreamingRandomizer requires a deserializer in streaming mode.");
+
+    if (m_randomizationRange == 0)
+        InvalidArgument("The randomization window of a streaming input cannot be 0.");
+}
+
+LTStreamingRandomizer::~LTStreamingRandomizer()
+{
+    // Make sure the outstanding prefetch does not wait for new data, and finishes before the members go away.
+    m_stopRequested = true;
+    WaitForPrefetch();
+}
+
+void LTStreamingRandomizer::Prefetch() const
+{
+    // Prefetch does not change any state that cannot be recalculated,
+    // only prefetches data.
+    size_t position = m_position;
+    size_t chunkCount = m_chunkCount;
+    m_prefetchedChunks.clear();
+    m_prefetchedSequences.clear();
+    m_prefetchedEndOfSweep = false;
+
+    int64_t range = m_randomizationRange;
+    while (range > 0 && !m_stopRequested)
+    {
+        bool isLocal = chunkCount % Config().m_numberOfWorkers == Config().m_workerRank;
+
+        StreamingChunk chunk;
+        if (!m_streamingDeserializer->TryReadChunk(position, static_cast<ChunkIdType>(chunkCount), isLocal, chunk))
+        {
+            if (m_streamingDeserializer->IsFollowingInput())
+            {
+                // No new data yet. The window is only handed out when it is full, so that it is the same
+                // when it is recomputed after restoring from a checkpoint.
+                std::this_thread::sleep_for(std::chrono::milliseconds(m_pollingIntervalInMs));
+                continue;
+            }
+
+            if (position == 0)
+                RuntimeError("The streamed input does not have any data.");
+
+            // End of the input, the window ends with the sweep.
+            m_prefetchedEndOfSweep = true;
+            break;
+        }
+
+        if (isLocal)
+        {
+            m_prefetchedSequences.insert(m_prefetchedSequences.end(), chunk.m_sequences.begin(), chunk.m_sequences.end());
+            m_prefetchedChunks.push_back(std::make_pair(static_cast<ChunkIdType>(chunkCount), chunk.m_data));
+
+            if (!m_sampleBasedRandomizationWindow)
+                --range;
+            else
+                for (const auto& s : chunk.m_sequences)
+                    range -= s.m_numberOfSamples;
+        }
+
+        position = chunk.m_endPosition;
+        chunkCount++;
+    }
+
+    m_prefetchedEndPosition = position;
+    m_prefetchedChunkCount = chunkCount;
+
+    if (m_randomize)
+    {
+        m_rng.seed((unsigned long)(m_chunkCount + m_sweepCount + m_seedOffset));
+        RandomShuffleMT(m_prefetchedSequences, 0, m_prefetchedSequences.size(), m_rng);
+    }
+
+    if (m_prefetchedEndOfSweep)
+        m_prefetchedSequences.push_back(s_endOfSweep);
+}
+
+void LTStreamingRandomizer::RefillSequenceWindow(SequenceWindow& window)
+{
+    window.m_dataChunks.clear();
+    window.m_sequences = m_prefetchedSequences;
+    for (const auto& c : m_prefetchedChunks)
+        window.m_dataChunks.insert(c);
+
+    if (m_prefetchedEndOfSweep)
+    {
+        m_sweepCount++;
+        m_position = 0;
+        m_chunkCount = 0;
+    }
+    else
+    {
+        m_position = m_prefetchedEndPosition;
+        m_chunkCount = m_prefetchedChunkCount;
+    }
+}
+
+std::map<std::wstring, size_t> LTStreamingRandomizer::GetInnerState()
+{
+    std::map<std::wstring, size_t> state;
+    state[s_streamPositionProperty] = m_position;
+    state[s_streamChunkCountProperty] = m_chunkCount;
+    state[s_streamSweepIndexProperty] = m_sweepCount;
+    return state;
+}
+
+void LTStreamingRandomizer::SetInnerState(const std::map<std::wstring, size_t>& state)
+{
+    m_position = ValueFrom(state, s_streamPositionProperty);
+    m_chunkCount = ValueFrom(state, s_streamChunkCountProperty);
+    m_sweepCount = ValueFrom(state, s_streamSweepIndexProperty);
+}
+
+}
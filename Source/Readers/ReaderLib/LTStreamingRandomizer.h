@@ -0,0 +1,74 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <atomic>
+#include <random>
+#include <vector>
+#include "LocalTimelineRandomizerBase.h"
+#include "StreamingDeserializer.h"
+
+namespace CNTK {
+
+// LT - LocalTimeline
+// A randomizer over a streaming deserializer: the input is read sequentially, chunk by chunk, without an index.
+// Sequences are shuffled inside a tumbling window (bounded shuffle buffer) of the next chunks, as in LTTumblingWindowRandomizer.
+// Chunks are distributed round robin between the workers, each worker only loads its own chunks.
+//
+// If the deserializer follows its input, reaching its end means waiting for new data, a sweep never ends.
+// Otherwise the end of input ends the sweep, and the next sweep starts from the beginning.
+// The checkpoint holds the input position of the current window, which is recomputed on restore.
+class LTStreamingRandomizer : public LocalTimelineRandomizerBase
+{
+    typedef LocalTimelineRandomizerBase Base;
+
+public:
+    LTStreamingRandomizer(
+        DataDeserializerPtr deserializer,
+        bool randomize,
+        bool sampleBasedRandomizationWindow,
+        size_t randomizationRange,
+        size_t seedOffset = 0,
+        size_t pollingIntervalInMs = 1000,
+        bool multithreadedGetNextSequences = false,
+        size_t maxNumberOfInvalidSequences = 0); // per worker
+
+    ~LTStreamingRandomizer();
+
+    std::map<std::wstring, size_t> GetInnerState() override;
+    void SetInnerState(const std::map<std::wstring, size_t>& state) override;
+    void RefillSequenceWindow(SequenceWindow& window) override;
+    void Prefetch() const override;
+
+private:
+    StreamingDeserializer* m_streamingDeserializer;
+
+    const bool m_randomize;
+    const bool m_sampleBasedRandomizationWindow;
+    const size_t m_randomizationRange;
+    const size_t m_seedOffset;
+    const size_t m_pollingIntervalInMs;
+
+    // Input position where the next window starts.
+    size_t m_position;
+    // Number of chunks read in the current sweep, used to assign chunks to workers.
+    size_t m_chunkCount;
+    // Current sweep count, incremented when the end of a finite input is reached.
+    size_t m_sweepCount;
+
+    // Set on destruction, so that prefetch does not wait for new data any longer.
+    std::atomic<bool> m_stopRequested;
+
+    // Do not store in the checkpoint, can be recalculated based on other members.
+    mutable std::mt19937_64 m_rng;
+    mutable std::vector<SequenceInfo> m_prefetchedSequences;
+    mutable std::vector<std::pair<ChunkIdType, ChunkPtr>> m_prefetchedChunks;
+    mutable size_t m_prefetchedEndPosition;
+    mutable size_t m_prefetchedChunkCount;
+    mutable bool m_prefetchedEndOfSweep;
+};
+
+}
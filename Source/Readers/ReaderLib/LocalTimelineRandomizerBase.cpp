@@ -18,7 +18,8 @@ LocalTimelineRandomizerBase::LocalTimelineRandomizerBase(
     DataDeserializerPtr deserializer,
     const std::map<std::wstring, size_t>& initialState,
     bool multithreadedGetNextSequences,
-    size_t maxNumberOfInvalidSequences)
+    size_t maxNumberOfInvalidSequences,
+    bool streaming)
 : m_deserializer(deserializer),
   m_multithreadedGetNextSequences(multithreadedGetNextSequences),
   m_cleaner(maxNumberOfInvalidSequences),
@@ -27,7 +28,7 @@ LocalTimelineRandomizerBase::LocalTimelineRandomizerBase(
   m_originalChunkDescriptions(deserializer->ChunkInfos()),
   m_currentState(initialState)
 {
-    if (m_originalChunkDescriptions.empty())
+    if (m_originalChunkDescriptions.empty() && !streaming)
         RuntimeError("The deserializer does not have any data, the number of chunks is 0.");
 }
 
@@ -46,7 +46,8 @@ protected:
         DataDeserializerPtr deserializer,
         const std::map<std::wstring, size_t>& initialState,
         bool multithreadedGetNextSequences = false,
-        size_t maxNumberOfInvalidSequences = 0); // per worker
+        size_t maxNumberOfInvalidSequences = 0, // per worker
+        bool streaming = false); // chunks are discovered while reading, the deserializer does not expose them
 
     // Struct that describes a window of sequences
     // that are currently processed.
@@ -92,6 +93,13 @@ protected:
     }
 
     ~LocalTimelineRandomizerBase()
+    {
+        WaitForPrefetch();
+    }
+
+    // Waits for the outstanding prefetch, if any. Child classes that need to stop
+    // their prefetch call it in their destructor, before their members go away.
+    void WaitForPrefetch()
     {
         if (m_prefetch.valid())
             m_prefetch.wait_for(std::chrono::seconds(60));
@@ -99,7 +107,7 @@ protected:
 
     const static SequenceInfo s_endOfSweep; // Marker indicating end of the sweep.
 
-    // Original chunk descriptions.
+    // Original chunk descriptions, empty in streaming mode.
     const std::vector<ChunkInfo> m_originalChunkDescriptions;
 
     const DataDeserializerPtr m_deserializer;
@@ -44,6 +44,8 @@ ReaderShim<ElemType>::ReaderShim() :
     m_deviceId(CPUDEVICE),
     m_dataTransferers(2, DataTransfererPtr()),
     m_currentDataTransferIndex(0),
+    m_prefetchFlowId(0),
+    m_zeroCopyInputs(false),
     m_endOfEpoch(false),
     m_endOfSweep(false),
     m_reader(nullptr),
@@ -76,6 +78,10 @@ void ReaderShim<ElemType>::Init(const ConfigParameters& config)
     // otherwise deferring - synchronous execution during .get() call
     m_launchType = prefetch ? launch::async : launch::deferred;
 
+    // If set, dense inputs that live on the CPU are not copied out of the packer buffers,
+    // the network matrices point directly to them.
+    m_zeroCopyInputs = config(L"zeroCopyInputs", false);
+
     m_numParallelSequences = numberOfuttsPerMinibatchForAllEpochs[0];
 
     if (!m_reader)
@@ -272,6 +278,7 @@ bool ReaderShim<ElemType>::GetMinibatch(StreamMinibatchInputs& matrices)
     auto result = m_prefetchTask.get();
 
     // Ok, prefetch is done.
+    ProfilerFlowEnd(m_prefetchFlowId, "Minibatch");
 
     // Let's update our sample position.
     m_currentState = m_reader->GetState();
@@ -359,10 +366,25 @@ bool ReaderShim<ElemType>::GetMinibatch(StreamMinibatchInputs& matrices)
 }
 
 template <class ElemType>
-void FillMatrixFromStream(StorageFormat type, Matrix<ElemType>* matrix, size_t numRows, const StreamMinibatchPtr& stream, DataTransferer* transferer)
+void FillMatrixFromStream(StorageFormat type, Matrix<ElemType>* matrix, size_t numRows, const StreamMinibatchPtr& stream, DataTransferer* transferer, bool zeroCopy)
 {
     size_t numCols = stream->m_layout->GetNumCols();
 
+    if (type == StorageFormat::Dense && zeroCopy && matrix->GetDeviceId() == CPUDEVICE && matrix->GetMatrixType() == DENSE)
+    {
+        // The matrix refers to the packer buffer of this minibatch. The packer alternates between two buffers,
+        // so the buffer is only overwritten when the minibatch after the next one is prefetched, i.e.
+        // after the network has requested the next minibatch and is done with this one.
+        auto data = reinterpret_cast<const ElemType*>(stream->m_data);
+        matrix->SetValue(numRows, numCols, CPUDEVICE, const_cast<ElemType*>(data), matrixFlagDontOwnBuffer);
+        return;
+    }
+
+    // The matrix may still refer to a packer buffer (it could have been swapped in from a zero-copy reader),
+    // such matrix cannot be resized, so it gets its own storage first.
+    if (!matrix->OwnBuffer())
+        *matrix = Matrix<ElemType>(0, 0, matrix->GetDeviceId(), matrix->GetMatrixType(), matrix->GetFormat());
+
     if (type == StorageFormat::Dense)
     {
         auto data = reinterpret_cast<const ElemType*>(stream->m_data);
@@ -387,6 +409,7 @@ template <class ElemType>
 typename ReaderShim<ElemType>::PrefetchResult ReaderShim<ElemType>::PrefetchMinibatch(size_t currentDataTransferIndex)
 {
     PROFILE_SCOPE(profilerEvtPrefetchMinibatch);
+    m_prefetchFlowId = ProfilerFlowBegin("Minibatch");
 
     // Resetting layouts.
     for (auto& mx : m_prefetchBuffers)
@@ -422,7 +445,7 @@ typename ReaderShim<ElemType>::PrefetchResult ReaderShim<ElemType>::PrefetchMini
         }
 
         size_t sampleSize = m_streams[streamId].m_sampleLayout.TotalSize();
-        FillMatrixFromStream(m_streams[streamId].m_storageFormat, mx.second.m_matrix.get(), sampleSize, stream, m_dataTransferers[currentDataTransferIndex].get());
+        FillMatrixFromStream(m_streams[streamId].m_storageFormat, mx.second.m_matrix.get(), sampleSize, stream, m_dataTransferers[currentDataTransferIndex].get(), m_zeroCopyInputs);
     }
 
     // Let's record that we started the copy, so that the main thread can wait afterwards.
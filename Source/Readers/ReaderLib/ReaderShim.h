@@ -140,6 +140,10 @@ private:
     std::vector<StreamInformation> m_streams;
     launch m_launchType;
 
+    // Whether dense CPU input matrices are handed over without a copy, pointing to the packer buffers.
+    // The data of a minibatch stays valid until the next minibatch is requested.
+    bool m_zeroCopyInputs;
+
     // Data structure required for prefetch.
     struct StreamPrefetchBuffer
     {
@@ -165,6 +169,10 @@ private:
     // Can be changed only from the main thread with no ongoing prefetch.
     size_t m_currentDataTransferIndex; 
 
+    // Profiler flow linking the prefetch of a minibatch to its consumption in GetMinibatch.
+    // Set by the prefetch thread, read by the main thread once the prefetch task has finished.
+    unsigned long long m_prefetchFlowId;
+
     // Device id.
     int m_deviceId;
 
@@ -62,7 +62,10 @@ Minibatch SequencePacker::ReadMinibatch()
 
     Minibatch minibatch(sequences.m_endOfSweep, sequences.m_endOfEpoch);
     if (batch.empty())
+    {
+        UpdatePaddingStatistics(minibatch);
         return minibatch;
+    }
 
     auto& currentBuffer = m_streamBuffers[m_currentBufferIndex];
 
@@ -100,11 +103,46 @@ Minibatch SequencePacker::ReadMinibatch()
     }
 
     EstablishIdToKey(minibatch, sequences);
+    UpdatePaddingStatistics(minibatch);
 
     m_currentBufferIndex = (m_currentBufferIndex + 1) % m_numberOfBuffers;
     return minibatch;
 }
 
+void SequencePacker::UpdatePaddingStatistics(const Minibatch& minibatch)
+{
+    // Streams can have different layouts (e.g. per-frame features and per-sequence labels),
+    // the one with the most frames is what the recurrent loops iterate over.
+    MBLayoutPtr layout;
+    for (const auto& stream : minibatch.m_data)
+    {
+        if (stream->m_layout && (!layout || stream->m_layout->GetNumCols() > layout->GetNumCols()))
+            layout = stream->m_layout;
+    }
+
+    if (layout)
+    {
+        size_t dataFrames = layout->GetActualNumSamples();
+        size_t packedFrames = layout->GetNumCols();
+        m_numberOfDataFrames += dataFrames;
+        m_numberOfPackedFrames += packedFrames;
+
+        if (m_verbosity >= 2)
+            fprintf(stderr, "SequencePacker: minibatch of %" PRIu64 " sequences in %" PRIu64 " parallel sequences x %" PRIu64 " time steps, "
+                "%" PRIu64 " of %" PRIu64 " frames hold data (padding efficiency %.2f%%)\n",
+                layout->GetNumSequences(), layout->GetNumParallelSequences(), layout->GetNumTimeSteps(),
+                dataFrames, packedFrames, 100.0 * dataFrames / packedFrames);
+    }
+
+    if (minibatch.m_endOfEpoch)
+    {
+        if (m_verbosity >= 1 && m_numberOfPackedFrames > 0)
+            fprintf(stderr, "SequencePacker: %" PRIu64 " of %" PRIu64 " packed frames of the epoch hold data (padding efficiency %.2f%%)\n",
+                m_numberOfDataFrames, m_numberOfPackedFrames, 100.0 * m_numberOfDataFrames / m_numberOfPackedFrames);
+        m_numberOfDataFrames = m_numberOfPackedFrames = 0;
+    }
+}
+
 void SequencePacker::SetConfiguration(const ReaderConfiguration& config, const std::vector<MemoryProviderPtr>& memoryProviders)
 {
     PackerBase::SetConfiguration(config, memoryProviders);
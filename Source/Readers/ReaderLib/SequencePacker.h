@@ -19,11 +19,15 @@ public:
         const std::vector<StreamInformation>& streams,
         size_t numberOfBuffers = 2,
         bool useLocalTimeline = false,
-        CorpusDescriptorPtr corpus = nullptr) :
+        CorpusDescriptorPtr corpus = nullptr,
+        int verbosity = 0) :
         PackerBase(corpus, sequenceEnumerator, streams, numberOfBuffers),
         m_useLocalTimeline(useLocalTimeline),
         m_globalMinibatchSizeInSamples(0),
-        m_localMinibatchSizeInSamples(0)
+        m_localMinibatchSizeInSamples(0),
+        m_verbosity(verbosity),
+        m_numberOfDataFrames(0),
+        m_numberOfPackedFrames(0)
     {}
 
     virtual Minibatch ReadMinibatch() override;
@@ -45,6 +49,10 @@ protected:
 
     std::pair<vector<MBLayout::SequenceInfo>,size_t> CreateSequenceInfos(const StreamBatch& batch);
 
+    // Accumulates the padding efficiency (frames holding data / packed frames) of the minibatch and
+    // reports it per minibatch (verbosity >= 2) and per epoch (verbosity >= 1).
+    void UpdatePaddingStatistics(const Minibatch& minibatch);
+
     // A flag indicating whether to use local timeline for data.
     bool m_useLocalTimeline;
 
@@ -54,6 +62,11 @@ protected:
     // A minibatch size for this worker in global samples.
     size_t m_globalMinibatchSizeInSamples;
 
+    int m_verbosity;
+
+    // Frames holding data and all packed frames (including gaps) since the start of the epoch.
+    size_t m_numberOfDataFrames;
+    size_t m_numberOfPackedFrames;
 };
 
 typedef std::shared_ptr<SequencePacker> SequencePackerPtr;
@@ -18,8 +18,11 @@ namespace CNTK {
     SequenceRandomizer::SequenceRandomizer(
         int verbosity,
         DataDeserializerPtr deserializer,
-        ChunkRandomizerPtr chunkRandomizer)
+        ChunkRandomizerPtr chunkRandomizer,
+        size_t numberOfLengthBuckets)
         : m_verbosity(verbosity),
+        m_numberOfLengthBuckets(numberOfLengthBuckets),
+        m_seed(0),
         m_randomizedChunks(chunkRandomizer->GetRandomizedChunks()),
         m_chunkWindowBegin(0),
         m_randomizedWindowEnd(0),
@@ -46,6 +49,7 @@ namespace CNTK {
     void SequenceRandomizer::Reset(size_t randSeed)
     {
         m_rng.seed((unsigned long)randSeed);
+        m_seed = randSeed;
 
         m_sequenceWindow.clear();
         m_randomizedChunkInfo.clear();
@@ -232,6 +236,11 @@ namespace CNTK {
         // Let's recalculate number of samples in the randomized chunks for efficient indexing in seek.
         size_t sampleCount = 0;
         size_t randomizedChunk = m_randomizedWindowEnd - m_chunkWindowBegin;
+        if (m_numberOfLengthBuckets > 1)
+        {
+            GroupSequencesByLength(m_sequenceWindow[randomizedChunk], m_randomizedWindowEnd);
+        }
+
         for (size_t index = 0; index < m_sequenceWindow[randomizedChunk].size(); index++)
         {
             sampleCount += m_sequenceWindow[randomizedChunk][index].m_numberOfSamples;
@@ -259,6 +268,40 @@ namespace CNTK {
                 m_randomizationCursor);
     }
 
+    // Sorts the sequences of a randomized chunk by length and cuts them into buckets with the same number of sequences.
+    // The buckets are then returned in random order, and the sequences inside each bucket in random order, so
+    // consecutive minibatches contain sequences of similar length while the data is still randomized across buckets.
+    // Sequences stay inside their chunk, so the randomization windows and sample counts of the chunks do not change.
+    // The order only depends on the sweep seed and the chunk, so all workers and Seek() reproduce it.
+    void SequenceRandomizer::GroupSequencesByLength(std::vector<RandomizedSequenceDescription>& sequences, size_t chunkIndex)
+    {
+        size_t numberOfBuckets = std::min(m_numberOfLengthBuckets, sequences.size());
+        if (numberOfBuckets <= 1)
+            return;
+
+        std::stable_sort(sequences.begin(), sequences.end(),
+            [](const RandomizedSequenceDescription& a, const RandomizedSequenceDescription& b) { return a.m_numberOfSamples < b.m_numberOfSamples; });
+
+        std::mt19937_64 rng(m_seed * m_randomizedChunks.size() + chunkIndex);
+        std::vector<size_t> bucketOrder(numberOfBuckets);
+        for (size_t i = 0; i < numberOfBuckets; ++i)
+            bucketOrder[i] = i;
+        Microsoft::MSR::CNTK::RandomShuffleMT(bucketOrder, rng);
+
+        std::vector<RandomizedSequenceDescription> grouped;
+        grouped.reserve(sequences.size());
+        for (size_t bucket : bucketOrder)
+        {
+            size_t begin = grouped.size();
+            grouped.insert(grouped.end(),
+                sequences.begin() + bucket * sequences.size() / numberOfBuckets,
+                sequences.begin() + (bucket + 1) * sequences.size() / numberOfBuckets);
+            Microsoft::MSR::CNTK::RandomShuffleMT(grouped, begin, grouped.size(), rng);
+        }
+
+        sequences.swap(grouped);
+    }
+
     // Sets current cursor to the given sample offset.
     // If offset is in the middle of the sequence, the next sequence is picked up.
     // If there is no sequence, an offset outside the sweep is returned.
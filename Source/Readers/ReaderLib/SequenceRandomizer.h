@@ -32,10 +32,13 @@ struct RandomizedSequenceDescription
 class SequenceRandomizer
 {
 public:
+    // If numberOfLengthBuckets > 1, the sequences of each randomized chunk are grouped into that many buckets
+    // of similar length (see GroupSequencesByLength()).
     SequenceRandomizer(
         int verbosity,
         DataDeserializerPtr deserializer,
-        ChunkRandomizerPtr chunkRandomizer);
+        ChunkRandomizerPtr chunkRandomizer,
+        size_t numberOfLengthBuckets = 0);
 
     // Resets the current sweep according to the randomization seed provided.
     void Reset(size_t seed);
@@ -76,6 +79,10 @@ private:
     // Release chunks from the chunk window that are not needed anymore.
     void ReleaseChunks();
 
+    // Reorders the (final) sequences of a randomized chunk so that sequences of similar length follow each other,
+    // which reduces padding in the minibatches packed from them.
+    void GroupSequencesByLength(std::vector<RandomizedSequenceDescription>& sequences, size_t chunkIndex);
+
     DataDeserializerPtr m_deserializer;
 
     // Used only as a buffer to get sequence descriptions without memory reallocation.
@@ -156,6 +163,12 @@ private:
     // General configuration
     int m_verbosity;
 
+    // Number of length buckets per chunk, 0 or 1 means no grouping by length.
+    size_t m_numberOfLengthBuckets;
+
+    // Seed of the current sweep.
+    size_t m_seed;
+
     std::mt19937_64 m_rng;
 };
 
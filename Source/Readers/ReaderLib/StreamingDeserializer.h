@@ -0,0 +1,51 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <vector>
+#include "DataDeserializer.h"
+
+namespace CNTK {
+
+// A chunk of sequences read by a streaming deserializer.
+struct StreamingChunk
+{
+    // Input position (byte offset) right after the chunk, where the next chunk starts.
+    size_t m_endPosition;
+
+    // Sequences of the chunk, with the chunk id given to TryReadChunk.
+    std::vector<SequenceInfo> m_sequences;
+
+    // Chunk data, only if it was requested.
+    ChunkPtr m_data;
+};
+
+// Interface of deserializers that can read their input sequentially, without building an index
+// (and hence without knowing the chunks) upfront. This allows to train on input that is too big to be indexed
+// or that keeps growing while it is read, i.e. continuously appended logs.
+// In streaming mode ChunkInfos() is empty and the data is read with TryReadChunk by the LTStreamingRandomizer.
+class StreamingDeserializer
+{
+public:
+    // Returns true if the deserializer is configured to stream its input.
+    virtual bool IsStreaming() const = 0;
+
+    // Returns true if the input is expected to grow: reaching the end of the input means that there is
+    // no new data yet, rather than the end of a sweep.
+    virtual bool IsFollowingInput() const = 0;
+
+    // Reads the chunk of complete sequences that starts at the given input position (0 is the beginning of the input).
+    // Returns false if there is no such chunk (yet). Chunk boundaries only depend on the position and on the input,
+    // so reading again from the same position gives the same chunk, which makes the position checkpointable.
+    // If loadData is false, only the boundaries of the chunk are determined, which is cheaper than parsing it.
+    virtual bool TryReadChunk(size_t position, ChunkIdType chunkId, bool loadData, StreamingChunk& result) = 0;
+
+    virtual ~StreamingDeserializer() {}
+};
+
+typedef std::shared_ptr<StreamingDeserializer> StreamingDeserializerPtr;
+
+}
@@ -284,6 +284,10 @@ bool TruncatedBPTTPacker::PackSlot(size_t streamIndex, size_t slotIndex, size_t&
     // Distance between two samples of the same sequence in bytes.
     size_t strideSize = m_numParallelSequences * sampleSize;
 
+    // The samples of the slot go to every strideSize bytes of the buffer, starting at its slot.
+    auto& buffer = m_streamBuffers[m_currentBufferIndex][streamIndex];
+    char* destination = buffer.m_data.get() + slotIndex * sampleSize;
+
     // Add current sequence to the minibatch layout.
     idToKey.resize(sequenceId + 1);
     idToKey[sequenceId] = slot.FrontSequence()->m_key.m_sequence;
@@ -293,53 +297,55 @@ bool TruncatedBPTTPacker::PackSlot(size_t streamIndex, size_t slotIndex, size_t&
         -(int)slot.m_sampleCursor,
         slot.FrontSequence()->m_numberOfSamples - slot.m_sampleCursor);
 
-    // Ok, now fill in the buffer with data.
-    for (size_t currentTimestep = 0; currentTimestep < numberOfSamples; ++currentTimestep)
+    // Ok, now fill in the buffer with data, one run of samples of the front sequence at a time.
+    size_t currentTimestep = 0;
+    for (;;)
     {
-        // Check if reach the end of the front sequence.
-        if (slot.m_sampleCursor >= slot.FrontSequence()->m_numberOfSamples)
-        {
-            // Starting a new sequence. Have to reset current pointers and add it to the minibatch layout.
-            containsEndOfSweepSequence |= slot.PopSequence();
-
-            //Adding next sequence to the minibatch.
-            idToKey.resize(sequenceId + 1);
-            idToKey[sequenceId] = slot.FrontSequence()->m_key.m_sequence;
-            m_currentLayouts[streamIndex]->AddSequence(
-                sequenceId++,
-                slotIndex,
-                currentTimestep,
-                currentTimestep + slot.FrontSequence()->m_numberOfSamples);
-        }
-
-        // Fill in the data from the first sequence in the slot.
         auto data = slot.FrontSequence();
-        // Get buffer destination for the current sample.
-        auto& buffer = m_streamBuffers[m_currentBufferIndex][streamIndex];
-        auto offset = strideSize * currentTimestep + slotIndex * sampleSize;
-        assert(offset >= 0 && offset < buffer.m_size);
-        char* destination = buffer.m_data.get() + offset;
+        size_t runLength = min(numberOfSamples - currentTimestep, data->m_numberOfSamples - slot.m_sampleCursor);
+        assert(runLength == 0 || (size_t)(destination - buffer.m_data.get()) + (runLength - 1) * strideSize + sampleSize <= buffer.m_size);
 
-        // Pack the sample.
+        // Pack the samples.
         if (storageType == StorageFormat::Dense)
         {
             assert(slot.m_sampleOffset == slot.m_sampleCursor * sampleSize);
-            PackDenseSample(destination, data, slot.m_sampleOffset, sampleSize);
-            slot.m_sampleOffset += sampleSize;
+            const char* source = (const char*)data->GetDataBuffer() + slot.m_sampleOffset;
+            for (size_t i = 0; i < runLength; ++i, source += sampleSize, destination += strideSize)
+                memcpy(destination, source, sampleSize);
+            slot.m_sampleOffset += runLength * sampleSize;
+            slot.m_sampleCursor += runLength;
         }
         else
         {
             assert(storageType == StorageFormat::SparseCSC);
             // TODO: make type casts members of the SparseSequenceData
             SparseSequenceDataPtr sparseSequence = static_pointer_cast<SparseSequenceData>(data);
-            assert(slot.m_sampleCursor < sparseSequence->m_nnzCounts.size());
-            PackSparseSampleAsDense(destination, sparseSequence, slot.m_sampleCursor, 
-                slot.m_sampleOffset, sampleSize, elementSize);
-            slot.m_sampleOffset += sparseSequence->m_nnzCounts[slot.m_sampleCursor];
-            assert(slot.m_sampleOffset <= sparseSequence->m_totalNnzCount);
+            for (size_t i = 0; i < runLength; ++i, destination += strideSize)
+            {
+                assert(slot.m_sampleCursor < sparseSequence->m_nnzCounts.size());
+                PackSparseSampleAsDense(destination, sparseSequence, slot.m_sampleCursor,
+                    slot.m_sampleOffset, sampleSize, elementSize);
+                slot.m_sampleOffset += sparseSequence->m_nnzCounts[slot.m_sampleCursor];
+                assert(slot.m_sampleOffset <= sparseSequence->m_totalNnzCount);
+                slot.m_sampleCursor++;
+            }
         }
 
-        slot.m_sampleCursor++;
+        currentTimestep += runLength;
+        if (currentTimestep == numberOfSamples)
+            break;
+
+        // Reached the end of the front sequence. Starting a new sequence: have to reset current pointers and add it to the minibatch layout.
+        containsEndOfSweepSequence |= slot.PopSequence();
+
+        //Adding next sequence to the minibatch.
+        idToKey.resize(sequenceId + 1);
+        idToKey[sequenceId] = slot.FrontSequence()->m_key.m_sequence;
+        m_currentLayouts[streamIndex]->AddSequence(
+            sequenceId++,
+            slotIndex,
+            currentTimestep,
+            currentTimestep + slot.FrontSequence()->m_numberOfSamples);
     }
 
     // Cleaning up the last sequence we have just read if needed.
@@ -0,0 +1,319 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "MASGD.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// BlockMomentumSGD -- block-wise model update filtering (BMUF)
+//
+// Each worker trains on its own for a block of samples. At the end of a block, the workers average
+// the change of their local models since the last sync (the block gradient), and the global model
+// is updated by filtering the averaged block gradients with block momentum:
+//
+//     blockUpdate  = blockMomentum * blockUpdate + blockLearningRate * averageBlockGradient
+//     globalModel -= blockUpdate
+//
+// The next block starts from the global model, or, with Nesterov-style block momentum, from
+// globalModel - blockMomentum * blockUpdate.
+//
+// With overlapCommunication, the block gradient is all-reduced asynchronously while the workers
+// train on the next block, and the block update is applied one block later: each worker then
+// continues from the updated global model plus its own progress during the block in between.
+// This hides the all-reduce for large models at the cost of one block of staleness.
+// At the end of an epoch, all pending updates are applied, so all workers hold the same model.
+// -----------------------------------------------------------------------
+
+template <typename ElemType>
+class BlockMomentumSGD : public IMASGD<ElemType>
+{
+    typedef IMASGD<ElemType> Base;
+    using Base::m_pMPI;
+    using Base::m_deviceId;
+    using Base::DownCast;
+
+public:
+    BlockMomentumSGD(const MPIWrapperPtr& pMPI, size_t reportFreq, DEVICEID_TYPE devID,
+                     bool useNesterovMomentum, bool resetSGDM,
+                     double blockLearningRate, double blockMomentumAsTimeConstant, size_t syncPeriod,
+                     bool overlapCommunication = false)
+        : Base(pMPI, reportFreq, devID),
+          m_useNesterovMomentum(useNesterovMomentum),
+          m_resetSGDMomentumAfterAggregation(resetSGDM),
+          m_blockLearningRate(blockLearningRate),
+          m_blockMomentumAsTimeConstantPerWorker(blockMomentumAsTimeConstant / pMPI->NumNodesInUse()),
+          m_syncPeriodPerWorker(syncPeriod / pMPI->NumNodesInUse()),
+          m_overlapCommunication(overlapCommunication),
+          m_isEpochEnd(false)
+    {
+        if (m_syncPeriodPerWorker == 0)
+            InvalidArgument("Sync period is too small.");
+        m_blockMomentum = TimeConstant2Momentum(m_blockMomentumAsTimeConstantPerWorker, m_syncPeriodPerWorker);
+    }
+
+    ~BlockMomentumSGD()
+    {
+        // an exception may leave an all-reduce in flight; its buffers must outlive it
+        try
+        {
+            WaitForPendingAggregation();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void OnEpochStart(const std::list<ComputationNodeBasePtr>& learnableNodes) override
+    {
+        Base::OnEpochStart(learnableNodes);
+
+        fprintf(stderr, "Parallel training (%d workers) using BlockMomentumSGD with block momentum = %6.4f, block momentum time constant (per worker) = %6.4f, block learning rate = %6.4f, block size per worker = %d samples, %s%s%s\n",
+                (int)m_pMPI->NumNodesInUse(), m_blockMomentum, m_blockMomentumAsTimeConstantPerWorker, m_blockLearningRate, (int)m_syncPeriodPerWorker,
+                m_useNesterovMomentum ? "using Nesterov-style block momentum, " : "",
+                m_resetSGDMomentumAfterAggregation ? "resetting SGD momentum after sync." : "not resetting SGD momentum after sync.",
+                m_overlapCommunication ? " Block aggregation overlaps with the next block." : "");
+
+        // The global model starts out as the local one. A model restored from a checkpoint is the same on all
+        // workers, a freshly initialized one is not guaranteed to be, so it is taken from the main node.
+        bool isFreshModel = m_parameters.empty();
+        for (auto& pBaseNode : learnableNodes)
+        {
+            if (!pBaseNode->IsParameterUpdateRequired())
+                continue;
+
+            auto& value = DownCast(pBaseNode)->Value();
+            auto& state = m_parameters[pBaseNode->NodeName()];
+            if (isFreshModel)
+                BroadcastFromMainNode(value);
+            if (!state.globalModel)
+            {
+                state.globalModel = make_shared<Matrix<ElemType>>(value.DeepClone());
+                state.blockUpdate = make_shared<Matrix<ElemType>>(value.GetNumRows(), value.GetNumCols(), value.GetDeviceId());
+                state.blockUpdate->SetValue(0);
+            }
+            state.blockStart = make_shared<Matrix<ElemType>>(value.DeepClone());
+        }
+    }
+
+    void OnEpochEnd(const std::list<ComputationNodeBasePtr>& learnableNodes,
+                    std::list<Matrix<ElemType>>& smoothedGradient,
+                    size_t samplesSinceLastSync) override
+    {
+        m_isEpochEnd = true;
+        Base::OnEpochEnd(learnableNodes, smoothedGradient, samplesSinceLastSync);
+        m_isEpochEnd = false;
+    }
+
+    void ModelAggregationProcessing(
+        size_t samplesSinceLastSync,                               /* in */
+        const std::list<ComputationNodeBasePtr>& learnableNodes,   /* in/out */
+        std::list<Matrix<ElemType>>& smoothedGradient,             /* in/out */
+        size_t& totalSamplesProcessed,                             /* out */
+        float& secondsOnCommunication                              /* out */) override
+    {
+        Timer commTimer;
+        secondsOnCommunication = 0.0f;
+
+        //----------------------------------------
+        // 1. number of samples of this block (statistics only, block gradients are averaged over workers)
+        //----------------------------------------
+        commTimer.Start();
+        size_t nTotalSamples = samplesSinceLastSync;
+        m_pMPI->AllReduce(&nTotalSamples, 1);
+        commTimer.Stop();
+        secondsOnCommunication += (float)commTimer.ElapsedSeconds();
+        totalSamplesProcessed = nTotalSamples;
+
+        //----------------------------------------
+        // 2. apply the block updates of the block before, start all-reducing the block gradients of this one
+        //----------------------------------------
+        bool overlap = m_overlapCommunication && !m_isEpochEnd;
+        commTimer.Restart();
+        bool hadPendingAggregation = WaitForPendingAggregation();
+        commTimer.Stop();
+        secondsOnCommunication += (float)commTimer.ElapsedSeconds();
+
+        for (auto& pBaseNode : learnableNodes)
+        {
+            if (!pBaseNode->IsParameterUpdateRequired())
+                continue;
+
+            auto& value = DownCast(pBaseNode)->Value();
+            auto& state = GetParameterState(pBaseNode->NodeName());
+
+            // block gradient of this worker: how far it moved since the start of the block
+            Matrix<ElemType> blockGradient(value.GetNumRows(), value.GetNumCols(), value.GetDeviceId());
+            blockGradient.AssignDifferenceOf(*state.blockStart, value);
+
+            if (hadPendingAggregation)
+            {
+                // continue from the updated global model, keeping the local progress since
+                UpdateGlobalModel(state);
+                value.AssignDifferenceOf(*state.blockStart, blockGradient);
+            }
+
+            state.aggregatedGradient.reset(blockGradient.CopyToArray());
+            m_pMPI->AllReduceAsync(state.aggregatedGradient.get(), blockGradient.GetNumElements(), &state.request);
+            m_numPendingRequests++;
+            state.blockStart->SetValue(value);
+        }
+
+        if (!overlap)
+        {
+            commTimer.Restart();
+            WaitForPendingAggregation();
+            commTimer.Stop();
+            secondsOnCommunication += (float)commTimer.ElapsedSeconds();
+
+            for (auto& pBaseNode : learnableNodes)
+            {
+                if (!pBaseNode->IsParameterUpdateRequired())
+                    continue;
+
+                auto& value = DownCast(pBaseNode)->Value();
+                auto& state = GetParameterState(pBaseNode->NodeName());
+                UpdateGlobalModel(state);
+                value.SetValue(*state.blockStart);
+            }
+        }
+
+        //----------------------------------------
+        // 3. the local momentum is stale w.r.t. the new model
+        //----------------------------------------
+        if (m_resetSGDMomentumAfterAggregation)
+        {
+            for (auto& g : smoothedGradient)
+                g.SetValue(0);
+        }
+    }
+
+    void SaveToCheckPoint(File& fstream) override
+    {
+        if (m_numPendingRequests > 0)
+            LogicError("BlockMomentumSGD: Cannot checkpoint while a block aggregation is in flight.");
+
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BBlockMomentumSGD");
+        fstream << (size_t)m_parameters.size();
+        for (const auto& entry : m_parameters)
+        {
+            fstream << entry.first;
+            fstream << *entry.second.globalModel << *entry.second.blockUpdate;
+        }
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EBlockMomentumSGD");
+    }
+
+    void LoadFromCheckPoint(File& fstream) override
+    {
+        // checkpoints of other model aggregation schemes carry no state
+        if (!fstream.TryGetMarker(FileMarker::fileMarkerBeginSection, L"BBlockMomentumSGD"))
+            return;
+
+        m_parameters.clear();
+        size_t numParameters;
+        fstream >> numParameters;
+        for (size_t i = 0; i < numParameters; i++)
+        {
+            std::wstring name;
+            fstream >> name;
+            auto& state = m_parameters[name];
+            state.globalModel = make_shared<Matrix<ElemType>>(m_deviceId);
+            state.blockUpdate = make_shared<Matrix<ElemType>>(m_deviceId);
+            fstream >> *state.globalModel >> *state.blockUpdate;
+        }
+        fstream.GetMarker(FileMarker::fileMarkerEndSection, L"EBlockMomentumSGD");
+    }
+
+    static double TimeConstant2Momentum(double timeConstant, size_t syncPeriod)
+    {
+        if (timeConstant == 0)
+            return 0;
+        return exp(-((double)syncPeriod) / timeConstant);
+    }
+
+    static double Momentum2TimeConstant(double blockMomentum, size_t syncPeriod)
+    {
+        if (blockMomentum >= 1.0 || blockMomentum < 0.0)
+            InvalidArgument("Unexpected block momentum (%.2f). Block momentum should be in the range of [0,1)\n", blockMomentum);
+        return -(double)syncPeriod / log(blockMomentum);
+    }
+
+private:
+    struct ParameterState
+    {
+        shared_ptr<Matrix<ElemType>> globalModel;  // model after the last block update (without Nesterov look-ahead)
+        shared_ptr<Matrix<ElemType>> blockUpdate;  // block momentum
+        shared_ptr<Matrix<ElemType>> blockStart;   // local model at the start of the current block
+        std::unique_ptr<ElemType[]> aggregatedGradient; // block gradient being all-reduced
+        MPI_Request request;
+    };
+
+    ParameterState& GetParameterState(const std::wstring& nodeName)
+    {
+        auto iter = m_parameters.find(nodeName);
+        if (iter == m_parameters.end() || !iter->second.blockStart)
+            LogicError("BlockMomentumSGD: No state for parameter '%ls'.", nodeName.c_str());
+        return iter->second;
+    }
+
+    // Filter the all-reduced block gradient into the global model. Leaves the start of the next block in blockStart.
+    void UpdateGlobalModel(ParameterState& state)
+    {
+        auto& globalModel = *state.globalModel;
+        auto& blockUpdate = *state.blockUpdate;
+
+        Matrix<ElemType> averageBlockGradient(globalModel.GetDeviceId());
+        averageBlockGradient.SetValue(globalModel.GetNumRows(), globalModel.GetNumCols(), globalModel.GetDeviceId(), state.aggregatedGradient.get());
+        state.aggregatedGradient.reset();
+
+        Matrix<ElemType>::ScaleAndAdd((ElemType)(m_blockLearningRate / m_pMPI->NumNodesInUse()), averageBlockGradient, (ElemType)m_blockMomentum, blockUpdate);
+        Matrix<ElemType>::ScaleAndAdd((ElemType)-1, blockUpdate, globalModel);
+
+        state.blockStart->SetValue(globalModel);
+        if (m_useNesterovMomentum)
+            Matrix<ElemType>::ScaleAndAdd((ElemType)-m_blockMomentum, blockUpdate, *state.blockStart);
+    }
+
+    // returns whether there was an aggregation in flight
+    bool WaitForPendingAggregation()
+    {
+        if (m_numPendingRequests == 0)
+            return false;
+        for (auto& entry : m_parameters)
+        {
+            if (entry.second.aggregatedGradient)
+                m_pMPI->Wait(&entry.second.request, MPI_STATUS_IGNORE);
+        }
+        m_numPendingRequests = 0;
+        return true;
+    }
+
+    void BroadcastFromMainNode(Matrix<ElemType>& value)
+    {
+        std::unique_ptr<ElemType[]> px(value.CopyToArray());
+        m_pMPI->Bcast(px.get(), value.GetNumElements(), m_pMPI->MainNodeRank());
+        value.SetValue(value.GetNumRows(), value.GetNumCols(), value.GetDeviceId(), px.get());
+    }
+
+    bool   m_useNesterovMomentum;
+    bool   m_resetSGDMomentumAfterAggregation;
+    double m_blockLearningRate;
+    double m_blockMomentumAsTimeConstantPerWorker;
+    size_t m_syncPeriodPerWorker;
+    bool   m_overlapCommunication;
+    double m_blockMomentum;
+    bool   m_isEpochEnd;
+    size_t m_numPendingRequests = 0;
+    std::map<std::wstring, ParameterState> m_parameters; // by node name
+};
+
+}}}
@@ -0,0 +1,141 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// ConcurrentValidation.h -- validates a snapshot of the model on a background thread while training goes on (SGD concurrentCV)
+//
+#pragma once
+
+#include <functional>
+#include <future>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "ComputationNetwork.h"
+#include "Criterion.h"
+#include "InputAndParamNodes.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// The validation network lives in CPU memory, whatever device the model trains on. The background thread thus
+// never touches the GPU, whose cuBLAS/cuDNN handles belong to the training thread and must not be shared.
+template <class ElemType>
+class ConcurrentValidation
+{
+public:
+    typedef std::function<std::vector<EpochCriterion>(const ComputationNetworkPtr& cvNet)> EvaluateFunction;
+
+    // 'modelFileName' is a model of the network that is trained. 'numCPUThreads' > 0 splits the OpenMP threads
+    // between training and validation while a validation runs.
+    ConcurrentValidation(const std::wstring& modelFileName, int numCPUThreads)
+        : m_cvNet(ComputationNetwork::CreateFromFile<ElemType>(CPUDEVICE, modelFileName)),
+          m_numCPUThreads(numCPUThreads),
+          m_numTrainingCPUThreads(GetNumCPUThreadsOfThisThread()),
+          m_pending(false),
+          m_epoch(0)
+    {
+    }
+
+    ~ConcurrentValidation()
+    {
+        if (m_result.valid())
+            m_result.wait();
+    }
+
+    // Snapshots 'net' (the model after 'epoch') and starts 'evaluate' on it in the background.
+    void Start(const ComputationNetworkPtr& net, int epoch, const EvaluateFunction& evaluate)
+    {
+        if (m_pending)
+            LogicError("ConcurrentValidation: The validation of epoch %d is still pending.", m_epoch + 1);
+        CopyModel(net, m_cvNet);
+
+        int numCPUThreads = m_numCPUThreads;
+        if (numCPUThreads > 0)
+            SetNumCPUThreadsOfThisThread(m_numTrainingCPUThreads - numCPUThreads);
+        auto cvNet = m_cvNet;
+        m_result = std::async(std::launch::async, [cvNet, evaluate, numCPUThreads]()
+        {
+            if (numCPUThreads > 0)
+                SetNumCPUThreadsOfThisThread(numCPUThreads);
+            return evaluate(cvNet);
+        });
+        m_pending = true;
+        m_epoch = epoch;
+    }
+
+    bool IsPending() const { return m_pending; }
+
+    // Waits for the pending validation and returns its result, and the epoch whose model it validated.
+    std::vector<EpochCriterion> Finish(int& epoch)
+    {
+        if (!m_pending)
+            LogicError("ConcurrentValidation: No validation is pending.");
+        m_pending = false;
+        epoch = m_epoch;
+        std::vector<EpochCriterion> scores;
+        try
+        {
+            scores = m_result.get();
+        }
+        catch (...)
+        {
+            RestoreCPUThreads();
+            throw;
+        }
+        RestoreCPUThreads();
+        return scores;
+    }
+
+    const ComputationNetworkPtr& Net() const { return m_cvNet; }
+
+    // Copies learned parameters and precomputed statistics from 'net' into 'cvNet', across devices.
+    static void CopyModel(const ComputationNetworkPtr& net, const ComputationNetworkPtr& cvNet)
+    {
+        for (const auto& cvNode : cvNet->GetAllNodes())
+        {
+            if (cvNode->OperationName() != OperationNameOf(LearnableParameter) && !cvNode->RequiresPreCompute())
+                continue;
+            auto node = dynamic_pointer_cast<ComputationNode<ElemType>>(net->GetNodeFromName(cvNode->NodeName()));
+            auto typedCVNode = dynamic_pointer_cast<ComputationNode<ElemType>>(cvNode);
+            if (node && typedCVNode)
+                typedCVNode->Value().AssignValuesOf(node->Value());
+        }
+    }
+
+private:
+    void RestoreCPUThreads()
+    {
+        if (m_numCPUThreads > 0)
+            SetNumCPUThreadsOfThisThread(m_numTrainingCPUThreads);
+    }
+
+    // OpenMP thread count of the calling thread only (the validation thread keeps its own)
+    static int GetNumCPUThreadsOfThisThread()
+    {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    static void SetNumCPUThreadsOfThisThread(int numThreads)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(std::max(numThreads, 1));
+#else
+        UNUSED(numThreads);
+#endif
+    }
+
+    ComputationNetworkPtr m_cvNet;
+    std::future<std::vector<EpochCriterion>> m_result;
+    const int m_numCPUThreads;
+    const int m_numTrainingCPUThreads;
+    bool m_pending;
+    int m_epoch;
+};
+
+}}}
@@ -31,6 +31,16 @@ namespace Microsoft { namespace MSR { namespace CNTK {
                 node->NotifyFunctionValuesMBSizeModified();
     }
 
+    // Deep-copies into an input matrix. The input matrix may refer to the reader's buffer (see 'zeroCopyInputs'),
+    // in which case it cannot be resized, so it gets its own storage first.
+    template <class ElemType>
+    static void SetInputMatrixValue(Matrix<ElemType>& input, const Matrix<ElemType>& value)
+    {
+        if (!input.OwnBuffer())
+            input = Matrix<ElemType>(0, 0, input.GetDeviceId(), input.GetMatrixType(), input.GetFormat());
+        input.SetValue(value);
+    }
+
     // -------------------------------------------------------------------
     // GetMinibatchIntoNetwork() -- get one minibatch from Reader (this->trainSetDataReader) into Network (this->net)
     // Returns false if no data is read. In that case, no other return value can be expected to contain meaningful values (e.g. actualMBSize will be unchanged).
@@ -227,7 +237,7 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         for (auto k : mb)
         {
             const auto& name = k.first;
-            mb.GetInputMatrix<ElemType>(name).SetValue(decimatedMB.GetInputMatrix<ElemType>(name)); // deep-copy our local one to the output location
+            SetInputMatrixValue(mb.GetInputMatrix<ElemType>(name), decimatedMB.GetInputMatrix<ElemType>(name)); // deep-copy our local one to the output location
         }
         pMBLayout->MoveFrom(pDecimatedMBLayout);
         return selected;
@@ -550,7 +560,7 @@ namespace Microsoft { namespace MSR { namespace CNTK {
             for (auto& x : decimatedMatrices)
             {
                 const wstring& name = x.first;
-                m_netInputMatrixPtr.GetInputMatrix<ElemType>(name).SetValue(decimatedMatrices.GetInputMatrix<ElemType>(name));
+                DataReaderHelpers::SetInputMatrixValue(m_netInputMatrixPtr.GetInputMatrix<ElemType>(name), decimatedMatrices.GetInputMatrix<ElemType>(name));
             }
 
             m_netMBLayoutPtr->CopyFrom(decimatedLayout);
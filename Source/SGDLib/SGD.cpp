@@ -22,19 +22,20 @@
 // ^^ workaround until this line in AggregateGradientsImpl() gets updated: assert(headerCPU->evalErrors[i] == 0);
 #include "AllReduceDistGradAggregator.h"
 
-#include "BlockMomentumSGD.h"
 #include "V2BlockMomentumSGD.h"
 
 #include "V2AllReduceDistGradAggregator.h"
 #endif
 
 #include "ASGDHelper.h"
+#include "BlockMomentumSGD.h"
 
 #include "CNTKLibraryInternals.h"
 #include "SimpleDistGradAggregator.h"
 #include "V2SimpleDistGradAggregator.h"
 #include "ProgressTracing.h"
 #include "PerformanceProfiler.h"
+#include "ConcurrentValidation.h"
 
 #include <map>
 #include <set>
@@ -509,6 +510,117 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     }
 
     // --- MAIN EPOCH LOOP
+    // per-node profiling, reported for the training part of each epoch
+    // Nodes also show up in the performance profiler, which syncs the GPU per node if profilerSyncGpu is set.
+    if (m_profileNodes)
+    {
+        net->EnableNodeProfiling(true);
+        NodeProfiler::EventSink sink;
+        sink.timeBegin = [] { return ProfilerTimeBegin(); };
+        sink.timeEnd = [](long long stateId, const char* eventDescription) { ProfilerTimeEnd(stateId, eventDescription); };
+        sink.syncGpu = [] { ProfilerSyncGpu(); };
+        net->NodeProfilerPtr()->SetEventSink(sink);
+    }
+
+    if (m_asyncCheckpoint && ((m_mpi == nullptr) || m_mpi->IsMainNode()))
+        m_checkpointWriter.reset(new AsyncCheckpointWriter(m_maxPendingCheckpoints));
+
+    vector<wstring> cvSetTrainAndEvalNodes;
+    if (criterionNodes.size() > 0)
+    {
+        cvSetTrainAndEvalNodes.push_back(criterionNodes[0]->NodeName());
+    }
+    for (let node : evaluationNodes)
+    {
+        cvSetTrainAndEvalNodes.push_back(node->NodeName());
+    }
+
+    // log the validation result of an epoch and use it for saving the best models and controlling the learning rate
+    auto reportValidationResult = [&](int epoch, const vector<EpochCriterion>& vScore)
+    {
+        LOGPRINTF(stderr, "Finished Epoch[%2d of %d]: [Validate] ", epoch + 1, (int)m_maxEpochs);
+        for (size_t k = 0; k < vScore.size() /*&& k < 2*/; k++)
+            vScore[k].LogCriterion(cvSetTrainAndEvalNodes[k], /*addSemicolon=*/k + 1 < vScore.size());
+            //fprintf(stderr, "%s %ls = %.8f * %d", k ? ";" : "", cvSetTrainAndEvalNodes[k].c_str(), vScore[k].Average(), (int)vScore[k].second);
+        fprintf(stderr, "\n");
+
+        if (tensorBoardWriter)
+        {
+            for (size_t k = 0; k < vScore.size(); k++)
+            {
+                tensorBoardWriter->WriteValue(L"summary/test_" + cvSetTrainAndEvalNodes[k], (float)vScore[k].Average(), epoch + 1);
+            }
+
+            tensorBoardWriter->Flush();
+        }
+
+        if (m_saveBestModelPerCriterion)
+        {
+            // Loops through criteria (i.e. score) and updates the best one if smaller value is found.
+            UpdateBestEpochs(vScore, cvSetTrainAndEvalNodes, epoch, m_criteriaBestEpoch);
+        }
+
+        if (m_useCVSetControlLRIfCVExists)
+        {
+            if (m_useEvalCriterionControlLR && vScore.size() > 1)
+                lrControlCriterion = vScore[1].Average(); // use the first of possibly multiple eval criteria
+            else
+                lrControlCriterion = vScore[0].Average(); // the first one is the training criterion
+        }
+    };
+
+    // With concurrentCV, the main node evaluates a CPU snapshot of the model on a background thread while the
+    // next epoch trains, non-distributed. The result is picked up at the end of that epoch, so the learning rate
+    // follows the validation set one epoch late. The starting model is validated, too, so that the learning-rate
+    // control sees validation results only. Not used with ASGD, whose background thread already owns MPI.
+    bool concurrentCV = m_concurrentCV && validationSetDataReader != trainSetDataReader && validationSetDataReader != nullptr &&
+                        GetParallelizationMethod() != ParallelizationMethod::dataParallelASGD;
+    unique_ptr<ConcurrentValidation<ElemType>> concurrentValidation; // (main node only)
+    bool cvPending = false;
+
+    auto startConcurrentValidation = [&](int epoch, size_t mbSize)
+    {
+        if ((m_mpi == nullptr) || m_mpi->IsMainNode())
+        {
+            concurrentValidation->Start(net, epoch, [validationSetDataReader, cvSetTrainAndEvalNodes, mbSize](const ComputationNetworkPtr& cvNet)
+            {
+                SimpleEvaluator<ElemType> evalforvalidation(cvNet, nullptr);
+                return evalforvalidation.Evaluate(validationSetDataReader, cvSetTrainAndEvalNodes, mbSize);
+            });
+        }
+        cvPending = true;
+    };
+
+    // must be called by all workers
+    auto finishConcurrentValidation = [&]()
+    {
+        if (!cvPending)
+            return;
+        cvPending = false;
+        if ((m_mpi == nullptr) || m_mpi->IsMainNode())
+        {
+            Timer waitTimer;
+            waitTimer.Start();
+            int cvEpoch;
+            let vScore = concurrentValidation->Finish(cvEpoch);
+            waitTimer.Stop();
+            if (m_traceLevel > 0)
+                LOGPRINTF(stderr, "SGD: Waited %.3f seconds for the concurrent validation of epoch %d.\n", waitTimer.ElapsedSeconds(), cvEpoch + 1);
+            reportValidationResult(cvEpoch, vScore);
+        }
+        // only the main node validated
+        if ((m_mpi != nullptr) && (m_mpi->NumNodesInUse() > 1))
+            m_mpi->Bcast(&lrControlCriterion, 1, m_mpi->MainNodeRank());
+    };
+
+    if (concurrentCV && startEpoch < (int) m_maxEpochs)
+    {
+        // the starting model was saved above or is the one we loaded
+        if ((m_mpi == nullptr) || m_mpi->IsMainNode())
+            concurrentValidation.reset(new ConcurrentValidation<ElemType>(GetModelNameForEpoch(startEpoch - 1), m_cvNumCPUThreads));
+        startConcurrentValidation(startEpoch - 1, m_mbSize[startEpoch]);
+    }
+
     for (int i = startEpoch; i < (int) m_maxEpochs; i++) // TODO: why is this an int, and not a size_t?
     {
         // Always skip the first epoch for profiling to avoid startup behavior.
@@ -518,6 +630,9 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
             ProfilerEnable(true);
         }
 
+        if (m_profileNodes)
+            net->NodeProfilerPtr()->Reset();
+
         // Synchronize all ranks before proceeding to ensure that
         // rank 0 has finished writing the previous model file
         SynchronizeWorkers();
@@ -677,6 +792,8 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         for (size_t j = 0; j < epochEvalErrors.size(); j++)
             epochEvalErrors[j].LogCriterion(evaluationNodes[j]->NodeName());
         fprintf(stderr, "totalSamplesSeen = %zu; learningRatePerSample = %.8g; epochTime=%.6gs\n", totalTrainingSamplesSeen, learnRatePerSample, epochTime);
+        if (m_profileNodes && (!m_mpi || m_mpi->IsMainNode()))
+            net->NodeProfilerPtr()->Print(stderr);
 #if 0
         // TODO: This was only printed if >1 eval criterion. Why? Needed?
         LOGPRINTF(stderr, "Finished Epoch[%2d of %d]:     Criterion Node [%ls] Per Sample = %.8g\n",
@@ -700,52 +817,20 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
             tensorBoardWriter->Flush();
         }
 
-        if (validationSetDataReader != trainSetDataReader && validationSetDataReader != nullptr)
+        if (concurrentCV)
+        {
+            // the validation of the previous epoch's model ran alongside this epoch
+            finishConcurrentValidation();
+        }
+        else if (validationSetDataReader != trainSetDataReader && validationSetDataReader != nullptr)
         {
             // TODO(dataASGD) making evaluator becoming nondistributed one when using ASGD, since Multiverso has another background thread using MPI.
             //                Making the evaluation serial (non-distributed) will slowdown training especially when validation set is large.
             SimpleEvaluator<ElemType> evalforvalidation(net, UsingAsyncGradientAggregation(i + 1) ?nullptr : m_mpi, m_enableDistributedMBReading);
-            vector<wstring> cvSetTrainAndEvalNodes;
-            if (criterionNodes.size() > 0)
-            {
-                cvSetTrainAndEvalNodes.push_back(criterionNodes[0]->NodeName());
-            }
-            for (let node : evaluationNodes)
-            {
-                cvSetTrainAndEvalNodes.push_back(node->NodeName());
-            }
 
             // BUGBUG: We should not use the training MB size. The training MB size is constrained by both convergence and memory. Eval is only constrained by memory.
             let vScore = evalforvalidation.Evaluate(validationSetDataReader, cvSetTrainAndEvalNodes, UsingAsyncGradientAggregation(i + 1) ? m_mbSize[i] / m_mpi->NumNodesInUse() : m_mbSize[i]);
-            LOGPRINTF(stderr, "Finished Epoch[%2d of %d]: [Validate] ", i + 1, (int)m_maxEpochs);
-            for (size_t k = 0; k < vScore.size() /*&& k < 2*/; k++)
-                vScore[k].LogCriterion(cvSetTrainAndEvalNodes[k], /*addSemicolon=*/k + 1 < vScore.size());
-                //fprintf(stderr, "%s %ls = %.8f * %d", k ? ";" : "", cvSetTrainAndEvalNodes[k].c_str(), vScore[k].Average(), (int)vScore[k].second);
-            fprintf(stderr, "\n");
-
-            if (tensorBoardWriter)
-            {
-                for (size_t k = 0; k < vScore.size(); k++)
-                {
-                    tensorBoardWriter->WriteValue(L"summary/test_" + cvSetTrainAndEvalNodes[k], (float)vScore[k].Average(), i + 1);
-                }
-
-                tensorBoardWriter->Flush();
-            }
-
-            if (m_saveBestModelPerCriterion)
-            {
-                // Loops through criteria (i.e. score) and updates the best one if smaller value is found.
-                UpdateBestEpochs(vScore, cvSetTrainAndEvalNodes, i, m_criteriaBestEpoch);
-            }
-
-            if (m_useCVSetControlLRIfCVExists)
-            {
-                if (m_useEvalCriterionControlLR && vScore.size() > 1)
-                    lrControlCriterion = vScore[1].Average(); // use the first of possibly multiple eval criteria
-                else
-                    lrControlCriterion = vScore[0].Average(); // the first one is the training criterion
-            }
+            reportValidationResult(i, vScore);
         }
 
         // broadcast epochCriterion to make sure each processor will have the same learning rate schedule
@@ -783,6 +868,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     // roll back
                     auto bestModelPath = GetModelNameForEpoch(i - m_learnRateAdjustInterval);
                     LOGPRINTF(stderr, "Loading (rolling back to) previous model with best training-criterion value: %ls.\n", bestModelPath.c_str());
+                    CompletePendingCheckpoints();
                     net->RereadPersistableParameters<ElemType>(bestModelPath);
                     LoadCheckPointInfo(i - m_learnRateAdjustInterval,
                                        /*out*/ totalTrainingSamplesSeen,
@@ -862,6 +948,9 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         // Persist model and check-point info
         if ((m_mpi == nullptr) || m_mpi->IsMainNode())
         {
+            Timer checkpointTimer;
+            checkpointTimer.Start();
+            double checkpointStallSeconds = m_checkpointWriter ? m_checkpointWriter->StallSeconds() : 0;
             if (loadedPrevModel)
             {
                 // If previous best model is loaded, we will first remove epochs that lead to worse results
@@ -869,8 +958,8 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 {
                     int epochToDelete = i - j;
                     LOGPRINTF(stderr, "SGD: removing model and checkpoint files for epoch %d after rollback to epoch %lu\n", epochToDelete + 1, (unsigned long)(i - m_learnRateAdjustInterval) + 1);  // report 1 based epoch number
-                    _wunlink(GetModelNameForEpoch(epochToDelete).c_str());
-                    _wunlink(GetCheckPointFileNameForEpoch(epochToDelete).c_str());
+                    RemoveCheckpointFile(GetModelNameForEpoch(epochToDelete));
+                    RemoveCheckpointFile(GetCheckPointFileNameForEpoch(epochToDelete));
                 }
 
                 // Set i back to the loaded model
@@ -898,7 +987,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 auto modelName = GetModelNameForEpoch(i);
                 if (m_traceLevel > 0)
                     LOGPRINTF(stderr, "SGD: Saving checkpoint model '%ls'\n", modelName.c_str());
-                net->Save(modelName);
+                SaveModel(net, modelName);
                 if (!m_keepCheckPointFiles)
                 {
                     // delete previous checkpoint file to save space
@@ -906,19 +995,27 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     {
                         if (epochsSinceLastLearnRateAdjust != 1)
                         {
-                            _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                            RemoveCheckpointFile(GetCheckPointFileNameForEpoch(i - 1));
                         }
                         if (epochsSinceLastLearnRateAdjust == m_learnRateAdjustInterval)
                         {
-                            _wunlink(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval).c_str());
+                            RemoveCheckpointFile(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval));
                         }
                     }
                     else
                     {
-                        _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                        RemoveCheckpointFile(GetCheckPointFileNameForEpoch(i - 1));
                     }
                 }
             }
+
+            // time the training thread spent on the checkpoint, including waiting for earlier ones to be written
+            if (m_checkpointWriter && m_traceLevel > 0)
+            {
+                checkpointTimer.Stop();
+                LOGPRINTF(stderr, "SGD: Checkpoint stalled training for %.3f seconds (%.3f seconds waiting for earlier checkpoints).\n",
+                          checkpointTimer.ElapsedSeconds(), m_checkpointWriter->StallSeconds() - checkpointStallSeconds);
+            }
         }
         else
         {
@@ -929,6 +1026,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
             }
         }
 
+        // validate the model we continue from (after a possible rollback) while the next epoch trains
+        if (concurrentCV)
+            startConcurrentValidation(i, m_mbSize[i]);
+
         if (learnRatePerSample < 1e-12)
         {
             LOGPRINTF(stderr, "learnRate per sample is reduced to %.8g which is below 1e-12. stop training.\n",
@@ -937,6 +1038,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     }
     // --- END OF MAIN EPOCH LOOP
 
+    finishConcurrentValidation();
+    CompletePendingCheckpoints();
+    m_checkpointWriter.reset();
+
     // Check if we need to save best model per criterion and this is the main node as well.
     if (m_saveBestModelPerCriterion && ((m_mpi == nullptr) || m_mpi->IsMainNode()))
     {
@@ -1627,6 +1732,7 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         isFirstMinibatch = false;
 
         ProfilerTimeEnd(profPost, profilerEvtMainPost);
+        ProfilerCounterRate(profMinibatch, "Samples/sec", (double)actualMBSize);
         ProfilerTimeEnd(profMinibatch, profilerEvtMainMinibatch);
     }
 
@@ -1834,6 +1940,7 @@ double SGD<ElemType>::SearchForBestLearnRate(ComputationNetworkPtr net,
     }
 
     int baseModelEpoch = epochNumber - 1;
+    CompletePendingCheckpoints();
     net->RereadPersistableParameters<ElemType>(GetModelNameForEpoch(baseModelEpoch));
 
     double learnRate = learnRatePerSample;
@@ -2213,6 +2320,7 @@ void SGD<ElemType>::TrainOneMiniEpochAndReloadModel(ComputationNetworkPtr net,
     int baseModelEpoch = epochNumber - 1;
     let path = GetModelNameForEpoch(baseModelEpoch);
     //fprintf(stderr, "Reverting parameters back to %ls\n", path.c_str());
+    CompletePendingCheckpoints();
     net->RereadPersistableParameters<ElemType>(path);
 
     double dummyLearnRate;
@@ -2311,10 +2419,8 @@ void SGD<ElemType>::InitModelAggregationHandler(int traceLevel, DEVICEID_TYPE de
     }
     else if (GetParallelizationMethod() == ParallelizationMethod::blockMomentumSGD)
     {
-#ifndef CNTK_PARALLEL_TRAINING_SUPPORT
-        RuntimeError("Block Momentum is not supported in the main CNTK repo. You need to enable 1bit submodule.");
-#else
-        if (Globals::UseV2Aggregator())
+#ifdef CNTK_PARALLEL_TRAINING_SUPPORT
+        if (Globals::UseV2Aggregator() && !m_overlapBlockMomentumCommunication)
         {
             auto communicator = ::CNTK::MPICommunicator();
             m_pMASGDHelper = make_shared<V2BlockMomentumSGD<ElemType>>(
@@ -2329,11 +2435,11 @@ void SGD<ElemType>::InitModelAggregationHandler(int traceLevel, DEVICEID_TYPE de
                 m_modelAggregationBlockSize);
         }
         else
+#endif
             m_pMASGDHelper = make_shared<BlockMomentumSGD<ElemType>>(m_mpi, traceLevel, devID, 
                                                                  m_useNesterovBlockMomentum, m_resetSGDMomentum, 
                                                                  m_blockLearningRate, m_blockMomentumAsTimeConstant, 
-                                                                 m_modelAggregationBlockSize);
-#endif 
+                                                                 m_modelAggregationBlockSize, m_overlapBlockMomentumCommunication);
     }
 }
 
@@ -2486,62 +2592,147 @@ void SGD<ElemType>::SaveCheckPointInfo(const size_t epoch, const size_t totalSam
         // This is a standard trick to avoid havign corrupted checkpoints files if process dies during writing
         wstring tempFileName = checkPointFileName + L".tmp";
 
+        // With asyncCheckpoint, the smoothed gradients are copied to the CPU and written by the background thread.
+        // The model-averaging state is not snapshotable, so with it the file is written right away.
+        bool writeInBackground = m_checkpointWriter && !m_pMASGDHelper &&
+                                 all_of(smoothedGradients.begin(), smoothedGradients.end(), [](const Matrix<ElemType>& m) { return m.GetMatrixType() == MatrixType::DENSE; });
+        if (writeInBackground)
+        {
+            auto snapshot = make_shared<std::list<Matrix<ElemType>>>();
+            for (const auto& smoothedGradientValues : smoothedGradients)
+            {
+                snapshot->emplace_back(smoothedGradientValues.GetNumRows(), smoothedGradientValues.GetNumCols(), CPUDEVICE);
+                snapshot->back().AssignValuesOf(smoothedGradientValues);
+            }
+            auto criteriaBestEpoch = m_saveBestModelPerCriterion ? make_shared<std::map<std::wstring, BestEpoch>>(m_criteriaBestEpoch) : nullptr;
+            m_checkpointWriter->Enqueue([=]()
+            {
+                WriteCheckPointInfo(tempFileName, totalSamplesSeen, learnRatePerSample, *snapshot, smoothedCounts, prevCriterion, minibatchSize, criteriaBestEpoch.get(), nullptr);
+                AsyncCheckpointWriter::CommitFile(tempFileName, checkPointFileName);
+            });
+        }
+        else
         {
-            File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
-            // Buffer writes in memory then flush to filesystem, which reduces number of small writes
-            fstream.Setvbuf();
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
-            fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
+            WriteCheckPointInfo(tempFileName, totalSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, minibatchSize,
+                                m_saveBestModelPerCriterion ? &m_criteriaBestEpoch : nullptr, m_pMASGDHelper.get());
+            CommitCheckpointFile(tempFileName, checkPointFileName);
+        }
+    }
+}
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
-            fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
+template <class ElemType>
+/*static*/ void SGD<ElemType>::WriteCheckPointInfo(const wstring& fileName, const size_t totalSamplesSeen,
+                                                   const double learnRatePerSample,
+                                                   const std::list<Matrix<ElemType>>& smoothedGradients,
+                                                   const std::vector<double>& smoothedCounts,
+                                                   const double prevCriterion,
+                                                   const size_t minibatchSize,
+                                                   const std::map<std::wstring, BestEpoch>* criteriaBestEpoch,
+                                                   IMASGD<ElemType>* pMASGDHelper)
+{
+    File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+    // Buffer writes in memory then flush to filesystem, which reduces number of small writes
+    fstream.Setvbuf();
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
+    fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
-            fstream << minibatchSize;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
+    fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
+    fstream << minibatchSize;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
 
-            for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
-            {
-                const Matrix<ElemType>& smoothedGradientValues = *smoothedGradientIter;
-                fstream << smoothedGradientValues;
-            }
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+    for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+    {
+        const Matrix<ElemType>& smoothedGradientValues = *smoothedGradientIter;
+        fstream << smoothedGradientValues;
+    }
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
 
-            for (auto sc : smoothedCounts)
-                fstream << sc;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
+    for (auto sc : smoothedCounts)
+        fstream << sc;
 
-            if (m_saveBestModelPerCriterion)
-            {
-                fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCriteria");
-                const int32_t criteriaSize = static_cast<int32_t>(m_criteriaBestEpoch.size());
-                fstream << criteriaSize;
-                for (const auto& criterion : m_criteriaBestEpoch)
-                {
-                    fstream << criterion.second.criterionMinValue << criterion.second.epochIndex;
-                }
-                fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECriteria");
-            }
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
-            if (m_pMASGDHelper)
-                m_pMASGDHelper->SaveToCheckPoint(fstream);
-            // Ensuring that data is written
-            fstream.Flush();
+    if (criteriaBestEpoch)
+    {
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCriteria");
+        const int32_t criteriaSize = static_cast<int32_t>(criteriaBestEpoch->size());
+        fstream << criteriaSize;
+        for (const auto& criterion : *criteriaBestEpoch)
+        {
+            fstream << criterion.second.criterionMinValue << criterion.second.epochIndex;
         }
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECriteria");
+    }
 
-        _wunlink(checkPointFileName.c_str());
-        renameOrDie(tempFileName, checkPointFileName);
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
+    if (pMASGDHelper)
+        pMASGDHelper->SaveToCheckPoint(fstream);
+    // Ensuring that data is written
+    fstream.Flush();
+}
+
+template <class ElemType>
+void SGD<ElemType>::SaveModel(const ComputationNetworkPtr& net, const wstring& modelName)
+{
+    if (m_checkpointWriter)
+    {
+        // the parameters keep changing, so copy them to CPU memory now and serialize the copy in the background
+        auto snapshot = net->CreateSnapshotForSave();
+        m_checkpointWriter->Enqueue([=]()
+        {
+            wstring tempFileName = modelName + L".tmp";
+            snapshot->SaveToFileImpl(tempFileName, FileOptions::fileOptionsBinary);
+            AsyncCheckpointWriter::CommitFile(tempFileName, modelName);
+        });
     }
+    else
+        net->Save(modelName);
+}
+
+// rename a freshly written checkpoint file into place; with asyncCheckpoint, after syncing it to disk in the background
+template <class ElemType>
+void SGD<ElemType>::CommitCheckpointFile(const wstring& tempFileName, const wstring& fileName)
+{
+    if (m_checkpointWriter)
+        m_checkpointWriter->Enqueue([=]() { AsyncCheckpointWriter::CommitFile(tempFileName, fileName); });
+    else
+    {
+        _wunlink(fileName.c_str());
+        renameOrDie(tempFileName, fileName);
+    }
+}
+
+// delete an old model or checkpoint file; with asyncCheckpoint, only after the writes queued before
+template <class ElemType>
+void SGD<ElemType>::RemoveCheckpointFile(const wstring& fileName)
+{
+    if (m_checkpointWriter)
+        m_checkpointWriter->Enqueue([=]() { _wunlink(fileName.c_str()); });
+    else
+        _wunlink(fileName.c_str());
+}
+
+// With asyncCheckpoint, wait for the main node's background writes before any worker reads a checkpoint back.
+// Must be called by all workers.
+template <class ElemType>
+void SGD<ElemType>::CompletePendingCheckpoints()
+{
+    if (!m_asyncCheckpoint)
+        return;
+    if (m_checkpointWriter)
+        m_checkpointWriter->Wait();
+    SynchronizeWorkers();
 }
 
 template <class ElemType>
@@ -2908,6 +3099,9 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_useCVSetControlLRIfCVExists = configAALR(L"UseCVSetControlLRIfCVExists", true);
     m_useEvalCriterionControlLR = configAALR(L"UseEvalCriterionControlLR", false);
 
+    m_concurrentCV = configSGD(L"concurrentCV", false);
+    m_cvNumCPUThreads = configSGD(L"cvNumCPUThreads", 0);
+
     // TODO: mbSize and truncated should be specified differently for truncated BPTT:
     //       mbSize = total number of samples after which a model update should happen
     //       truncated = truncation length
@@ -2964,6 +3158,7 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_numMBsToShowResult = configSGD(L"numMBsToShowResult", (size_t)10);
     m_firstMBsToShowResult = configSGD(L"firstMBsToShowResult", (size_t)0);
     m_numMBsToCUDAProfile = configSGD(L"numMBsToCUDAProfile", (size_t)0);
+    m_profileNodes = configSGD(L"profileNodes", false);
 
     // Parameters that control logging of training progress in TensorBoard.
     // Directory to create TensorBoard event files in. If empty (default), the progress is not logged as event files.
@@ -3117,6 +3312,11 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     if (m_adaptationRegWeight > 1 || m_adaptationRegWeight < 0)
         InvalidArgument("adaptationRegWeight must be in [0 1]");
 
+    // concurrentCV judges a model only after the next epoch has trained, so a rollback would load the model that
+    // was just judged worse, with a checkpointed criterion that is off by one epoch
+    if (m_concurrentCV && m_autoLearnRateSearchType == LearningRateSearchAlgorithm::AdjustAfterEpoch && m_loadBestModel)
+        InvalidArgument("concurrentCV cannot roll back to the best model with autoAdjustLR=adjustAfterEpoch. Please set loadBestModel=false.");
+
     m_minLearnRate = configSGD(L"minLearningRatePerSample", 1e-9f);
 
     m_needAdaptRegularization = false;
@@ -3132,6 +3332,7 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_enableDistributedMBReading = false;
     m_parallelizationStartEpochNum = 0;
     m_modelAggregationBlockSize = 0; 
+    m_overlapBlockMomentumCommunication = false;
 
     if (configSGD.Exists(L"ParallelTrain"))
     {
@@ -3203,9 +3404,6 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
         }
         if (configParallelTrain.Exists(L"BlockMomentumSGD"))
         {
-#ifndef CNTK_PARALLEL_TRAINING_SUPPORT
-            InvalidArgument("BlockMomentumSGD is not enabled in this version.\n");
-#else
             const ConfigRecordType& configBMSGD(configParallelTrain(L"BlockMomentumSGD", ConfigRecordType::Record()));
             if (configBMSGD.Exists(L"blockSize") && configBMSGD.Exists(L"blockSizePerWorker"))
                 InvalidArgument("It is only allowed to set blockSizePerWorker or blockSize, not both of them");
@@ -3231,6 +3429,7 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
             m_resetSGDMomentum = configBMSGD(L"resetSGDMomentum", true);
             m_useNesterovBlockMomentum = configBMSGD(L"useNesterovMomentum", true);
             m_blockLearningRate = configBMSGD(L"blockLearningRate", 1.0); 
+            m_overlapBlockMomentumCommunication = configBMSGD(L"overlapCommunication", false);
 
             if (configBMSGD.Exists(L"blockMomentumPerSync") && configBMSGD.Exists(L"blockMomentumAsTimeConstant"))
             {
@@ -3252,7 +3451,6 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
                 double blockMomentum = 1.0 - 1.0 / (double)numMPIWorkers;   // this is a default value which ensures each block update contributes equally
                 m_blockMomentumAsTimeConstant = BlockMomentumSGD<double>::Momentum2TimeConstant(blockMomentum, m_modelAggregationBlockSize);
             }
-#endif 
         }
 
         if (configParallelTrain.Exists(L"DataParallelASGD"))
@@ -3304,7 +3502,6 @@ SGDParams::SGDParams(const ScriptableObjects::IConfigRecordPtr configp)
 
 void SGDParams::InitializeAndCheckBlockMomentumSGDParameters()
 {
-#ifdef CNTK_PARALLEL_TRAINING_SUPPORT 
     // final argument checking in case of user specifying a bad parameter
     size_t numMPIWorker = MPIWrapper::GetInstance()->NumNodesInUse();
     double blockMomentum = BlockMomentumSGD<double>::TimeConstant2Momentum(m_blockMomentumAsTimeConstant, m_modelAggregationBlockSize);
@@ -3316,11 +3513,6 @@ void SGDParams::InitializeAndCheckBlockMomentumSGDParameters()
     {
         fprintf(stderr, "WARNING: blockMomentum equals to zero. \n");
     }
-#else
-    // don't need do anything here 
-    m_blockMomentumAsTimeConstant = 0.0;
-    m_blockLearningRate = 1.0;
-#endif 
 }
 
 // register SGD<> with the ScriptableObject system
@@ -20,6 +20,7 @@
 #include "Profiler.h"
 #include "MASGD.h"
 #include "ASGDHelper.h"
+#include "AsyncCheckpointWriter.h"
 #include <map>
 using namespace std; // ugh! TODO: get rid of this from .h files!!!
 
@@ -233,6 +234,11 @@ protected:
     bool m_useCVSetControlLRIfCVExists;
     bool m_useEvalCriterionControlLR;
 
+    // Evaluate the validation set on a background thread, on a snapshot of the model, while the next epoch trains.
+    // The result of epoch i is then reported, and controls the learning rate, at the end of epoch i+1.
+    bool m_concurrentCV;
+    int m_cvNumCPUThreads; // CPU threads given to the validation thread and taken from training while it runs (0: no change)
+
     double m_increaseLearnRateIfImproveMoreThan;
     double m_learnRateIncreaseFactor;
     double m_learnRateDecreaseFactor;
@@ -258,6 +264,7 @@ protected:
     size_t m_numMBsToShowResult = 0;
     size_t m_firstMBsToShowResult = 0;
     int m_numMBsToCUDAProfile;
+    bool m_profileNodes; // print per-node forward/backward statistics after each epoch
 
     std::wstring m_tensorBoardLogDir;
     size_t m_tensorBoardNumMBsToLogResult;
@@ -300,6 +307,7 @@ protected:
     bool   m_useNesterovBlockMomentum;
     double m_blockLearningRate; 
     double m_blockMomentumAsTimeConstant;
+    bool   m_overlapBlockMomentumCommunication; // all-reduce block gradients while training the next block
 
     bool m_needAveMultiplier;
     double m_L2RegWeight;
@@ -353,6 +361,8 @@ public:
           // TODO: The next few do not belong into SGD any more than the network or reader we operate on. Either move network and reader in here, or move these out.
           m_modelPath((const wstring&) configSGD(L"modelPath")),
           m_keepCheckPointFiles(configSGD(L"keepCheckPointFiles", false)),
+          m_asyncCheckpoint(configSGD(L"asyncCheckpoint", false)),
+          m_maxPendingCheckpoints(configSGD(L"maxPendingCheckpoints", (size_t)1)),
           m_saveBestModelPerCriterion(configSGD(L"saveBestModelPerCriterion", false)),
           m_trainCriterionNodeName((const wstring&) configSGD(L"trainCriterionNodeName", L"")),
           m_evalCriterionNodeName ((const wstring&) configSGD(L"evalCriterionNodeName", L"")),
@@ -538,6 +548,18 @@ protected:
                             const std::vector<double>& smoothedCounts,
                             const double prevCriterion,
                             const size_t minibatchSize);
+    static void WriteCheckPointInfo(const std::wstring& fileName, const size_t totalSamplesSeen,
+                                    const double learnRatePerSample,
+                                    const std::list<Matrix<ElemType>>& smoothedGradients,
+                                    const std::vector<double>& smoothedCounts,
+                                    const double prevCriterion,
+                                    const size_t minibatchSize,
+                                    const std::map<std::wstring, BestEpoch>* criteriaBestEpoch, // (null unless saveBestModelPerCriterion)
+                                    IMASGD<ElemType>* pMASGDHelper);
+    void SaveModel(const ComputationNetworkPtr& net, const std::wstring& modelName);
+    void CommitCheckpointFile(const std::wstring& tempFileName, const std::wstring& fileName);
+    void RemoveCheckpointFile(const std::wstring& fileName);
+    void CompletePendingCheckpoints();
 
     bool TryLoadCheckPointInfo(const size_t epochNumber,
                                /*out*/ size_t& totalSamplesSeen,
@@ -576,6 +598,12 @@ public:
 protected:
     std::wstring m_modelPath;
     bool m_keepCheckPointFiles;
+    // Write checkpoints on a background thread. The training thread only takes the snapshot (model
+    // file and a CPU copy of the learner state); syncing, renaming and deleting old files overlap
+    // with the next epoch. At most maxPendingCheckpoints are in flight.
+    bool m_asyncCheckpoint;
+    size_t m_maxPendingCheckpoints;
+    std::unique_ptr<AsyncCheckpointWriter> m_checkpointWriter; // (main node only)
     bool m_saveBestModelPerCriterion;
     // Mapping from criterion to the best epoch on validation data set.
     std::map<std::wstring, BestEpoch> m_criteriaBestEpoch;
@@ -151,6 +151,23 @@ private:
         return true;
     }
 
+    // The aggregation issues different MPI collectives for sparse and dense gradients, so all workers must agree on which
+    // gradients are sparse, or they would deadlock. Fail on all workers alike if they do not.
+    void VerifyGradientMatrixTypesAgree(const std::vector<Matrix<ElemType>*>& gradients)
+    {
+        std::vector<int> numWorkersWithSparse(gradients.size());
+        for (size_t i = 0; i < gradients.size(); i++)
+            numWorkersWithSparse[i] = gradients[i]->GetMatrixType() != DENSE ? 1 : 0;
+
+        m_mpi->AllReduce(numWorkersWithSparse.data(), numWorkersWithSparse.size());
+        for (size_t i = 0; i < gradients.size(); i++)
+        {
+            if (numWorkersWithSparse[i] != 0 && numWorkersWithSparse[i] != (int)NumProc())
+                RuntimeError("Gradient aggregation: gradient matrix %d is sparse on %d of %d workers, but must be so on all or none.",
+                             (int)i, numWorkersWithSparse[i], (int)NumProc());
+        }
+    }
+
     void ResetState(const std::vector<Matrix<ElemType>*>& gradients, int numEvalNodes, bool resetState)
     {
         // When called the first time let's setup the intermediateCPU buffers for gradient aggregation if needed
@@ -165,9 +182,22 @@ private:
                 m_allocator.reset(new CUDAPageLockedMemAllocator(deviceId));
             }
 
+            VerifyGradientMatrixTypesAgree(gradients);
+
             size_t packedGradientsSizeInElements = 0;
             for (size_t i = 0; i < gradients.size(); i++)
             {
+                // Sparse block column gradients (e.g. of embeddings fed by a sparse input) are aggregated separately,
+                // exchanging only the touched columns. This is currently supported for CPU gradients without async aggregation.
+                if (gradients[i]->GetMatrixType() != DENSE)
+                {
+                    if (gradients[i]->GetFormat() != matrixFormatSparseBlockCol || deviceId != CPUDEVICE || m_useAsyncAggregation)
+                        RuntimeError("Gradient aggregation for sparse gradient matrices is currently only supported for sparse block column gradients on CPU without async aggregation!");
+
+                    m_sparseGradientIndex.push_back(i);
+                    continue;
+                }
+
                 if (!m_useAsyncAggregation && sizeof(ElemType) * gradients[i]->GetNumElements() <= m_packThresholdSizeInBytes)
                 {
                     packedGradientsSizeInElements += gradients[i]->GetNumElements();
@@ -178,10 +208,6 @@ private:
                     m_gradientIndexToAggregate.push_back(i);
                 }
 
-                // Make sure none of the gradient matrixes are sparse - we currently do not support aggregation of sparse gradient matrices
-                if (gradients[i]->GetMatrixType() != DENSE)
-                    RuntimeError("Gradient aggregation for sparse gradient matrices is currently unsupported!");
-
                 if (m_useAsyncAggregation)
                     m_bufferedGradients[gradients[i]].reset(new Matrix<ElemType>(gradients[i]->GetNumRows(), gradients[i]->GetNumCols(), deviceId));
             }
@@ -201,7 +227,8 @@ private:
                 // Reuse "@param m_gradientIndexToAggregate" for following code, if no continous buffer allocated
                 for (size_t i = 0; i < gradients.size(); i++)
                 {
-                    m_gradientIndexToAggregate.push_back(i);
+                    if (gradients[i]->GetMatrixType() == DENSE)
+                        m_gradientIndexToAggregate.push_back(i);
                 }
             }
             else
@@ -409,6 +436,10 @@ private:
             }
         }
 
+        // Aggregate the sparse gradients while the dense all-reduce operations are in flight
+        for (size_t i : m_sparseGradientIndex)
+            AggregateSparseBlockColumnGradient(*gradients[i]);
+
         // On the main node wait for the headers to arrive and aggregate
         if (m_mpi->IsMainNode())
         {
@@ -474,6 +505,37 @@ private:
         }
     }
 
+    // Aggregates a sparse block column gradient, whose non-zero columns differ between workers.
+    // The workers first exchange the ids of their non-zero columns and lay out the union of them in the same order,
+    // then the values are summed with a single all-reduce. Both steps cost only proportional to the touched columns.
+    void AggregateSparseBlockColumnGradient(Matrix<ElemType>& gradient)
+    {
+        std::vector<size_t> columnIds;
+        gradient.GetSparseBlockColumnIds(columnIds);
+
+        // Gather the column ids of all workers, padded to the largest count, since MPIWrapper has no Allgatherv
+        size_t numColumns = columnIds.size();
+        std::vector<size_t> numColumnsPerNode(NumProc());
+        m_mpi->AllGather(&numColumns, 1, numColumnsPerNode.data(), 1);
+        size_t maxNumColumns = *std::max_element(numColumnsPerNode.begin(), numColumnsPerNode.end());
+        if (maxNumColumns == 0)
+            return;
+
+        const size_t noColumn = SIZE_MAX;
+        columnIds.resize(maxNumColumns, noColumn);
+        std::vector<size_t> allColumnIds(maxNumColumns * NumProc());
+        m_mpi->AllGather(columnIds.data(), maxNumColumns, allColumnIds.data(), maxNumColumns);
+
+        // All workers compute the same sorted union, which becomes the common block layout
+        std::sort(allColumnIds.begin(), allColumnIds.end());
+        allColumnIds.erase(std::unique(allColumnIds.begin(), allColumnIds.end()), allColumnIds.end());
+        if (allColumnIds.back() == noColumn)
+            allColumnIds.pop_back();
+
+        gradient.AdjustSparseBlockColumnIds(allColumnIds);
+        m_mpi->AllReduce(gradient.Data(), gradient.GetNumRows() * allColumnIds.size());
+    }
+
 private:
     std::unique_ptr<CUDAPageLockedMemAllocator> m_allocator;
 
@@ -499,6 +561,9 @@ private:
     std::vector<size_t> m_packedGradientsIndex;
     std::vector<size_t> m_gradientIndexToAggregate;
 
+    // Sparse block column gradients, which are aggregated by exchanging only their non-zero columns
+    std::vector<size_t> m_sparseGradientIndex;
+
     int m_syncStatsTrace;
 
     // Only used for controlling frequency of measuring/showing gradient aggregation perf stats
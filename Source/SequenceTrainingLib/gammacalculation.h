@@ -8,6 +8,7 @@
 #include "Matrix.h"
 #include "CUDAPageLockedMemAllocator.h"
 
+#include <exception>
 #include <memory>
 #include <vector>
 
@@ -99,7 +100,6 @@ public:
     {
         // check total frame number to be added ?
         // int deviceid = loglikelihood.GetDeviceId();
-        size_t boundaryframenum;
         std::vector<size_t> validframes; // [s] cursor pointing to next utterance begin within a single parallel sequence [s]
         validframes.assign(samplesInRecurrentStep, 0);
         ElemType objectValue = 0.0;
@@ -125,126 +125,133 @@ public:
             assert(T == pMBLayout->GetNumTimeSteps());
         }
 
-        size_t mapi = 0; // parallel-sequence index for utterance [i]
-        // cal gamma for each utterance
+        // pass 1: lay out the utterances within the minibatch and copy their logLLs to pred
+        const size_t numutts = lattices.size();
+        std::vector<utterancelayout> layout(numutts);
         size_t ts = 0;
-        for (size_t i = 0; i < lattices.size(); i++)
+        for (size_t i = 0; i < numutts; i++)
         {
-            const size_t numframes = lattices[i]->getnumframes();
+            auto& utt = layout[i];
+            utt.ts = ts;
+            utt.numframes = lattices[i]->getnumframes();
+            utt.mapi = 0;
+            utt.tbegin = 0;
 
-            msra::dbn::matrixstripe predstripe(pred, ts, numframes);           // logLLs for this utterance
-            msra::dbn::matrixstripe dengammasstripe(dengammas, ts, numframes); // denominator gammas
-
-            if (samplesInRecurrentStep == 1) // no sequence parallelism
-            {
-                tempmatrix = loglikelihood.ColumnSlice(ts, numframes);
-                // if (m_deviceid == CPUDEVICE)
-                {
-                    CopyFromCNTKMatrixToSSEMatrix(tempmatrix, numframes, predstripe);
-                }
-
-                if (m_deviceid != CPUDEVICE)
-                    parallellattice.setloglls(tempmatrix);
-            }
-            else // multiple parallel sequences
+            if (samplesInRecurrentStep > 1) // multiple parallel sequences
             {
                 // get number of frames for the utterance
-                mapi = extrauttmap[i]; // parallel-sequence index; in case of >1 utterance within this parallel sequence, this is in order of concatenation
+                utt.mapi = extrauttmap[i]; // parallel-sequence index; in case of >1 utterance within this parallel sequence, this is in order of concatenation
+                utt.tbegin = validframes[utt.mapi];
 
                 // scan MBLayout for end of utterance
                 size_t mapframenum = SIZE_MAX; // duration of utterance [i] as determined from MBLayout
-                for (size_t t = validframes[mapi]; t < T; t++)
+                for (size_t t = utt.tbegin; t < T; t++)
                 {
                     // TODO: Adapt this to new MBLayout, m_sequences would be easier to work off.
-                    if (pMBLayout->IsEnd(mapi, t))
+                    if (pMBLayout->IsEnd(utt.mapi, t))
                     {
-                        mapframenum = t - validframes[mapi] + 1;
+                        mapframenum = t - utt.tbegin + 1;
                         break;
                     }
                 }
 
                 // must match the explicit information we get from the reader
-                if (numframes != mapframenum)
-                    LogicError("gammacalculation: IsEnd() not working, numframes (%d) vs. mapframenum (%d)", (int) numframes, (int) mapframenum);
-                assert(numframes == mapframenum);
+                if (utt.numframes != mapframenum)
+                    LogicError("gammacalculation: IsEnd() not working, numframes (%d) vs. mapframenum (%d)", (int) utt.numframes, (int) mapframenum);
+                assert(utt.numframes == mapframenum);
 
-                if (numframes > tempmatrix.GetNumCols())
-                    tempmatrix.Resize(numrows, numframes);
+                validframes[utt.mapi] += utt.numframes; // advance the cursor within the parallel sequence
+            }
 
-                Microsoft::MSR::CNTK::Matrix<ElemType> loglikelihoodForCurrentParallelUtterance = loglikelihood.ColumnSlice(mapi + (validframes[mapi] * samplesInRecurrentStep), ((numframes - 1) * samplesInRecurrentStep) + 1);
-                tempmatrix.CopyColumnsStrided(loglikelihoodForCurrentParallelUtterance, numframes, samplesInRecurrentStep, 1);
+            msra::dbn::matrixstripe predstripe(pred, ts, utt.numframes); // logLLs for this utterance
+            GetUtteranceColumns(loglikelihood, utt, samplesInRecurrentStep, tempmatrix);
+            CopyFromCNTKMatrixToSSEMatrix(tempmatrix, utt.numframes, predstripe);
+            ts += utt.numframes;
+        }
 
-                // if (doreferencealign || m_deviceid == CPUDEVICE)
+        // pass 2: lattice forward-backward per utterance
+        std::vector<double> denavlogps(numutts);
+        if (m_deviceid == CPUDEVICE)
+        {
+            // On the CPU, lattices are independent (each writes to its own stripe of dengammas), so process them concurrently.
+            // Lattices vary a lot in size, hence dynamic scheduling.
+            // Exceptions must not escape the OpenMP region; the first one is rethrown afterwards.
+            std::exception_ptr firsterror;
+#pragma omp parallel for schedule(dynamic)
+            for (long i = 0; i < (long) numutts; i++)
+            {
+                try
                 {
-                    CopyFromCNTKMatrixToSSEMatrix(tempmatrix, numframes, predstripe);
+                    denavlogps[i] = ForwardBackwardUtterance(*lattices[i], layout[i], uids, boundaries, doreferencealign);
                 }
-
-                if (m_deviceid != CPUDEVICE)
+                catch (...)
                 {
-                    parallellattice.setloglls(tempmatrix);
+#pragma omp critical
+                    if (!firsterror)
+                        firsterror = std::current_exception();
                 }
             }
+            if (firsterror)
+                std::rethrow_exception(firsterror);
 
-            array_ref<size_t> uidsstripe(&uids[ts], numframes);
-
-            if (doreferencealign)
+            for (size_t i = 0; i < numutts; i++)
             {
-                boundaryframenum = numframes;
+                const auto& utt = layout[i];
+                msra::dbn::matrixstripe dengammasstripe(dengammas, utt.ts, utt.numframes);
+                if (samplesInRecurrentStep == 1)
+                    tempmatrix = gammafromlattice.ColumnSlice(utt.ts, utt.numframes);
+                CopyFromSSEMatrixToCNTKMatrix(dengammasstripe, numrows, utt.numframes, tempmatrix, gammafromlattice.GetDeviceId());
+                if (samplesInRecurrentStep > 1)
+                    SetUtteranceColumns(tempmatrix, utt, samplesInRecurrentStep, gammafromlattice);
             }
-            else
-                boundaryframenum = 0;
-            array_ref<size_t> boundariesstripe(&boundaries[ts], boundaryframenum);
-
-            double numavlogp = 0;
-            foreach_column (t, dengammasstripe) // we do not allocate memory for numgamma now, should be the same as numgammasstripe
+        }
+        else
+        {
+            // the GPU holds the state of a single lattice at a time
+            for (size_t i = 0; i < numutts; i++)
             {
-                const size_t s = uidsstripe[t];
-                numavlogp += predstripe(s, t) / amf;
-            }
-            numavlogp /= numframes;
+                const auto& utt = layout[i];
+                GetUtteranceColumns(loglikelihood, utt, samplesInRecurrentStep, tempmatrix);
+                parallellattice.setloglls(tempmatrix);
 
-            // auto_timer dengammatimer;
-            double denavlogp = lattices[i]->second.forwardbackward(parallellattice,
-                                                                   (const msra::math::ssematrixbase&) predstripe, (const msra::asr::simplesenonehmm&) m_hset,
-                                                                   (msra::math::ssematrixbase&) dengammasstripe, (msra::math::ssematrixbase&) gammasbuffer /*empty, not used*/,
-                                                                   lmf, wp, amf, boostmmifactor, seqsMBRmode, uidsstripe, boundariesstripe);
-            objectValue += (ElemType)((numavlogp - denavlogp) * numframes);
+                denavlogps[i] = ForwardBackwardUtterance(*lattices[i], utt, uids, boundaries, doreferencealign);
 
-            if (samplesInRecurrentStep == 1)
-            {
-                tempmatrix = gammafromlattice.ColumnSlice(ts, numframes);
+                if (samplesInRecurrentStep == 1)
+                    tempmatrix = gammafromlattice.ColumnSlice(utt.ts, utt.numframes);
+                parallellattice.getgamma(tempmatrix);
+                if (samplesInRecurrentStep > 1)
+                    SetUtteranceColumns(tempmatrix, utt, samplesInRecurrentStep, gammafromlattice);
             }
+        }
 
-            // copy gamma to tempmatrix
-            if (m_deviceid == CPUDEVICE)
-            {
-                CopyFromSSEMatrixToCNTKMatrix(dengammas, numrows, numframes, tempmatrix, gammafromlattice.GetDeviceId());
-            }
-            else
-                parallellattice.getgamma(tempmatrix);
+        // pass 3: objective and reference alignment, in utterance order
+        for (size_t i = 0; i < numutts; i++)
+        {
+            const auto& utt = layout[i];
+            msra::dbn::matrixstripe predstripe(pred, utt.ts, utt.numframes);
+            const size_t* uidsstripe = &uids[utt.ts];
 
-            // set gamma for multi channel
-            if (samplesInRecurrentStep > 1)
+            double numavlogp = 0;
+            for (size_t t = 0; t < utt.numframes; t++) // we do not allocate memory for numgamma now, should be the same as numgammasstripe
             {
-                Microsoft::MSR::CNTK::Matrix<ElemType> gammaFromLatticeForCurrentParallelUtterance = gammafromlattice.ColumnSlice(mapi + (validframes[mapi] * samplesInRecurrentStep), ((numframes - 1) * samplesInRecurrentStep) + 1);
-                gammaFromLatticeForCurrentParallelUtterance.CopyColumnsStrided(tempmatrix, numframes, 1, samplesInRecurrentStep);
+                const size_t s = uidsstripe[t];
+                numavlogp += predstripe(s, t) / amf;
             }
+            numavlogp /= utt.numframes;
+            objectValue += (ElemType)((numavlogp - denavlogps[i]) * utt.numframes);
 
             if (doreferencealign)
             {
-                for (size_t nframe = 0; nframe < numframes; nframe++)
+                for (size_t nframe = 0; nframe < utt.numframes; nframe++)
                 {
                     size_t uid = uidsstripe[nframe];
                     if (samplesInRecurrentStep > 1)
-                        labels(uid, (nframe + validframes[mapi]) * samplesInRecurrentStep + mapi) = 1.0;
+                        labels(uid, (nframe + utt.tbegin) * samplesInRecurrentStep + utt.mapi) = 1.0;
                     else
-                        labels(uid, ts + nframe) = 1.0;
+                        labels(uid, utt.ts + nframe) = 1.0;
                 }
             }
-            if (samplesInRecurrentStep > 1)
-                validframes[mapi] += numframes; // advance the cursor within the parallel sequence
-            fprintf(stderr, "dengamma value %f\n", denavlogp);
-            ts += numframes;
+            fprintf(stderr, "dengamma value %f\n", denavlogps[i]);
         }
         functionValues.SetValue(objectValue);
     }
@@ -383,6 +390,57 @@ public:
     }
 
 private:
+    // placement of an utterance within the minibatch
+    struct utterancelayout
+    {
+        size_t ts;        // first column of the utterance in pred/dengammas/uids
+        size_t numframes; // number of frames of the utterance
+        size_t mapi;      // parallel-sequence index
+        size_t tbegin;    // first time step within the parallel sequence
+    };
+
+    // gather the (possibly interleaved) columns of an utterance into a contiguous matrix
+    void GetUtteranceColumns(const Microsoft::MSR::CNTK::Matrix<ElemType>& src, const utterancelayout& utt, size_t samplesInRecurrentStep,
+                             Microsoft::MSR::CNTK::Matrix<ElemType>& dest)
+    {
+        if (samplesInRecurrentStep == 1) // no sequence parallelism
+        {
+            dest = src.ColumnSlice(utt.ts, utt.numframes);
+            return;
+        }
+
+        if (utt.numframes > dest.GetNumCols())
+            dest.Resize(src.GetNumRows(), utt.numframes);
+
+        Microsoft::MSR::CNTK::Matrix<ElemType> srcForCurrentParallelUtterance = src.ColumnSlice(utt.mapi + (utt.tbegin * samplesInRecurrentStep), ((utt.numframes - 1) * samplesInRecurrentStep) + 1);
+        dest.CopyColumnsStrided(srcForCurrentParallelUtterance, utt.numframes, samplesInRecurrentStep, 1);
+    }
+
+    // scatter a contiguous utterance matrix back into its interleaved columns
+    void SetUtteranceColumns(const Microsoft::MSR::CNTK::Matrix<ElemType>& src, const utterancelayout& utt, size_t samplesInRecurrentStep,
+                             Microsoft::MSR::CNTK::Matrix<ElemType>& dest)
+    {
+        Microsoft::MSR::CNTK::Matrix<ElemType> destForCurrentParallelUtterance = dest.ColumnSlice(utt.mapi + (utt.tbegin * samplesInRecurrentStep), ((utt.numframes - 1) * samplesInRecurrentStep) + 1);
+        destForCurrentParallelUtterance.CopyColumnsStrided(src, utt.numframes, 1, samplesInRecurrentStep);
+    }
+
+    // run forward-backward on one lattice, writing the denominator gammas to its stripe of dengammas
+    // In CPU mode this only touches per-utterance state and is called concurrently for different utterances.
+    double ForwardBackwardUtterance(const msra::dbn::latticepair& lattice, const utterancelayout& utt,
+                                    std::vector<size_t>& uids, std::vector<size_t>& boundaries, bool doreferencealign)
+    {
+        msra::dbn::matrixstripe predstripe(pred, utt.ts, utt.numframes);
+        msra::dbn::matrixstripe dengammasstripe(dengammas, utt.ts, utt.numframes);
+        array_ref<size_t> uidsstripe(&uids[utt.ts], utt.numframes);
+        array_ref<size_t> boundariesstripe(&boundaries[utt.ts], doreferencealign ? utt.numframes : 0);
+
+        // auto_timer dengammatimer;
+        return lattice.second.forwardbackward(parallellattice,
+                                              (const msra::math::ssematrixbase&) predstripe, (const msra::asr::simplesenonehmm&) m_hset,
+                                              (msra::math::ssematrixbase&) dengammasstripe, (msra::math::ssematrixbase&) gammasbuffer /*empty, not used*/,
+                                              lmf, wp, amf, boostmmifactor, seqsMBRmode, uidsstripe, boundariesstripe);
+    }
+
     // Helper methods for copying between ssematrix objects and CNTK matrices
     void CopyFromCNTKMatrixToSSEMatrix(const Microsoft::MSR::CNTK::Matrix<ElemType>& src, size_t numCols, msra::math::ssematrixbase& dest)
     {
@@ -14,6 +14,7 @@
 #include "latticestorage.h"
 #include <unordered_map>
 #include <list>
+#include <memory>
 #include <stdexcept>
 
 using namespace std;
@@ -40,12 +41,40 @@ class littlematrixheap
     size_t totalallocated;
     std::vector<matrixfrombuffer> matrices;
 
+    // make sure starting element of the last chunk is SSE-aligned (the matrix constructor demands that)
+    void alignlast()
+    {
+        allocatedinlast = 0;
+        const size_t offelem = (((size_t) &heap.back()[allocatedinlast]) / sizeof(float)) % 4;
+        if (offelem != 0)
+            allocatedinlast += 4 - offelem;
+    }
+
 public:
     littlematrixheap(size_t estimatednumentries)
         : totalallocated(0), allocatedinlast(0)
     {
         matrices.reserve(estimatednumentries + 1);
     }
+    // release all matrices handed out so far, but keep the memory for the next lattice
+    // Chunks are merged into one so that a lattice of the same size fits without further allocation.
+    void reset(size_t estimatednumentries)
+    {
+        matrices.clear();
+        matrices.reserve(estimatednumentries + 1);
+        if (heap.empty())
+            return;
+        if (heap.size() > 1)
+        {
+            size_t nelem = 0;
+            for (const auto &chunk : heap)
+                nelem += chunk.size();
+            heap.clear();
+            heap.push_back(std::vector<float>(nelem));
+        }
+        alignlast();
+        totalallocated = 0;
+    }
     msra::math::ssematrixbase &newmatrix(size_t rows, size_t cols)
     {
         const size_t elementsneeded = matrixfrombuffer::elementsneeded(rows, cols);
@@ -53,11 +82,7 @@ public:
         {
             const size_t nelem = max(CHUNKSIZE, elementsneeded + 3 /*+3 for SSE alignment*/);
             heap.push_back(std::vector<float>(nelem));
-            allocatedinlast = 0;
-            // make sure starting element is SSE-aligned (the constructor demands that)
-            const size_t offelem = (((size_t) &heap.back()[allocatedinlast]) / sizeof(float)) % 4;
-            if (offelem != 0)
-                allocatedinlast += 4 - offelem;
+            alignlast();
         }
         auto &buffer = heap.back();
         if (elementsneeded > heap.back().size() - allocatedinlast)
@@ -1353,7 +1378,14 @@ double lattice::forwardbackward(parallelstate &parallelstate, const msra::math::
     if (info.numframes != result.cols())
         fprintf(stderr, "forwardbackward: #frames mismatch between lattice (%d) and result (%d)\n", (int) info.numframes, (int) result.cols());
 
-    littlematrixheap matrixheap(info.numedges); // for abcs
+    // scratch for abcs; one heap per thread, kept across lattices so that lattices of a minibatch
+    // can be processed concurrently (see GammaCalculation::calgammaformb()) without reallocating per call
+    static THREAD_LOCAL std::unique_ptr<littlematrixheap> threadmatrixheap;
+    if (!threadmatrixheap)
+        threadmatrixheap.reset(new littlematrixheap(info.numedges));
+    else
+        threadmatrixheap->reset(info.numedges);
+    littlematrixheap &matrixheap = *threadmatrixheap;
 
     // PHASE 0: fake word level forward backwards --only used when pruning enabled
     const double minlogpp = LOGZERO; // pruning threshold  --LOGZERO means disabled
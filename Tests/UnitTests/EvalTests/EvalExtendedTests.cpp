@@ -175,6 +175,54 @@ BOOST_AUTO_TEST_CASE(EvalScalarTimesDualOutputTest)
     eval->Destroy();
 }
 
+BOOST_AUTO_TEST_CASE(EvalOptimizeForInferenceTest)
+{
+    // Constant subexpression (1 + 2), a Dropout, a criterion and an output that are not requested.
+    // OptimizeForInferenceFoldsAndRemovesNodes in the NetworkTests checks what happens to the nodes of the same network.
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(1) \n"
+        "l1 = Input(1) \n"
+        "c1 = Plus(Constant(1), Constant(2)) \n"
+        "d1 = Dropout(i1) \n"
+        "o1 = Times(c1, d1, tag=\"output\") \n"
+        "o2 = Times(Constant(5), i1, tag=\"output\") \n"
+        "ce = SquareError(l1, o1, tag=\"criterion\") \n"
+        "FeatureNodes = (i1) \n"
+        "LabelNodes = (l1) \n"
+        "] \n";
+
+    IEvaluateModelExtended<float> *eval;
+    GetEvalExtendedF(&eval);
+    eval->Init("optimizeForInference = true");
+    eval->CreateNetwork(modelDefinition);
+    eval->StartForwardEvaluation({ L"o1" });
+
+    // the labels only feed the removed criterion
+    VariableSchema inputLayouts = eval->GetInputSchema();
+    VariableSchema outputLayouts = eval->GetOutputSchema();
+    BOOST_REQUIRE_EQUAL(inputLayouts.size(), 1);
+    BOOST_CHECK(inputLayouts[0].m_name == L"i1");
+    BOOST_REQUIRE_EQUAL(outputLayouts.size(), 1);
+    BOOST_CHECK(outputLayouts[0].m_name == L"o1");
+
+    auto outputBuffer = outputLayouts.CreateBuffers<float>({ 1 });
+    Values<float> inputBuffer(1);
+    inputBuffer[0].m_buffer = { 2 };
+
+    eval->ForwardPass(inputBuffer, outputBuffer);
+
+    std::vector<float> expected{ 6 };
+    auto buf = outputBuffer[0].m_buffer;
+    BOOST_CHECK_EQUAL_COLLECTIONS(buf.begin(), buf.end(), expected.begin(), expected.end());
+
+    eval->Destroy();
+}
+
 BOOST_AUTO_TEST_CASE(EvalDenseTimesTest)
 {
     std::string modelDefinition =
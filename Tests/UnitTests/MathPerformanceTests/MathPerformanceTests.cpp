@@ -9,12 +9,17 @@
 //#include "Windows.h"
 #include "Matrix.h"
 #include "CPUMatrix.h"
+#include "CPUSparseMatrix.h"
 #include "TensorView.h"
 #include "Sequences.h"
 #include <chrono>
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+#include <numeric>
 
 using namespace Microsoft::MSR::CNTK;
 using namespace std;
@@ -156,6 +161,108 @@ void SquareMultiplyAndAdd10TimesAvgTest(int n, int count)
     cout << "CPUMatrix/Matrix ratio is: " << cpu_avg / m_avg << " seconds" << endl;
 }
 
+// Compares the CPU sparse kernels used by sparse input layers (e.g. bag-of-words times embedding) against a dense GEMM
+// on the densified input, for a range of sparsity levels:
+//  - forward:  C(hidden x batch) = W(hidden x vocab) * X(vocab x batch), X sparse CSC
+//  - gradient: dW = dC(hidden x batch) * X^T, accumulated into a block-sparse matrix holding only the touched columns of W
+template <class ElemType>
+void SparseTimesDenseTest(int hidden, int vocab, int batch, double density, int count)
+{
+    cout << "W(" << hidden << "x" << vocab << ") * X(" << vocab << "x" << batch << "), density " << density << endl;
+
+    mt19937 rng(1);
+    uniform_real_distribution<float> nd(-1, 1);
+    uniform_int_distribution<int> rowDist(0, vocab - 1);
+
+    // build X as CSC with a fixed number of (sorted, distinct) non-zeros per column
+    size_t nzPerCol = max((size_t) 1, (size_t) (density * vocab));
+    vector<CPUSPARSE_INDEX_TYPE> colStart(1, 0);
+    vector<CPUSPARSE_INDEX_TYPE> rows;
+    vector<ElemType> values;
+    for (int j = 0; j < batch; j++)
+    {
+        set<CPUSPARSE_INDEX_TYPE> colRows;
+        while (colRows.size() < nzPerCol)
+            colRows.insert(rowDist(rng));
+        for (auto row : colRows)
+        {
+            rows.push_back(row);
+            values.push_back(nd(rng));
+        }
+        colStart.push_back((CPUSPARSE_INDEX_TYPE) rows.size());
+    }
+    CPUSparseMatrix<ElemType> X(matrixFormatSparseCSC, vocab, batch, values.size());
+    X.SetMatrixFromCSCFormat(colStart.data(), rows.data(), values.data(), values.size(), vocab, batch);
+    CPUMatrix<ElemType> XDense(vocab, batch);
+    X.AssignColumnSliceToDense(XDense, 0, batch);
+
+    CPUMatrix<ElemType> W(hidden, vocab);
+    randomInitializeCPUMatrix<ElemType>(W, -1, 1);
+    CPUMatrix<ElemType> dC(hidden, batch);
+    randomInitializeCPUMatrix<ElemType>(dC, -1, 1);
+    CPUMatrix<ElemType> C(hidden, batch);
+    CPUMatrix<ElemType> dWDense(hidden, vocab);
+
+    auto timeIt = [count](const function<void()>& f)
+    {
+        f(); // warm up
+        auto t_start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < count; i++)
+            f();
+        auto t_end = chrono::high_resolution_clock::now();
+        return chrono::duration<double>(t_end - t_start).count() / count;
+    };
+
+    double sparseForward = timeIt([&] { CPUSparseMatrix<ElemType>::MultiplyAndWeightedAdd(1, W, false, X, false, 0, C); });
+    double denseForward  = timeIt([&] { CPUMatrix<ElemType>::MultiplyAndWeightedAdd(1, W, false, XDense, false, 0, C); });
+    double sparseGradient = timeIt([&]
+    {
+        CPUSparseMatrix<ElemType> dW(matrixFormatSparseBlockCol);
+        CPUSparseMatrix<ElemType>::MultiplyAndAdd(1, dC, false, X, true, dW);
+    });
+    double denseGradient = timeIt([&] { CPUMatrix<ElemType>::MultiplyAndWeightedAdd(1, dC, false, XDense, true, 1, dWDense); });
+
+    cout << "forward:  sparse " << sparseForward << " s, dense GEMM " << denseForward << " s, speedup " << denseForward / sparseForward << endl;
+    cout << "gradient: sparse " << sparseGradient << " s, dense GEMM " << denseGradient << " s, speedup " << denseGradient / sparseGradient << endl;
+}
+
+// Compares the top-K path of CPUMatrix::VectorMax (as used by TopK and decoding over large vocabularies) against
+// partially sorting the row indices of each column, for a (m x n) matrix of scores
+template <class ElemType>
+void VectorMaxTopKTest(int m, int n, int topK, int count)
+{
+    cout << "VectorMax top " << topK << " of (" << m << "x" << n << ")" << endl;
+
+    CPUMatrix<ElemType> A(m, n);
+    randomInitializeCPUMatrix<ElemType>(A);
+    CPUMatrix<ElemType> maxIndexes;
+    CPUMatrix<ElemType> maxValues;
+    vector<int> indices(m);
+
+    auto timeIt = [count](const function<void()>& f)
+    {
+        f(); // warm up
+        auto t_start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < count; i++)
+            f();
+        auto t_end = chrono::high_resolution_clock::now();
+        return chrono::duration<double>(t_end - t_start).count() / count;
+    };
+
+    double selection = timeIt([&] { A.VectorMax(maxIndexes, maxValues, true, topK); });
+    double sorting = timeIt([&]
+    {
+        for (int j = 0; j < n; j++)
+        {
+            const ElemType* col = A.Data() + (size_t) j * m;
+            iota(indices.begin(), indices.end(), 0);
+            partial_sort(indices.begin(), indices.begin() + topK, indices.end(), [col](int a, int b) { return col[a] > col[b]; });
+        }
+    });
+
+    cout << "selection " << selection << " s, partial sort " << sorting << " s, speedup " << sorting / selection << endl;
+}
+
 // simple test suite for TensorView
 //  - this is meant for performance optimization
 //  - correctness is defined as same result between GPU and CPU
@@ -353,7 +460,19 @@ int wmain()
     MultiplyAndWeightedAddTest<float>(11,10,12);    
     MultiplyAndWeightedAddTest<float>(110,100,120);    
     MultiplyAndWeightedAddTest<float>(1100,1000,1200);    
-    MultiplyAndWeightedAddTest<float>(11000,10000,12000);*/
+    MultiplyAndWeightedAddTest<float>(11000,10000,12000);
+
+    cout<<endl<<"********************CPUSparseMatrix sparse x dense TEST********************"<<endl;
+    for (double density : { 0.0001, 0.001, 0.01, 0.1 })
+        SparseTimesDenseTest<float>(512, 100000, 256, density, 10);
+
+    cout<<endl<<"********************CPUMatrix VectorMax top-K TEST********************"<<endl;
+    for (int m : { 1000, 10000, 100000, 1000000 })
+        for (int topK : { 5, 10, 100 })
+        {
+            VectorMaxTopKTest<float>(m, 1, topK, 10);
+            VectorMaxTopKTest<float>(m, 64, topK, 10);
+        }*/
 
     return 0;
 }
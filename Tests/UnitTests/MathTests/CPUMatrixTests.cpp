@@ -61,6 +61,24 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixConstructorFormatRowMajor, RandomSeedFixture)
     BOOST_CHECK_EQUAL(m(1, 2), 12);
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixSetValueExternalBuffer, RandomSeedFixture)
+{
+    std::array<float, 6> array1 = {1, 2, 3, 4, 5, 6};
+    std::array<float, 4> array2 = {7, 8, 9, 10};
+
+    SMatrix m(2, 2);
+    m.SetValue(2, 3, array1.data(), matrixFlagDontOwnBuffer);
+    BOOST_CHECK(!m.OwnBuffer());
+    BOOST_CHECK_EQUAL(m.Data(), array1.data());
+    BOOST_CHECK_EQUAL(m(1, 2), 6);
+
+    // Pointing to another external buffer must not free the previous one.
+    m.SetValue(2, 2, array2.data(), matrixFlagDontOwnBuffer);
+    BOOST_CHECK_EQUAL(m.Data(), array2.data());
+    BOOST_CHECK_EQUAL(m(1, 1), 10);
+    BOOST_CHECK_EQUAL(array1[5], 6);
+}
+
 BOOST_FIXTURE_TEST_CASE(CPUMatrixAddAndSub, RandomSeedFixture)
 {
     DMatrix m0(2, 3);
@@ -602,6 +620,132 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixNorms, RandomSeedFixture)
     BOOST_CHECK(mResult.IsEqualTo(m2, c_epsilonFloatE4));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixVectorMaxTopK, RandomSeedFixture)
+{
+    // a single tall column, which is split into row ranges when several threads are available;
+    // every value repeats, ties must go to the lower row
+    const int rows = 200000;
+    const int topK = 5;
+    SMatrix m0(rows, 1);
+    for (int i = 0; i < rows; i++)
+        m0(i, 0) = (float) (i % 1000);
+
+    SMatrix maxIndexes;
+    SMatrix maxValues;
+    m0.VectorMax(maxIndexes, maxValues, true, topK);
+    BOOST_CHECK_EQUAL(topK, maxIndexes.GetNumRows());
+    BOOST_CHECK_EQUAL(1, maxIndexes.GetNumCols());
+    for (int k = 0; k < topK; k++)
+    {
+        BOOST_CHECK_EQUAL(999 + 1000 * k, maxIndexes(k, 0));
+        BOOST_CHECK_EQUAL(999, maxValues(k, 0));
+    }
+
+    // several columns, results sorted in descending order
+    float values[] = { 1, 5, 3, 5, 0, 2,
+                       -1, -4, -2, -3, -6, -5 };
+    SMatrix m1(6, 2, values);
+    m1.VectorMax(maxIndexes, maxValues, true, 3);
+    float expectedIndexes[] = { 1, 3, 2,
+                                0, 2, 3 };
+    float expectedValues[] = { 5, 5, 3,
+                               -1, -2, -3 };
+    BOOST_CHECK(maxIndexes.IsEqualTo(SMatrix(3, 2, expectedIndexes)));
+    BOOST_CHECK(maxValues.IsEqualTo(SMatrix(3, 2, expectedValues)));
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUMatrixCTCScore, RandomSeedFixture)
+{
+    // three utterances in two channels: channel 0 holds utterances 0 and 2, channel 1 holds utterance 1
+    const size_t numChannels = 2;
+    const size_t numFrames = 6;
+    const size_t numTokens = 3;
+    const size_t blankTokenId = 2;
+    const std::vector<size_t> uttToChanInd = { 0, 1, 0 };
+    const std::vector<size_t> uttBeginFrame = { 0, 0, 3 };
+    const std::vector<size_t> uttFrameNum = { 3, 6, 3 };
+    const std::vector<std::vector<size_t>> uttLabels = { { 0 }, { 0, 1 }, { 1, 1 } };
+
+    // labels interleaved with blanks, between boundary markers
+    std::vector<size_t> uttPhoneNum;
+    size_t maxPhoneNum = 0;
+    for (const auto& labels : uttLabels)
+    {
+        uttPhoneNum.push_back(2 * labels.size() + 3);
+        maxPhoneNum = std::max(maxPhoneNum, uttPhoneNum.back());
+    }
+    DMatrix phoneSeq(maxPhoneNum, uttLabels.size());
+    DMatrix phoneBound(maxPhoneNum, uttLabels.size());
+    phoneBound.SetValue(0);
+    for (size_t u = 0; u < uttLabels.size(); u++)
+    {
+        phoneSeq(0, u) = (double)SIZE_MAX;
+        for (size_t i = 0; i < uttLabels[u].size(); i++)
+        {
+            phoneSeq(2 * i + 1, u) = (double)blankTokenId;
+            phoneSeq(2 * i + 2, u) = (double)uttLabels[u][i];
+        }
+        phoneSeq(uttPhoneNum[u] - 2, u) = (double)blankTokenId;
+        phoneSeq(uttPhoneNum[u] - 1, u) = (double)SIZE_MAX;
+    }
+
+    // log-posteriors
+    const size_t numCols = numFrames * numChannels;
+    DMatrix prob = DMatrix::RandomUniform(numTokens, numCols, -3, 3, IncrementCounter());
+    for (size_t j = 0; j < numCols; j++)
+    {
+        double sum = 0;
+        for (size_t k = 0; k < numTokens; k++)
+            sum += exp(prob(k, j));
+        double logSum = log(sum);
+        for (size_t k = 0; k < numTokens; k++)
+            prob(k, j) -= logSum;
+    }
+
+    DMatrix alpha(maxPhoneNum, numCols), beta(maxPhoneNum, numCols), ctcScore(numTokens, numCols), totalScore(1, 1);
+    alpha.SetValue(LZERO);
+    beta.SetValue(LZERO);
+    ctcScore.SetValue(LZERO);
+    ctcScore.AssignCTCScore(prob, alpha, beta, phoneSeq, phoneBound, totalScore, uttToChanInd, uttBeginFrame, uttFrameNum, uttPhoneNum,
+                            numChannels, numFrames, blankTokenId, /*delayConstraint=*/ -1, /*isColWise=*/ true);
+
+    // sum the probabilities of all paths that collapse to the labels
+    double expectedTotalScore = 0;
+    for (size_t u = 0; u < uttLabels.size(); u++)
+    {
+        double labelsProbability = 0;
+        std::vector<size_t> path(uttFrameNum[u], 0);
+        for (size_t pathId = 0; pathId < (size_t)pow(numTokens, uttFrameNum[u]); pathId++)
+        {
+            for (size_t t = 0, rest = pathId; t < uttFrameNum[u]; t++, rest /= numTokens)
+                path[t] = rest % numTokens;
+
+            std::vector<size_t> collapsed;
+            double logProbability = 0;
+            for (size_t t = 0; t < uttFrameNum[u]; t++)
+            {
+                if (path[t] != blankTokenId && (t == 0 || path[t] != path[t - 1]))
+                    collapsed.push_back(path[t]);
+                logProbability += prob(path[t], (uttBeginFrame[u] + t) * numChannels + uttToChanInd[u]);
+            }
+            if (collapsed == uttLabels[u])
+                labelsProbability += exp(logProbability);
+        }
+        expectedTotalScore -= log(labelsProbability);
+    }
+    // LogAdd neglects terms below exp(MINLOGEXP) relative to the larger one
+    BOOST_CHECK_CLOSE(expectedTotalScore, totalScore(0, 0), 0.1);
+
+    // the posteriors of each frame sum to one
+    for (size_t j = 0; j < numCols; j++)
+    {
+        double posteriorSum = 0;
+        for (size_t k = 0; k < numTokens; k++)
+            posteriorSum += ctcScore(k, j);
+        BOOST_CHECK_CLOSE(1.0, posteriorSum, 0.1);
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(CPUMatrixSetValues, RandomSeedFixture)
 {
     DMatrix m0(3, 3);
@@ -116,6 +116,82 @@ BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixMultiplyAndAdd, RandomSeedFixture)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixAdjustBlockColumnIds, RandomSeedFixture)
+{
+    const size_t m = 10;
+    const size_t n = 8;
+
+    // blocks for columns 5 and 2, in this order
+    const size_t blockIds[] = { 5, 2 };
+    std::vector<double> values(2 * m);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = (double)(i + 1);
+
+    SparseMatrix sm(MatrixFormat::matrixFormatSparseBlockCol, m, n, 0);
+    sm.RequireSizeAndAllocate(m, n, 2 * m, true, false);
+    sm.SetBlockSize(2);
+    memcpy(sm.BlockIdsLocation(), blockIds, sizeof(blockIds));
+    memcpy(sm.Data(), values.data(), sizeof(double) * values.size());
+
+    DenseMatrix dm(m, n);
+    foreach_coord(row, col, dm)
+        dm(row, col) = sm(row, col);
+
+    // re-layout to the union with columns of another worker, in sorted order
+    const size_t newBlockIds[] = { 0, 2, 5, 7 };
+    sm.AdjustBlockColumnIds(newBlockIds, 4);
+
+    BOOST_CHECK_EQUAL(sm.GetBlockSize(), 4);
+    std::vector<size_t> columnIds;
+    sm.GetBlockColumnIds(columnIds);
+    BOOST_CHECK(columnIds == std::vector<size_t>(newBlockIds, newBlockIds + 4));
+    foreach_coord(row, col, dm)
+        BOOST_CHECK_EQUAL(sm(row, col), dm(row, col));
+
+    // dropping a column that owns a block would lose its values
+    const size_t missingBlockIds[] = { 0, 2, 7 };
+    BOOST_CHECK_THROW(sm.AdjustBlockColumnIds(missingBlockIds, 3), std::logic_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixFSAdagrad, RandomSeedFixture)
+{
+    const size_t m = 10;
+    const size_t n = 8;
+    const double learnRatePerSample = 0.1;
+    const double momentum = 0.9;
+    const double adaWeight = 0.95;
+    const double adaMul = 0.5;
+    const double unitGainFactor = 0.1;
+
+    // gradient in the columns 6 and 1, in this order; the other columns are zero
+    const size_t blockIds[] = { 6, 1 };
+    DenseMatrix dmGradient(m, n);
+    dmGradient.SetValue(0);
+    SparseMatrix smGradient(MatrixFormat::matrixFormatSparseBlockCol, m, n, 0);
+    smGradient.RequireSizeAndAllocate(m, n, 2 * m, true, false);
+    smGradient.SetBlockSize(2);
+    memcpy(smGradient.BlockIdsLocation(), blockIds, sizeof(blockIds));
+    for (size_t block = 0; block < 2; block++)
+        for (size_t row = 0; row < m; row++)
+            dmGradient(row, blockIds[block]) = smGradient.Data()[block * m + row] = 0.1 * (double)(row + 1) - 0.3 * (double)block;
+
+    DenseMatrix dmValues(m, n);
+    dmValues.SetUniformRandomValue(-1, 1, IncrementCounter());
+    DenseMatrix smValues(dmValues);
+    DenseMatrix dmState, smState;
+
+    // Starting from a zero state, the dense update leaves the columns without gradient as they are,
+    // so both must agree. The second step also exercises the smoothed gradients and the momentum.
+    for (size_t step = 0; step < 2; step++)
+    {
+        dmState.FSAdagrad(dmGradient, dmValues, learnRatePerSample, momentum, adaWeight, adaMul, unitGainFactor);
+        smGradient.FSAdagrad(smState, smValues, learnRatePerSample, momentum, adaWeight, adaMul, unitGainFactor);
+
+        BOOST_CHECK(smValues.IsEqualTo(dmValues, c_epsilonFloatE5));
+        BOOST_CHECK(smState.IsEqualTo(dmState, c_epsilonFloatE5));
+    }
+}
+
 BOOST_FIXTURE_TEST_CASE(CPUSparseMatrixDoGatherColumnsOf, RandomSeedFixture)
 {
     const size_t m = 100;
@@ -0,0 +1,202 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include <atomic>
+#include <future>
+#include <boost/filesystem.hpp>
+#include "AsyncCheckpointWriter.h"
+#include "ComputationNetworkBuilder.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace fs = boost::filesystem;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// Writes into a directory of its own, which is removed afterwards.
+struct CheckpointDirectoryFixture
+{
+    CheckpointDirectoryFixture()
+        : m_dir(fs::temp_directory_path() / fs::unique_path("cntk-checkpoint-%%%%-%%%%"))
+    {
+        fs::create_directories(m_dir);
+    }
+
+    ~CheckpointDirectoryFixture()
+    {
+        fs::remove_all(m_dir);
+    }
+
+    wstring FileName(const wstring& name) const
+    {
+        return (m_dir / name).wstring();
+    }
+
+    static void WriteFile(const wstring& fileName, const string& text)
+    {
+        FILE* f = fopenOrDie(fileName, L"wb");
+        fwriteOrDie(text.data(), 1, text.size(), f);
+        fcloseOrDie(f);
+    }
+
+    static string ReadFile(const wstring& fileName)
+    {
+        FILE* f = fopenOrDie(fileName, L"rb");
+        string text;
+        char buffer[256];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+            text.append(buffer, n);
+        fcloseOrDie(f);
+        return text;
+    }
+
+    fs::path m_dir;
+};
+
+// Blocks the writer's jobs until Release() is called.
+class Gate
+{
+public:
+    Gate() : m_future(m_promise.get_future().share()) {}
+    void Pass() const { m_future.wait(); }
+    void Release() { m_promise.set_value(); }
+
+private:
+    promise<void> m_promise;
+    shared_future<void> m_future;
+};
+
+BOOST_FIXTURE_TEST_SUITE(AsyncCheckpointWriterTestSuite, CheckpointDirectoryFixture)
+
+BOOST_AUTO_TEST_CASE(JobsRunInOrder)
+{
+    AsyncCheckpointWriter writer(/*maxPending=*/3);
+    vector<int> done;
+    for (int i = 0; i < 20; i++)
+        writer.Enqueue([&done, i]() { done.push_back(i); });
+    writer.Wait();
+
+    BOOST_REQUIRE_EQUAL(done.size(), (size_t)20);
+    for (int i = 0; i < 20; i++)
+        BOOST_CHECK_EQUAL(done[i], i);
+}
+
+// Enqueue() blocks while maxPending jobs are queued or running, and the time it blocks is a stall.
+BOOST_AUTO_TEST_CASE(EnqueueBlocksAtMaxPending)
+{
+    const size_t maxPending = 2;
+    AsyncCheckpointWriter writer(maxPending);
+    Gate gate;
+    atomic<size_t> numRunning(0), maxRunning(0);
+    auto job = [&]()
+    {
+        maxRunning = max(maxRunning.load(), ++numRunning);
+        gate.Pass();
+        numRunning--;
+    };
+    for (size_t i = 0; i < maxPending; i++)
+        writer.Enqueue(job);
+    BOOST_CHECK_LT(writer.StallSeconds(), 0.1);
+
+    auto blocked = async(launch::async, [&]() { writer.Enqueue(job); });
+    BOOST_CHECK(blocked.wait_for(chrono::milliseconds(200)) == future_status::timeout);
+
+    gate.Release();
+    blocked.get();
+    writer.Wait();
+    BOOST_CHECK_EQUAL(maxRunning.load(), (size_t)1); // one job at a time
+    BOOST_CHECK_GE(writer.StallSeconds(), 0.1);
+}
+
+// An error of a job is rethrown once, by the next Enqueue() or Wait(), and later jobs still run.
+BOOST_AUTO_TEST_CASE(ErrorsAreRethrown)
+{
+    AsyncCheckpointWriter writer(/*maxPending=*/1);
+    writer.Enqueue([]() { RuntimeError("disk full"); });
+    BOOST_CHECK_THROW(writer.Wait(), runtime_error);
+    BOOST_CHECK_NO_THROW(writer.Wait());
+
+    // with maxPending 1, the next Enqueue() waits for the failing job, and does not queue its own
+    bool ran = false;
+    writer.Enqueue([]() { RuntimeError("disk full"); });
+    BOOST_CHECK_THROW(writer.Enqueue([&ran]() { ran = true; }), runtime_error);
+    writer.Wait();
+    BOOST_CHECK(!ran);
+
+    writer.Enqueue([&ran]() { ran = true; });
+    writer.Wait();
+    BOOST_CHECK(ran);
+}
+
+BOOST_AUTO_TEST_CASE(DestructorFinishesPendingJobs)
+{
+    atomic<int> numDone(0);
+    {
+        AsyncCheckpointWriter writer(/*maxPending=*/5);
+        for (int i = 0; i < 5; i++)
+            writer.Enqueue([&numDone]() { this_thread::sleep_for(chrono::milliseconds(10)); numDone++; });
+        writer.Enqueue([]() { RuntimeError("ignored"); });
+    }
+    BOOST_CHECK_EQUAL(numDone.load(), 5);
+}
+
+// CommitFile() moves the temporary file into place, replacing an older checkpoint.
+BOOST_AUTO_TEST_CASE(CommitFileReplacesCheckpoint)
+{
+    const wstring fileName = FileName(L"model.dnn");
+    const wstring tmpFileName = fileName + L".tmp";
+    WriteFile(fileName, "old");
+    WriteFile(tmpFileName, "new");
+
+    AsyncCheckpointWriter::CommitFile(tmpFileName, fileName);
+    BOOST_CHECK(!fexists(tmpFileName));
+    BOOST_CHECK_EQUAL(ReadFile(fileName), "new");
+
+    BOOST_CHECK_THROW(AsyncCheckpointWriter::CommitFile(tmpFileName, fileName), runtime_error);
+    BOOST_CHECK_EQUAL(ReadFile(fileName), "new");
+}
+
+// The snapshot keeps the values it was taken with, in CPU memory, while the network goes on changing.
+BOOST_AUTO_TEST_CASE(SnapshotIsSavedWhileTrainingGoesOn)
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto features = builder.CreateInputNode(L"features", 3);
+    auto W = builder.CreateLearnableParameter(L"W", 2, 3);
+    net->RandomInitLearnableParameters(W, /*uniformInit=*/true, /*randomSeed=*/1, /*initValueScale=*/1);
+    auto output = builder.Times(W, features, 1, L"output");
+    net->AddToNodeGroup(L"output", output);
+    net->CompileNetwork();
+
+    const Matrix<float> savedW = W->Value().DeepClone();
+    auto snapshot = net->CreateSnapshotForSave();
+    W->Value().SetValue(0);
+
+    auto snapshotW = dynamic_pointer_cast<LearnableParameter<float>>(snapshot->GetNodeFromName(L"W"));
+    BOOST_REQUIRE(snapshotW);
+    BOOST_CHECK_EQUAL(snapshotW->Value().GetDeviceId(), CPUDEVICE);
+    BOOST_CHECK(!static_pointer_cast<ComputationNode<float>>(snapshotW)->GradientPtr());
+    BOOST_CHECK(snapshot->GetNodeFromName(L"output")->GetInputs()[0] == snapshotW);
+
+    const wstring fileName = FileName(L"model.dnn");
+    AsyncCheckpointWriter writer;
+    writer.Enqueue([=]()
+    {
+        snapshot->SaveToFileImpl(fileName + L".tmp", FileOptions::fileOptionsBinary);
+        AsyncCheckpointWriter::CommitFile(fileName + L".tmp", fileName);
+    });
+    writer.Wait();
+
+    auto loaded = ComputationNetwork::CreateFromFile<float>(CPUDEVICE, fileName);
+    auto loadedW = dynamic_pointer_cast<LearnableParameter<float>>(loaded->GetNodeFromName(L"W"));
+    BOOST_REQUIRE(loadedW);
+    BOOST_CHECK(loadedW->Value().IsEqualTo(savedW));
+    BOOST_CHECK_EQUAL(loaded->OutputNodes().size(), (size_t)1);
+    BOOST_CHECK(loaded->OutputNodes()[0]->NodeName() == L"output");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
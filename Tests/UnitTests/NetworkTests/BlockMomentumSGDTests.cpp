@@ -0,0 +1,321 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "InputAndParamNodes.h"
+#include "../../../Source/SGDLib/SGD.h"
+#include "../../../Source/SGDLib/BlockMomentumSGD.h"
+#include "TestHelpers.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// These tests run with any number of workers. The distributed end-to-end test runs them under mpiexec with two.
+
+static const size_t c_numRows = 3;
+static const size_t c_numCols = 2;
+static const size_t c_blockSize = 1024;
+static const double c_blockMomentumAsTimeConstant = 2048;
+static const double c_blockLearningRate = 1.0;
+
+static MPIWrapperPtr GetMPI()
+{
+    auto mpi = MPIWrapper::GetInstance();
+    if (!mpi)
+        mpi = MPIWrapper::GetInstance(/*create=*/true);
+    return mpi;
+}
+
+// Local progress of a worker during a block. It does not depend on the model, so the block gradients
+// are the same whether or not the block updates arrive late.
+static vector<float> LocalStep(size_t rank, size_t epoch, size_t block)
+{
+    vector<float> step(c_numRows * c_numCols);
+    for (size_t i = 0; i < step.size(); i++)
+        step[i] = 0.01f * (float)((i + 3 * block + 5 * epoch + 2 * rank) % 7) - 0.03f;
+    return step;
+}
+
+static void AddLocalStep(LearnableParameter<float>& parameter, size_t rank, size_t epoch, size_t block)
+{
+    auto step = LocalStep(rank, epoch, block);
+    Matrix<float> delta(c_numRows, c_numCols, step.data(), CPUDEVICE);
+    parameter.Value() += delta;
+}
+
+static vector<float> ValueOf(LearnableParameter<float>& parameter)
+{
+    unique_ptr<float[]> data(parameter.Value().CopyToArray());
+    return vector<float>(data.get(), data.get() + c_numRows * c_numCols);
+}
+
+static void SetValue(LearnableParameter<float>& parameter, vector<float> value)
+{
+    parameter.Value().SetValue(c_numRows, c_numCols, CPUDEVICE, value.data());
+}
+
+static const vector<float> c_initialModel{ 0.5f, -0.25f, 1.0f, 0.0f, -1.5f, 0.75f };
+
+// A parameter that starts out as the initial model on the main node, and as something else on the others,
+// which BlockMomentumSGD must replace by the model of the main node.
+static shared_ptr<LearnableParameter<float>> CreateParameter(const MPIWrapperPtr& mpi)
+{
+    auto parameter = make_shared<LearnableParameter<float>>(CPUDEVICE, L"W", TensorShape(c_numRows, c_numCols));
+    auto initial = c_initialModel;
+    if (!mpi->IsMainNode())
+        for (auto& x : initial)
+            x += 1.0f + (float)mpi->CurrentNodeRank();
+    SetValue(*parameter, initial);
+    return parameter;
+}
+
+static list<Matrix<float>> CreateSmoothedGradients()
+{
+    list<Matrix<float>> smoothedGradients;
+    smoothedGradients.emplace_back(c_numRows, c_numCols, CPUDEVICE);
+    smoothedGradients.back().SetValue(0);
+    return smoothedGradients;
+}
+
+static shared_ptr<BlockMomentumSGD<float>> CreateBlockMomentumSGD(const MPIWrapperPtr& mpi, bool overlapCommunication, bool useNesterovMomentum)
+{
+    return make_shared<BlockMomentumSGD<float>>(mpi, /*reportFreq=*/0, CPUDEVICE, useNesterovMomentum, /*resetSGDM=*/true,
+                                                c_blockLearningRate, c_blockMomentumAsTimeConstant, c_blockSize, overlapCommunication);
+}
+
+// Runs epochs 'firstEpoch' .. 'endEpoch' - 1 of 'numBlocks' full blocks plus a partial one. Returns the model after every sync.
+static vector<vector<float>> RunEpochs(BlockMomentumSGD<float>& blockMomentum, const shared_ptr<LearnableParameter<float>>& parameter, size_t rank,
+                                       size_t firstEpoch, size_t endEpoch, size_t numBlocks)
+{
+    list<ComputationNodeBasePtr> learnableNodes{ parameter };
+    auto smoothedGradients = CreateSmoothedGradients();
+
+    vector<vector<float>> models;
+    for (size_t epoch = firstEpoch; epoch < endEpoch; epoch++)
+    {
+        blockMomentum.OnEpochStart(learnableNodes);
+        for (size_t block = 0; block < numBlocks; block++)
+        {
+            AddLocalStep(*parameter, rank, epoch, block);
+            BOOST_REQUIRE(blockMomentum.OnArrivingAtSyncPoint(learnableNodes, smoothedGradients, c_blockSize));
+            models.push_back(ValueOf(*parameter));
+        }
+        AddLocalStep(*parameter, rank, epoch, numBlocks);
+        blockMomentum.OnEpochEnd(learnableNodes, smoothedGradients, c_blockSize / 2);
+        models.push_back(ValueOf(*parameter));
+    }
+    return models;
+}
+
+static vector<vector<float>> TrainWithBlockMomentum(bool overlapCommunication, bool useNesterovMomentum, size_t numEpochs, size_t numBlocks)
+{
+    auto mpi = GetMPI();
+    auto parameter = CreateParameter(mpi);
+    auto blockMomentum = CreateBlockMomentumSGD(mpi, overlapCommunication, useNesterovMomentum);
+    return RunEpochs(*blockMomentum, parameter, mpi->CurrentNodeRank(), 0, numEpochs, numBlocks);
+}
+
+// The block momentum filter applied to the block gradients averaged over all workers, computed directly.
+static vector<float> ReferenceModel(bool useNesterovMomentum, size_t numEpochs, size_t numBlocks)
+{
+    size_t numWorkers = GetMPI()->NumNodesInUse();
+    double blockMomentum = BlockMomentumSGD<float>::TimeConstant2Momentum(c_blockMomentumAsTimeConstant, c_blockSize);
+    vector<double> globalModel(c_initialModel.begin(), c_initialModel.end());
+    vector<double> blockUpdate(globalModel.size(), 0);
+    for (size_t epoch = 0; epoch < numEpochs; epoch++)
+    {
+        for (size_t block = 0; block <= numBlocks; block++)
+        {
+            vector<double> averageStep(globalModel.size(), 0);
+            for (size_t rank = 0; rank < numWorkers; rank++)
+            {
+                auto step = LocalStep(rank, epoch, block);
+                for (size_t i = 0; i < globalModel.size(); i++)
+                    averageStep[i] += step[i] / numWorkers;
+            }
+            for (size_t i = 0; i < globalModel.size(); i++)
+            {
+                blockUpdate[i] = blockMomentum * blockUpdate[i] - c_blockLearningRate * averageStep[i];
+                globalModel[i] -= blockUpdate[i];
+            }
+        }
+    }
+    vector<float> result(globalModel.size());
+    for (size_t i = 0; i < globalModel.size(); i++)
+        result[i] = (float)(globalModel[i] - (useNesterovMomentum ? blockMomentum * blockUpdate[i] : 0));
+    return result;
+}
+
+BOOST_AUTO_TEST_SUITE(BlockMomentumSGDTestSuite)
+
+BOOST_AUTO_TEST_CASE(BlockMomentumSGDOverlapMatchesSynchronous)
+{
+    const size_t numEpochs = 2;
+    const size_t numBlocks = 5;
+    const float c_threshold = 1e-5f;
+
+    for (bool useNesterovMomentum : { false, true })
+    {
+        auto synchronous = TrainWithBlockMomentum(/*overlapCommunication=*/false, useNesterovMomentum, numEpochs, numBlocks);
+        auto overlapped = TrainWithBlockMomentum(/*overlapCommunication=*/true, useNesterovMomentum, numEpochs, numBlocks);
+        BOOST_REQUIRE_EQUAL(synchronous.size(), overlapped.size());
+
+        // During an epoch, the overlapped updates are applied one block late, so the models must differ...
+        BOOST_CHECK(!AreEqual(synchronous[1].data(), overlapped[1].data(), synchronous[1].size(), c_threshold));
+
+        // ...but at the end of each epoch, both have applied the same block updates in the same order.
+        for (size_t epoch = 0; epoch < numEpochs; epoch++)
+        {
+            auto& expected = synchronous[(epoch + 1) * (numBlocks + 1) - 1];
+            auto& actual = overlapped[(epoch + 1) * (numBlocks + 1) - 1];
+            BOOST_CHECK(AreEqual(expected.data(), actual.data(), expected.size(), c_threshold));
+        }
+
+        auto reference = ReferenceModel(useNesterovMomentum, numEpochs, numBlocks);
+        BOOST_CHECK(AreEqual(reference.data(), synchronous.back().data(), reference.size(), c_threshold));
+        BOOST_CHECK(AreEqual(reference.data(), overlapped.back().data(), reference.size(), c_threshold));
+    }
+}
+
+// Each worker minimizes a quadratic loss of its own. At the end of each epoch, all workers hold the same model,
+// which converges to the optimum of the average loss, also when the block updates arrive one block late.
+BOOST_AUTO_TEST_CASE(BlockMomentumSGDConvergesToOptimumOfAverageLoss)
+{
+    const size_t numEpochs = 8;
+    const size_t numBlocks = 10;
+    const size_t numLocalSteps = 10;
+    const float learningRate = 0.1f;
+
+    auto mpi = GetMPI();
+    size_t numWorkers = mpi->NumNodesInUse();
+    auto targetOf = [](size_t rank)
+    {
+        vector<float> target(c_numRows * c_numCols);
+        for (size_t i = 0; i < target.size(); i++)
+            target[i] = 1.0f + 2.0f * (float)rank - 0.5f * (float)i;
+        return target;
+    };
+    vector<float> optimum(c_numRows * c_numCols, 0);
+    for (size_t rank = 0; rank < numWorkers; rank++)
+    {
+        auto target = targetOf(rank);
+        for (size_t i = 0; i < optimum.size(); i++)
+            optimum[i] += target[i] / numWorkers;
+    }
+    auto target = targetOf(mpi->CurrentNodeRank());
+
+    for (bool overlapCommunication : { false, true })
+    {
+        for (bool useNesterovMomentum : { false, true })
+        {
+            auto parameter = CreateParameter(mpi);
+            auto blockMomentum = CreateBlockMomentumSGD(mpi, overlapCommunication, useNesterovMomentum);
+            list<ComputationNodeBasePtr> learnableNodes{ parameter };
+            auto smoothedGradients = CreateSmoothedGradients();
+
+            for (size_t epoch = 0; epoch < numEpochs; epoch++)
+            {
+                blockMomentum->OnEpochStart(learnableNodes);
+                for (size_t block = 0; block <= numBlocks; block++)
+                {
+                    auto model = ValueOf(*parameter);
+                    for (size_t step = 0; step < numLocalSteps; step++)
+                        for (size_t i = 0; i < model.size(); i++)
+                            model[i] -= learningRate * (model[i] - target[i]);
+                    SetValue(*parameter, model);
+
+                    if (block < numBlocks)
+                        BOOST_REQUIRE(blockMomentum->OnArrivingAtSyncPoint(learnableNodes, smoothedGradients, c_blockSize));
+                    else
+                        blockMomentum->OnEpochEnd(learnableNodes, smoothedGradients, c_blockSize);
+                }
+            }
+
+            auto model = ValueOf(*parameter);
+            BOOST_CHECK(AreEqual(optimum.data(), model.data(), model.size(), 1e-2f));
+        }
+    }
+}
+
+// The throughput statistics count the samples of all workers.
+BOOST_AUTO_TEST_CASE(BlockMomentumSGDCountsSamplesOfAllWorkers)
+{
+    auto mpi = GetMPI();
+    size_t numWorkers = mpi->NumNodesInUse();
+    auto parameter = CreateParameter(mpi);
+    auto blockMomentum = CreateBlockMomentumSGD(mpi, /*overlapCommunication=*/false, /*useNesterovMomentum=*/false);
+    list<ComputationNodeBasePtr> learnableNodes{ parameter };
+    auto smoothedGradients = CreateSmoothedGradients();
+
+    blockMomentum->OnEpochStart(learnableNodes);
+    size_t totalSamplesProcessed = 0;
+    float secondsOnCommunication = -1;
+    blockMomentum->ModelAggregationProcessing(100 * (mpi->CurrentNodeRank() + 1), learnableNodes, smoothedGradients, totalSamplesProcessed, secondsOnCommunication);
+    BOOST_CHECK_EQUAL(totalSamplesProcessed, 100 * numWorkers * (numWorkers + 1) / 2);
+    BOOST_CHECK_GE(secondsOnCommunication, 0);
+    blockMomentum->OnEpochEnd(learnableNodes, smoothedGradients, 0);
+}
+
+// A checkpoint taken at the end of an epoch holds the global model and the block momentum, so that training
+// continues as if it had not been interrupted.
+BOOST_AUTO_TEST_CASE(BlockMomentumSGDCheckpointRoundTrip)
+{
+    const size_t numBlocks = 3;
+    const float c_threshold = 1e-6f;
+    auto mpi = GetMPI();
+    size_t rank = mpi->CurrentNodeRank();
+    const wstring fileName = L"BlockMomentumSGD.checkpoint." + to_wstring(rank);
+
+    for (bool useNesterovMomentum : { false, true })
+    {
+        auto parameter = CreateParameter(mpi);
+        auto blockMomentum = CreateBlockMomentumSGD(mpi, /*overlapCommunication=*/true, useNesterovMomentum);
+        RunEpochs(*blockMomentum, parameter, rank, 0, 1, numBlocks);
+        {
+            File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+            blockMomentum->SaveToCheckPoint(fstream);
+        }
+
+        auto restoredParameter = CreateParameter(mpi);
+        SetValue(*restoredParameter, ValueOf(*parameter));
+        auto restoredBlockMomentum = CreateBlockMomentumSGD(mpi, /*overlapCommunication=*/true, useNesterovMomentum);
+        {
+            File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+            restoredBlockMomentum->LoadFromCheckPoint(fstream);
+        }
+
+        auto freshParameter = CreateParameter(mpi);
+        SetValue(*freshParameter, ValueOf(*parameter));
+        auto freshBlockMomentum = CreateBlockMomentumSGD(mpi, /*overlapCommunication=*/true, useNesterovMomentum);
+
+        auto expected = RunEpochs(*blockMomentum, parameter, rank, 1, 3, numBlocks);
+        auto restored = RunEpochs(*restoredBlockMomentum, restoredParameter, rank, 1, 3, numBlocks);
+        auto fresh = RunEpochs(*freshBlockMomentum, freshParameter, rank, 1, 3, numBlocks);
+        BOOST_REQUIRE_EQUAL(expected.size(), restored.size());
+        for (size_t i = 0; i < expected.size(); i++)
+            BOOST_CHECK(AreEqual(expected[i].data(), restored[i].data(), expected[i].size(), c_threshold));
+        // without the block momentum of the checkpoint, training takes another course
+        BOOST_CHECK(!AreEqual(expected.back().data(), fresh.back().data(), expected.back().size(), c_threshold));
+    }
+
+    // an overlapped block aggregation in flight cannot be checkpointed
+    auto parameter = CreateParameter(mpi);
+    auto blockMomentum = CreateBlockMomentumSGD(mpi, /*overlapCommunication=*/true, /*useNesterovMomentum=*/false);
+    list<ComputationNodeBasePtr> learnableNodes{ parameter };
+    auto smoothedGradients = CreateSmoothedGradients();
+    blockMomentum->OnEpochStart(learnableNodes);
+    AddLocalStep(*parameter, rank, 0, 0);
+    BOOST_REQUIRE(blockMomentum->OnArrivingAtSyncPoint(learnableNodes, smoothedGradients, c_blockSize));
+    {
+        File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+        BOOST_CHECK_THROW(blockMomentum->SaveToCheckPoint(fstream), logic_error);
+    }
+    blockMomentum->OnEpochEnd(learnableNodes, smoothedGradients, 0);
+
+    _wunlink(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -0,0 +1,153 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include <future>
+#include <boost/filesystem.hpp>
+#include "ComputationNetworkBuilder.h"
+#include "ConcurrentValidation.h"
+#include "SGD.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace fs = boost::filesystem;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+static const size_t c_numElements = 2 * 3;
+
+// 'W * features' on the CPU, saved into a directory of its own, which is removed afterwards.
+struct ConcurrentValidationFixture
+{
+    ConcurrentValidationFixture()
+        : m_dir(fs::temp_directory_path() / fs::unique_path("cntk-concurrentcv-%%%%-%%%%")),
+          m_net(make_shared<ComputationNetwork>(CPUDEVICE))
+    {
+        fs::create_directories(m_dir);
+
+        ComputationNetworkBuilder<float> builder(*m_net);
+        auto features = builder.CreateInputNode(L"features", 3);
+        m_W = builder.CreateLearnableParameter(L"W", 2, 3);
+        m_W->Value().SetValue(1);
+        auto output = builder.Times(m_W, features, 1, L"output");
+        m_net->AddToNodeGroup(L"output", output);
+        m_net->CompileNetwork();
+        m_net->Save(ModelFileName());
+    }
+
+    ~ConcurrentValidationFixture()
+    {
+        fs::remove_all(m_dir);
+    }
+
+    wstring ModelFileName() const
+    {
+        return (m_dir / L"model.dnn").wstring();
+    }
+
+    // The "validation" sums up the validated model's W.
+    static vector<EpochCriterion> SumOfW(const ComputationNetworkPtr& cvNet)
+    {
+        auto W = dynamic_pointer_cast<ComputationNode<float>>(cvNet->GetNodeFromName(L"W"));
+        BOOST_REQUIRE(W);
+        return vector<EpochCriterion>{ EpochCriterion(W->Value().SumOfElements(), 1) };
+    }
+
+    fs::path m_dir;
+    ComputationNetworkPtr m_net;
+    shared_ptr<ComputationNode<float>> m_W;
+};
+
+BOOST_FIXTURE_TEST_SUITE(ConcurrentValidationTestSuite, ConcurrentValidationFixture)
+
+// The model is copied when the validation starts, into CPU memory, and training may change it right away.
+BOOST_AUTO_TEST_CASE(ValidatesSnapshotTakenAtStart)
+{
+    ConcurrentValidation<float> validation(ModelFileName(), /*numCPUThreads=*/0);
+    BOOST_CHECK(validation.Net() != m_net);
+    auto cvW = dynamic_pointer_cast<ComputationNode<float>>(validation.Net()->GetNodeFromName(L"W"));
+    BOOST_REQUIRE(cvW);
+    BOOST_CHECK_EQUAL(cvW->Value().GetDeviceId(), CPUDEVICE);
+
+    m_W->Value().SetValue(2);
+    promise<void> trained;
+    auto trainedFuture = trained.get_future().share();
+    validation.Start(m_net, 0, [trainedFuture](const ComputationNetworkPtr& cvNet)
+    {
+        trainedFuture.wait(); // validate while the next epoch trains
+        return SumOfW(cvNet);
+    });
+    BOOST_CHECK(validation.IsPending());
+    m_W->Value().SetValue(3);
+    trained.set_value();
+
+    int epoch = -1;
+    auto scores = validation.Finish(epoch);
+    BOOST_CHECK(!validation.IsPending());
+    BOOST_CHECK_EQUAL(epoch, 0);
+    BOOST_REQUIRE_EQUAL(scores.size(), (size_t)1);
+    BOOST_CHECK_EQUAL(scores[0].Average(), 2.0 * c_numElements);
+    BOOST_CHECK_EQUAL(cvW->Value().GetDeviceId(), CPUDEVICE);
+}
+
+// As in SGD: the starting model is validated while epoch 0 trains, and the result of epoch i arrives at the end of epoch i + 1.
+BOOST_AUTO_TEST_CASE(ResultsLagOneEpoch)
+{
+    const int numEpochs = 4;
+    ConcurrentValidation<float> validation(ModelFileName(), /*numCPUThreads=*/1);
+    m_W->Value().SetValue(-1);
+    validation.Start(m_net, -1, SumOfW);
+    for (int i = 0; i < numEpochs; i++)
+    {
+        m_W->Value().SetValue((float)i); // train epoch i
+
+        int epoch;
+        auto scores = validation.Finish(epoch);
+        BOOST_CHECK_EQUAL(epoch, i - 1);
+        BOOST_CHECK_EQUAL(scores[0].Average(), (double)(i - 1) * c_numElements);
+
+        validation.Start(m_net, i, SumOfW);
+    }
+
+    int epoch;
+    auto scores = validation.Finish(epoch);
+    BOOST_CHECK_EQUAL(epoch, numEpochs - 1);
+    BOOST_CHECK_EQUAL(scores[0].Average(), (double)(numEpochs - 1) * c_numElements);
+}
+
+BOOST_AUTO_TEST_CASE(ErrorsAreRethrownByFinish)
+{
+    ConcurrentValidation<float> validation(ModelFileName(), /*numCPUThreads=*/0);
+    int epoch;
+    BOOST_CHECK_THROW(validation.Finish(epoch), logic_error);
+
+    validation.Start(m_net, 0, [](const ComputationNetworkPtr&) -> vector<EpochCriterion> { RuntimeError("reader failed"); });
+    BOOST_CHECK_THROW(validation.Start(m_net, 1, SumOfW), logic_error);
+    BOOST_CHECK_THROW(validation.Finish(epoch), runtime_error);
+
+    // the next validation runs as usual
+    validation.Start(m_net, 1, SumOfW);
+    BOOST_CHECK_EQUAL(validation.Finish(epoch)[0].Average(), 1.0 * c_numElements);
+}
+
+// With adjustAfterEpoch, a rollback would load the model that concurrentCV has just judged worse, so it is refused.
+BOOST_AUTO_TEST_CASE(RollbackIsRejected)
+{
+    auto createSGD = [this](const string& autoAdjust)
+    {
+        ConfigParameters config;
+        config.Parse("modelPath=" + (m_dir / "sgd" / "model.dnn").string() + ";learningRatesPerSample=0.1;concurrentCV=true;AutoAdjust=[" + autoAdjust + "]");
+        SGD<float> sgd(config);
+    };
+
+    BOOST_CHECK_THROW(createSGD("autoAdjustLR=adjustAfterEpoch"), invalid_argument);
+    BOOST_CHECK_THROW(createSGD("autoAdjustLR=adjustAfterEpoch;loadBestModel=true"), invalid_argument);
+
+    // the learning rate may follow the validation set one epoch late, or it may not be adjusted
+    BOOST_CHECK_NO_THROW(createSGD("autoAdjustLR=adjustAfterEpoch;loadBestModel=false"));
+    BOOST_CHECK_NO_THROW(createSGD("autoAdjustLR=none"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -0,0 +1,58 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "../../../Source/SGDLib/DataReaderHelpers.h"
+#include "TestHelpers.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+BOOST_AUTO_TEST_SUITE(DataReaderHelpersTestSuite)
+
+// An input filled by a reader with 'zeroCopyInputs' points to the reader's buffer and cannot be resized;
+// decimation must give it its own storage and leave the reader's buffer alone.
+BOOST_AUTO_TEST_CASE(DecimateMinibatchInPlaceExternalBuffer)
+{
+    const size_t numRows = 2;
+    const size_t numSequences = 4;
+    const size_t numTimeSteps = 3;
+    vector<float> buffer(numRows * numSequences * numTimeSteps);
+    for (size_t i = 0; i < buffer.size(); i++)
+        buffer[i] = (float)i;
+    const auto original = buffer;
+
+    auto matrix = make_shared<Matrix<float>>(CPUDEVICE);
+    matrix->SetValue(numRows, numSequences * numTimeSteps, CPUDEVICE, buffer.data(), matrixFlagDontOwnBuffer);
+    BOOST_REQUIRE(!matrix->OwnBuffer());
+
+    auto layout = make_shared<MBLayout>(numSequences, numTimeSteps, L"X");
+    for (size_t s = 0; s < numSequences; s++)
+        layout->AddSequence(s, s, 0, numTimeSteps);
+
+    StreamMinibatchInputs mb;
+    mb.AddInput(L"features", matrix, layout, TensorShape(numRows));
+
+    // The second of two workers gets the parallel sequences 2 and 3.
+    auto selected = DataReaderHelpers::DecimateMinibatchInPlace<float>(mb, 2, 1, layout);
+    BOOST_CHECK_EQUAL(selected.first, (size_t)2);
+    BOOST_CHECK_EQUAL(selected.second, numSequences);
+
+    BOOST_CHECK(matrix->OwnBuffer());
+    BOOST_REQUIRE_EQUAL(matrix->GetNumRows(), numRows);
+    BOOST_REQUIRE_EQUAL(matrix->GetNumCols(), 2 * numTimeSteps);
+    BOOST_CHECK_EQUAL(layout->GetNumParallelSequences(), (size_t)2);
+
+    for (size_t t = 0; t < numTimeSteps; t++)
+        for (size_t s = 0; s < 2; s++)
+            for (size_t r = 0; r < numRows; r++)
+                BOOST_CHECK_EQUAL((*matrix)(r, t * 2 + s), original[(t * numSequences + s + 2) * numRows + r]);
+
+    BOOST_CHECK(buffer == original);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -4,10 +4,43 @@
 //
 #include "stdafx.h"
 #include "EvaluationNodes.h"
+#include <random>
 
 using namespace Microsoft::MSR::CNTK;
 namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
 
+// Number of insertions, deletions and substitutions of the minimum-cost alignment, computed on the full grid.
+// Ties are broken as substitution, then deletion, then insertion.
+static float ReferenceNumErrors(const vector<int>& first, const vector<int>& second, float subPen, float delPen, float insPen)
+{
+    struct Cell { float cost, ins, del, sub; };
+    vector<vector<Cell>> grid(first.size() + 1, vector<Cell>(second.size() + 1, Cell{ 0, 0, 0, 0 }));
+    for (size_t i = 0; i <= first.size(); i++)
+        grid[i][0] = Cell{ i * delPen, 0, (float)i, 0 };
+    for (size_t j = 0; j <= second.size(); j++)
+        grid[0][j] = Cell{ j * insPen, (float)j, 0, 0 };
+    for (size_t i = 1; i <= first.size(); i++)
+    {
+        for (size_t j = 1; j <= second.size(); j++)
+        {
+            const Cell& diag = grid[i - 1][j - 1];
+            const Cell& up = grid[i - 1][j];
+            const Cell& left = grid[i][j - 1];
+            float sub = diag.cost + subPen, del = up.cost + delPen, ins = left.cost + insPen;
+            if (first[i - 1] == second[j - 1])
+                grid[i][j] = diag;
+            else if (sub <= del && sub <= ins)
+                grid[i][j] = Cell{ sub, diag.ins, diag.del, diag.sub + 1 };
+            else if (del < ins)
+                grid[i][j] = Cell{ del, up.ins, up.del + 1, up.sub };
+            else
+                grid[i][j] = Cell{ ins, left.ins + 1, left.del, left.sub };
+        }
+    }
+    const Cell& last = grid[first.size()][second.size()];
+    return last.ins + last.del + last.sub;
+}
+
 BOOST_AUTO_TEST_SUITE(EditDistanceTests)
 
 BOOST_AUTO_TEST_CASE(ComputeEditDistanceErrorTest)
@@ -44,6 +77,62 @@ BOOST_AUTO_TEST_CASE(ComputeEditDistanceErrorTest)
     assert((int)ed == 1);
 }
 
+BOOST_AUTO_TEST_CASE(ComputeEditDistanceErrorParallelSequencesTest)
+{
+    // parallel sequences of different lengths, followed by gaps
+    const size_t numParallelSequences = 3;
+    const size_t numTimeSteps = 40;
+    const vector<size_t> sequenceLengths = { 40, 23, 31 };
+    const float subPen = 1.0f, delPen = 0.5f, insPen = 2.0f;
+
+    MBLayoutPtr pMBLayout = make_shared<MBLayout>(numParallelSequences, numTimeSteps, L"X");
+    for (size_t s = 0; s < numParallelSequences; s++)
+    {
+        pMBLayout->AddSequence(s, s, 0, sequenceLengths[s]);
+        if (sequenceLengths[s] < numTimeSteps)
+            pMBLayout->AddGap(s, sequenceLengths[s], numTimeSteps);
+    }
+
+    Matrix<float> firstSeq(CPUDEVICE);
+    Matrix<float> secondSeq(CPUDEVICE);
+    firstSeq.Resize(1, numParallelSequences * numTimeSteps);
+    secondSeq.Resize(1, numParallelSequences * numTimeSteps);
+    std::mt19937 rng(7);
+    for (size_t j = 0; j < numParallelSequences * numTimeSteps; j++)
+    {
+        firstSeq(0, j) = (float)(rng() % 4);
+        secondSeq(0, j) = rng() % 3 == 0 ? (float)(rng() % 4) : firstSeq(0, j);
+    }
+
+    unique_ptr<EditDistanceErrorNode<float>> pEDNode(new EditDistanceErrorNode<float>(-1, L"ednode"));
+    for (bool squashInputs : { false, true })
+    {
+        vector<size_t> tokensToIgnore = { 3 };
+        float expectedErrors = 0;
+        size_t expectedSamples = 0, totalFrames = 0;
+        for (size_t s = 0; s < numParallelSequences; s++)
+        {
+            vector<int> first, second;
+            for (const auto* seq : { &firstSeq, &secondSeq })
+            {
+                vector<int>& samples = seq == &firstSeq ? first : second;
+                for (size_t t = 0; t < sequenceLengths[s]; t++)
+                {
+                    int sample = (int)(*seq)(0, t * numParallelSequences + s);
+                    if ((!squashInputs || t == 0 || sample != (int)(*seq)(0, (t - 1) * numParallelSequences + s)) && sample != 3)
+                        samples.push_back(sample);
+                }
+            }
+            expectedErrors += ReferenceNumErrors(first, second, subPen, delPen, insPen);
+            expectedSamples += first.size();
+            totalFrames += sequenceLengths[s];
+        }
+
+        float ed = pEDNode->ComputeEditDistanceError(firstSeq, secondSeq, pMBLayout, subPen, delPen, insPen, squashInputs, tokensToIgnore);
+        BOOST_CHECK_EQUAL(ed, expectedErrors * totalFrames / expectedSamples);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
\ No newline at end of file
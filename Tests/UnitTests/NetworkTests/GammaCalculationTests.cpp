@@ -0,0 +1,236 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include <fstream>
+#include <random>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "Common/NetworkTestHelper.h"
+#include "gammacalculation.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+typedef std::shared_ptr<const msra::dbn::latticepair> LatticePtr;
+
+// The lattices of the lattice reader tests (see CompressedLatticeArchiveTests), which _test_lattice() of Scripts/lat2cla.py
+// generates over the 3-state units of state.list, with the symbol list and the HMMs they refer to.
+struct GammaCalculationFixture : DataFixture
+{
+    GammaCalculationFixture()
+        : DataFixture("/../ReaderTests/Data/HTKDeserializers")
+    {
+#ifdef _OPENMP
+        m_numThreads = omp_get_max_threads();
+#endif
+        m_hset.loadfromfile(L"model.overalltying", L"state.list", L"model.transprob");
+        msra::dbn::latticesource source(make_pair(vector<wstring>{ L"lattices.toc" }, vector<wstring>{ L"lattices.toc" }), m_hset.getsymmap(), L"");
+
+        ifstream toc("lattices.toc");
+        string line;
+        while (getline(toc, line))
+        {
+            if (line.empty())
+                continue;
+            LatticePtr lattice;
+            source.getlattices(msra::strfun::utf16(line.substr(0, line.find('='))), lattice, SIZE_MAX);
+            m_lattices.push_back(lattice);
+        }
+        BOOST_REQUIRE_GE(m_lattices.size(), (size_t)4);
+
+        // random log-likelihoods and reference senones per utterance
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> logLL(-5, 0);
+        for (const auto& lattice : m_lattices)
+        {
+            vector<float> values(m_hset.getnumsenone() * lattice->getnumframes());
+            for (auto& value : values)
+                value = logLL(rng);
+            m_logLLs.push_back(values);
+            for (size_t t = 0; t < lattice->getnumframes(); t++)
+                m_uids.push_back(rng() % m_hset.getnumsenone());
+        }
+    }
+
+    ~GammaCalculationFixture()
+    {
+        SetNumThreads(m_numThreads);
+    }
+
+    // Runs calgammaformb() on the utterances u (in this order), laid out by the caller in logLLs.
+    float CalculateGammas(const vector<size_t>& u, const Matrix<float>& logLLs, size_t numParallelSequences, MBLayoutPtr layout,
+                          vector<size_t> extrauttmap, Matrix<float>& gammas)
+    {
+        msra::lattices::GammaCalculation<float> calculator;
+        calculator.init(m_hset, CPUDEVICE);
+        calculator.SetGammarCalculationParams(msra::lattices::SeqGammarCalParam());
+
+        vector<LatticePtr> lattices;
+        vector<size_t> uids;
+        for (auto i : u)
+        {
+            lattices.push_back(m_lattices[i]);
+            uids.insert(uids.end(), m_uids.begin() + FirstFrame(i), m_uids.begin() + FirstFrame(i) + NumFrames(i));
+        }
+        vector<size_t> boundaries(uids.size());
+
+        Matrix<float> objective(1, 1, CPUDEVICE);
+        Matrix<float> labels(CPUDEVICE);
+        gammas.Resize(logLLs.GetNumRows(), logLLs.GetNumCols());
+        gammas.SetValue(0);
+        calculator.calgammaformb(objective, lattices, logLLs, labels, gammas, uids, boundaries, numParallelSequences, layout, extrauttmap, /*doreferencealign=*/false);
+        return objective.Get00Element();
+    }
+
+    // Runs calgammaformb() on the utterances u, concatenated in a single sequence as in frame mode.
+    float CalculateGammas(const vector<size_t>& u, vector<float>& gammas)
+    {
+        vector<float> values;
+        for (auto i : u)
+            values.insert(values.end(), m_logLLs[i].begin(), m_logLLs[i].end());
+        Matrix<float> logLLs(m_hset.getnumsenone(), values.size() / m_hset.getnumsenone(), values.data(), CPUDEVICE);
+        Matrix<float> result(CPUDEVICE);
+        float objective = CalculateGammas(u, logLLs, 1, nullptr, vector<size_t>(), result);
+        gammas = ToVector(result);
+        return objective;
+    }
+
+    static vector<float> ToVector(const Matrix<float>& m)
+    {
+        unique_ptr<float[]> values(m.CopyToArray());
+        return vector<float>(values.get(), values.get() + m.GetNumElements());
+    }
+
+    size_t NumFrames(size_t i) const
+    {
+        return m_lattices[i]->getnumframes();
+    }
+
+    size_t FirstFrame(size_t i) const
+    {
+        size_t t = 0;
+        for (size_t j = 0; j < i; j++)
+            t += NumFrames(j);
+        return t;
+    }
+
+    static void SetNumThreads(int numThreads)
+    {
+#ifdef _OPENMP
+        omp_set_num_threads(numThreads);
+#else
+        numThreads;
+#endif
+    }
+
+    int m_numThreads = 1;
+    msra::asr::simplesenonehmm m_hset;
+    vector<LatticePtr> m_lattices;
+    vector<vector<float>> m_logLLs; // [utterance] senones x frames
+    vector<size_t> m_uids;          // all utterances concatenated
+};
+
+BOOST_FIXTURE_TEST_SUITE(GammaCalculationTestSuite, GammaCalculationFixture)
+
+// The lattices of a minibatch are processed concurrently and each writes the gammas of its own utterance.
+// This must give the same gammas and objective as a serial run, and as the utterances on their own.
+BOOST_AUTO_TEST_CASE(ParallelForwardBackwardMatchesSerial)
+{
+    const size_t numSenones = m_hset.getnumsenone();
+    vector<size_t> all;
+    for (size_t i = 0; i < m_lattices.size(); i++)
+        all.push_back(i);
+
+    vector<float> serialGammas, parallelGammas;
+    SetNumThreads(1);
+    float serialObjective = CalculateGammas(all, serialGammas);
+    SetNumThreads(4);
+    float parallelObjective = CalculateGammas(all, parallelGammas);
+
+    BOOST_CHECK_EQUAL(parallelObjective, serialObjective);
+    BOOST_REQUIRE_EQUAL(parallelGammas.size(), serialGammas.size());
+    BOOST_CHECK(parallelGammas == serialGammas);
+
+    // MMI gammas are posteriors: they sum up to 1 in every frame
+    for (size_t t = 0; t < parallelGammas.size() / numSenones; t++)
+    {
+        float sum = 0;
+        for (size_t s = 0; s < numSenones; s++)
+            sum += parallelGammas[t * numSenones + s];
+        BOOST_CHECK_CLOSE(sum, 1.0f, 1e-2);
+    }
+
+    float sumOfObjectives = 0;
+    for (auto i : all)
+    {
+        vector<float> gammas;
+        sumOfObjectives += CalculateGammas({ i }, gammas);
+        auto begin = parallelGammas.begin() + FirstFrame(i) * numSenones;
+        BOOST_CHECK_MESSAGE(gammas == vector<float>(begin, begin + gammas.size()), "gammas of utterance " << i << " differ");
+    }
+    BOOST_CHECK_CLOSE(parallelObjective, sumOfObjectives, 1e-3);
+}
+
+// With parallel sequences, the gammas of each utterance go to its own interleaved columns; gap frames stay 0.
+BOOST_AUTO_TEST_CASE(ParallelSequencesGetTheirOwnGammas)
+{
+    const size_t numSenones = m_hset.getnumsenone();
+    const size_t numParallelSequences = 2;
+
+    // utterances 0, 2, ... in sequence 0 and 1, 3, ... in sequence 1, one after the other
+    vector<size_t> all, extrauttmap, tBegin(m_lattices.size());
+    vector<size_t> numTimeSteps(numParallelSequences);
+    for (size_t i = 0; i < m_lattices.size(); i++)
+    {
+        all.push_back(i);
+        extrauttmap.push_back(i % numParallelSequences);
+        tBegin[i] = numTimeSteps[i % numParallelSequences];
+        numTimeSteps[i % numParallelSequences] += NumFrames(i);
+    }
+    const size_t T = max(numTimeSteps[0], numTimeSteps[1]);
+
+    auto layout = make_shared<MBLayout>(numParallelSequences, T, L"X");
+    vector<float> values(numSenones * T * numParallelSequences, 0);
+    for (size_t i = 0; i < m_lattices.size(); i++)
+    {
+        size_t s = extrauttmap[i];
+        layout->AddSequence(NEW_SEQUENCE_ID, s, tBegin[i], tBegin[i] + NumFrames(i));
+        for (size_t t = 0; t < NumFrames(i); t++)
+            copy_n(m_logLLs[i].begin() + t * numSenones, numSenones, values.begin() + ((tBegin[i] + t) * numParallelSequences + s) * numSenones);
+    }
+    for (size_t s = 0; s < numParallelSequences; s++)
+        layout->AddGap(s, numTimeSteps[s], T);
+
+    Matrix<float> logLLs(numSenones, T * numParallelSequences, values.data(), CPUDEVICE);
+    Matrix<float> result(CPUDEVICE);
+    SetNumThreads(4);
+    float objective = CalculateGammas(all, logLLs, numParallelSequences, layout, extrauttmap, result);
+    auto parallelGammas = ToVector(result);
+
+    float sumOfObjectives = 0;
+    for (size_t i = 0; i < m_lattices.size(); i++)
+    {
+        vector<float> gammas;
+        sumOfObjectives += CalculateGammas({ i }, gammas);
+        for (size_t t = 0; t < NumFrames(i); t++)
+        {
+            auto begin = parallelGammas.begin() + ((tBegin[i] + t) * numParallelSequences + extrauttmap[i]) * numSenones;
+            BOOST_CHECK_MESSAGE(equal(begin, begin + numSenones, gammas.begin() + t * numSenones), "gammas of utterance " << i << " differ in frame " << t);
+        }
+    }
+    BOOST_CHECK_CLOSE(objective, sumOfObjectives, 1e-3);
+
+    for (size_t s = 0; s < numParallelSequences; s++)
+        for (size_t t = numTimeSteps[s]; t < T; t++)
+        {
+            auto begin = parallelGammas.begin() + (t * numParallelSequences + s) * numSenones;
+            BOOST_CHECK(all_of(begin, begin + numSenones, [](float g) { return g == 0; }));
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
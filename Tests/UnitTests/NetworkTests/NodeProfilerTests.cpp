@@ -0,0 +1,194 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include <set>
+#include "ComputationNetworkBuilder.h"
+#include "NodeProfiler.h"
+#include "TestHelpers.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+typedef shared_ptr<ComputationNode<float>> NodePtr;
+
+static const size_t c_inputDim = 3;
+static const size_t c_hiddenDim = 4;
+static const size_t c_outputDim = 2;
+static const size_t c_numSequences = 2;
+static const size_t c_numTimeSteps = 6;
+static const size_t c_numColumns = c_numSequences * c_numTimeSteps;
+
+// 'features -> Times -> Tanh -> Times -> SquareError' on the CPU, with one minibatch.
+struct NodeProfilerFixture
+{
+    NodeProfilerFixture()
+        : m_net(make_shared<ComputationNetwork>(CPUDEVICE))
+    {
+        ComputationNetworkBuilder<float> builder(*m_net);
+        auto parameter = [&](const wstring& name, size_t rows, size_t cols, unsigned long seed)
+        {
+            auto node = builder.CreateLearnableParameter(name, rows, cols);
+            m_net->RandomInitLearnableParameters(node, /*uniformInit=*/true, seed, /*initValueScale=*/1);
+            return node;
+        };
+
+        m_features = builder.CreateInputNode(L"features", c_inputDim);
+        m_labels = builder.CreateInputNode(L"labels", c_outputDim);
+        m_hidden = builder.Times(parameter(L"W", c_hiddenDim, c_inputDim, 1), m_features, 1, L"hidden");
+        m_activation = builder.Tanh(m_hidden, L"activation");
+        m_output = builder.Times(parameter(L"Wout", c_outputDim, c_hiddenDim, 2), m_activation, 1, L"output");
+        m_criterion = builder.SquareError(m_labels, m_output, L"criterion");
+        m_net->AddToNodeGroup(L"criterion", m_criterion);
+        m_net->CompileNetwork();
+    }
+
+    void AllocateAllMatrices()
+    {
+        m_net->AllocateAllMatrices({}, {}, m_criterion);
+    }
+
+    void ForwardAndBackprop()
+    {
+        auto layout = m_features->GetMBLayout();
+        layout->Init(c_numSequences, c_numTimeSteps);
+        for (size_t s = 0; s < c_numSequences; s++)
+            layout->AddSequence(s, s, 0, c_numTimeSteps);
+
+        vector<float> featureValues(c_inputDim * c_numColumns), labelValues(c_outputDim * c_numColumns);
+        for (size_t i = 0; i < featureValues.size(); i++)
+            featureValues[i] = 0.1f * (float)((i * 7) % 11) - 0.5f;
+        for (size_t i = 0; i < labelValues.size(); i++)
+            labelValues[i] = 0.2f * (float)((i * 3) % 5) - 0.4f;
+        m_features->Value().SetValue(c_inputDim, c_numColumns, CPUDEVICE, featureValues.data());
+        m_labels->Value().SetValue(c_outputDim, c_numColumns, CPUDEVICE, labelValues.data());
+
+        ScopedNetworkOperationMode modeGuard(m_net, NetworkOperationMode::training);
+        m_net->StartEvaluateMinibatchLoop(m_criterion);
+        ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ m_features, m_labels });
+        m_net->ForwardProp(m_criterion);
+        m_net->Backprop(m_criterion);
+    }
+
+    NodeProfiler& Profiler()
+    {
+        BOOST_REQUIRE(m_net->NodeProfilerPtr());
+        return *m_net->NodeProfilerPtr();
+    }
+
+    // Value and Gradient are each requested from the MatrixPool, scaled by the minibatch
+    static double ExpectedRequestedBytes(size_t sampleDim)
+    {
+        return 2.0 * sampleDim * c_numColumns * sizeof(float);
+    }
+
+    ComputationNetworkPtr m_net;
+    NodePtr m_features, m_labels, m_hidden, m_activation, m_output;
+    ComputationNodeBasePtr m_criterion;
+};
+
+BOOST_FIXTURE_TEST_SUITE(NodeProfilerTestSuite, NodeProfilerFixture)
+
+BOOST_AUTO_TEST_CASE(CountsCallsAndFlops)
+{
+    m_net->EnableNodeProfiling(true);
+    AllocateAllMatrices();
+    ForwardAndBackprop();
+
+    // Times: a multiply-add per inner dimension element and output element, twice as many in backprop
+    const auto* hidden = Profiler().GetStats(m_hidden.get());
+    BOOST_REQUIRE(hidden);
+    BOOST_CHECK(hidden->nodeName == L"hidden");
+    BOOST_CHECK(hidden->operationName == L"Times");
+    BOOST_CHECK_EQUAL(hidden->forwardCalls, 1);
+    BOOST_CHECK_EQUAL(hidden->backwardCalls, 1);
+    BOOST_CHECK_GE(hidden->forwardSeconds, 0);
+    const double timesFlops = 2.0 * c_hiddenDim * c_numColumns * c_inputDim;
+    BOOST_CHECK_CLOSE(hidden->flops, 3 * timesFlops, 1e-6);
+    BOOST_CHECK_EQUAL(hidden->numColumns, c_numColumns);
+
+    // element-wise: one operation per output element
+    const auto* activation = Profiler().GetStats(m_activation.get());
+    BOOST_REQUIRE(activation);
+    BOOST_CHECK_CLOSE(activation->flops, 3.0 * c_hiddenDim * c_numColumns, 1e-6);
+
+    // the statistics accumulate until Reset()
+    ForwardAndBackprop();
+    BOOST_CHECK_EQUAL(Profiler().GetStats(m_hidden.get())->forwardCalls, 2);
+    Profiler().Reset();
+    BOOST_CHECK(!Profiler().GetStats(m_hidden.get()));
+}
+
+// The pool shares matrices between nodes. Each node is charged what it requested, not the matrices it ends up with.
+BOOST_AUTO_TEST_CASE(MemoryComesFromMatrixPoolRequests)
+{
+    m_net->EnableNodeProfiling(true);
+    AllocateAllMatrices();
+    ForwardAndBackprop();
+
+    const double hiddenBytes = ExpectedRequestedBytes(c_hiddenDim);
+    const double outputBytes = ExpectedRequestedBytes(c_outputDim);
+    BOOST_CHECK_CLOSE(Profiler().GetRequestedBytes(m_hidden.get()), hiddenBytes, 1e-6);
+    BOOST_CHECK_CLOSE(Profiler().GetRequestedBytes(m_activation.get()), hiddenBytes, 1e-6);
+    BOOST_CHECK_CLOSE(Profiler().GetRequestedBytes(m_output.get()), outputBytes, 1e-6);
+    // parameters and inputs do not come from the pool
+    BOOST_CHECK_EQUAL(Profiler().GetRequestedBytes(m_features.get()), 0);
+
+    double requestedBytes = 0;
+    for (const auto& node : m_net->GetAllNodes())
+        requestedBytes += Profiler().GetRequestedBytes(node.get());
+
+    size_t numBuffers = 0;
+    double poolBytes = Profiler().GetPoolBytes(&numBuffers);
+    BOOST_CHECK_GT(numBuffers, 0);
+    BOOST_CHECK_GE(poolBytes, hiddenBytes / 2);
+    BOOST_CHECK_LE(poolBytes, requestedBytes);
+
+    // if matrices are shared, the pool needs less than the sum of the requests
+    set<const void*> matrices;
+    size_t numMatrices = 0;
+    for (const auto& node : { m_hidden, m_activation, m_output })
+    {
+        matrices.insert(node->ValuePtr().get());
+        matrices.insert(node->GradientPtr().get());
+        numMatrices += 2;
+    }
+    if (matrices.size() < numMatrices)
+        BOOST_CHECK_LT(poolBytes, requestedBytes);
+}
+
+// Profiling may be enabled after the matrices are allocated, and the requests survive Reset().
+BOOST_AUTO_TEST_CASE(EnableAfterAllocation)
+{
+    AllocateAllMatrices();
+    m_net->EnableNodeProfiling(true);
+    ForwardAndBackprop();
+    BOOST_CHECK_CLOSE(Profiler().GetRequestedBytes(m_hidden.get()), ExpectedRequestedBytes(c_hiddenDim), 1e-6);
+
+    Profiler().Reset();
+    BOOST_CHECK_EQUAL(Profiler().GetRequestedBytes(m_hidden.get()), 0);
+    BOOST_CHECK_EQUAL(Profiler().GetPoolBytes(), 0);
+    ForwardAndBackprop();
+    BOOST_CHECK_CLOSE(Profiler().GetRequestedBytes(m_hidden.get()), ExpectedRequestedBytes(c_hiddenDim), 1e-6);
+
+    FILE* f = tmpfile();
+    BOOST_REQUIRE(f);
+    Profiler().Print(f);
+    rewind(f);
+    string text;
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), f))
+        text += buffer;
+    fclose(f);
+    BOOST_CHECK(text.find("hidden : Times") != string::npos);
+    BOOST_CHECK(text.find("Times (2 nodes)") != string::npos);
+    BOOST_CHECK(text.find("MatrixPool:") != string::npos);
+
+    m_net->EnableNodeProfiling(false);
+    BOOST_CHECK(!m_net->NodeProfilerPtr());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
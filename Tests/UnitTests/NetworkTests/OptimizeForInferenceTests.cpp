@@ -0,0 +1,78 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "ComputationNetworkBuilder.h"
+#include "InputAndParamNodes.h"
+#include "TestHelpers.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+BOOST_AUTO_TEST_SUITE(OptimizeForInferenceTestSuite)
+
+// The network of EvalOptimizeForInferenceTest in the EvalTests, which can only see the outputs of the network:
+// a constant subexpression (1 + 2), a Dropout, a criterion and an output that are not requested.
+BOOST_AUTO_TEST_CASE(OptimizeForInferenceFoldsAndRemovesNodes)
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto constant = [&](const wstring& name, float value)
+    {
+        auto parameter = builder.CreateLearnableParameter(name, 1, 1);
+        net->InitLearnableParameters(parameter, L"fixedValue", value);
+        parameter->SetLearningRateMultiplier(0);
+        return parameter;
+    };
+
+    auto i1 = builder.CreateInputNode(L"i1", 1);
+    auto l1 = builder.CreateInputNode(L"l1", 1);
+    auto c1 = builder.Plus(constant(L"one", 1), constant(L"two", 2), L"c1");
+    auto d1 = builder.Dropout(i1, L"d1");
+    auto o1 = builder.Times(c1, d1, 1, L"o1");
+    auto o2 = builder.Times(constant(L"five", 5), i1, 1, L"o2");
+    auto ce = builder.SquareError(l1, o1, L"ce");
+    net->AddToNodeGroup(L"output", o1);
+    net->AddToNodeGroup(L"output", o2);
+    net->AddToNodeGroup(L"criterion", ce);
+    net->CompileNetwork();
+
+    net->OptimizeForInference<float>({ o1 });
+
+    // c1 became a constant that holds 1 + 2
+    BOOST_REQUIRE(net->NodeNameExists(L"c1"));
+    auto folded = net->GetNodeFromName(L"c1");
+    BOOST_CHECK(folded->OperationName() == OperationNameOf(LearnableParameter));
+    BOOST_CHECK_EQUAL(folded->GetLearningRateMultiplier(), 0);
+    BOOST_CHECK_EQUAL(dynamic_pointer_cast<ComputationNode<float>>(folded)->Value().Get00Element(), 3);
+
+    // the Dropout is bypassed, so o1 reads the constant and the input directly
+    BOOST_REQUIRE_EQUAL(o1->GetNumInputs(), (size_t)2);
+    BOOST_CHECK(o1->GetInputs()[0] == folded);
+    BOOST_CHECK(o1->GetInputs()[1] == i1);
+
+    // everything o1 does not depend on is gone, also from the node groups
+    for (const auto& name : { L"d1", L"one", L"two", L"five", L"o2", L"l1", L"ce" })
+        BOOST_CHECK_MESSAGE(!net->NodeNameExists(name), "node not removed");
+    BOOST_CHECK(net->FinalCriterionNodes().empty());
+    BOOST_REQUIRE_EQUAL(net->OutputNodes().size(), (size_t)1);
+    BOOST_CHECK(net->OutputNodes()[0] == o1);
+
+    // and o1 is still computed correctly
+    net->AllocateAllMatrices({}, { o1 }, nullptr);
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::inferring);
+    net->StartEvaluateMinibatchLoop(ComputationNodeBasePtr(o1));
+    auto layout = i1->GetMBLayout();
+    layout->Init(1, 1);
+    layout->AddSequence(0, 0, 0, 1);
+    float input = 2;
+    i1->Value().SetValue(1, 1, CPUDEVICE, &input);
+    ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ i1 });
+    net->ForwardProp(ComputationNodeBasePtr(o1));
+    BOOST_CHECK_EQUAL(o1->Value().Get00Element(), 6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
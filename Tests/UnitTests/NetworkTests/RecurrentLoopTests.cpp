@@ -0,0 +1,272 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "ComputationNetworkBuilder.h"
+#include "Globals.h"
+#include "RecurrentNodes.h"
+#include "TestHelpers.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+typedef shared_ptr<ComputationNode<float>> NodePtr;
+
+static const size_t c_inputDim = 3;
+static const size_t c_cellDim = 4;
+static const size_t c_outputDim = 2;
+static const size_t c_numSequences = 2;
+static const size_t c_numTimeSteps = 6;
+static const float c_threshold = 1e-5f;
+
+static NodePtr CreateParameter(ComputationNetworkBuilder<float>& builder, ComputationNetwork& net, const wstring& name, size_t rows, size_t cols, unsigned long& seed)
+{
+    auto parameter = builder.CreateLearnableParameter(name, rows, cols);
+    net.RandomInitLearnableParameters(parameter, /*uniformInit=*/true, seed++, /*initValueScale=*/1);
+    return parameter;
+}
+
+// An LSTM without peepholes, running forward or backward in time. Each gate multiplies the delayed
+// output with its own weights, so the loop contains four TimesNodes with the same right operand.
+static NodePtr AddLSTM(ComputationNetworkBuilder<float>& builder, ComputationNetwork& net, const NodePtr& input, const wstring& prefix, bool backward, unsigned long& seed)
+{
+    auto delay = [&](const wstring& name)
+    {
+        return backward ? builder.FutureValue(nullptr, 0.1f, c_cellDim, 1, prefix + name) : builder.PastValue(nullptr, 0.1f, c_cellDim, 1, prefix + name);
+    };
+    auto prevOutput = delay(L"prevOutput");
+    auto prevCell = delay(L"prevCell");
+    auto gate = [&](const wstring& name)
+    {
+        auto wx = CreateParameter(builder, net, prefix + L"Wx" + name, c_cellDim, c_inputDim, seed);
+        auto wh = CreateParameter(builder, net, prefix + L"Wh" + name, c_cellDim, c_cellDim, seed);
+        auto b = CreateParameter(builder, net, prefix + L"b" + name, c_cellDim, 1, seed);
+        return builder.Plus(builder.Plus(builder.Times(wx, input), builder.Times(wh, prevOutput)), b);
+    };
+    auto inputGate = builder.Sigmoid(gate(L"i"));
+    auto forgetGate = builder.Sigmoid(gate(L"f"));
+    auto outputGate = builder.Sigmoid(gate(L"o"));
+    auto cellInput = builder.Tanh(gate(L"c"));
+
+    auto cell = builder.Plus(builder.ElementTimes(forgetGate, prevCell), builder.ElementTimes(inputGate, cellInput));
+    auto output = builder.ElementTimes(outputGate, builder.Tanh(cell), prefix + L"output");
+    prevOutput->AttachInputs({ output });
+    prevCell->AttachInputs({ cell });
+    return output;
+}
+
+// Builds 'features -> hidden -> Times -> SquareError' on the CPU and runs one forward and backward pass over
+// a full-length and a shorter sequence. Returns the output, followed by the gradients of all parameters.
+// 'checkNetwork' is called on the compiled network before the minibatch is processed.
+template <class BuildHidden, class CheckNetwork>
+static vector<vector<float>> ForwardAndBackprop(const BuildHidden& buildHidden, const CheckNetwork& checkNetwork)
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+    unsigned long seed = 1;
+
+    auto features = builder.CreateInputNode(L"features", c_inputDim);
+    auto labels = builder.CreateInputNode(L"labels", c_outputDim);
+    auto hidden = buildHidden(builder, *net, features, seed);
+    auto output = builder.Times(CreateParameter(builder, *net, L"Wout", c_outputDim, c_cellDim, seed), hidden, 1, L"output");
+    ComputationNodeBasePtr criterion = builder.SquareError(labels, output, L"criterion");
+    net->AddToNodeGroup(L"criterion", criterion);
+    net->AddToNodeGroup(L"output", output);
+    net->CompileNetwork();
+    net->AllocateAllMatrices({}, { output }, criterion);
+    checkNetwork(*net, criterion);
+
+    auto layout = features->GetMBLayout();
+    layout->Init(c_numSequences, c_numTimeSteps);
+    layout->AddSequence(0, 0, 0, c_numTimeSteps);
+    layout->AddSequence(1, 1, 0, c_numTimeSteps - 2);
+    layout->AddGap(1, c_numTimeSteps - 2, c_numTimeSteps);
+
+    const size_t numColumns = c_numSequences * c_numTimeSteps;
+    vector<float> featureValues(c_inputDim * numColumns), labelValues(c_outputDim * numColumns);
+    for (size_t i = 0; i < featureValues.size(); i++)
+        featureValues[i] = 0.1f * (float)((i * 7) % 11) - 0.5f;
+    for (size_t i = 0; i < labelValues.size(); i++)
+        labelValues[i] = 0.2f * (float)((i * 3) % 5) - 0.4f;
+    features->Value().SetValue(c_inputDim, numColumns, CPUDEVICE, featureValues.data());
+    labels->Value().SetValue(c_outputDim, numColumns, CPUDEVICE, labelValues.data());
+
+    ScopedNetworkOperationMode modeGuard(net, NetworkOperationMode::training);
+    net->StartEvaluateMinibatchLoop(criterion);
+    ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ features, labels });
+    net->ForwardProp(criterion);
+    net->Backprop(criterion);
+
+    vector<vector<float>> result;
+    auto addValues = [&result](const Matrix<float>& matrix)
+    {
+        unique_ptr<float[]> data(matrix.CopyToArray());
+        result.push_back(vector<float>(data.get(), data.get() + matrix.GetNumElements()));
+    };
+    addValues(output->Value());
+    for (const auto& parameter : net->LearnableParameterNodes(criterion))
+        addValues(dynamic_pointer_cast<ComputationNode<float>>(parameter)->Gradient());
+    return result;
+}
+
+template <class BuildHidden>
+static vector<vector<float>> ForwardAndBackprop(const BuildHidden& buildHidden)
+{
+    return ForwardAndBackprop(buildHidden, [](ComputationNetwork&, const ComputationNodeBasePtr&) {});
+}
+
+static void CheckEqual(const vector<vector<float>>& expected, const vector<vector<float>>& actual)
+{
+    BOOST_REQUIRE_EQUAL(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        BOOST_REQUIRE_EQUAL(expected[i].size(), actual[i].size());
+        BOOST_CHECK(AreEqual(expected[i].data(), actual[i].data(), expected[i].size(), c_threshold));
+    }
+}
+
+// Sequences of a truncated-BPTT test, in global time. Stream 0 holds one sequence, stream 1 two.
+struct TruncatedSequence
+{
+    UniqueSequenceId seqId;
+    size_t s;
+    size_t tBegin, tEnd;
+};
+static const TruncatedSequence c_truncatedSequences[] = { { 0, 0, 0, 12 }, { 1, 1, 0, 7 }, { 2, 1, 7, 12 } };
+static const size_t c_truncatedTimeSteps = 12;
+static const size_t c_delayTimeStep = 3;
+
+// Builds 'h = features + PastValue(h)', a loop, and 'PastValue(features)', which is outside of any loop,
+// both with a time step of 3, and feeds the sequences as consecutive minibatches of the given lengths.
+// Returns the values of both over all minibatches. With 'unspecifiedBegin' sequences that begin in an earlier
+// minibatch are passed like the V2 API does, without their begin.
+static vector<vector<float>> ForwardInChunks(const vector<size_t>& chunkLengths, bool unspecifiedBegin)
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+
+    auto features = builder.CreateInputNode(L"features", c_inputDim);
+    auto delayed = builder.PastValue(nullptr, 0.5f, c_inputDim, c_delayTimeStep, L"delayed");
+    auto hidden = builder.Plus(features, delayed, L"hidden");
+    delayed->AttachInputs({ hidden });
+    auto pastFeatures = builder.PastValue(features, 0.25f, c_inputDim, c_delayTimeStep, L"pastFeatures");
+    vector<ComputationNodeBasePtr> outputs = { hidden, pastFeatures };
+    for (const auto& output : outputs)
+        net->AddToNodeGroup(L"output", output);
+    net->CompileNetwork();
+    net->AllocateAllMatrices({}, outputs, nullptr);
+    net->StartEvaluateMinibatchLoop(outputs);
+
+    vector<vector<float>> result(outputs.size());
+    auto layout = features->GetMBLayout();
+    size_t begin = 0;
+    for (size_t length : chunkLengths)
+    {
+        layout->Init(c_numSequences, length);
+        for (const auto& sequence : c_truncatedSequences)
+        {
+            if (sequence.tEnd <= begin || sequence.tBegin >= begin + length)
+                continue;
+            ptrdiff_t tBegin = (ptrdiff_t)sequence.tBegin - (ptrdiff_t)begin;
+            if (unspecifiedBegin && tBegin < 0)
+                tBegin = SentinelValueIndicatingUnspecifedSequenceBeginIdx;
+            layout->AddSequence(sequence.seqId, sequence.s, tBegin, sequence.tEnd - begin);
+        }
+
+        vector<float> featureValues(c_inputDim * c_numSequences * length);
+        for (size_t i = 0; i < featureValues.size(); i++)
+            featureValues[i] = 0.1f * (float)((begin * c_inputDim * c_numSequences + i) % 17) - 0.8f;
+        features->Value().SetValue(c_inputDim, c_numSequences * length, CPUDEVICE, featureValues.data());
+
+        ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ features });
+        net->ForwardProp(outputs);
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            const auto& value = dynamic_pointer_cast<ComputationNode<float>>(outputs[i])->Value();
+            unique_ptr<float[]> data(value.CopyToArray());
+            result[i].insert(result[i].end(), data.get(), data.get() + value.GetNumElements());
+        }
+        begin += length;
+    }
+    BOOST_REQUIRE_EQUAL(begin, c_truncatedTimeSteps);
+    return result;
+}
+
+BOOST_AUTO_TEST_SUITE(RecurrentLoopTestSuite)
+
+BOOST_AUTO_TEST_CASE(StackedRecurrentTimesMatchesNodeByNode)
+{
+    auto buildLSTM = [](ComputationNetworkBuilder<float>& builder, ComputationNetwork& net, const NodePtr& input, unsigned long& seed)
+    {
+        return AddLSTM(builder, net, input, L"lstm.", /*backward=*/false, seed);
+    };
+
+    bool stackRecurrentTimes = Globals::ShouldStackRecurrentTimes();
+    Globals::SetStackRecurrentTimes(false);
+    auto nodeByNode = ForwardAndBackprop(buildLSTM);
+    Globals::SetStackRecurrentTimes(true);
+    auto stacked = ForwardAndBackprop(buildLSTM);
+    Globals::SetStackRecurrentTimes(stackRecurrentTimes);
+
+    // output, 4 x 3 parameters per gate, output weights
+    BOOST_CHECK_EQUAL(nodeByNode.size(), (size_t)(1 + 4 * 3 + 1));
+    CheckEqual(nodeByNode, stacked);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentLoopsMatchSequential)
+{
+    // a bidirectional LSTM; the two directions only share the features, which are outside of the loops
+    auto buildBidirectionalLSTM = [](ComputationNetworkBuilder<float>& builder, ComputationNetwork& net, const NodePtr& input, unsigned long& seed)
+    {
+        auto forward = AddLSTM(builder, net, input, L"fwd.", /*backward=*/false, seed);
+        auto backward = AddLSTM(builder, net, input, L"bwd.", /*backward=*/true, seed);
+        return builder.Plus(forward, backward);
+    };
+
+    // ScheduleConcurrentLoops() must have moved the nodes of both loops next to each other
+    auto checkLoopsAreAdjacent = [](ComputationNetwork& net, const ComputationNodeBasePtr& criterion)
+    {
+        vector<size_t> loopPositions;
+        size_t position = 0;
+        for (const auto& node : net.GetEvalOrder(criterion))
+        {
+            if (node->IsPartOfLoop())
+                loopPositions.push_back(position);
+            position++;
+        }
+        BOOST_REQUIRE(!loopPositions.empty());
+        BOOST_CHECK_EQUAL(loopPositions.back() - loopPositions.front() + 1, loopPositions.size());
+    };
+
+    bool concurrentLoops = Globals::ShouldRunLoopsConcurrently();
+    Globals::SetConcurrentLoops(false);
+    auto sequential = ForwardAndBackprop(buildBidirectionalLSTM);
+    Globals::SetConcurrentLoops(true);
+    auto concurrent = ForwardAndBackprop(buildBidirectionalLSTM, checkLoopsAreAdjacent);
+    Globals::SetConcurrentLoops(concurrentLoops);
+
+    // output, 4 x 3 parameters per gate and direction, output weights
+    BOOST_CHECK_EQUAL(sequential.size(), (size_t)(1 + 2 * 4 * 3 + 1));
+    CheckEqual(sequential, concurrent);
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedCarryOverMatchesSingleMinibatch)
+{
+    // all sequences in one minibatch: nothing is carried over
+    auto expected = ForwardInChunks({ c_truncatedTimeSteps }, /*unspecifiedBegin=*/false);
+
+    // Minibatches longer than the time step only keep its last frames for the next minibatch, minibatches
+    // of at most the time step keep all of them. {3, 3, 3, 3} only reads from full copies, {4, 4, 4} only from
+    // shortened ones, {5, 4, 3} from both, including a full copy made after reading from a shortened one.
+    for (const auto& chunkLengths : vector<vector<size_t>>{ { 3, 3, 3, 3 }, { 4, 4, 4 }, { 5, 4, 3 } })
+    {
+        CheckEqual(expected, ForwardInChunks(chunkLengths, /*unspecifiedBegin=*/false));
+        // the begin of a truncated sequence is then restored from the kept layout
+        CheckEqual(expected, ForwardInChunks(chunkLengths, /*unspecifiedBegin=*/true));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
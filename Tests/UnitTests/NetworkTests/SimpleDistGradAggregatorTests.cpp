@@ -0,0 +1,140 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include "ComputationNetworkBuilder.h"
+#include "InputAndParamNodes.h"
+#include "../../../Source/SGDLib/SimpleDistGradAggregator.h"
+#include "TestHelpers.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// These tests run with any number of workers. The distributed end-to-end test runs them under mpiexec with two.
+
+static const size_t c_embeddingDim = 3;
+static const size_t c_vocabularySize = 10;
+static const size_t c_numWords = 3;
+
+static MPIWrapperPtr GetMPI()
+{
+    auto mpi = MPIWrapper::GetInstance();
+    if (!mpi)
+        mpi = MPIWrapper::GetInstance(/*create=*/true);
+    return mpi;
+}
+
+// The words of the minibatch of a worker, one per sample. The last one is seen by all workers.
+static vector<size_t> WordsOf(size_t rank)
+{
+    return vector<size_t>{ (2 * rank) % c_vocabularySize, (2 * rank + 5) % c_vocabularySize, c_vocabularySize - 1 };
+}
+
+static float OutputGradientOf(size_t rank, size_t row, size_t sample)
+{
+    return 0.1f * (float)(rank + 1) * (float)(row + c_embeddingDim * sample + 1);
+}
+
+// The gradient of an embedding matrix fed by a sparse one-hot input, as computed by LookupTableNode::BackpropTo().
+static void ComputeEmbeddingGradient(size_t rank, Matrix<float>& gradient)
+{
+    auto words = WordsOf(rank);
+    vector<CPUSPARSE_INDEX_TYPE> columnStarts(c_numWords + 1), rows(c_numWords);
+    vector<float> ones(c_numWords, 1);
+    for (size_t s = 0; s < c_numWords; s++)
+    {
+        columnStarts[s + 1] = (CPUSPARSE_INDEX_TYPE)(s + 1);
+        rows[s] = (CPUSPARSE_INDEX_TYPE)words[s];
+    }
+    Matrix<float> input(c_vocabularySize, c_numWords, CPUDEVICE, SPARSE, matrixFormatSparseCSC);
+    input.SetMatrixFromCSCFormat(columnStarts.data(), rows.data(), ones.data(), c_numWords, c_vocabularySize, c_numWords);
+
+    vector<float> outputGradientValues(c_embeddingDim * c_numWords);
+    for (size_t s = 0; s < c_numWords; s++)
+        for (size_t row = 0; row < c_embeddingDim; row++)
+            outputGradientValues[row + c_embeddingDim * s] = OutputGradientOf(rank, row, s);
+    Matrix<float> outputGradient(c_embeddingDim, c_numWords, outputGradientValues.data(), CPUDEVICE);
+
+    Matrix<float>::MultiplyAndAdd(outputGradient, false, input, true, gradient);
+}
+
+BOOST_AUTO_TEST_SUITE(SimpleDistGradAggregatorTestSuite)
+
+// The last worker gets an empty minibatch. Its embedding gradient is sparse nevertheless, since the type is decided
+// from the graph, so it takes part in the same collectives as the others.
+BOOST_AUTO_TEST_CASE(AggregateSparseBlockColumnGradient)
+{
+    auto mpi = GetMPI();
+    size_t numWorkers = mpi->NumNodesInUse();
+    size_t rank = mpi->CurrentNodeRank();
+    bool isEmpty = numWorkers > 1 && rank == numWorkers - 1;
+
+    Matrix<float> sparseGradient(c_embeddingDim, c_vocabularySize, CPUDEVICE, SPARSE, matrixFormatSparseBlockCol);
+    if (!isEmpty)
+        ComputeEmbeddingGradient(rank, sparseGradient);
+    Matrix<float> denseGradient(2, 2, CPUDEVICE);
+    denseGradient.SetValue(isEmpty ? 0.0f : (float)(rank + 1));
+
+    shared_ptr<DistGradHeader> header(DistGradHeader::Create(/*numEvalNode=*/0), [](DistGradHeader* h) { DistGradHeader::Destroy(h); });
+    header->Clear();
+    header->numSamples = isEmpty ? 0 : c_numWords;
+    header->numSamplesWithLabel = header->numSamples;
+
+    SimpleDistGradAggregator<float> aggregator(mpi, /*useAsyncAggregation=*/false, CPUDEVICE, /*syncStatsTrace=*/0);
+    BOOST_CHECK(aggregator.AggregateGradients({ &sparseGradient, &denseGradient }, header.get(), /*resetState=*/true));
+
+    // the sum over all workers that saw data
+    size_t numWorkersWithData = numWorkers > 1 ? numWorkers - 1 : 1;
+    vector<float> expected(c_embeddingDim * c_vocabularySize, 0);
+    set<size_t> touchedColumns;
+    float expectedDense = 0;
+    for (size_t worker = 0; worker < numWorkersWithData; worker++)
+    {
+        auto words = WordsOf(worker);
+        for (size_t s = 0; s < c_numWords; s++)
+        {
+            touchedColumns.insert(words[s]);
+            for (size_t row = 0; row < c_embeddingDim; row++)
+                expected[row + c_embeddingDim * words[s]] += OutputGradientOf(worker, row, s);
+        }
+        expectedDense += (float)(worker + 1);
+    }
+    BOOST_CHECK_EQUAL(header->numSamples, numWorkersWithData * c_numWords);
+
+    // all workers hold the union of the touched columns, in the same order
+    BOOST_REQUIRE_EQUAL(sparseGradient.GetMatrixType(), SPARSE);
+    vector<size_t> columnIds;
+    sparseGradient.GetSparseBlockColumnIds(columnIds);
+    BOOST_CHECK(columnIds == vector<size_t>(touchedColumns.begin(), touchedColumns.end()));
+
+    sparseGradient.SwitchToMatrixType(DENSE, matrixFormatDense, /*keepValues=*/true);
+    unique_ptr<float[]> actual(sparseGradient.CopyToArray());
+    BOOST_CHECK(AreEqual(expected.data(), actual.get(), expected.size(), 1e-5f));
+
+    unique_ptr<float[]> actualDense(denseGradient.CopyToArray());
+    for (size_t i = 0; i < 4; i++)
+        BOOST_CHECK_CLOSE(actualDense[i], expectedDense, 1e-5);
+}
+
+// The embedding gradient is sparse before the first backprop, so also on a worker that never saw data.
+BOOST_AUTO_TEST_CASE(LookupTableGradientIsSparseBeforeBackprop)
+{
+    auto net = make_shared<ComputationNetwork>(CPUDEVICE);
+    ComputationNetworkBuilder<float> builder(*net);
+    auto input = builder.CreateSparseInputNode(L"features", c_vocabularySize);
+    auto embedding = builder.CreateLearnableParameter(L"E", c_embeddingDim, c_vocabularySize);
+    auto lookup = builder.LookupTable(embedding, input, L"lookup");
+    auto criterion = builder.Sum(lookup, L"criterion");
+    net->AddToNodeGroup(L"criterion", criterion);
+    net->CompileNetwork();
+    net->AllocateAllMatrices({}, {}, criterion);
+
+    BOOST_CHECK_EQUAL(embedding->Gradient().GetMatrixType(), SPARSE);
+    BOOST_CHECK(embedding->Gradient().GetFormat() == matrixFormatSparseBlockCol);
+    BOOST_CHECK(embedding->GetPreferredGradientMatrixType() == SPARSE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
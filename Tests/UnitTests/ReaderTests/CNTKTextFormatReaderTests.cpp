@@ -4,6 +4,7 @@
 //
 #include "stdafx.h"
 #include <algorithm>
+#include <numeric>
 #ifdef _WIN32
 #include <io.h>
 #else // On Linux
@@ -16,6 +17,7 @@
 #include <boost/scope_exit.hpp>
 #include "Common/ReaderTestHelper.h"
 #include "TextParser.h"
+#include "LTStreamingRandomizer.h"
 
 using namespace Microsoft::MSR::CNTK;
 
@@ -47,6 +49,19 @@ namespace CNTK {
         {
             m_chunk = m_parser.GetChunk(0);
         }
+
+        // Creates a parser that streams its input in chunks of the given size.
+        static std::shared_ptr<TextParser<ElemType>> CreateStreamingParser(const string& filename,
+            const vector<StreamDescriptor>& streams, size_t chunkSize, bool followInput)
+        {
+            std::shared_ptr<TextParser<ElemType>> parser(new TextParser<ElemType>(
+                std::make_shared<CorpusDescriptor>(true), wstring(filename.begin(), filename.end()), streams, true));
+            parser->SetChunkSize(chunkSize);
+            parser->SetNumRetries(0);
+            parser->SetStreaming(true, followInput);
+            parser->Initialize();
+            return parser;
+        }
     };
 }
 
@@ -88,6 +103,61 @@ BOOST_AUTO_TEST_CASE(CNTKTextFormatReader_Simple_dense)
     test({ L"defMBSize=true" });
 };
 
+// With zeroCopyInputs, ReaderShim hands dense CPU inputs over without a copy, the input matrices point to the packer buffers.
+BOOST_AUTO_TEST_CASE(CNTKTextFormatReader_Simple_dense_zero_copy)
+{
+    const string configFile = testDataPath() + "/Config/CNTKTextFormatReader/dense.cntk";
+    const vector<wstring> zeroCopy = { L"Simple=[reader=[zeroCopyInputs=true]]" };
+
+    HelperRunReaderTest<float>(
+        configFile,
+        testDataPath() + "/Control/CNTKTextFormatReader/Simple_dense.txt",
+        testDataPath() + "/Control/CNTKTextFormatReader/Simple_dense_zero_copy_Output.txt",
+        "Simple",
+        "reader",
+        1000, // epoch size
+        250,  // mb size
+        10,   // num epochs
+        1,
+        1,
+        0,
+        1,
+        false, false, true,
+        zeroCopy);
+
+    // The helper above may put the inputs on the GPU, where data is always copied; check the CPU case explicitly.
+    auto layout = make_shared<MBLayout>(1, 0, L"X");
+    StreamMinibatchInputs inputs;
+    inputs.AddInput(L"features", make_shared<Matrix<float>>(CPUDEVICE), layout, TensorShape());
+    inputs.AddInput(L"labels", make_shared<Matrix<float>>(CPUDEVICE), layout, TensorShape());
+    auto& features = inputs.GetInputMatrix<float>(L"features");
+
+    auto zeroCopyReader = GetDataReader(configFile, "Simple", "reader", zeroCopy);
+    auto copyReader = GetDataReader(configFile, "Simple", "reader", {});
+    zeroCopyReader->StartMinibatchLoop(250, 0, inputs.GetStreamDescriptions(), 1000);
+    copyReader->StartMinibatchLoop(100, 0, inputs.GetStreamDescriptions(), 1000);
+
+    BOOST_REQUIRE(zeroCopyReader->GetMinibatch(inputs));
+    BOOST_CHECK(!features.OwnBuffer());
+    BOOST_REQUIRE_EQUAL(features.GetNumCols(), (size_t)250);
+    unique_ptr<float[]> zeroCopyData(features.CopyToArray());
+
+    // Such a matrix cannot be resized...
+    BOOST_CHECK_THROW(features.Resize(features.GetNumRows(), 100), std::logic_error);
+
+    // ...but other readers can still fill it with data of a different size, here through the copy path of ReaderShim.
+    BOOST_REQUIRE(copyReader->GetMinibatch(inputs));
+    BOOST_CHECK(features.OwnBuffer());
+    BOOST_REQUIRE_EQUAL(features.GetNumCols(), (size_t)100);
+    unique_ptr<float[]> copyData(features.CopyToArray());
+    BOOST_CHECK(std::equal(copyData.get(), copyData.get() + features.GetNumElements(), zeroCopyData.get()));
+
+    // A matrix that owns its buffer is handed over without a copy again.
+    BOOST_REQUIRE(zeroCopyReader->GetMinibatch(inputs));
+    BOOST_CHECK(!features.OwnBuffer());
+    BOOST_CHECK_EQUAL(features.GetNumCols(), (size_t)250);
+};
+
 BOOST_AUTO_TEST_CASE(CNTKTextFormatReader_Simple_dense_single_stream)
 {
     auto test = [this](const vector<wstring>& parameters)
@@ -1045,6 +1115,138 @@ BOOST_AUTO_TEST_CASE(CompositeCNTKTextFormatReader_5x5_and_5x10_jagged_minibatch
         false);
 };
 
+BOOST_AUTO_TEST_CASE(CNTKTextFormatReader_streaming_follow_input)
+{
+    vector<StreamDescriptor> streams(1);
+    streams[0].m_alias = "A";
+    streams[0].m_name = L"A";
+    streams[0].m_storageFormat = StorageFormat::Dense;
+    streams[0].m_sampleDimension = 1;
+
+    string filename = "streaming_follow_input.txt";
+    {
+        std::ofstream file(filename);
+        file << "0 |A 1\n0 |A 2\n1 |A 3\n";
+    }
+
+    {
+        auto parser = CNTKTextFormatReaderTestRunner<float>::CreateStreamingParser(filename, streams, 16, true);
+        BOOST_REQUIRE(parser->ChunkInfos().empty());
+
+        // Less than a chunk worth of input is available, the chunk is not complete yet.
+        StreamingChunk chunk;
+        BOOST_REQUIRE(!parser->TryReadChunk(0, 0, true, chunk));
+
+        {
+            std::ofstream file(filename, std::ofstream::app);
+            file << "1 |A 4\n2 |A 5\n";
+        }
+
+        BOOST_REQUIRE(parser->TryReadChunk(0, 7, true, chunk));
+        BOOST_REQUIRE_EQUAL(chunk.m_endPosition, 14);
+        BOOST_REQUIRE_EQUAL(chunk.m_sequences.size(), 1);
+        BOOST_REQUIRE_EQUAL(chunk.m_sequences[0].m_numberOfSamples, 2);
+        BOOST_REQUIRE_EQUAL(chunk.m_sequences[0].m_chunkId, 7);
+
+        vector<SequenceDataPtr> data;
+        chunk.m_data->GetSequence(0, data);
+        BOOST_REQUIRE_EQUAL(reinterpret_cast<const float*>(data[0]->GetDataBuffer())[1], 2.f);
+
+        // The last sequence is not known to be complete while the input is followed.
+        BOOST_REQUIRE(!parser->TryReadChunk(14, 1, true, chunk));
+
+        {
+            std::ofstream file(filename, std::ofstream::app);
+            file << "3 |A 6\n3 |A 7\n4 |A 8\n";
+        }
+
+        BOOST_REQUIRE(parser->TryReadChunk(14, 1, false, chunk));
+        BOOST_REQUIRE_EQUAL(chunk.m_endPosition, 35);
+        BOOST_REQUIRE_EQUAL(chunk.m_sequences.size(), 2);
+        BOOST_REQUIRE(chunk.m_data == nullptr);
+    }
+
+    boost::filesystem::remove(filename);
+};
+
+BOOST_AUTO_TEST_CASE(CNTKTextFormatReader_streaming_randomizer)
+{
+    vector<StreamDescriptor> streams(1);
+    streams[0].m_alias = "A";
+    streams[0].m_name = L"A";
+    streams[0].m_storageFormat = StorageFormat::Dense;
+    streams[0].m_sampleDimension = 1;
+
+    string filename = "streaming_randomizer.txt";
+    {
+        std::ofstream file(filename);
+        for (int i = 0; i < 100; ++i)
+            file << i << " |A " << i << "\n";
+    }
+
+    // Reads two sweeps with a window of 3 chunks, optionally restoring or saving the state.
+    auto read = [&](size_t numberOfWorkers, size_t workerRank, const std::map<std::wstring, size_t>* restore,
+        std::map<std::wstring, size_t>* save, size_t saveAt)
+    {
+        auto parser = CNTKTextFormatReaderTestRunner<float>::CreateStreamingParser(filename, streams, 64, false);
+        LTStreamingRandomizer randomizer(parser, true, false, 3, 0, 10);
+
+        EpochConfiguration config;
+        config.m_numberOfWorkers = numberOfWorkers;
+        config.m_workerRank = workerRank;
+        config.m_minibatchSizeInSamples = 1;
+        config.m_totalEpochSizeInSamples = SIZE_MAX;
+        config.m_totalEpochSizeInSweeps = 2;
+        config.m_epochIndex = 0;
+        randomizer.StartEpoch(config);
+        if (restore)
+            randomizer.SetState(*restore);
+
+        vector<float> values;
+        for (;;)
+        {
+            if (save && values.size() == saveAt)
+                *save = randomizer.GetState();
+
+            auto sequences = randomizer.GetNextSequences(1, 1);
+            if (!sequences.m_data.empty())
+                values.push_back(*reinterpret_cast<const float*>(sequences.m_data[0][0]->GetDataBuffer()));
+            if (sequences.m_endOfEpoch)
+                break;
+        }
+        return values;
+    };
+
+    auto values = read(1, 0, nullptr, nullptr, 0);
+    BOOST_REQUIRE_EQUAL(values.size(), 200);
+
+    // Each sweep sees all sequences once, in a different order.
+    vector<float> expected(100);
+    std::iota(expected.begin(), expected.end(), 0.f);
+    for (size_t sweep = 0; sweep < 2; ++sweep)
+    {
+        vector<float> sorted(values.begin() + sweep * 100, values.begin() + (sweep + 1) * 100);
+        std::sort(sorted.begin(), sorted.end());
+        BOOST_REQUIRE(sorted == expected);
+    }
+    BOOST_REQUIRE(!std::equal(values.begin(), values.begin() + 100, expected.begin()));
+    BOOST_REQUIRE(!std::equal(values.begin(), values.begin() + 100, values.begin() + 100));
+
+    // Restoring from a checkpoint continues with the same sequences.
+    std::map<std::wstring, size_t> state;
+    read(1, 0, nullptr, &state, 77);
+    auto resumed = read(1, 0, &state, nullptr, 0);
+    BOOST_REQUIRE_EQUAL(resumed.size(), 200 - 77);
+    BOOST_REQUIRE(std::equal(resumed.begin(), resumed.end(), values.begin() + 77));
+
+    // The workers read disjoint chunks.
+    auto worker0 = read(2, 0, nullptr, nullptr, 0);
+    auto worker1 = read(2, 1, nullptr, nullptr, 0);
+    BOOST_REQUIRE_EQUAL(worker0.size() + worker1.size(), 200);
+
+    boost::filesystem::remove(filename);
+};
+
 BOOST_AUTO_TEST_CASE(CNTKTextFormatReaderNoFirstMinibatchData)
 {
     HelperRunReaderTest<double>(
@@ -0,0 +1,185 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "Common/ReaderTestHelper.h"
+#include "../../../Source/Readers/HTKDeserializers/CompressedLatticeArchive.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+using ::CNTK::CompressedLatticeArchive;
+
+// lattices.lats is a legacy lattice archive with synthetic V2 lattices from _test_lattice() of Scripts/lat2cla.py, lattices.toc its TOC,
+// lattices.cla the same lattices converted by Scripts/lat2cla.py --input lattices.toc --output lattices.cla.
+struct CompressedLatticeArchiveFixture : ReaderFixture
+{
+    CompressedLatticeArchiveFixture()
+        : ReaderFixture("/Data/HTKDeserializers/")
+    {
+    }
+
+    static vector<char> ReadFile(const string& path)
+    {
+        ifstream file(path, ios::binary);
+        BOOST_REQUIRE_MESSAGE(file, "Cannot open " << path);
+        return vector<char>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+
+    static void WriteFile(const string& path, const vector<char>& content)
+    {
+        ofstream file(path, ios::binary);
+        file.write(content.data(), content.size());
+    }
+
+    // Returns the keys and the legacy lattices in the order of the TOC.
+    static vector<pair<string, vector<char>>> ReadLegacyLattices(const string& tocPath)
+    {
+        vector<pair<string, size_t>> entries;
+        string archivePath;
+        ifstream toc(tocPath);
+        string line;
+        while (getline(toc, line))
+        {
+            if (line.empty())
+                continue;
+            auto eq = line.find('='), open = line.find('['), close = line.find(']');
+            BOOST_REQUIRE(eq != string::npos && open != string::npos && close != string::npos);
+            if (open > eq + 1)
+                archivePath = line.substr(eq + 1, open - eq - 1);
+            entries.push_back(make_pair(line.substr(0, eq), (size_t)stoull(line.substr(open + 1, close - open - 1))));
+        }
+
+        // All lattices of the test TOC are in one archive.
+        auto archive = ReadFile(archivePath);
+        vector<pair<string, vector<char>>> result;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            size_t end = i + 1 < entries.size() ? entries[i + 1].second : archive.size();
+            result.push_back(make_pair(entries[i].first, vector<char>(archive.begin() + entries[i].second, archive.begin() + end)));
+        }
+        return result;
+    }
+
+    // Writes a modified copy of the archive and tries to open it.
+    template <class Modify>
+    static void OpenModifiedArchive(const vector<char>& original, Modify modify)
+    {
+        auto content = original;
+        modify(content);
+        auto path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.cla")).generic_string();
+        WriteFile(path, content);
+        BOOST_CHECK_THROW(CompressedLatticeArchive archive(wstring(path.begin(), path.end())), std::runtime_error);
+        boost::filesystem::remove(path);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(CompressedLatticeArchiveTestSuite, CompressedLatticeArchiveFixture)
+
+BOOST_AUTO_TEST_CASE(CompressedLatticeArchiveMatchesLegacyArchive)
+{
+    BOOST_CHECK(CompressedLatticeArchive::IsCompressedLatticeArchive(L"lattices.cla"));
+    BOOST_CHECK(!CompressedLatticeArchive::IsCompressedLatticeArchive(L"lattices.lats"));
+    BOOST_CHECK(!CompressedLatticeArchive::IsCompressedLatticeArchive(L"lattices.toc"));
+    // a missing TOC file is reported by the lattice deserializer, which goes on with the next one
+    BOOST_CHECK(!CompressedLatticeArchive::IsCompressedLatticeArchive(L"missing.toc"));
+
+    auto legacy = ReadLegacyLattices("lattices.toc");
+    CompressedLatticeArchive archive(L"lattices.cla");
+    BOOST_REQUIRE_EQUAL(archive.NumberOfLattices(), legacy.size());
+
+    for (size_t i = 0; i < legacy.size(); ++i)
+    {
+        const auto& entry = archive.Entry(i);
+        BOOST_CHECK_EQUAL(archive.Key(entry), legacy[i].first);
+        BOOST_CHECK_EQUAL(&archive.EntryByBlockOffset(entry.blockOffset), &entry);
+        BOOST_CHECK(entry.flags & CompressedLatticeArchive::Lz4);
+        BOOST_CHECK(entry.flags & CompressedLatticeArchive::DeltaNodeTimes);
+
+        BOOST_REQUIRE_EQUAL(entry.originalSize, legacy[i].second.size());
+        vector<char> lattice(entry.originalSize);
+        archive.Decompress(entry.blockOffset, entry.compressedSize, entry.flags, lattice.data(), lattice.size());
+        BOOST_CHECK(lattice == legacy[i].second);
+    }
+
+    BOOST_CHECK_THROW(archive.EntryByBlockOffset(archive.Entry(1).blockOffset + 1), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedLatticeArchiveCorruptBlocks)
+{
+    auto file = ReadFile("lattices.cla");
+    CompressedLatticeArchive archive(L"lattices.cla");
+    const auto& entry = archive.Entry(2);
+    const char* block = file.data() + entry.blockOffset;
+    vector<char> lattice(entry.originalSize);
+
+    // Truncated block, or a block that does not decode to the expected size.
+    BOOST_CHECK_THROW(CompressedLatticeArchive::Lz4Decompress(block, entry.compressedSize - 1, lattice.data(), lattice.size()), std::runtime_error);
+    BOOST_CHECK_THROW(CompressedLatticeArchive::Lz4Decompress(block, entry.compressedSize, lattice.data(), lattice.size() - 1), std::runtime_error);
+    BOOST_CHECK_THROW(CompressedLatticeArchive::Lz4Decompress(block, entry.compressedSize / 2, lattice.data(), lattice.size()), std::runtime_error);
+
+    // A literal length that is cut off, a match before the start of the output, a match offset that is cut off.
+    const char truncatedLength[] = { '\xF0' };
+    const char matchBeforeStart[] = { '\x10', 'a', '\x05', '\x00' };
+    const char truncatedOffset[] = { '\x10', 'a', '\x01' };
+    BOOST_CHECK_THROW(CompressedLatticeArchive::Lz4Decompress(truncatedLength, sizeof(truncatedLength), lattice.data(), 20), std::runtime_error);
+    BOOST_CHECK_THROW(CompressedLatticeArchive::Lz4Decompress(matchBeforeStart, sizeof(matchBeforeStart), lattice.data(), 5), std::runtime_error);
+    BOOST_CHECK_THROW(CompressedLatticeArchive::Lz4Decompress(truncatedOffset, sizeof(truncatedOffset), lattice.data(), 5), std::runtime_error);
+
+    // A valid block: one literal, then a match of 4 repeating it.
+    const char repeated[] = { '\x10', 'a', '\x01', '\x00' };
+    CompressedLatticeArchive::Lz4Decompress(repeated, sizeof(repeated), lattice.data(), 5);
+    BOOST_CHECK_EQUAL(string(lattice.data(), 5), "aaaaa");
+
+    // Node times of something that is not a lattice, or of a lattice cut off in its node times.
+    auto legacy = ReadLegacyLattices("lattices.toc");
+    auto& truncatedLattice = legacy[0].second;
+    BOOST_CHECK_THROW(CompressedLatticeArchive::RestoreNodeTimes(&file[0], 100), std::runtime_error);
+    BOOST_CHECK_THROW(CompressedLatticeArchive::RestoreNodeTimes(truncatedLattice.data(), 52), std::runtime_error);
+    BOOST_CHECK_THROW(CompressedLatticeArchive::RestoreNodeTimes(truncatedLattice.data(), 20), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedLatticeArchiveCorruptFile)
+{
+    auto file = ReadFile("lattices.cla");
+    auto header = *reinterpret_cast<const CompressedLatticeArchive::Header*>(file.data());
+    auto setHeader = [](vector<char>& content, const CompressedLatticeArchive::Header& h) { memcpy(content.data(), &h, sizeof(h)); };
+
+    // Too small for a header, not an archive, unknown version.
+    OpenModifiedArchive(file, [](vector<char>& c) { c.resize(sizeof(CompressedLatticeArchive::Header) - 1); });
+    OpenModifiedArchive(file, [](vector<char>& c) { c[0] ^= 1; });
+    OpenModifiedArchive(file, [&](vector<char>& c) { auto h = header; h.version++; setHeader(c, h); });
+
+    // Truncated in the keys or in the TOC.
+    OpenModifiedArchive(file, [](vector<char>& c) { c.pop_back(); });
+    OpenModifiedArchive(file, [&](vector<char>& c) { c.resize(header.keysOffset - 1); });
+    OpenModifiedArchive(file, [&](vector<char>& c) { c.resize(header.tocOffset + sizeof(CompressedLatticeArchive::TocEntry)); });
+
+    // Header or TOC entries pointing out of bounds.
+    OpenModifiedArchive(file, [&](vector<char>& c) { auto h = header; h.numberOfLattices *= 1000; setHeader(c, h); });
+    OpenModifiedArchive(file, [&](vector<char>& c) { auto h = header; h.keysOffset = c.size() + 1; setHeader(c, h); });
+    OpenModifiedArchive(file, [&](vector<char>& c)
+    {
+        auto toc = reinterpret_cast<CompressedLatticeArchive::TocEntry*>(c.data() + header.tocOffset);
+        toc[1].compressedSize = (uint32_t)c.size();
+    });
+    OpenModifiedArchive(file, [&](vector<char>& c)
+    {
+        auto toc = reinterpret_cast<CompressedLatticeArchive::TocEntry*>(c.data() + header.tocOffset);
+        toc[3].blockOffset = toc[2].blockOffset; // overlaps the previous block
+    });
+    OpenModifiedArchive(file, [&](vector<char>& c)
+    {
+        auto toc = reinterpret_cast<CompressedLatticeArchive::TocEntry*>(c.data() + header.tocOffset);
+        toc[4].keyOffset = c.size();
+    });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
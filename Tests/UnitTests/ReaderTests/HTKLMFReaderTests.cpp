@@ -5,6 +5,8 @@
 #include "stdafx.h"
 #include "Common/ReaderTestHelper.h"
 #include "CPUMatrix.h"
+#include "../../../Source/Readers/HTKDeserializers/HTKChunkDescription.h"
+#include <chrono>
 
 using namespace Microsoft::MSR::CNTK;
 
@@ -402,6 +404,37 @@ BOOST_AUTO_TEST_CASE(HTKDeserializersSimpleDataLoop1)
         true);
 };
 
+// Same as HTKDeserializersSimpleDataLoop1, but chunks are loaded on several threads with read-ahead;
+// the data must not change. The data is a single archive, so this exercises the split of an archive
+// into ranges read by different threads. Reports the loading throughput.
+BOOST_AUTO_TEST_CASE(HTKDeserializersParallelChunkLoad)
+{
+    const size_t epochSize = 500;
+    const size_t numEpochs = 2;
+    auto start = std::chrono::steady_clock::now();
+    HelperRunReaderTest<float>(
+        testDataPath() + "/Config/HTKDeserializersParallelChunkLoad_Config.cntk",
+        testDataPath() + "/Control/HTKMLFReaderSimpleDataLoop1_5_11_Control.txt",
+        testDataPath() + "/Control/HTKDeserializersParallelChunkLoad_Output.txt",
+        "Simple_Test",
+        "reader",
+        epochSize,
+        250,
+        numEpochs,
+        1,
+        1,
+        0,
+        1,
+        false,
+        false,
+        true,
+        {},
+        true);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("HTKDeserializersParallelChunkLoad: " << epochSize * numEpochs << " frames in " << seconds << " seconds, "
+                       << (seconds > 0 ? epochSize * numEpochs / seconds : 0.0) << " frames/sec");
+};
+
 BOOST_AUTO_TEST_CASE(HTKDeserializersSimpleDataLoop5)
 {
     HelperRunReaderTest<float>(
@@ -671,6 +704,45 @@ BOOST_AUTO_TEST_CASE(HTKDeserializers_NonExistingScpFile)
         "reader");
 };
 
+// A binary MLF (Scripts/mlf2bin.py) must give the same minibatches as the text MLF it was converted from.
+BOOST_AUTO_TEST_CASE(HTKDeserializersBinaryMLF)
+{
+    const string dataPath = testDataPath() + "/Data/HTKDeserializers";
+    const std::wstring labelDataDir = L"LabelDataDir=" + std::wstring(dataPath.begin(), dataPath.end());
+    auto readLabels = [&](const std::wstring& mlfFile, const string& outputFile)
+    {
+        HelperReadInAndWriteOut<float>(
+            testDataPath() + "/Config/HTKDeserializersBinaryMLF_Config.cntk",
+            outputFile,
+            "Simple_Test",
+            "reader",
+            500,
+            250,
+            2,
+            1,
+            1,
+            0,
+            1,
+            false,
+            false,
+            true,
+            { labelDataDir, L"MlfFile=" + mlfFile });
+    };
+
+    readLabels(L"glob_0000_40.mlf", testDataPath() + "/Control/HTKDeserializersTextMLF_Output.txt");
+    readLabels(L"glob_0000_40.mlfbin", testDataPath() + "/Control/HTKDeserializersBinaryMLF_Output.txt");
+    CheckFilesEquivalent(
+        testDataPath() + "/Control/HTKDeserializersTextMLF_Output.txt",
+        testDataPath() + "/Control/HTKDeserializersBinaryMLF_Output.txt");
+
+    // The binary MLF was converted with state.list; a state list with the same states in another order is rejected.
+    HelperRunReaderTestWithException<float, std::runtime_error>(
+        testDataPath() + "/Config/HTKDeserializersBinaryMLF_Config.cntk",
+        "Simple_Test",
+        "reader",
+        { labelDataDir, L"MlfFile=glob_0000_40.mlfbin", L"StateList=state_swapped.list" });
+};
+
 BOOST_AUTO_TEST_CASE(HTKDeserializersSimpleDataLoop2)
 {
     HelperRunReaderTest<float>(
@@ -846,6 +918,60 @@ BOOST_AUTO_TEST_CASE(HTKIVectorBptt)
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(HTKChunkInfoTestSuite)
+
+// Adds an utterance of the given number of frames, following the previous one in the given archive.
+static void AddUtterance(::CNTK::HTKChunkInfo& chunk, unsigned int archiveIndex, uint32_t numFrames)
+{
+    ::CNTK::htkfeatreader::parsedpath path;
+    path.s = 0;
+    path.e = numFrames - 1;
+    path.archivePathIdx = archiveIndex;
+    path.isarchive = true;
+    path.isidxformat = false;
+    chunk.Add(::CNTK::UtteranceDescription(std::move(path)));
+}
+
+BOOST_AUTO_TEST_CASE(HTKChunkInfoReadRanges)
+{
+    // a single archive is split into ranges of about the same number of frames
+    ::CNTK::HTKChunkInfo singleArchive(0);
+    for (size_t i = 0; i < 12; ++i)
+        AddUtterance(singleArchive, 0, 100);
+
+    std::vector<size_t> expected = { 0, 12 };
+    auto ranges = singleArchive.GetReadRanges(1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(ranges.begin(), ranges.end(), expected.begin(), expected.end());
+
+    expected = { 0, 3, 6, 9, 12 };
+    ranges = singleArchive.GetReadRanges(4);
+    BOOST_CHECK_EQUAL_COLLECTIONS(ranges.begin(), ranges.end(), expected.begin(), expected.end());
+
+    // no more ranges than utterances
+    expected = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    ranges = singleArchive.GetReadRanges(64);
+    BOOST_CHECK_EQUAL_COLLECTIONS(ranges.begin(), ranges.end(), expected.begin(), expected.end());
+
+    // ranges never span two archives, and long utterances get a range of their own
+    ::CNTK::HTKChunkInfo multipleArchives(1);
+    AddUtterance(multipleArchives, 0, 100);
+    AddUtterance(multipleArchives, 0, 100);
+    AddUtterance(multipleArchives, 1, 400);
+    AddUtterance(multipleArchives, 1, 100);
+    AddUtterance(multipleArchives, 1, 100);
+    AddUtterance(multipleArchives, 2, 100);
+
+    expected = { 0, 2, 5, 6 };
+    ranges = multipleArchives.GetReadRanges(1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(ranges.begin(), ranges.end(), expected.begin(), expected.end());
+
+    expected = { 0, 2, 3, 5, 6 };
+    ranges = multipleArchives.GetReadRanges(3);
+    BOOST_CHECK_EQUAL_COLLECTIONS(ranges.begin(), ranges.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 }
 
 }}}
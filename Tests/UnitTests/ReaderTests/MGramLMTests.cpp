@@ -0,0 +1,239 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <set>
+#include "Common/ReaderTestHelper.h"
+#include "../../../Source/Readers/HTKMLFReader/msra_mgram.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+// defined by the reader that includes msra_mgram.h, HTKMLFReader.cpp, which is not linked into the tests
+namespace msra { namespace lm {
+
+/*static*/ const mgram_map::index_t mgram_map::nindex = (mgram_map::index_t) -1; // invalid index
+}
+}
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+using msra::lm::CMGramLM;
+using msra::lm::CHashedMGramLM;
+
+static const double c_scoreTolerance = 1e-5;
+
+// The symbol map that CMGramLM::read() maps the LM's words to. (CSymbolSet hashes the pointers of
+// its keys with std::hash<const char*>, so it cannot look up words by their string with libstdc++.)
+class SymbolMap
+{
+    unordered_map<string, int> m_ids;
+    vector<string> m_symbols;
+
+public:
+    int sym2existingId(const string& symbol) const
+    {
+        auto iter = m_ids.find(symbol);
+        return iter != m_ids.end() ? iter->second : -1;
+    }
+    int sym2id(const string& symbol)
+    {
+        auto result = m_ids.insert(make_pair(symbol, (int)m_symbols.size()));
+        if (result.second)
+            m_symbols.push_back(symbol);
+        return result.first->second;
+    }
+    const char* id2sym(int id) const
+    {
+        return m_symbols[id].c_str();
+    }
+    size_t size() const
+    {
+        return m_symbols.size();
+    }
+};
+
+// trigram.arpa is a small hand-written trigram LM over the words a..e, with back-off weights
+// for all unigrams and bigrams, and trigrams only for some of the bigram histories.
+struct MGramLMFixture : ReaderFixture
+{
+    MGramLMFixture()
+        : ReaderFixture("/Data/MGramLM/")
+    {
+    }
+
+    // Writes a random trigram LM with 'vocabularySize' words in ARPA format. Every word has
+    // 'bigramsPerWord' successors, every second bigram is a trigram history with 'trigramsPerBigram' successors.
+    static void WriteRandomArpa(const string& path, int vocabularySize, int bigramsPerWord, int trigramsPerBigram)
+    {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> word(0, vocabularySize - 1);
+        std::uniform_real_distribution<float> logP(-3.0f, -0.1f), logB(-1.0f, 0.0f);
+        auto successors = [&](int count)
+        {
+            set<int> result;
+            while ((int)result.size() < count)
+                result.insert(word(rng));
+            return result;
+        };
+
+        // m-grams must be sorted by the unigram order, i.e. by word index
+        vector<set<int>> bigrams(vocabularySize);
+        vector<pair<pair<int, int>, set<int>>> trigrams;
+        size_t numBigrams = 0, numTrigrams = 0;
+        for (int w1 = 0; w1 < vocabularySize; w1++)
+        {
+            bigrams[w1] = successors(bigramsPerWord);
+            numBigrams += bigrams[w1].size();
+            for (int w2 : bigrams[w1])
+                if (rng() % 2 == 0)
+                {
+                    trigrams.push_back(make_pair(make_pair(w1, w2), successors(trigramsPerBigram)));
+                    numTrigrams += trigrams.back().second.size();
+                }
+        }
+
+        FILE* f = fopen(path.c_str(), "w");
+        BOOST_REQUIRE_MESSAGE(f, "Cannot create " << path);
+        fprintf(f, "\\data\\\nngram 1=%d\nngram 2=%d\nngram 3=%d\n", vocabularySize, (int)numBigrams, (int)numTrigrams);
+        fprintf(f, "\n\\1-grams:\n");
+        for (int w = 0; w < vocabularySize; w++)
+            fprintf(f, "%.4f w%d %.4f\n", logP(rng), w, logB(rng));
+        fprintf(f, "\n\\2-grams:\n");
+        for (int w1 = 0; w1 < vocabularySize; w1++)
+            for (int w2 : bigrams[w1])
+                fprintf(f, "%.4f w%d w%d %.4f\n", logP(rng), w1, w2, logB(rng));
+        fprintf(f, "\n\\3-grams:\n");
+        for (const auto& trigram : trigrams)
+            for (int w3 : trigram.second)
+                fprintf(f, "%.4f w%d w%d w%d\n", logP(rng), trigram.first.first, trigram.first.second, w3);
+        fprintf(f, "\n\\end\\\n");
+        fclose(f);
+    }
+
+    // Scores 'words' left to right with the state interface, and checks each word against CMGramLM::score().
+    static void CheckSentence(const CMGramLM& lm, const CHashedMGramLM& hashedLM, const vector<int>& words)
+    {
+        int s = hashedLM.initialstate(nullptr, 0);
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            int m = (int)min(i + 1, (size_t)lm.order());
+            double expected = lm.score(&words[i + 1 - m], m);
+            BOOST_CHECK_CLOSE_FRACTION(hashedLM.score(s, words[i], s), expected, c_scoreTolerance);
+        }
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(MGramLMTestSuite, MGramLMFixture)
+
+BOOST_AUTO_TEST_CASE(HashedMGramLMMatchesMGramLM)
+{
+    // 'x' is known to the user but not to the LM
+    SymbolMap symbols;
+    const int oov = symbols.sym2id("x");
+    CMGramLM lm;
+    lm.read(L"trigram.arpa", symbols, /*filterVocabulary=*/false, /*maxM=*/3);
+    BOOST_REQUIRE_EQUAL(lm.order(), 3);
+
+    CHashedMGramLM hashedLM;
+    hashedLM.build(lm);
+    BOOST_CHECK_EQUAL(hashedLM.order(), 3);
+    BOOST_CHECK(hashedLM.oov(oov));
+    BOOST_CHECK(!hashedLM.oov(symbols.sym2existingId("a")));
+
+    // all m-grams of up to three words over the LM's vocabulary and the OOV word: m-grams in the LM,
+    // back-offs from trigram to bigram or unigram, and unknown histories
+    vector<int> words;
+    for (const char* word : { "<s>", "</s>", "a", "b", "c", "d", "e", "x" })
+        words.push_back(symbols.sym2id(word));
+    for (int m = 1; m <= 3; m++)
+    {
+        vector<size_t> index(m, 0);
+        for (;;)
+        {
+            vector<int> mgram(m);
+            for (int k = 0; k < m; k++)
+                mgram[k] = words[index[k]];
+            BOOST_CHECK_CLOSE_FRACTION(hashedLM.score(mgram.data(), m), lm.score(mgram.data(), m), c_scoreTolerance);
+
+            int k = m - 1;
+            while (k >= 0 && ++index[k] == words.size())
+                index[k--] = 0;
+            if (k < 0)
+                break;
+        }
+    }
+
+    // scoring a sentence incrementally; the state has to follow back-offs and OOVs
+    vector<int> sentence;
+    for (const char* word : { "<s>", "a", "b", "a", "c", "e", "x", "b", "d", "a", "</s>" })
+        sentence.push_back(symbols.sym2id(word));
+    CheckSentence(lm, hashedLM, sentence);
+
+    // a context of more than M-1 words only uses the last M-1
+    const int context[] = { symbols.sym2id("c"), symbols.sym2id("<s>"), symbols.sym2id("a") };
+    int s = hashedLM.initialstate(context, 3);
+    int trigram[] = { symbols.sym2id("<s>"), symbols.sym2id("a"), symbols.sym2id("b") };
+    BOOST_CHECK_CLOSE_FRACTION(lm.score(trigram, 3), -0.1 * log(10.0), c_scoreTolerance); // ARPA scores are log10
+    BOOST_CHECK_CLOSE_FRACTION(hashedLM.score(s, symbols.sym2id("b"), s), lm.score(trigram, 3), c_scoreTolerance);
+}
+
+BOOST_AUTO_TEST_CASE(HashedMGramLMThroughput)
+{
+    const int vocabularySize = 2000;
+    auto path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.arpa")).generic_string();
+    WriteRandomArpa(path, vocabularySize, /*bigramsPerWord=*/20, /*trigramsPerBigram=*/5);
+
+    SymbolMap symbols;
+    CMGramLM lm;
+    lm.read(wstring(path.begin(), path.end()), symbols, /*filterVocabulary=*/false, /*maxM=*/3);
+    boost::filesystem::remove(path);
+    CHashedMGramLM hashedLM;
+    hashedLM.build(lm);
+
+    // A random word sequence. Uniformly drawn words mostly back off to unigrams, so most words
+    // repeat an earlier word pair instead, to also exercise bigram and trigram hits.
+    const size_t numQueries = 1000000;
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> word(0, vocabularySize - 1);
+    vector<int> words(numQueries);
+    for (size_t i = 0; i < numQueries; i++)
+    {
+        if (i >= 2 && rng() % 4 != 0)
+            words[i] = words[rng() % (i - 1) + 1];
+        else
+        {
+            char name[20];
+            sprintf(name, "w%d", word(rng));
+            words[i] = symbols.sym2id(name);
+        }
+    }
+    CheckSentence(lm, hashedLM, vector<int>(words.begin(), words.begin() + 10000));
+
+    auto start = std::chrono::steady_clock::now();
+    double total = 0;
+    for (size_t i = 0; i < numQueries; i++)
+    {
+        int m = (int)min(i + 1, (size_t)3);
+        total += lm.score(&words[i + 1 - m], m);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("CMGramLM: " << numQueries << " queries in " << seconds << " seconds, " << (seconds > 0 ? numQueries / seconds : 0.0) << " queries/sec");
+
+    start = std::chrono::steady_clock::now();
+    double hashedTotal = 0;
+    int s = hashedLM.initialstate(nullptr, 0);
+    for (size_t i = 0; i < numQueries; i++)
+        hashedTotal += hashedLM.score(s, words[i], s);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("CHashedMGramLM: " << numQueries << " queries in " << seconds << " seconds, " << (seconds > 0 ? numQueries / seconds : 0.0) << " queries/sec");
+
+    BOOST_CHECK_CLOSE_FRACTION(hashedTotal, total, c_scoreTolerance);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -0,0 +1,226 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include <set>
+#include <thread>
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include "PerformanceProfiler.h"
+
+using namespace std;
+namespace pt = boost::property_tree;
+namespace fs = boost::filesystem;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// Profiles into a directory of its own, which is removed afterwards.
+struct PerformanceProfilerFixture
+{
+    PerformanceProfilerFixture()
+        : m_dir(fs::temp_directory_path() / fs::unique_path("cntk-profiler-%%%%-%%%%"))
+    {
+        fs::create_directories(m_dir);
+    }
+
+    ~PerformanceProfilerFixture()
+    {
+        ProfilerClose();
+        fs::remove_all(m_dir);
+    }
+
+    void Init(unsigned long long bufferBytes, bool ringBuffer)
+    {
+        ProfilerInit(m_dir.wstring(), bufferBytes, L"test", /*syncGpu=*/false, ringBuffer);
+        ProfilerEnable(true);
+    }
+
+    static string EventName(size_t i)
+    {
+        char name[16];
+        sprintf(name, "event %04d", (int)i);
+        return name;
+    }
+
+    static void RecordEvents(size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            auto stateId = ProfilerTimeBegin();
+            ProfilerTimeEnd(stateId, EventName(i).c_str());
+        }
+    }
+
+    // Dumps the trace and returns its events, after the process_name metadata event it starts with.
+    vector<pt::ptree> DumpTrace()
+    {
+        auto fileName = (m_dir / "trace.json").wstring();
+        ProfilerDumpTrace(fileName);
+
+        pt::ptree trace;
+        pt::read_json((m_dir / "trace.json").string(), trace);
+        BOOST_REQUIRE_EQUAL(trace.get<string>("displayTimeUnit"), "ms");
+
+        vector<pt::ptree> events;
+        for (const auto& event : trace.get_child("traceEvents"))
+            events.push_back(event.second);
+        BOOST_REQUIRE(!events.empty());
+        BOOST_CHECK_EQUAL(events[0].get<string>("name"), "process_name");
+        BOOST_CHECK_EQUAL(events[0].get<string>("ph"), "M");
+        BOOST_CHECK_EQUAL(events[0].get<string>("args.name"), "CNTK test");
+        events.erase(events.begin());
+
+        for (const auto& event : events)
+        {
+            BOOST_CHECK_EQUAL(event.get<unsigned int>("pid"), events.front().get<unsigned int>("pid"));
+            BOOST_CHECK_GE(event.get<double>("ts"), 0.0);
+        }
+        return events;
+    }
+
+    // Checks that the events are complete ("X") events named after first, first + 1, ...
+    static void CheckConsecutiveEvents(const vector<pt::ptree>& events, size_t first)
+    {
+        double ts = 0;
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            BOOST_CHECK_EQUAL(events[i].get<string>("name"), EventName(first + i));
+            BOOST_CHECK_EQUAL(events[i].get<string>("ph"), "X");
+            BOOST_CHECK(events[i].count("tid") == 1);
+            BOOST_CHECK_GE(events[i].get<double>("dur"), 0.0);
+            BOOST_CHECK_GE(events[i].get<double>("ts"), ts);
+            ts = events[i].get<double>("ts");
+        }
+    }
+
+    fs::path m_dir;
+};
+
+BOOST_FIXTURE_TEST_SUITE(PerformanceProfilerTestSuite, PerformanceProfilerFixture)
+
+// The ring buffer keeps the most recent events, in order, across several wraps.
+BOOST_AUTO_TEST_CASE(RingBufferKeepsMostRecentEvents)
+{
+    const unsigned long long bufferBytes = 1024;
+    const size_t numEvents = 200;
+    Init(bufferBytes, /*ringBuffer=*/true);
+    RecordEvents(0, numEvents);
+
+    auto events = DumpTrace();
+    // a record takes at most 64 bytes: the header and "event nnnn", padded
+    BOOST_CHECK_GE(events.size(), bufferBytes / 64);
+    BOOST_REQUIRE_LT(events.size(), numEvents);
+    CheckConsecutiveEvents(events, numEvents - events.size());
+
+    // the trace can be dumped at any time, and recording goes on
+    RecordEvents(numEvents, numEvents + 5);
+    auto moreEvents = DumpTrace();
+    BOOST_REQUIRE(!moreEvents.empty());
+    CheckConsecutiveEvents(moreEvents, numEvents + 5 - moreEvents.size());
+}
+
+// Without the ring buffer, the events that do not fit anymore are dropped.
+BOOST_AUTO_TEST_CASE(FullBufferDropsNewEvents)
+{
+    const unsigned long long bufferBytes = 1024;
+    Init(bufferBytes, /*ringBuffer=*/false);
+    RecordEvents(0, 200);
+
+    auto events = DumpTrace();
+    BOOST_CHECK_GE(events.size(), bufferBytes / 64);
+    BOOST_CHECK_LT(events.size(), (size_t)200);
+    CheckConsecutiveEvents(events, 0);
+}
+
+// Events are only recorded while profiling is enabled.
+BOOST_AUTO_TEST_CASE(DisabledProfilerRecordsNothing)
+{
+    Init(4096, /*ringBuffer=*/true);
+    ProfilerEnable(false);
+    RecordEvents(0, 10);
+    ProfilerCounter("counter", 1);
+    BOOST_CHECK(DumpTrace().empty());
+
+    ProfilerEnable(true);
+    RecordEvents(10, 12);
+    auto events = DumpTrace();
+    BOOST_CHECK_EQUAL(events.size(), (size_t)2);
+    CheckConsecutiveEvents(events, 10);
+}
+
+// Flows link events on different threads, counters become "C" events, and names are escaped.
+BOOST_AUTO_TEST_CASE(FlowsCountersAndEscapedNames)
+{
+    Init(64 * 1024, /*ringBuffer=*/true);
+
+    auto flowId = ProfilerFlowBegin("minibatch");
+    thread consumer([flowId]()
+    {
+        auto stateId = ProfilerTimeBegin();
+        ProfilerFlowEnd(flowId, "minibatch");
+        ProfilerTimeEnd(stateId, "consume");
+    });
+    consumer.join();
+    ProfilerCounter("samples/sec", 1234.5);
+    const string quotedName = "say \"hi\"\\\tthere";
+    auto stateId = ProfilerTimeBegin();
+    ProfilerTimeEnd(stateId, quotedName.c_str());
+
+    auto events = DumpTrace();
+    BOOST_REQUIRE_EQUAL(events.size(), (size_t)5);
+
+    const auto& flowBegin = events[0];
+    BOOST_CHECK_EQUAL(flowBegin.get<string>("name"), "minibatch");
+    BOOST_CHECK_EQUAL(flowBegin.get<string>("cat"), "flow");
+    BOOST_CHECK_EQUAL(flowBegin.get<string>("ph"), "s");
+    BOOST_CHECK_EQUAL(flowBegin.get<unsigned long long>("id"), flowId);
+
+    const auto& flowEnd = events[1];
+    BOOST_CHECK_EQUAL(flowEnd.get<string>("name"), "minibatch");
+    BOOST_CHECK_EQUAL(flowEnd.get<string>("cat"), "flow");
+    BOOST_CHECK_EQUAL(flowEnd.get<string>("ph"), "f");
+    BOOST_CHECK_EQUAL(flowEnd.get<string>("bp"), "e");
+    BOOST_CHECK_EQUAL(flowEnd.get<unsigned long long>("id"), flowId);
+    BOOST_CHECK_NE(flowEnd.get<unsigned int>("tid"), flowBegin.get<unsigned int>("tid"));
+    BOOST_CHECK_GE(flowEnd.get<double>("ts"), flowBegin.get<double>("ts"));
+
+    // the flow ends inside the consumer's event
+    const auto& consume = events[2];
+    BOOST_CHECK_EQUAL(consume.get<string>("name"), "consume");
+    BOOST_CHECK_EQUAL(consume.get<string>("ph"), "X");
+    BOOST_CHECK_EQUAL(consume.get<unsigned int>("tid"), flowEnd.get<unsigned int>("tid"));
+    BOOST_CHECK_LE(consume.get<double>("ts"), flowEnd.get<double>("ts"));
+    BOOST_CHECK_GE(consume.get<double>("ts") + consume.get<double>("dur") + 0.001, flowEnd.get<double>("ts"));
+
+    const auto& counter = events[3];
+    BOOST_CHECK_EQUAL(counter.get<string>("name"), "samples/sec");
+    BOOST_CHECK_EQUAL(counter.get<string>("ph"), "C");
+    BOOST_CHECK_CLOSE(counter.get<double>("args.value"), 1234.5, 1e-3);
+
+    BOOST_CHECK_EQUAL(events[4].get<string>("name"), quotedName);
+}
+
+// ProfilerClose() writes the summary, the detail log and the trace.
+BOOST_AUTO_TEST_CASE(CloseWritesReports)
+{
+    Init(4096, /*ringBuffer=*/false);
+    RecordEvents(0, 3);
+    ProfilerClose();
+
+    set<string> kinds;
+    for (fs::directory_iterator file(m_dir), end; file != end; ++file)
+    {
+        auto name = file->path().filename().string();
+        for (const auto& kind : { "_summary_test.txt", "_detail_test.csv", "_trace_test.json" })
+            if (name.size() > strlen(kind) && name.compare(name.size() - strlen(kind), string::npos, kind) == 0)
+                kinds.insert(kind);
+    }
+    BOOST_CHECK_EQUAL(kinds.size(), (size_t)3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -4,6 +4,7 @@
 //
 
 #include "stdafx.h"
+#include <chrono>
 #include <numeric>
 #include <random>
 #include <set>
@@ -1092,6 +1093,147 @@ BOOST_AUTO_TEST_CASE(CheckEpochBoundarySingleWorker)
     test(underTestNo);
 }
 
+// With length buckets, a sweep returns the same sequences, in a reproducible order, with less padding
+// (the number of sequences times the longest sequence, minus the samples, summed over minibatches).
+BOOST_AUTO_TEST_CASE(BlockRandomizerLengthBuckets)
+{
+    size_t chunkSizeInSamples = 10000;
+    size_t sweepNumberOfSamples = 100000;
+    uint32_t maxSequenceLength = 100;
+    size_t randomizationWindow = chunkSizeInSamples * 3;
+    size_t minibatchSize = 400;
+    auto deserializer = make_shared<SequentialDeserializer>(0, chunkSizeInSamples, sweepNumberOfSamples, maxSequenceLength);
+
+    auto readSweep = [&](size_t numberOfLengthBuckets, vector<float>& sequenceIds)
+    {
+        auto randomizer = make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true, false, 0, true, 0, numberOfLengthBuckets);
+
+        EpochConfiguration config;
+        config.m_numberOfWorkers = 1;
+        config.m_workerRank = 0;
+        config.m_minibatchSizeInSamples = minibatchSize;
+        config.m_totalEpochSizeInSamples = sweepNumberOfSamples;
+        config.m_epochIndex = 0;
+        randomizer->StartEpoch(config);
+
+        size_t padding = 0;
+        Sequences s;
+        do
+        {
+            s = randomizer->GetNextSequences(minibatchSize, minibatchSize);
+            if (s.m_data.empty())
+                continue;
+
+            size_t numberOfSamples = 0, maxLength = 0;
+            for (const auto& seq : s.m_data.front())
+            {
+                sequenceIds.push_back(*((float*)seq->GetDataBuffer()));
+                numberOfSamples += seq->m_numberOfSamples;
+                maxLength = max(maxLength, (size_t)seq->m_numberOfSamples);
+            }
+            padding += s.m_data.front().size() * maxLength - numberOfSamples;
+        } while (!s.m_endOfEpoch);
+        return padding;
+    };
+
+    vector<float> randomized, bucketed, bucketedAgain;
+    size_t randomizedPadding = readSweep(0, randomized);
+    size_t bucketedPadding = readSweep(8, bucketed);
+    readSweep(8, bucketedAgain);
+
+    BOOST_CHECK(bucketed == bucketedAgain);
+    BOOST_CHECK(bucketed != randomized);
+    BOOST_CHECK_LT(bucketedPadding * 2, randomizedPadding);
+
+    sort(randomized.begin(), randomized.end());
+    sort(bucketed.begin(), bucketed.end());
+    BOOST_CHECK(bucketed == randomized);
+}
+
+BOOST_AUTO_TEST_CASE(BlockRandomizerContiguousChunkPlacement)
+{
+    size_t chunkSizeInSamples = 1000;
+    size_t sweepNumberOfSamples = 40000;
+    uint32_t maxSequenceLength = 50;
+    size_t randomizationWindowInChunks = 8;
+    size_t minibatchSize = 400;
+    size_t numberOfWorkers = 4;
+    auto deserializer = make_shared<SequentialDeserializer>(0, chunkSizeInSamples, sweepNumberOfSamples, maxSequenceLength);
+    const auto& corpus = deserializer->Corpus();
+
+    // Original chunks read by each worker in each of two sweeps, and its local samples of each minibatch.
+    vector<vector<set<size_t>>> chunks(2, vector<set<size_t>>(numberOfWorkers));
+    vector<vector<size_t>> localSamples(numberOfWorkers);
+    size_t numberOfSamples = 0;
+    for (size_t rank = 0; rank < numberOfWorkers; ++rank)
+    {
+        auto randomizer = make_shared<BlockRandomizer>(0, randomizationWindowInChunks, deserializer, true, false, 0, false, 0, 0, true);
+        for (size_t epoch = 0; epoch < 2; ++epoch)
+        {
+            EpochConfiguration config;
+            config.m_numberOfWorkers = numberOfWorkers;
+            config.m_workerRank = rank;
+            config.m_minibatchSizeInSamples = minibatchSize;
+            config.m_totalEpochSizeInSamples = sweepNumberOfSamples;
+            config.m_epochIndex = epoch;
+            randomizer->StartEpoch(config);
+
+            Sequences s;
+            do
+            {
+                s = randomizer->GetNextSequences(minibatchSize, minibatchSize);
+                size_t samples = 0;
+                for (const auto& sequence : s.m_data.empty() ? vector<SequenceDataPtr>() : s.m_data.front())
+                {
+                    chunks[epoch][rank].insert(corpus.at((size_t)*((float*)sequence->GetDataBuffer())).chunkId);
+                    samples += sequence->m_numberOfSamples;
+                }
+                localSamples[rank].push_back(samples);
+                numberOfSamples += samples;
+            } while (!s.m_endOfEpoch);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(numberOfSamples, 2 * sweepNumberOfSamples);
+    for (size_t epoch = 0; epoch < 2; ++epoch)
+    {
+        // Each chunk is read by exactly one worker.
+        set<size_t> all;
+        for (size_t rank = 0; rank < numberOfWorkers; ++rank)
+        {
+            BOOST_REQUIRE(!chunks[epoch][rank].empty());
+            for (auto c : chunks[epoch][rank])
+                BOOST_CHECK(all.insert(c).second);
+        }
+        BOOST_CHECK_EQUAL(all.size(), deserializer->ChunkInfos().size());
+
+        // Each worker reads the same part of every group of randomized chunks, so the workers' chunks are
+        // ordered by their position in the input. The parts rotate between sweeps.
+        double previousMean = -1;
+        for (size_t i = 0; i < numberOfWorkers; ++i)
+        {
+            const auto& workerChunks = chunks[epoch][(i + epoch) % numberOfWorkers];
+            double mean = accumulate(workerChunks.begin(), workerChunks.end(), 0.0) / workerChunks.size();
+            BOOST_CHECK_GT(mean, previousMean);
+            previousMean = mean;
+        }
+    }
+
+    // Every randomization window has about the same number of samples of each worker, so the minibatches stay balanced
+    // (if each worker read one part of the input, a window could come from the chunks of a single worker).
+    size_t minibatchesPerWindow = randomizationWindowInChunks * chunkSizeInSamples / minibatchSize;
+    double expectedSamples = minibatchesPerWindow * (double)minibatchSize / numberOfWorkers;
+    for (size_t rank = 0; rank < numberOfWorkers; ++rank)
+    {
+        for (size_t i = 0; i + minibatchesPerWindow <= localSamples[rank].size(); i += minibatchesPerWindow)
+        {
+            auto begin = localSamples[rank].begin() + i;
+            double samples = (double)accumulate(begin, begin + minibatchesPerWindow, (size_t)0);
+            BOOST_CHECK_LT(fabs(samples - expectedSamples), 0.5 * expectedSamples);
+        }
+    }
+}
+
 // Make sure we do not cut the minibatches at the end of the epoch such that they
 // contain only a single sequence. For example, with an input data consisting of 3-sample
 // sequences, minibatch size set to 90 and the epoch size to 100, the source should return
@@ -1802,6 +1944,105 @@ BOOST_AUTO_TEST_CASE(TestTruncatedBpttPacker)
     BOOST_TEST(!mb.m_endOfSweep);
 }
 
+BOOST_AUTO_TEST_CASE(TestTruncatedBpttPackerData)
+{
+    size_t chunkSizeInSamples = 100;
+    size_t sweepNumberOfSamples = 1000;
+    uint32_t maxSequenceLength = 20;
+    auto deserializer = make_shared<SequentialDeserializer>(0, chunkSizeInSamples, sweepNumberOfSamples, maxSequenceLength);
+    auto noRandomizer = make_shared<NoRandomizer>(deserializer, true);
+    auto packer = std::make_shared<TruncatedBPTTPacker>(noRandomizer, deserializer->StreamInfos());
+
+    EpochConfiguration config;
+    config.m_allowMinibatchesToCrossSweepBoundaries = true;
+    config.m_numberOfWorkers = 1;
+    config.m_minibatchSizeInSamples = 32;
+    config.m_truncationSize = 5;
+    config.m_totalEpochSizeInSweeps = 3;
+    config.m_epochIndex = 0;
+
+    noRandomizer->StartEpoch(config);
+    packer->SetConfiguration(config,
+        std::vector<MemoryProviderPtr> { std::make_shared<HeapMemoryProvider>() });
+
+    // The deserializer produces the sample values 0 .. N-1 in order, so the samples of a sequence have consecutive values,
+    // also across the minibatches a sequence is truncated into.
+    std::vector<bool> seen(sweepNumberOfSamples, false);
+    std::vector<float> lastValueOfSlot;
+    size_t sampleCount = 0;
+    while (sampleCount < sweepNumberOfSamples * 2)
+    {
+        auto mb = packer->ReadMinibatch();
+        BOOST_REQUIRE(!mb.m_data.empty());
+
+        const auto& layout = mb.m_data[0]->m_layout;
+        const float* data = (const float*)mb.m_data[0]->m_data;
+        size_t numParallelSequences = layout->GetNumParallelSequences();
+        size_t numTimeSteps = layout->GetNumTimeSteps();
+        BOOST_REQUIRE_EQUAL(numTimeSteps, config.m_truncationSize);
+        lastValueOfSlot.resize(numParallelSequences, -1);
+
+        for (const auto& sequence : layout->GetAllSequences())
+        {
+            if (sequence.seqId == GAP_SEQUENCE_ID)
+                continue;
+
+            size_t begin = (size_t)max(sequence.tBegin, (ptrdiff_t)0);
+            size_t end = min(sequence.tEnd, numTimeSteps);
+            float expected = sequence.tBegin < 0 ? lastValueOfSlot[sequence.s] + 1 : data[begin * numParallelSequences + sequence.s];
+            for (size_t t = begin; t < end; ++t, ++expected)
+            {
+                float value = data[t * numParallelSequences + sequence.s];
+                BOOST_REQUIRE_EQUAL(value, expected);
+                seen[(size_t)value] = true;
+            }
+            if (sequence.tEnd > numTimeSteps)
+                lastValueOfSlot[sequence.s] = data[(numTimeSteps - 1) * numParallelSequences + sequence.s];
+        }
+
+        sampleCount += layout->GetActualNumSamples();
+    }
+
+    BOOST_CHECK(std::all_of(seen.begin(), seen.end(), [](bool b) { return b; }));
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedBpttPackerThroughput)
+{
+    size_t chunkSizeInSamples = 10000;
+    size_t sweepNumberOfSamples = 2000000;
+    uint32_t maxSequenceLength = 500;
+    auto deserializer = make_shared<SequentialDeserializer>(0, chunkSizeInSamples, sweepNumberOfSamples, maxSequenceLength);
+    auto noRandomizer = make_shared<NoRandomizer>(deserializer, true);
+    auto packer = std::make_shared<TruncatedBPTTPacker>(noRandomizer, deserializer->StreamInfos());
+
+    EpochConfiguration config;
+    config.m_allowMinibatchesToCrossSweepBoundaries = true;
+    config.m_numberOfWorkers = 1;
+    config.m_minibatchSizeInSamples = 2560;
+    config.m_truncationSize = 20;
+    config.m_totalEpochSizeInSweeps = 2;
+    config.m_epochIndex = 0;
+
+    noRandomizer->StartEpoch(config);
+    packer->SetConfiguration(config,
+        std::vector<MemoryProviderPtr> { std::make_shared<HeapMemoryProvider>() });
+
+    // One sweep of minibatches of 128 parallel sequences, each truncated into runs of 20 samples.
+    // This includes getting the chunks from the deserializer, which copies them.
+    size_t sampleCount = 0, minibatchCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (sampleCount < sweepNumberOfSamples)
+    {
+        auto mb = packer->ReadMinibatch();
+        BOOST_REQUIRE(!mb.m_data.empty());
+        sampleCount += mb.m_data[0]->m_layout->GetActualNumSamples();
+        minibatchCount++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE("TruncatedBpttPackerThroughput: " << sampleCount << " samples in " << minibatchCount << " minibatches in "
+        << seconds << " seconds, " << (seconds > 0 ? sampleCount / seconds : 0.0) << " samples/sec");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
@@ -31,6 +31,7 @@ namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
 
         void* m_data;
         NDShape m_sampleShape;
+        ChunkPtr m_chunk; // keeps m_data alive while a packer holds on to the sequence
     };
 
     // A mock deserializer that produces N sequential samples
@@ -47,7 +48,7 @@ namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
             float startingValue;
         };
 
-        struct SequentialChunk : Chunk
+        struct SequentialChunk : Chunk, std::enable_shared_from_this<SequentialChunk>
         {
             std::vector<std::vector<float>> m_data;
             size_t m_sizeInSamples;
@@ -91,6 +92,7 @@ namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
                 s->m_data = (void*)&data[0];
                 s->m_numberOfSamples = (uint32_t)data.size();
                 s->m_sampleShape = m_sampleShape;
+                s->m_chunk = shared_from_this();
                 result.push_back(s);
             }
         };
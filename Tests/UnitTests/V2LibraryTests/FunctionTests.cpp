@@ -564,6 +564,197 @@ void TestTimesIndirectSparseInputGradientSparse(const DeviceDescriptor& device)
         ReportFailure("Gradient is expected to be sparse.");
 }
 
+// Loss and gradients of SampledSoftmax for a given multiset of sampled classes, in double precision.
+struct SampledSoftmaxReference
+{
+    double loss;
+    std::vector<double> inputGradient;
+    std::vector<double> weightsGradient;
+    std::vector<double> biasGradient;
+};
+
+static SampledSoftmaxReference ComputeSampledSoftmaxReference(const std::vector<size_t>& labelClasses, const std::vector<float>& input,
+                                                              const std::vector<float>& weights, const std::vector<float>& bias,
+                                                              const std::vector<double>& logQ, const std::vector<size_t>& sampledClasses)
+{
+    const size_t numClasses = bias.size();
+    const size_t inputDim = weights.size() / numClasses;
+    SampledSoftmaxReference result = { 0, std::vector<double>(input.size()), std::vector<double>(weights.size()), std::vector<double>(numClasses) };
+    for (size_t t = 0; t < labelClasses.size(); t++)
+    {
+        // softmax over the true class, followed by the sampled classes
+        std::vector<size_t> classes(1, labelClasses[t]);
+        classes.insert(classes.end(), sampledClasses.begin(), sampledClasses.end());
+        std::vector<double> logits(classes.size());
+        for (size_t j = 0; j < classes.size(); j++)
+        {
+            logits[j] = bias[classes[j]] - logQ[classes[j]];
+            for (size_t i = 0; i < inputDim; i++)
+                logits[j] += (double)weights[classes[j] * inputDim + i] * input[t * inputDim + i];
+        }
+        double maxLogit = *std::max_element(logits.begin(), logits.end());
+        double sumOfExp = 0;
+        for (auto logit : logits)
+            sumOfExp += exp(logit - maxLogit);
+        double logSumOfExp = maxLogit + log(sumOfExp);
+        result.loss += logSumOfExp - logits[0];
+
+        for (size_t j = 0; j < classes.size(); j++)
+        {
+            double logitGradient = exp(logits[j] - logSumOfExp) - (j == 0 ? 1 : 0);
+            size_t k = classes[j];
+            result.biasGradient[k] += logitGradient;
+            for (size_t i = 0; i < inputDim; i++)
+            {
+                result.weightsGradient[k * inputDim + i] += logitGradient * input[t * inputDim + i];
+                result.inputGradient[t * inputDim + i] += logitGradient * weights[k * inputDim + i];
+            }
+        }
+    }
+    return result;
+}
+
+// Appends all sorted multisets of 'size' classes out of classes[first...] to 'result'.
+static void EnumerateMultisets(const std::vector<size_t>& classes, size_t first, size_t size, std::vector<size_t>& current, std::vector<std::vector<size_t>>& result)
+{
+    if (current.size() == size)
+    {
+        result.push_back(current);
+        return;
+    }
+    for (size_t i = first; i < classes.size(); i++)
+    {
+        current.push_back(classes[i]);
+        EnumerateMultisets(classes, i, size, current, result);
+        current.pop_back();
+    }
+}
+
+static void CompareWithSampledSoftmaxReference(const std::vector<float>& actual, const std::vector<double>& expected, const char* message)
+{
+    if (actual.size() != expected.size())
+    {
+        ReportFailure("%s; Expected %d elements, Actual %d", message, (int)expected.size(), (int)actual.size());
+        return;
+    }
+    for (size_t i = 0; i < actual.size(); i++)
+    {
+        if (std::abs(actual[i] - expected[i]) > 1e-4 + 1e-3 * std::abs(expected[i]))
+            ReportFailure("%s; Element %d: Expected=%g, Actual=%g", message, (int)i, expected[i], actual[i]);
+    }
+}
+
+void TestSampledSoftmax(const DeviceDescriptor& device, bool useSamplingWeights)
+{
+    // The classes that the node draws are not observable. Instead, the loss of every multiset of classes that can be drawn
+    // is computed, and the one that matches the loss of the node identifies the drawn classes (for the data below, the losses
+    // of any two multisets differ by more than 1e-3). The gradients of the node are compared with the reference for these
+    // classes, and the frequencies of the classes drawn with many seeds with the sampling distribution.
+    const size_t inputDim = 3;
+    const size_t numClasses = 5;
+    const size_t numSamples = 3;
+    const size_t numSeeds = 400;
+    const size_t numSeedsWithGradientCheck = 10;
+    const std::vector<size_t> labelClasses = { 0, 3, 1, 3, 2 };
+    const size_t batchSize = labelClasses.size();
+    std::vector<float> inputData = { 0.5f, -1.0f, 0.25f, 1.5f, 0.75f, -0.5f, -0.25f, 1.25f, 1.0f, 0.0f, -0.75f, 0.5f, 1.0f, 0.25f, -1.5f };
+    std::vector<float> weightsData = { 0.3f, -0.8f, 0.5f, -0.4f, 0.9f, 0.1f, 0.7f, 0.2f, -0.6f, -0.9f, -0.3f, 0.8f, 0.05f, 0.6f, -0.2f }; // [inputDim x numClasses]
+    std::vector<float> biasData = { 0.1f, -0.3f, 0.25f, 0.0f, -0.15f };
+    std::vector<float> samplingWeightsData = { 4, 3, 2, 1, 0 };
+
+    // sampling distribution, and the log of the expected number of occurrences of each class in the sampled set
+    std::vector<double> probabilities(numClasses), logQ(numClasses);
+    const double sumOfSamplingWeights = std::accumulate(samplingWeightsData.begin(), samplingWeightsData.end(), 0.0);
+    std::vector<size_t> drawableClasses;
+    for (size_t k = 0; k < numClasses; k++)
+    {
+        probabilities[k] = useSamplingWeights ? samplingWeightsData[k] / sumOfSamplingWeights : (log(k + 2.0) - log(k + 1.0)) / log(numClasses + 1.0);
+        logQ[k] = log(std::max(probabilities[k], (double)std::numeric_limits<float>::min()) * numSamples);
+        if (probabilities[k] > 0)
+            drawableClasses.push_back(k);
+    }
+
+    std::vector<size_t> current;
+    std::vector<std::vector<size_t>> multisets;
+    EnumerateMultisets(drawableClasses, 0, numSamples, current, multisets);
+    std::vector<SampledSoftmaxReference> references;
+    for (const auto& multiset : multisets)
+        references.push_back(ComputeSampledSoftmaxReference(labelClasses, inputData, weightsData, biasData, logQ, multiset));
+
+    auto input = InputVariable(NDShape({ inputDim }), DataType::Float, L"input");
+    auto labels = InputVariable(NDShape({ numClasses }), DataType::Float, L"labels");
+    auto weights = Parameter(MakeSharedObject<NDArrayView>(NDShape({ inputDim, numClasses }), weightsData.data(), weightsData.size(), DeviceDescriptor::CPUDevice(), true)->DeepClone(device));
+    auto bias = Parameter(MakeSharedObject<NDArrayView>(NDShape({ numClasses }), biasData.data(), biasData.size(), DeviceDescriptor::CPUDevice(), true)->DeepClone(device));
+    auto samplingWeights = Constant(MakeSharedObject<NDArrayView>(NDShape({ numClasses }), samplingWeightsData.data(), samplingWeightsData.size(), DeviceDescriptor::CPUDevice(), true)->DeepClone(device));
+
+    std::vector<float> labelsData(numClasses * batchSize, 0);
+    for (size_t t = 0; t < batchSize; t++)
+        labelsData[t * numClasses + labelClasses[t]] = 1;
+    std::unordered_map<Variable, ValuePtr> arguments = {
+        { input, Value::CreateBatch(NDShape({ inputDim }), inputData, device, true) },
+        { labels, Value::CreateBatch(NDShape({ numClasses }), labelsData, device, true) } };
+
+    std::vector<size_t> counts(numClasses, 0);
+    for (unsigned long seed = 1; seed <= numSeeds; seed++)
+    {
+        auto loss = useSamplingWeights ? SampledSoftmax(labels, input, weights, bias, samplingWeights, numSamples, seed, L"sampledSoftmax")
+                                       : SampledSoftmax(labels, input, weights, bias, numSamples, seed, L"sampledSoftmax");
+        std::unordered_map<Variable, ValuePtr> outputs = { { loss->Output(), nullptr } };
+        auto backpropState = loss->Forward(arguments, outputs, device, { loss->Output() });
+        float lossValue = *outputs[loss->Output()]->Data()->DeepClone(DeviceDescriptor::CPUDevice())->DataBuffer<float>();
+
+        size_t drawn = 0;
+        for (size_t i = 1; i < references.size(); i++)
+        {
+            if (std::abs(references[i].loss - lossValue) < std::abs(references[drawn].loss - lossValue))
+                drawn = i;
+        }
+        if (std::abs(references[drawn].loss - lossValue) > 1e-4)
+        {
+            ReportFailure("SampledSoftmax: loss %g does not match the loss of any set of sampled classes (seed %d).", lossValue, (int)seed);
+            continue;
+        }
+        for (auto k : multisets[drawn])
+            counts[k]++;
+
+        if (seed > numSeedsWithGradientCheck)
+            continue;
+
+        std::unordered_map<Variable, ValuePtr> rootGradients = { { loss->Output(), MakeSharedObject<Value>(MakeSharedObject<NDArrayView>(1.0f, NDShape({}), device)) } };
+        std::unordered_map<Variable, ValuePtr> inputGradients = { { input, nullptr }, { weights, nullptr }, { bias, nullptr } };
+        loss->Backward(backpropState, rootGradients, inputGradients);
+
+        std::vector<std::vector<float>> inputGradientPerSample;
+        inputGradients[input]->CopyVariableValueTo(input, inputGradientPerSample);
+        std::vector<float> inputGradient;
+        for (const auto& sample : inputGradientPerSample)
+            inputGradient.insert(inputGradient.end(), sample.begin(), sample.end());
+        auto parameterGradient = [&inputGradients](const Variable& parameter)
+        {
+            auto gradient = MakeSharedObject<NDArrayView>(DataType::Float, StorageFormat::Dense, parameter.Shape(), DeviceDescriptor::CPUDevice());
+            gradient->CopyFrom(*inputGradients[parameter]->Data());
+            return std::vector<float>(gradient->DataBuffer<float>(), gradient->DataBuffer<float>() + gradient->Shape().TotalSize());
+        };
+
+        // the gradients of the weights and bias are only non-zero in the columns of the true and sampled classes,
+        // and the one of the weights is kept sparse, as for Times with a sparse input
+        if (!inputGradients[weights]->IsSparse())
+            ReportFailure("SampledSoftmax: gradient of the weights is expected to be sparse.");
+        const auto& reference = references[drawn];
+        CompareWithSampledSoftmaxReference(inputGradient, reference.inputGradient, "SampledSoftmax: gradient of the input does not match the reference");
+        CompareWithSampledSoftmaxReference(parameterGradient(weights), reference.weightsGradient, "SampledSoftmax: gradient of the weights does not match the reference");
+        CompareWithSampledSoftmaxReference(parameterGradient(bias), reference.biasGradient, "SampledSoftmax: gradient of the bias does not match the reference");
+    }
+
+    // 4 standard deviations of the frequency of any class
+    for (size_t k = 0; k < numClasses; k++)
+    {
+        double frequency = (double)counts[k] / (numSeeds * numSamples);
+        if (std::abs(frequency - probabilities[k]) > 0.06)
+            ReportFailure("SampledSoftmax: class %d was drawn with frequency %g instead of %g.", (int)k, frequency, probabilities[k]);
+    }
+}
+
 template <typename ElementType>
 void TestChangingParameterValues(size_t rank, const DeviceDescriptor& device)
 {
@@ -1204,6 +1395,21 @@ BOOST_AUTO_TEST_CASE(TimesIndirectSparseGradType)
 }
 
 
+BOOST_AUTO_TEST_CASE(SampledSoftmax)
+{
+    if (ShouldRunOnCpu())
+    {
+        TestSampledSoftmax(DeviceDescriptor::CPUDevice(), /*useSamplingWeights=*/false);
+        TestSampledSoftmax(DeviceDescriptor::CPUDevice(), /*useSamplingWeights=*/true);
+    }
+
+    if (ShouldRunOnGpu())
+    {
+        TestSampledSoftmax(DeviceDescriptor::GPUDevice(0), /*useSamplingWeights=*/false);
+        TestSampledSoftmax(DeviceDescriptor::GPUDevice(0), /*useSamplingWeights=*/true);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(TestSettingDropoutRate)
 {
     if (ShouldRunOnCpu())
@@ -7,6 +7,7 @@
 #include <functional>
 #include "Common.h"
 #include <numeric>
+#include <chrono>
 #include "CNTKLibraryC.h"
 
 using namespace CNTK;
@@ -377,6 +378,257 @@ void TestSimpleRecurrence(size_t inputDim,
     }
 }
 
+// Compares the beam search decoder against an exhaustive search, on a step Function whose scores depend on the previous
+// token and on a recurrent state: scores = T * token + U * state, next state = tanh(state + E * token).
+// The beam is wide enough for the search to be exact.
+void TestBeamSearchDecoderIsExact(double lengthNormalizationExponent, const DeviceDescriptor& device)
+{
+    const size_t vocabularySize = 4;
+    const size_t stateDim = 3;
+    const size_t numSequences = 2;
+    const size_t maxLength = 3;
+    const size_t startToken = 0;
+    const size_t endToken = 1;
+    const size_t nBest = 3;
+    const size_t beamWidth = 16; // = vocabularySize^(maxLength - 1), nothing is pruned
+
+    auto token = InputVariable({ vocabularySize }, DataType::Double, L"token", { Axis::DefaultBatchAxis() });
+    auto state = InputVariable({ stateDim }, DataType::Double, L"state", { Axis::DefaultBatchAxis() });
+    auto T = NDArrayView::RandomUniform<double>({ vocabularySize, vocabularySize }, -2, 2, 1, device);
+    auto U = NDArrayView::RandomUniform<double>({ vocabularySize, stateDim }, -2, 2, 2, device);
+    auto E = NDArrayView::RandomUniform<double>({ stateDim, vocabularySize }, -2, 2, 3, device);
+    auto scores = Plus(Times(Constant(T), token), Times(Constant(U), state), L"scores");
+    auto nextState = Tanh(Plus(state, Times(Constant(E), token)), L"nextState");
+    auto stepFunction = Combine({ scores, nextState });
+
+    auto decoder = CreateBeamSearchDecoder(stepFunction, token, scores, { { state, nextState } },
+                                           startToken, endToken, beamWidth, maxLength, nBest, lengthNormalizationExponent);
+
+    auto initialStates = NDArrayView::RandomUniform<double>({ stateDim, numSequences }, -1, 1, 4, DeviceDescriptor::CPUDevice());
+    auto initialStateData = initialStates->DataBuffer<double>();
+    auto results = decoder->Decode({ { state, MakeSharedObject<Value>(initialStates->DeepClone(device)) } }, device);
+    BOOST_REQUIRE_EQUAL(results.size(), numSequences);
+
+    auto t = T->DeepClone(DeviceDescriptor::CPUDevice())->DataBuffer<double>();
+    auto u = U->DeepClone(DeviceDescriptor::CPUDevice())->DataBuffer<double>();
+    auto e = E->DeepClone(DeviceDescriptor::CPUDevice())->DataBuffer<double>();
+
+    for (size_t s = 0; s < numSequences; s++)
+    {
+        // enumerate all hypotheses
+        std::vector<BeamSearchHypothesis> expected;
+        std::function<void(std::vector<size_t>&, std::vector<double>, double)> expand = [&](std::vector<size_t>& tokens, std::vector<double> h, double logProbability)
+        {
+            size_t previous = tokens.empty() ? startToken : tokens.back();
+            std::vector<double> z(vocabularySize);
+            for (size_t v = 0; v < vocabularySize; v++)
+            {
+                z[v] = t[v + previous * vocabularySize];
+                for (size_t d = 0; d < stateDim; d++)
+                    z[v] += u[v + d * vocabularySize] * h[d];
+            }
+            double logNormalizer = 0;
+            for (size_t v = 0; v < vocabularySize; v++)
+                logNormalizer += exp(z[v]);
+            logNormalizer = log(logNormalizer);
+
+            for (size_t v = 0; v < vocabularySize; v++)
+            {
+                tokens.push_back(v);
+                double p = logProbability + z[v] - logNormalizer;
+                if ((v == endToken) || (tokens.size() == maxLength))
+                    expected.push_back({ tokens, p, p / pow((double)tokens.size(), lengthNormalizationExponent) });
+                else
+                {
+                    std::vector<double> nextH(stateDim);
+                    for (size_t d = 0; d < stateDim; d++)
+                        nextH[d] = tanh(h[d] + e[d + v * stateDim]);
+                    expand(tokens, nextH, p);
+                }
+                tokens.pop_back();
+            }
+        };
+        std::vector<size_t> tokens;
+        expand(tokens, std::vector<double>(initialStateData + s * stateDim, initialStateData + (s + 1) * stateDim), 0);
+        std::stable_sort(expected.begin(), expected.end(), [](const BeamSearchHypothesis& a, const BeamSearchHypothesis& b) { return a.score > b.score; });
+
+        BOOST_REQUIRE_EQUAL(results[s].size(), nBest);
+        for (size_t n = 0; n < nBest; n++)
+        {
+            BOOST_TEST(results[s][n].tokens == expected[n].tokens);
+            FloatingPointCompare(results[s][n].logProbability, expected[n].logProbability, "Beam search log-probability does not match");
+            FloatingPointCompare(results[s][n].score, expected[n].score, "Beam search score does not match");
+        }
+    }
+}
+
+// Evaluates an LSTM model on streams fed in chunks of varying lengths, which join and leave at different times and sometimes
+// have no input, and compares the outputs with the evaluation of the full sequences.
+void TestStreamingEvaluator(const DeviceDescriptor& device)
+{
+    const size_t inputDim = 6;
+    const size_t cellDim = 5;
+    const size_t hiddenDim = 4;
+    const size_t numOutputClasses = 3;
+    const size_t numLSTMLayers = 2;
+
+    auto features = InputVariable({ inputDim }, DataType::Double, L"features");
+    auto model = LSTMNet<double>(features, cellDim, hiddenDim, numOutputClasses, numLSTMLayers, device, L"classifierOutput");
+    auto output = model->Output();
+
+    const std::vector<size_t> sequenceLengths = { 11, 4, 9, 6 };
+    const std::vector<size_t> firstCalls = { 0, 0, 2, 4 }; // sequence 2 takes the parallel sequence that sequence 1 left
+    auto sequences = GenerateSequences<double>(sequenceLengths, { inputDim });
+
+    // the full sequences are evaluated with a clone, so that the streaming evaluation builds its own network
+    auto fullSequenceModel = model->Clone(ParameterCloningMethod::Share);
+    std::vector<std::vector<double>> expected(sequences.size());
+    for (size_t i = 0; i < sequences.size(); i++)
+    {
+        std::unordered_map<Variable, ValuePtr> outputs = { { fullSequenceModel->Output(), nullptr } };
+        fullSequenceModel->Evaluate({ { fullSequenceModel->Arguments()[0], Value::CreateSequence<double>(features.Shape(), sequences[i], device) } }, outputs, device);
+        std::vector<std::vector<double>> outputData;
+        outputs[fullSequenceModel->Output()]->CopyVariableValueTo(fullSequenceModel->Output(), outputData);
+        expected[i] = outputData[0];
+    }
+
+    auto evaluator = CreateStreamingEvaluator(model, { output }, device);
+    std::vector<size_t> streamIds(sequences.size(), SIZE_MAX);
+    std::vector<size_t> numFramesDone(sequences.size(), 0);
+    std::vector<std::vector<double>> actual(sequences.size());
+    for (size_t call = 0; numFramesDone != sequenceLengths; call++)
+    {
+        std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>> inputs;
+        for (size_t i = 0; i < sequences.size(); i++)
+        {
+            if ((call < firstCalls[i]) || (numFramesDone[i] == sequenceLengths[i]))
+                continue;
+
+            if (streamIds[i] == SIZE_MAX)
+                streamIds[i] = evaluator->AddStream();
+
+            if ((call + i) % 4 == 3)
+                continue; // no input in this call
+
+            size_t chunkLength = std::min(1 + (call + i) % 3, sequenceLengths[i] - numFramesDone[i]);
+            std::vector<double> chunk(sequences[i].begin() + numFramesDone[i] * inputDim, sequences[i].begin() + (numFramesDone[i] + chunkLength) * inputDim);
+            inputs[streamIds[i]] = { { features, Value::CreateSequence<double>(features.Shape(), chunk, device) } };
+            numFramesDone[i] += chunkLength;
+        }
+
+        std::unordered_map<size_t, std::unordered_map<Variable, ValuePtr>> outputs;
+        evaluator->Evaluate(inputs, outputs);
+        BOOST_REQUIRE_EQUAL(outputs.size(), inputs.size());
+
+        for (size_t i = 0; i < sequences.size(); i++)
+        {
+            if ((streamIds[i] == SIZE_MAX) || (outputs.find(streamIds[i]) == outputs.end()))
+                continue;
+
+            std::vector<std::vector<double>> outputData;
+            outputs[streamIds[i]][output]->CopyVariableValueTo(output, outputData);
+            actual[i].insert(actual[i].end(), outputData[0].begin(), outputData[0].end());
+
+            if (numFramesDone[i] == sequenceLengths[i])
+            {
+                evaluator->RemoveStream(streamIds[i]);
+                streamIds[i] = SIZE_MAX;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < sequences.size(); i++)
+        FloatingPointVectorCompare(actual[i], expected[i], "Streaming evaluation does not match the evaluation of the full sequence");
+}
+
+// Decodes with a step Function of the size of the CMUDict sequence-to-sequence example (embedding 200, 2 LSTM layers
+// of 512, 69 tokens), and reports the time of a greedy decoding running the step Function for one sequence at a time
+// against the beam search decoder, which must produce the same output with a beam of one.
+template <typename ElementType>
+void BeamSearchDecoderPerformance(const DeviceDescriptor& device)
+{
+    const size_t vocabularySize = 69;
+    const size_t embeddingDim = 200;
+    const size_t hiddenDim = 512;
+    const size_t numLayers = 2;
+    const size_t numSequences = 32;
+    const size_t maxLength = 30;
+    const size_t startToken = 0;
+    const size_t endToken = 1;
+
+    auto token = InputVariable({ vocabularySize }, true /*isSparse*/, AsDataType<ElementType>(), L"token", { Axis::DefaultBatchAxis() });
+    Variable x = Embedding(token, embeddingDim, device);
+    std::vector<std::pair<Variable, Variable>> states;
+    std::vector<Variable> outputs;
+    for (size_t i = 0; i < numLayers; i++)
+    {
+        auto dh = InputVariable({ hiddenDim }, AsDataType<ElementType>(), L"dh", { Axis::DefaultBatchAxis() });
+        auto dc = InputVariable({ hiddenDim }, AsDataType<ElementType>(), L"dc", { Axis::DefaultBatchAxis() });
+        auto hc = LSTMPCellWithSelfStabilization<ElementType>(x, dh, dc, device);
+        states.push_back({ dh, hc.first });
+        states.push_back({ dc, hc.second });
+        x = hc.first;
+    }
+    auto scores = FullyConnectedLinearLayer(x, vocabularySize, device, L"scores");
+    outputs.push_back(scores);
+    for (const auto& s : states)
+        outputs.push_back(s.second);
+    auto stepFunction = Combine(outputs);
+
+    std::vector<NDArrayViewPtr> initialStates;
+    std::unordered_map<Variable, ValuePtr> initialValues;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        initialStates.push_back(NDArrayView::RandomUniform<ElementType>({ hiddenDim, numSequences }, -1, 1, (unsigned long)i + 1, DeviceDescriptor::CPUDevice()));
+        initialValues[states[i].first] = MakeSharedObject<Value>(initialStates[i]->DeepClone(device));
+    }
+
+    // greedy decoding, one sequence and one step at a time
+    std::vector<std::vector<size_t>> greedyTokens(numSequences);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t s = 0; s < numSequences; s++)
+    {
+        std::unordered_map<Variable, ValuePtr> arguments;
+        for (size_t i = 0; i < states.size(); i++)
+            arguments[states[i].first] = MakeSharedObject<Value>(initialStates[i]->SliceView({ 0, s }, { hiddenDim, 1 })->DeepClone(device));
+
+        size_t previous = startToken;
+        while ((greedyTokens[s].size() < maxLength) && (previous != endToken))
+        {
+            arguments[token] = Value::CreateBatch<ElementType>(vocabularySize, { previous }, device);
+            std::unordered_map<Variable, ValuePtr> stepOutputs;
+            for (const auto& output : outputs)
+                stepOutputs[output] = nullptr;
+            stepFunction->Evaluate(arguments, stepOutputs, device);
+
+            auto z = stepOutputs[scores]->Data()->DeepClone(DeviceDescriptor::CPUDevice());
+            auto zData = z->DataBuffer<ElementType>();
+            previous = std::max_element(zData, zData + vocabularySize) - zData;
+            greedyTokens[s].push_back(previous);
+            for (const auto& state : states)
+                arguments[state.first] = stepOutputs[state.second]->DeepClone();
+        }
+    }
+    auto greedyTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    for (size_t beamWidth : { 1, 5 })
+    {
+        auto decoder = CreateBeamSearchDecoder(stepFunction, token, scores, states, startToken, endToken, beamWidth, maxLength);
+        start = std::chrono::high_resolution_clock::now();
+        auto results = decoder->Decode(initialValues, device);
+        auto beamTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        printf("Decoding %d sequences: greedy, one sequence at a time %.3f s, beam search (beam width %d) %.3f s\n",
+               (int)numSequences, greedyTime, (int)beamWidth, beamTime);
+
+        BOOST_REQUIRE_EQUAL(results.size(), numSequences);
+        if (beamWidth == 1)
+        {
+            for (size_t s = 0; s < numSequences; s++)
+                BOOST_TEST(results[s][0].tokens == greedyTokens[s]);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE(RecurrentFunctionSuite)
 
 BOOST_AUTO_TEST_CASE(SimpleRecurrenceInCPU)
@@ -420,6 +672,34 @@ BOOST_AUTO_TEST_CASE(RecurrentNetworkCreationInGPU)
         TestRecurrentNetworkCreation<float>(DeviceDescriptor::GPUDevice(0), true);
 }
 
+BOOST_AUTO_TEST_CASE(BeamSearchDecoderInCPU)
+{
+    if (ShouldRunOnCpu())
+    {
+        TestBeamSearchDecoderIsExact(0.0, DeviceDescriptor::CPUDevice());
+        TestBeamSearchDecoderIsExact(0.7, DeviceDescriptor::CPUDevice());
+        BeamSearchDecoderPerformance<float>(DeviceDescriptor::CPUDevice());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BeamSearchDecoderInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestBeamSearchDecoderIsExact(0.7, DeviceDescriptor::GPUDevice(0));
+}
+
+BOOST_AUTO_TEST_CASE(StreamingEvaluatorInCPU)
+{
+    if (ShouldRunOnCpu())
+        TestStreamingEvaluator(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(StreamingEvaluatorInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestStreamingEvaluator(DeviceDescriptor::GPUDevice(0));
+}
+
 void ParityCandCppLSTMModel(DeviceDescriptor device, CNTK_DeviceDescriptor cdevice)
 {
     const size_t inputDim = 937;
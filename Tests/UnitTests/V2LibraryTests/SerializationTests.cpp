@@ -352,7 +352,8 @@ void CheckEnumValuesNotModified() {
                   static_cast<size_t>(PrimitiveOpType::Squeeze) == 88 &&
                   static_cast<size_t>(PrimitiveOpType::ConstantOp) == 89 &&
                   static_cast<size_t>(PrimitiveOpType::LatticeSequenceWithSoftmax) == 90 &&
-                  static_cast<size_t>(PrimitiveOpType::Cast) == 91,
+                  static_cast<size_t>(PrimitiveOpType::Cast) == 91 &&
+                  static_cast<size_t>(PrimitiveOpType::SampledSoftmax) == 92,
                   "PrimitiveOpType enum value was modified.");
 }
 
@@ -850,6 +851,54 @@ void TestCheckpointingWithStatefulNodes(const DeviceDescriptor& device)
     }
 }
 
+// Checkpoints written in the background hold the state of the time SaveCheckpoint() was called.
+void TestAsyncCheckpointing(const DeviceDescriptor& device)
+{
+    auto featureStreamName = L"features";
+    auto labelsStreamName = L"labels";
+
+    size_t inputDim = 784;
+    size_t numOutputClasses = 10;
+    auto features = InputVariable({ inputDim }, false /*isSparse*/, DataType::Float, featureStreamName);
+    auto labels = InputVariable({ numOutputClasses }, DataType::Float, labelsStreamName);
+    auto net = BuildFFClassifierNet(features, numOutputClasses, device, 1);
+
+    auto trainer = BuildTrainer(net, labels);
+    Internal::SetAsyncCheckpointing(trainer, true, /*maxPendingCheckpoints=*/2);
+
+    const size_t minibatchSize = 50;
+    const size_t epochSize = 150;
+    auto minibatchSource = TextFormatMinibatchSource(L"Train-28x28_cntk_text.txt", { { featureStreamName, inputDim }, { labelsStreamName, numOutputClasses } },  epochSize, false);
+    auto minibatchData = minibatchSource->GetNextMinibatch(minibatchSize, device);
+    auto featureStreamInfo = minibatchSource->StreamInfo(features);
+    auto labelStreamInfo = minibatchSource->StreamInfo(labels);
+
+    vector<double> expectedLoss;
+    for (int i = 0; i < epochSize / minibatchSize; i++)
+    {
+        trainer->SaveCheckpoint(L"async.model" + std::to_wstring(i));
+        trainer->TrainMinibatch({ { features, minibatchData[featureStreamInfo] }, { labels, minibatchData[labelStreamInfo] } }, device);
+        expectedLoss.push_back(trainer->PreviousMinibatchLossAverage());
+    }
+    BOOST_CHECK_GE(Internal::CheckpointStallSeconds(trainer), 0);
+
+    // RestoreFromCheckpoint() waits for the pending writes
+    for (int i = 0; i < epochSize / minibatchSize; i++)
+    {
+        trainer->RestoreFromCheckpoint(L"async.model" + std::to_wstring(i));
+        trainer->TrainMinibatch({ { features, minibatchData[featureStreamInfo] }, { labels, minibatchData[labelStreamInfo] } }, device);
+        double loss = trainer->PreviousMinibatchLossAverage();
+        FloatingPointCompare(loss, expectedLoss[i], "Post checkpoint restoration training loss does not match expectation");
+    }
+
+    // a trainer finishes its pending writes when it is destroyed
+    _wunlink(L"async.model.last");
+    _wunlink(L"async.model.last.ckp");
+    trainer->SaveCheckpoint(L"async.model.last");
+    trainer = nullptr;
+    BOOST_CHECK_NO_THROW(Function::Load(L"async.model.last", device));
+    BOOST_CHECK_NO_THROW(Dictionary::Load(L"async.model.last.ckp"));
+}
 
 void TestCheckpointingWithStatefulNodesAndExplicitSeeds(const DeviceDescriptor& device)
 {
@@ -1029,6 +1078,11 @@ BOOST_AUTO_TEST_CASE(CheckpointingInCPU)
     TestCheckpointing(DeviceDescriptor::CPUDevice());
 }
 
+BOOST_AUTO_TEST_CASE(AsyncCheckpointingInCPU)
+{
+    TestAsyncCheckpointing(DeviceDescriptor::CPUDevice());
+}
+
 BOOST_AUTO_TEST_CASE(LegacyModelSavingInCPU)
 {
     TestLegacyModelSaving(DeviceDescriptor::CPUDevice());
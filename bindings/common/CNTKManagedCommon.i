@@ -249,6 +249,11 @@ IGNORE_STRUCT CNTK::TestConfig;
 IGNORE_CLASS CNTK::TrainingSession;
 IGNORE_FUNCTION CNTK::CreateBasicTrainingSession;
 IGNORE_FUNCTION CNTK::CreateTrainingSession;
+IGNORE_STRUCT CNTK::BeamSearchHypothesis;
+IGNORE_CLASS CNTK::BeamSearchDecoder;
+IGNORE_FUNCTION CNTK::CreateBeamSearchDecoder;
+IGNORE_CLASS CNTK::StreamingEvaluator;
+IGNORE_FUNCTION CNTK::CreateStreamingEvaluator;
 IGNORE_FUNCTION CNTK::CreateDataParallelDistributedTrainer;
 IGNORE_FUNCTION CNTK::CreateQuantizedDataParallelDistributedTrainer;
 IGNORE_FUNCTION CNTK::SetCheckedMode;
@@ -106,6 +106,13 @@
 
 %ignore CNTK::NDArrayView::AdjustSparseBlockColumn;
 
+// the beam search decoder is only exposed to C++ for now
+%ignore CNTK::BeamSearchHypothesis;
+%ignore CNTK::BeamSearchDecoder;
+%ignore CNTK::CreateBeamSearchDecoder;
+%ignore CNTK::StreamingEvaluator;
+%ignore CNTK::CreateStreamingEvaluator;
+
 // renaming overloads for TrainMinibatch and TestMinibatch that take a map
 // of Variables and MinibatchData as their first parameter. If this is not done,
 // the overloads that are legal in C++ will be shadowed and ignored by SWIG.